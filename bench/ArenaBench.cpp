@@ -0,0 +1,80 @@
+// Frame arena benchmarks: per frame scratch buffers from the heap against a frame arena reset at the
+// frame boundary, with heap allocations per frame counted to check that the arena frame makes none
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "Bench.hpp"
+#include "FrameArena.hpp"
+
+namespace
+{
+// Scratch of a frame: CPU noise texture, updated texture list and a filter row
+constexpr size_t c_textureSize = 256 * 256;
+constexpr size_t c_rowSize = 1152 * 4;
+constexpr int c_textureCount = 2;
+
+// Fill per frame scratch like the frame loop does
+template <typename FloatVector, typename IndexVector>
+float fillFrame(FloatVector& texture, FloatVector& row, IndexVector& updated)
+{
+    for (size_t i = 0; i < texture.size(); i += 64) {
+        texture[i] = static_cast<float>(i);
+    }
+    for (size_t i = 0; i < row.size(); i += 64) {
+        row[i] = static_cast<float>(i);
+    }
+    for (int i = 0; i < c_textureCount; i++) {
+        updated.push_back(i);
+    }
+    return texture.back() + row.back() + static_cast<float>(updated.size());
+}
+
+void heapFrame()
+{
+    std::vector<float> texture(c_textureSize);
+    std::vector<float> row(c_rowSize);
+    std::vector<int32_t> updated;
+    Bench::doNotOptimize(fillFrame(texture, row, updated));
+}
+
+void arenaFrame(FrameArena& arena)
+{
+    arena.reset();
+    ArenaVector<float> texture(c_textureSize, 0.0f, ArenaAllocator<float>(arena));
+    ArenaVector<float> row(c_rowSize, 0.0f, ArenaAllocator<float>(arena));
+    ArenaVector<int32_t> updated{ArenaAllocator<int32_t>(arena)};
+    Bench::doNotOptimize(fillFrame(texture, row, updated));
+}
+
+// Returns heap allocations per call of given frame function after warm up
+template <typename Func>
+double countAllocations(Func&& func, int frames = 100)
+{
+    func();
+    const uint64_t before = AllocationCounter::getThreadCount();
+    for (int i = 0; i < frames; i++) {
+        func();
+    }
+    return static_cast<double>(AllocationCounter::getThreadCount() - before) / frames;
+}
+
+}  // namespace
+
+void runArenaBenchmarks(const std::string& filter)
+{
+    if (Bench::isSelected(filter, "frame-arena/heap")) {
+        Bench::run("frame-arena/heap", [] { heapFrame(); });
+        std::printf("%-48s %14.1f allocations/frame\n", "frame-arena/heap", countAllocations([] { heapFrame(); }));
+    }
+
+    if (Bench::isSelected(filter, "frame-arena/arena")) {
+        FrameArena arena;
+        Bench::run("frame-arena/arena", [&] { arenaFrame(arena); });
+        const double allocations = countAllocations([&] { arenaFrame(arena); });
+        std::printf("%-48s %14.1f allocations/frame%s\n", "frame-arena/arena", allocations, allocations > 0.0 ? "  FAIL: expected none" : "");
+    }
+}
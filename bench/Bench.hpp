@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//! Minimal benchmark helpers for portable CPU code paths
+namespace Bench
+{
+//! Benchmark result
+struct Result {
+    double medianNs = 0.0;  //!< Median time per call in nanoseconds
+    double minNs = 0.0;     //!< Minimum time per call in nanoseconds
+};
+
+//! Prevent compiler from optimizing away given value
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+    // Volatile read forces value to be materialized
+    static_cast<void>(*static_cast<const volatile char*>(static_cast<const void*>(&value)));
+}
+
+//! Returns true if benchmark name matches command line filter (substring, empty matches all)
+inline bool isSelected(const std::string& filter, const std::string& name) { return filter.empty() || name.find(filter) != std::string::npos; }
+
+//! Run func repeatedly in timed batches and print median and minimum time per call
+template <typename Func>
+Result run(const std::string& name, Func&& func, int batches = 15, double minBatchMs = 20.0)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Warm up and find batch size long enough for clock resolution
+    int callsPerBatch = 1;
+    while (true) {
+        const auto t0 = Clock::now();
+        for (int i = 0; i < callsPerBatch; i++) {
+            func();
+        }
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        if (ms >= minBatchMs || callsPerBatch >= (1 << 24)) {
+            break;
+        }
+        callsPerBatch *= 2;
+    }
+
+    std::vector<double> samples;
+    for (int b = 0; b < batches; b++) {
+        const auto t0 = Clock::now();
+        for (int i = 0; i < callsPerBatch; i++) {
+            func();
+        }
+        samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / callsPerBatch);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result result;
+    result.medianNs = samples[samples.size() / 2];
+    result.minNs = samples.front();
+    std::printf("%-48s %14.1f ns %14.1f ns\n", name.c_str(), result.medianNs, result.minNs);
+    return result;
+}
+
+}  // namespace Bench
@@ -0,0 +1,71 @@
+// Bilateral grid benchmarks: edge enhancement at camera frame size over grid resolutions, against the
+// separable high pass it replaces
+
+#include <cstdio>
+#include <string>
+
+#include "Bench.hpp"
+#include "BilateralGrid.hpp"
+#include "FilterCPU.hpp"
+
+namespace
+{
+// Video pass through camera frame size
+constexpr int c_width = 1152;
+constexpr int c_height = 1152;
+
+// Grid resolution: cell size in pixels and luminance bins
+struct Resolution {
+    int cellSize;
+    int rangeBins;
+};
+
+const Resolution c_resolutions[] = {{8, 8}, {16, 8}, {32, 8}, {16, 16}};
+
+}  // namespace
+
+void runBilateralGridBenchmarks(const std::string& filter)
+{
+    ImageRGBA src;
+    src.resize(c_width, c_height);
+    for (size_t i = 0; i < src.pixels.size(); i++) {
+        src.pixels[i] = static_cast<float>(((i * 7) ^ (i >> 9)) & 0xff) * (1.0f / 255.0f);
+    }
+    ImageRGBA dst;
+
+    for (const auto& resolution : c_resolutions) {
+        const std::string name =
+            "bilateral-grid/cell" + std::to_string(resolution.cellSize) + "/bins" + std::to_string(resolution.rangeBins);
+        if (!Bench::isSelected(filter, name)) {
+            continue;
+        }
+
+        FilterCPU::Params params;
+        params.filterType = FilterCPU::FilterBilateralGrid;
+        params.gridCellSize = resolution.cellSize;
+        params.gridRangeBins = resolution.rangeBins;
+        BilateralGrid grid;
+        Bench::run(
+            name,
+            [&] {
+                grid.process(src, dst, BilateralGrid::getParams(params));
+                Bench::doNotOptimize(dst.pixels[0]);
+            },
+            5);
+        std::printf("%-48s %d x %d x %d cells\n", "", grid.getSizeX(), grid.getSizeY(), grid.getSizeZ());
+    }
+
+    if (Bench::isSelected(filter, "bilateral-grid/highpass-reference")) {
+        FilterCPU::Params params;
+        params.filterType = FilterCPU::FilterHighPass;
+        params.highPassCutoffFreq = 5.0f;
+        params.lowPassMode = FilterCPU::LowPassSeparable;
+        Bench::run(
+            "bilateral-grid/highpass-reference",
+            [&] {
+                FilterCPU::process(src, dst, params);
+                Bench::doNotOptimize(dst.pixels[0]);
+            },
+            5);
+    }
+}
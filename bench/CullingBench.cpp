@@ -0,0 +1,108 @@
+// View frustum culling benchmarks
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Bench.hpp"
+#include "Bvh.hpp"
+
+namespace
+{
+// Deterministic pseudo random value in [0, 1)
+float hashUnit(uint32_t index, uint32_t channel)
+{
+    uint32_t h = index * 0x9E3779B1u ^ channel * 0x85EBCA77u;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    h *= 0x297A2D39u;
+    h ^= h >> 15;
+    return static_cast<float>(h >> 8) * (1.0f / 16777216.0f);
+}
+
+// Object bounds scattered on a ring around the viewer, like the test scene stress objects
+std::vector<Aabb> makeScene(size_t count)
+{
+    std::vector<Aabb> bounds(count);
+    for (uint32_t i = 0; i < count; i++) {
+        const float radius = 2.0f + 28.0f * std::sqrt(hashUnit(i, 0));
+        const float angle = 6.2831853f * hashUnit(i, 1);
+        const glm::vec3 center(radius * std::cos(angle), 8.0f * hashUnit(i, 2), radius * std::sin(angle));
+        const float extent = 0.5f * (0.05f + 0.15f * hashUnit(i, 3));
+        bounds[i] = {center - glm::vec3(extent), center + glm::vec3(extent)};
+    }
+    return bounds;
+}
+
+// Headset-like view: 100 degree vertical field of view looking along -Z from head height
+glm::mat4 makeViewProj()
+{
+    const glm::mat4 proj = glm::perspective(glm::radians(100.0f), 1.0f, 0.05f, 100.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 1.6f, 0.0f), glm::vec3(0.0f, 1.6f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return proj * view;
+}
+
+}  // namespace
+
+void runCullingBenchmarks(const std::string& filter)
+{
+    const Frustum frustum(makeViewProj());
+
+    for (size_t count : {size_t(1000), size_t(10000), size_t(100000), size_t(1000000)}) {
+        const std::string suffix = "/" + std::to_string(count);
+        auto bounds = makeScene(count);
+
+        Bvh bvh;
+        if (Bench::isSelected(filter, "bvh/build" + suffix)) {
+            Bench::run("bvh/build" + suffix, [&] { bvh.build(bounds); }, 5, 1.0);
+        }
+        bvh.build(bounds);
+
+        // Refit after moving every 16th object, as the stress scene does every frame
+        if (Bench::isSelected(filter, "bvh/refit-1/16" + suffix)) {
+            std::vector<uint32_t> changed;
+            for (uint32_t i = 0; i < count; i += 16) {
+                changed.push_back(i);
+            }
+            float phase = 0.0f;
+            Bench::run("bvh/refit-1/16" + suffix, [&] {
+                phase += 0.01f;
+                const glm::vec3 offset(0.0f, 0.001f * std::sin(phase), 0.0f);
+                for (const uint32_t i : changed) {
+                    bounds[i].min += offset;
+                    bounds[i].max += offset;
+                }
+                bvh.refit(bounds, changed);
+            });
+        }
+
+        std::vector<uint32_t> visible;
+        visible.reserve(count);
+
+        if (Bench::isSelected(filter, "cull/bvh" + suffix)) {
+            Bench::run("cull/bvh" + suffix, [&] {
+                visible.clear();
+                bvh.cull(frustum, visible);
+            });
+            std::printf("%-48s %13.1f %%\n", "  visible", 100.0 * visible.size() / count);
+        }
+
+        // Reference: test every object without hierarchy
+        if (Bench::isSelected(filter, "cull/linear" + suffix)) {
+            Bench::run("cull/linear" + suffix, [&] {
+                visible.clear();
+                for (uint32_t i = 0; i < count; i++) {
+                    const glm::vec3 center = 0.5f * (bounds[i].min + bounds[i].max);
+                    const glm::vec3 extent = 0.5f * (bounds[i].max - bounds[i].min);
+                    if (frustum.test(&center.x, &extent.x) != Frustum::Result::Outside) {
+                        visible.push_back(i);
+                    }
+                }
+            });
+            std::printf("%-48s %13.1f %%\n", "  visible", 100.0 * visible.size() / count);
+        }
+    }
+}
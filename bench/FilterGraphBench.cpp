@@ -0,0 +1,70 @@
+// Filter graph benchmarks: chains of filter stages run with every stage as its own pass over the image
+// against the fused passes the graph compiles them to
+
+#include <cstdio>
+#include <string>
+
+#include "Bench.hpp"
+#include "ColorLut.hpp"
+#include "FilterGraph.hpp"
+
+namespace
+{
+// Video pass through camera frame size
+constexpr int c_width = 1152;
+constexpr int c_height = 1152;
+
+// Filter chain as parsed by FilterGraph
+struct Chain {
+    const char* name;
+    const char* stages;
+};
+
+const Chain c_chains[] = {
+    {"invert-highpass-lut", "invert,highpass:5,lut"},
+    {"highpass-gain-lut", "highpass:5,gain:2:0.1,lut"},
+    {"point-ops", "invert,gain:0.8:0.1,absclamp:2,lut"},
+    {"kaleidoscope-lowpass", "kaleidoscope,invert,lowpass:5,lut"},
+};
+
+}  // namespace
+
+void runFilterGraphBenchmarks(const std::string& filter)
+{
+    ImageRGBA src;
+    src.resize(c_width, c_height);
+    for (size_t i = 0; i < src.pixels.size(); i++) {
+        src.pixels[i] = static_cast<float>(((i * 7) ^ (i >> 9)) & 0xff) * (1.0f / 255.0f);
+    }
+
+    ColorLut colorLut;
+    colorLut.bake(ColorLut::Params());
+
+    FilterCPU::Params engine;
+    engine.lowPassMode = FilterCPU::LowPassSeparable;
+
+    for (const auto& chain : c_chains) {
+        const std::string prefix = std::string("filter-graph/") + chain.name + "/";
+        for (const bool fuse : {false, true}) {
+            const std::string name = prefix + (fuse ? "fused" : "unfused");
+            if (!Bench::isSelected(filter, name)) {
+                continue;
+            }
+
+            FilterGraph graph;
+            std::string error;
+            graph.parse(chain.stages, error);
+            graph.compile(engine, &colorLut, fuse);
+
+            ImageRGBA dst;
+            Bench::run(
+                name,
+                [&] {
+                    graph.process(src, dst);
+                    Bench::doNotOptimize(dst.pixels[0]);
+                },
+                5);
+            std::printf("%-48s %d passes: %s\n", "", graph.getPassCount(), graph.describePasses().c_str());
+        }
+    }
+}
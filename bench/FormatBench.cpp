@@ -0,0 +1,92 @@
+// Pixel format conversion benchmarks: every pair of Varjo texture and working formats at camera frame size,
+// scalar against SIMD for the working format paths, and cached against streaming stores for large targets
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Bench.hpp"
+#include "PixelConvert.hpp"
+
+namespace
+{
+// Video pass through camera frame size
+constexpr int c_width = 1152;
+constexpr int c_height = 1152;
+
+// Source image of given format with values in [0, 1]
+std::vector<uint8_t> makeSource(PixelFormat format)
+{
+    std::vector<float> rgba(static_cast<size_t>(c_width) * c_height * 4);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    for (auto& v : rgba) {
+        v = distribution(rng);
+    }
+
+    std::vector<uint8_t> image(PixelConvert::getRowPitch(format, c_width) * c_height);
+    PixelConvert::convert(PixelFormat::RGBA32Float, rgba.data(), c_width * 4 * sizeof(float), format, image.data(),
+        PixelConvert::getRowPitch(format, c_width), c_width, c_height);
+    return image;
+}
+
+// Benchmark conversion of the frame between given formats
+void runConversion(const std::string& name, PixelFormat srcFormat, PixelFormat dstFormat, PixelConvert::Store store, bool simd)
+{
+    const std::vector<uint8_t> src = makeSource(srcFormat);
+    const size_t srcPitch = PixelConvert::getRowPitch(srcFormat, c_width);
+    const size_t dstPitch = PixelConvert::getRowPitch(dstFormat, c_width, 256);
+    std::vector<uint8_t> dst(dstPitch * c_height);
+
+    Bench::run(
+        name,
+        [&] {
+            PixelConvert::convert(srcFormat, src.data(), srcPitch, dstFormat, dst.data(), dstPitch, c_width, c_height, store, simd);
+            Bench::doNotOptimize(dst[0]);
+        },
+        5);
+}
+
+}  // namespace
+
+void runFormatBenchmarks(const std::string& filter)
+{
+    constexpr int formatCount = static_cast<int>(PixelFormat::Count);
+    for (int s = 0; s < formatCount; s++) {
+        for (int d = 0; d < formatCount; d++) {
+            const auto srcFormat = static_cast<PixelFormat>(s);
+            const auto dstFormat = static_cast<PixelFormat>(d);
+            const std::string name = std::string("format/") + PixelConvert::getName(srcFormat) + "->" + PixelConvert::getName(dstFormat);
+            if (Bench::isSelected(filter, name)) {
+                runConversion(name, srcFormat, dstFormat, PixelConvert::Store::Cached, true);
+            }
+        }
+    }
+
+    // Kernels with a SIMD path, results are identical either way
+    const std::pair<PixelFormat, PixelFormat> simdPairs[] = {
+        {PixelFormat::RGBA8Unorm, PixelFormat::RGBA32Float},
+        {PixelFormat::RGBA32Float, PixelFormat::RGBA8Unorm},
+        {PixelFormat::RGBA16Float, PixelFormat::RGBA32Float},
+        {PixelFormat::RGBA32Float, PixelFormat::RGBA16Float},
+    };
+    for (const auto& pair : simdPairs) {
+        const std::string name = std::string("format/scalar/") + PixelConvert::getName(pair.first) + "->" + PixelConvert::getName(pair.second);
+        if (Bench::isSelected(filter, name)) {
+            runConversion(name, pair.first, pair.second, PixelConvert::Store::Cached, false);
+        }
+    }
+
+    // Targets larger than the cache, like a working float frame or an upload buffer
+    const std::pair<PixelFormat, PixelFormat> largePairs[] = {
+        {PixelFormat::RGBA8Unorm, PixelFormat::RGBA32Float},
+        {PixelFormat::RGBA8Unorm, PixelFormat::RGBA16Float},
+        {PixelFormat::RGBA32Float, PixelFormat::RGBA32Float},
+    };
+    for (const auto& pair : largePairs) {
+        const std::string name = std::string("format/stream/") + PixelConvert::getName(pair.first) + "->" + PixelConvert::getName(pair.second);
+        if (Bench::isSelected(filter, name)) {
+            runConversion(name, pair.first, pair.second, PixelConvert::Store::Streaming, true);
+        }
+    }
+}
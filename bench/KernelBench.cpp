@@ -0,0 +1,67 @@
+// Kernel bank benchmarks: per frame kernel lookup, and low pass at camera frame size with the box
+// kernel against the Gaussian and windowed sinc bank kernels for the cutoffs of the UI slider
+
+#include <cstdio>
+#include <string>
+
+#include "Bench.hpp"
+#include "FilterCPU.hpp"
+#include "KernelBank.hpp"
+
+namespace
+{
+// Video pass through camera frame size
+constexpr int c_width = 1152;
+constexpr int c_height = 1152;
+
+// Cutoffs in cycles per degree within the UI slider range
+constexpr float c_cutoffs[] = {1.0f, 5.0f, 12.0f};
+
+}  // namespace
+
+void runKernelBenchmarks(const std::string& filter)
+{
+    if (Bench::isSelected(filter, "kernel-bank/find")) {
+        float cutoff = 0.1f;
+        Bench::run("kernel-bank/find", [&] {
+            const auto lookup = KernelBank::find(KernelBank::Shape::Gaussian, cutoff, KernelBank::c_defaultPpd);
+            Bench::doNotOptimize(lookup.kernel->weights[0]);
+            cutoff = cutoff < 12.0f ? cutoff + 0.1f : 0.1f;
+        });
+    }
+
+    ImageRGBA src;
+    src.resize(c_width, c_height);
+    for (size_t i = 0; i < src.pixels.size(); i++) {
+        src.pixels[i] = static_cast<float>(((i * 7) ^ (i >> 9)) & 0xff) * (1.0f / 255.0f);
+    }
+    ImageRGBA dst;
+
+    const char* const shapeNames[FilterCPU::KernelShapeCount] = {"box", "gaussian", "sinc"};
+    for (const float cutoff : c_cutoffs) {
+        for (int shape = 0; shape < FilterCPU::KernelShapeCount; shape++) {
+            const std::string name = "kernel-bank/lowpass/" + std::to_string(static_cast<int>(cutoff)) + "cpd/" + shapeNames[shape];
+            if (!Bench::isSelected(filter, name)) {
+                continue;
+            }
+
+            FilterCPU::Params params;
+            params.filterType = FilterCPU::FilterLowPass;
+            params.highPassCutoffFreq = cutoff;
+            params.lowPassMode = FilterCPU::LowPassSeparable;
+            params.kernelShape = shape;
+            Bench::run(
+                name,
+                [&] {
+                    FilterCPU::process(src, dst, params);
+                    Bench::doNotOptimize(dst.pixels[0]);
+                },
+                5);
+
+            if (shape != FilterCPU::KernelBox) {
+                const auto lookup = FilterCPU::findKernel(params);
+                std::printf("%-48s %d taps, %.0f texel spacing\n", "", 2 * lookup.kernel->radius + 1, lookup.step);
+            }
+        }
+    }
+}
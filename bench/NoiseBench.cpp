@@ -0,0 +1,74 @@
+// Noise texture benchmarks: per frame white noise generation against counter hash noise and blue noise atlas frames
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Bench.hpp"
+#include "BlueNoise.hpp"
+#include "HashNoise.hpp"
+#include "ThreadPool.hpp"
+
+namespace
+{
+// Noise texture size and channels, as in the post process shader parameters
+constexpr int c_textureSize = 256;
+constexpr int c_numChannels = 4;
+
+// White noise as generated by TestTexture for the Noise type
+void generateWhiteNoise(std::default_random_engine& generator, uint8_t* target)
+{
+    std::uniform_real_distribution<double> distribution(0, 255);
+    for (int i = 0; i < c_textureSize * c_textureSize * c_numChannels; i++) {
+        target[i] = static_cast<uint8_t>(distribution(generator));
+    }
+}
+
+}  // namespace
+
+void runNoiseBenchmarks(const std::string& filter)
+{
+    std::vector<uint8_t> texture(c_textureSize * c_textureSize * c_numChannels);
+    const size_t rowPitch = c_textureSize * c_numChannels;
+
+    if (Bench::isSelected(filter, "noise/white-frame")) {
+        std::default_random_engine generator;
+        Bench::run("noise/white-frame", [&] {
+            generateWhiteNoise(generator, texture.data());
+            Bench::doNotOptimize(texture[0]);
+        });
+    }
+
+    // Hash noise matches the GPU generator, scalar and SIMD give identical results
+    for (const bool simd : {false, true}) {
+        const std::string name = simd ? "noise/hash-frame-simd" : "noise/hash-frame-scalar";
+        if (Bench::isSelected(filter, name) && (!simd || HashNoise::isSimdAvailable())) {
+            uint32_t frame = 0;
+            Bench::run(name, [&] {
+                HashNoise::generate(frame++, HashNoise::c_defaultSeed, c_textureSize, c_textureSize, c_numChannels, texture.data(), rowPitch, simd);
+                Bench::doNotOptimize(texture[0]);
+            });
+        }
+    }
+
+    const bool atlasFrame = Bench::isSelected(filter, "noise/blue-atlas-frame");
+    const bool atlasGenerate = Bench::isSelected(filter, "noise/blue-atlas-generate");
+    if (atlasFrame || atlasGenerate) {
+        BlueNoise blueNoise;
+        blueNoise.generate(BlueNoise::Params(), ThreadPool::instance());
+
+        if (atlasFrame) {
+            int64_t frame = 0;
+            Bench::run("noise/blue-atlas-frame", [&] {
+                blueNoise.writeTexture(frame++, c_textureSize, c_textureSize, c_numChannels, texture.data(), rowPitch);
+                Bench::doNotOptimize(texture[0]);
+            });
+        }
+
+        // One time startup cost, all tiles in parallel
+        if (atlasGenerate) {
+            Bench::run("noise/blue-atlas-generate", [&] { blueNoise.generate(BlueNoise::Params(), ThreadPool::instance()); }, 3, 0.0);
+        }
+    }
+}
@@ -0,0 +1,91 @@
+// Frame pipeline benchmarks: decode, filter and encode run serially against overlapped in a pipeline
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Bench.hpp"
+#include "ColorLut.hpp"
+#include "FilterCPU.hpp"
+#include "FramePipeline.hpp"
+
+namespace
+{
+// Frames per benchmark call
+constexpr int c_frameCount = 16;
+
+// Decode stand-in: 8-bit RGBA to float image
+void decode(const std::vector<uint8_t>& src, int width, int height, ImageRGBA& dst)
+{
+    if (dst.width != width || dst.height != height) {
+        dst.resize(width, height);
+    }
+    for (size_t i = 0; i < src.size(); i++) {
+        dst.pixels[i] = src[i] * (1.0f / 255.0f);
+    }
+}
+
+// Encode stand-in: float image to 8-bit RGBA
+void encode(const ImageRGBA& src, std::vector<uint8_t>& dst)
+{
+    dst.resize(src.pixels.size());
+    for (size_t i = 0; i < dst.size(); i++) {
+        dst[i] = static_cast<uint8_t>(std::min(std::max(src.pixels[i], 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+}  // namespace
+
+void runPipelineBenchmarks(const std::string& filter)
+{
+    const int width = 640;
+    const int height = 360;
+    std::vector<uint8_t> encoded(static_cast<size_t>(width) * height * 4);
+    for (size_t i = 0; i < encoded.size(); i++) {
+        encoded[i] = static_cast<uint8_t>((i * 7) ^ (i >> 9));
+    }
+
+    ColorLut colorLut;
+    colorLut.bake(ColorLut::Params());
+
+    FilterCPU::Params params;
+    params.filterType = FilterCPU::FilterHighPass;
+    params.highPassCutoffFreq = 5.0f;
+    params.colorFactor = 1.0f;
+
+    const std::string suffix = "/" + std::to_string(c_frameCount) + "x" + std::to_string(width) + "x" + std::to_string(height);
+
+    if (Bench::isSelected(filter, "frame-pipeline/serial" + suffix)) {
+        ImageRGBA image;
+        ImageRGBA filtered;
+        std::vector<uint8_t> output;
+        Bench::run("frame-pipeline/serial" + suffix, [&] {
+            for (int n = 0; n < c_frameCount; n++) {
+                decode(encoded, width, height, image);
+                FilterCPU::process(image, filtered, params, &colorLut);
+                encode(filtered, output);
+            }
+            Bench::doNotOptimize(output.back());
+        });
+    }
+
+    if (Bench::isSelected(filter, "frame-pipeline/pipelined" + suffix)) {
+        std::vector<uint8_t> output;
+        Bench::run("frame-pipeline/pipelined" + suffix, [&] {
+            FramePipeline::Config config;
+            FramePipeline pipeline(config);
+            pipeline.setSource("Decode", [&](FramePipeline::Frame& frame) {
+                if (frame.index >= c_frameCount) {
+                    return false;
+                }
+                decode(encoded, width, height, frame.image);
+                return true;
+            });
+            pipeline.addStage("Filter", FramePipeline::makeFilterStage(params, &colorLut));
+            pipeline.setSink("Encode", [&](const FramePipeline::Frame& frame) { encode(frame.image, output); });
+            pipeline.run();
+            Bench::doNotOptimize(output.back());
+        });
+    }
+}
@@ -0,0 +1,80 @@
+// Scene transform and instance buffer benchmarks
+
+#include <cmath>
+#include <string>
+
+#include "Bench.hpp"
+#include "TransformStore.hpp"
+
+namespace
+{
+// Fill store with grid of objects similar to test scene layout
+void fillGrid(TransformStore& store, size_t count)
+{
+    store.resize(count);
+    const int side = static_cast<int>(std::ceil(std::cbrt(static_cast<double>(count))));
+    for (size_t i = 0; i < count; i++) {
+        const int x = static_cast<int>(i % side);
+        const int y = static_cast<int>((i / side) % side);
+        const int z = static_cast<int>(i / (side * side));
+        store.setPosition(i, {static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
+        store.setRotation(i, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+        store.setScale(i, {0.3f, 0.3f, 0.3f});
+        store.setColor(i, {0.5f, 0.5f, 0.5f, 1.0f}, 1.0f);
+    }
+    store.update();
+}
+
+}  // namespace
+
+void runSceneBenchmarks(const std::string& filter)
+{
+    for (size_t count : {size_t(250), size_t(10000), size_t(100000)}) {
+        TransformStore store;
+        fillGrid(store, count);
+        const std::string suffix = "/" + std::to_string(count);
+
+        // Static scene: nothing changed, update only checks dirty list
+        if (Bench::isSelected(filter, "transforms/static" + suffix)) {
+            Bench::run("transforms/static" + suffix, [&] {
+                Bench::doNotOptimize(store.update());
+            });
+        }
+
+        // Static scene written every frame with unchanged values, as in an animation loop that has stopped
+        if (Bench::isSelected(filter, "transforms/rewrite-unchanged" + suffix)) {
+            Bench::run("transforms/rewrite-unchanged" + suffix, [&] {
+                for (size_t i = 0; i < count; i++) {
+                    store.setScale(i, {0.3f, 0.3f, 0.3f});
+                }
+                Bench::doNotOptimize(store.update());
+            });
+        }
+
+        // Fully animated scene: every object changes every frame
+        if (Bench::isSelected(filter, "transforms/animate-all" + suffix)) {
+            float phase = 0.0f;
+            Bench::run("transforms/animate-all" + suffix, [&] {
+                phase += 0.01f;
+                const float s = 0.3f + 0.1f * std::sin(phase);
+                for (size_t i = 0; i < count; i++) {
+                    store.setScale(i, {s, s, s});
+                }
+                Bench::doNotOptimize(store.update());
+            });
+        }
+
+        // Sparse animation: one percent of objects change every frame
+        if (Bench::isSelected(filter, "transforms/animate-1pct" + suffix)) {
+            float phase = 0.0f;
+            Bench::run("transforms/animate-1pct" + suffix, [&] {
+                phase += 0.01f;
+                const float s = 0.3f + 0.1f * std::sin(phase);
+                for (size_t i = 0; i < count; i += 100) {
+                    store.setScale(i, {s, s, s});
+                }
+                Bench::doNotOptimize(store.update());
+            });
+        }
+    }
+}
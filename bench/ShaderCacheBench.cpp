@@ -0,0 +1,78 @@
+// Shader cache benchmarks: key hashing and lookups from memory and disk against storing a new binary
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Bench.hpp"
+#include "ShaderCache.hpp"
+
+namespace
+{
+// Cache directory used by benchmarks, relative to working directory
+const std::string c_benchCacheDirectory = "shader_cache_bench";
+
+// Synthetic shader source of roughly the size of the post process shader
+std::string makeSource(size_t size)
+{
+    std::string source;
+    while (source.size() < size) {
+        source += "float4 sample" + std::to_string(source.size()) + " = tex.SampleLevel(samp, uv, 0);\n";
+    }
+    return source;
+}
+
+}  // namespace
+
+void runShaderCacheBenchmarks(const std::string& filter)
+{
+    if (!Bench::isSelected(filter, "shader-cache/")) {
+        return;
+    }
+
+    ShaderCache& cache = ShaderCache::instance();
+    const std::string previousDirectory = cache.getDirectory();
+    if (!cache.setDirectory(c_benchCacheDirectory)) {
+        std::printf("Creating shader cache directory failed: %s\n", c_benchCacheDirectory.c_str());
+        return;
+    }
+
+    const std::string source = makeSource(8 * 1024);
+    const std::string identity = "Bench Vendor\nBench Renderer\n4.6.0\n";
+
+    if (Bench::isSelected(filter, "shader-cache/make-key")) {
+        Bench::run("shader-cache/make-key", [&] {
+            const uint64_t key = ShaderCache::makeKey(source, "cs_5_0", identity);
+            Bench::doNotOptimize(key);
+        });
+    }
+
+    for (size_t size : {size_t(4 * 1024), size_t(64 * 1024), size_t(1024 * 1024)}) {
+        const std::string suffix = "/" + std::to_string(size / 1024) + "k";
+        const uint64_t key = ShaderCache::makeKey(source, std::to_string(size), identity);
+        const std::vector<uint8_t> binary(size, 0x5a);
+
+        // Cold start: miss and store compiled binary
+        if (Bench::isSelected(filter, "shader-cache/store" + suffix)) {
+            Bench::run("shader-cache/store" + suffix, [&] { Bench::doNotOptimize(cache.store(key, 1, binary.data(), binary.size())); });
+        }
+        cache.store(key, 1, binary.data(), binary.size());
+
+        // Warm start in a new process: load from disk
+        if (Bench::isSelected(filter, "shader-cache/find-disk" + suffix)) {
+            Bench::run("shader-cache/find-disk" + suffix, [&] {
+                cache.clearMemory();
+                Bench::doNotOptimize(cache.find(key));
+            });
+        }
+
+        // Preset switch within a process: shared from memory
+        if (Bench::isSelected(filter, "shader-cache/find-memory" + suffix)) {
+            cache.find(key);
+            Bench::run("shader-cache/find-memory" + suffix, [&] { Bench::doNotOptimize(cache.find(key)); });
+        }
+    }
+
+    cache.clearMemory();
+    cache.setDirectory(previousDirectory);
+}
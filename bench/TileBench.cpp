@@ -0,0 +1,105 @@
+// Large texture benchmarks: whole texture hash noise generation on one thread against tiled generation on the
+// thread pool with band uploads, with time to first uploaded band and CPU side staging memory of each
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Bench.hpp"
+#include "HashNoise.hpp"
+#include "TextureTiler.hpp"
+#include "ThreadPool.hpp"
+
+namespace
+{
+// RGBA8 texture, like the default noise texture format
+constexpr int c_numChannels = 4;
+
+// Texture sizes, from the current input texture size to full resolution masks
+constexpr int c_sizes[] = {256, 1024, 4096};
+
+using Clock = std::chrono::steady_clock;
+
+// Returns milliseconds since given time
+double getMs(Clock::time_point start) { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); }
+
+// Whole texture generated to a full size staging buffer, then uploaded at once.
+// Upload is a copy to the texture memory. Returns time to first uploaded row in milliseconds.
+double generateWhole(int size, uint32_t frame, std::vector<uint8_t>& staging, std::vector<uint8_t>& texture)
+{
+    const auto start = Clock::now();
+    const size_t rowPitch = static_cast<size_t>(size) * c_numChannels;
+    HashNoise::generate(frame, HashNoise::c_defaultSeed, size, size, c_numChannels, staging.data(), rowPitch);
+    std::memcpy(texture.data(), staging.data(), staging.size());
+    return getMs(start);
+}
+
+// Texture generated in tiles to a band sized staging buffer, each band uploaded when done.
+// Returns time to first uploaded band in milliseconds.
+double generateTiled(const TextureTiler& tiler, int size, uint32_t frame, std::vector<uint8_t>& staging, std::vector<uint8_t>& texture)
+{
+    const auto start = Clock::now();
+    const size_t rowPitch = static_cast<size_t>(size) * c_numChannels;
+    double firstBandMs = -1.0;
+    int bandY = 0;
+
+    tiler.run(
+        ThreadPool::instance(),
+        [&](const TextureTiler::Region& band) { bandY = band.y; },
+        [&](const TextureTiler::Region& tile) {
+            uint8_t* dst = staging.data() + (tile.y - bandY) * rowPitch + tile.x * c_numChannels;
+            HashNoise::generateRegion(frame, HashNoise::c_defaultSeed, tile.x, tile.y, tile.width, tile.height, c_numChannels, dst, rowPitch);
+        },
+        [&](const TextureTiler::Region& band) {
+            std::memcpy(texture.data() + band.y * rowPitch, staging.data(), band.height * rowPitch);
+            if (firstBandMs < 0.0) {
+                firstBandMs = getMs(start);
+            }
+        });
+    return firstBandMs;
+}
+
+// Returns median of samples
+double getMedian(std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+// Print time to first upload and staging memory
+void printFirstUpload(const std::string& name, const std::vector<double>& firstMs, size_t stagingBytes)
+{
+    std::printf("%-48s %14.3f ms to first upload, %.2f MB staging\n", name.c_str(), getMedian(firstMs), stagingBytes / (1024.0 * 1024.0));
+}
+
+}  // namespace
+
+void runTileBenchmarks(const std::string& filter)
+{
+    for (const int size : c_sizes) {
+        const std::string prefix = "tiles/" + std::to_string(size) + "/";
+        const size_t textureBytes = static_cast<size_t>(size) * size * c_numChannels;
+        std::vector<uint8_t> texture(textureBytes);
+
+        if (Bench::isSelected(filter, prefix + "whole")) {
+            std::vector<uint8_t> staging(textureBytes);
+            std::vector<double> firstMs;
+            uint32_t frame = 0;
+            Bench::run(prefix + "whole", [&] { firstMs.push_back(generateWhole(size, frame++, staging, texture)); }, 5);
+            printFirstUpload(prefix + "whole", firstMs, staging.size());
+        }
+
+        if (Bench::isSelected(filter, prefix + "tiled")) {
+            const TextureTiler tiler(size, size);
+            std::vector<uint8_t> staging(tiler.getBand(0).height * static_cast<size_t>(size) * c_numChannels);
+            std::vector<double> firstMs;
+            uint32_t frame = 0;
+            Bench::run(prefix + "tiled", [&] { firstMs.push_back(generateTiled(tiler, size, frame++, staging, texture)); }, 5);
+            printFirstUpload(prefix + "tiled", firstMs, staging.size());
+        }
+    }
+}
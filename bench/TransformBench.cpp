@@ -0,0 +1,118 @@
+// Per view transform matrix benchmarks: glm per object path against batch SIMD kernels
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Bench.hpp"
+#include "TransformKernel.hpp"
+#include "TransformStore.hpp"
+
+namespace
+{
+// Fill store with pseudo random poses
+void fillPoses(TransformStore& store, size_t count)
+{
+    store.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const float f = static_cast<float>(i);
+        const float angle = 0.37f * f;
+        store.setPosition(i, {std::sin(f) * 10.0f, std::cos(0.5f * f) * 2.0f, -5.0f - std::fmod(f, 20.0f)});
+        store.setRotation(i, glm::quat(std::cos(angle), 0.0f, std::sin(angle), 0.0f));
+        store.setScale(i, {0.1f + 0.01f * std::fmod(f, 7.0f), 0.2f, 0.1f + 0.01f * std::fmod(f, 5.0f)});
+    }
+    store.update();
+}
+
+// Reference path: model matrix from pose and glm multiplies per object
+void transformGlm(const TransformStore& store, const std::vector<uint32_t>& indices, const glm::mat4& view, const glm::mat4& proj,
+    std::vector<glm::mat4>& mvp, std::vector<glm::mat3>& normal)
+{
+    const PoseArrays poses = store.getPoses();
+    for (size_t n = 0; n < indices.size(); n++) {
+        const uint32_t i = indices[n];
+        const glm::vec3 position(poses.posX[i], poses.posY[i], poses.posZ[i]);
+        const glm::quat rotation(poses.rotW[i], poses.rotX[i], poses.rotY[i], poses.rotZ[i]);
+        const glm::vec3 scale(poses.scaleX[i], poses.scaleY[i], poses.scaleZ[i]);
+
+        const glm::mat4 model = glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+        const glm::mat4 modelView = view * model;
+        mvp[n] = proj * modelView;
+        normal[n] = glm::inverseTranspose(glm::mat3(modelView));
+    }
+}
+
+}  // namespace
+
+void runTransformBenchmarks(const std::string& filter)
+{
+    using TransformKernel::Isa;
+
+    const glm::mat4 proj = glm::perspective(glm::radians(100.0f), 1.0f, 0.05f, 100.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.3f, 1.6f, 0.0f), glm::vec3(0.0f, 1.6f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    if (Bench::isSelected(filter, "view-matrices/")) {
+        std::printf("Transform kernel ISA: %s\n", TransformKernel::getIsaName(TransformKernel::getBestIsa()));
+    }
+
+    for (size_t count : {size_t(250), size_t(10000), size_t(100000)}) {
+        const std::string suffix = "/" + std::to_string(count);
+
+        TransformStore store;
+        fillPoses(store, count);
+
+        // Every third object visible, as after culling
+        std::vector<uint32_t> visible;
+        for (uint32_t i = 0; i < count; i += 3) {
+            visible.push_back(i);
+        }
+
+        std::vector<glm::mat4> refMvp(visible.size());
+        std::vector<glm::mat3> refNormal(visible.size());
+        if (Bench::isSelected(filter, "view-matrices/glm" + suffix)) {
+            Bench::run("view-matrices/glm" + suffix, [&] {
+                transformGlm(store, visible, view, proj, refMvp, refNormal);
+                Bench::doNotOptimize(refMvp.back());
+            });
+        }
+
+        for (Isa isa : {Isa::Scalar, Isa::Sse2, Isa::Avx2, Isa::Neon}) {
+            const std::string name = std::string("view-matrices/") + TransformKernel::getIsaName(isa) + suffix;
+            if (!TransformKernel::isSupported(isa) || !Bench::isSelected(filter, name)) {
+                continue;
+            }
+
+            std::vector<float> mvp(visible.size() * 16);
+            std::vector<float> normal(visible.size() * 12);
+            MatrixOutput out;
+            out.matrix = mvp.data();
+            out.normal = normal.data();
+            Bench::run(name, [&] {
+                TransformKernel::transform(store.getPoses(), visible.data(), visible.size(), view, proj, out, isa);
+                Bench::doNotOptimize(mvp.back());
+            });
+
+            // Compare against reference path
+            transformGlm(store, visible, view, proj, refMvp, refNormal);
+            float maxError = 0.0f;
+            for (size_t n = 0; n < visible.size(); n++) {
+                for (int c = 0; c < 4; c++) {
+                    for (int r = 0; r < 4; r++) {
+                        maxError = std::max(maxError, std::abs(mvp[n * 16 + c * 4 + r] - refMvp[n][c][r]));
+                    }
+                }
+                for (int c = 0; c < 3; c++) {
+                    for (int r = 0; r < 3; r++) {
+                        maxError = std::max(maxError, std::abs(normal[n * 12 + c * 4 + r] - refNormal[n][c][r]));
+                    }
+                }
+            }
+            std::printf("  %-46s %14g\n", "max abs error vs glm", maxError);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+// Benchmarks for CPU side code paths. Runs without Varjo runtime or GPU.
+//
+// Usage: VideoPostProcessBench [filter]
+// Runs benchmarks whose name contains the filter string, or all if omitted.
+
+#include <cstdio>
+#include <string>
+
+#include "ThreadPool.hpp"
+
+// Benchmark groups
+void runSceneBenchmarks(const std::string& filter);
+void runCullingBenchmarks(const std::string& filter);
+void runTransformBenchmarks(const std::string& filter);
+void runShaderCacheBenchmarks(const std::string& filter);
+void runPipelineBenchmarks(const std::string& filter);
+void runArenaBenchmarks(const std::string& filter);
+void runNoiseBenchmarks(const std::string& filter);
+void runFormatBenchmarks(const std::string& filter);
+void runTileBenchmarks(const std::string& filter);
+void runFilterGraphBenchmarks(const std::string& filter);
+void runKernelBenchmarks(const std::string& filter);
+void runBilateralGridBenchmarks(const std::string& filter);
+
+int main(int argc, char** argv)
+{
+    const std::string filter = argc > 1 ? argv[1] : "";
+
+    std::printf("Threads: %d\n", ThreadPool::instance().getThreadCount());
+    std::printf("%-48s %17s %17s\n", "Benchmark", "Median", "Min");
+
+    runSceneBenchmarks(filter);
+    runCullingBenchmarks(filter);
+    runTransformBenchmarks(filter);
+    runShaderCacheBenchmarks(filter);
+    runPipelineBenchmarks(filter);
+    runArenaBenchmarks(filter);
+    runNoiseBenchmarks(filter);
+    runFormatBenchmarks(filter);
+    runTileBenchmarks(filter);
+    runFilterGraphBenchmarks(filter);
+    runKernelBenchmarks(filter);
+    runBilateralGridBenchmarks(filter);
+
+    return 0;
+}
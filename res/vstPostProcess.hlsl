@@ -4,8 +4,20 @@
 // your own application. In your application, implement your own shader that suits
 // your needs.
 
-// Compute shader thread block size
+// Compute shader thread block size. Autotuned builds define this ahead of the source.
+#ifndef BLOCK_SIZE
 #define BLOCK_SIZE (8)
+#endif
+
+// Low pass strategies. Must match FilterCPU::LowPassMode. Autotuned builds define LOW_PASS_MODE
+// ahead of the source. Integral image needs a pass of its own, so it is CPU only.
+#define LOW_PASS_DIRECT (0)
+#define LOW_PASS_SEPARABLE (1)
+#define LOW_PASS_REDUCED (3)
+
+#ifndef LOW_PASS_MODE
+#define LOW_PASS_MODE (LOW_PASS_DIRECT)
+#endif
 
 // Debug texture output modes
 #define DEBUG_TEXTURE_OUT_NONE (0)
@@ -60,15 +72,21 @@ cbuffer ConstantBuffer : register(b0)
 
 // -------------------------------------------------------------------------
 
+// Bank kernel weight vectors. Must match c_kernelWeightCount / 4.
+#define KERNEL_WEIGHT_VECTORS (9)
+
+// Low pass kernel shapes. Must match FilterCPU::KernelShape.
+#define KERNEL_SHAPE_BOX (0)
+
 // Shader specific constants
 cbuffer ConstantBuffer : register(b1)
 {
     // Color grading
     float colorFactor;             // Color grading factor: 0=off, 1=full
-    float colorPreserveSaturated;  // Color grading saturated preservation
+    float colorPreserveSaturated;  // Color grading saturated preservation (baked into LUT)
     float2 _padding_b1_0;          // Padding
-    float4 colorValue;             // Color grading value
-    float4 colorExp;               // Color grading exponent
+    float4 colorValue;             // Color grading value (baked into LUT)
+    float4 colorExp;               // Color grading exponent (baked into LUT)
 
     // Noise texture
     float noiseAmount;  // Noise amount: 0=off, 1=full
@@ -79,47 +97,45 @@ cbuffer ConstantBuffer : register(b1)
     int blurKernelSize;  // Blur kernel size
     float highPassCutoffFreq;  // High pass cutoff frequency
     int filterType;
-    float2 _padding_b2_0;          // Padding
+    int tapStride;        // Low pass tap stride set by adaptive quality: 1=all taps
+    float _padding_b2_0;  // Padding
+
+    // Low pass kernel from KernelBank on CPU
+    int kernelShape;                              // Kernel shape: 0=box, 1=gaussian, 2=windowed sinc
+    int kernelRadius;                             // Bank kernel taps on each side of the center
+    float kernelStep;                             // Bank kernel tap spacing in texels
+    float _padding_b3_0;                          // Padding
+    float4 kernelWeights[KERNEL_WEIGHT_VECTORS];  // Bank kernel weights, tap i in component i % 4 of vector i / 4
+
+    // Bilateral grid edge enhancement
+    int gridCellSize;     // Grid cell size in pixels
+    int gridRangeBins;    // Grid luminance bins
+    float enhanceGain;    // Edge enhancement gain: 0=original
+    float _padding_b4_0;  // Padding
 }
 
 // Shader specific textures
 Texture2D<float4> noiseTexture : register(t1);
+Texture2D<float4> colorLutTexture : register(t2);  // Color grading LUT baked on CPU, blue slices side by side
 
-// -------------------------------------------------------------------------
-
-static const float Epsilon = 1e-10;
+// Color grading LUT size per axis. Must match ColorLut::c_size.
+#define COLOR_LUT_SIZE (33)
 
-float3 convertRGBtoHCV(in float3 RGB)
-{
-    float4 P = (RGB.g < RGB.b) ? float4(RGB.bg, -1.0, 2.0 / 3.0) : float4(RGB.gb, 0.0, -1.0 / 3.0);
-    float4 Q = (RGB.r < P.x) ? float4(P.xyw, RGB.r) : float4(RGB.r, P.yzx);
-    float C = Q.x - min(Q.w, Q.y);
-    float H = abs((Q.w - Q.y) / (6 * C + Epsilon) + Q.z);
-    return float3(H, C, Q.x);
-}
-
-// Converts given RGB color to HSV color. RGB = [0..1], HSV = [0..1].
-float3 convertRGBtoHSV(in float3 RGB)
-{
-    float3 HCV = convertRGBtoHCV(RGB);
-    float S = HCV.y / (HCV.z + Epsilon);
-    return float3(HCV.x, S, HCV.z);
-}
-
-// Converts HSV hue channel value to RGB color. H = [0..1].
-float3 hueToRGB(in float H)
-{
-    float R = abs(H * 6.0f - 3.0f) - 1.0f;
-    float G = 2.0f - abs(H * 6.0f - 2.0f);
-    float B = 2.0f - abs(H * 6.0f - 4.0f);
-    return saturate(float3(R, G, B));
-}
+// -------------------------------------------------------------------------
 
-// Converts given HSV color to RGB color. HSV = [0..1], RGB = [0..1].
-float3 hsvToRGB(in float3 HSV)
+// Sample color grading LUT with trilinear interpolation. Input is clamped to [0..1].
+float3 sampleColorLut(in float3 RGB)
 {
-    float3 RGB = hueToRGB(HSV.x);
-    return ((RGB - 1.0f) * HSV.y + 1.0f) * HSV.z;
+    const float n = COLOR_LUT_SIZE;
+    const float3 c = saturate(RGB) * (n - 1.0f);
+
+    // Blue selects two slices, red and green are filtered by the sampler within each slice
+    const float b0 = min(floor(c.b), n - 2.0f);
+    const float bf = c.b - b0;
+    const float2 uv = (c.rg + 0.5f) / float2(n * n, n);
+    const float3 c0 = colorLutTexture.SampleLevel(SamplerLinearClamp, uv + float2(b0 / n, 0.0f), 0.0).rgb;
+    const float3 c1 = colorLutTexture.SampleLevel(SamplerLinearClamp, uv + float2((b0 + 1.0f) / n, 0.0f), 0.0).rgb;
+    return lerp(c0, c1, bf);
 }
 
 float3 homogenize(float4 v) { return v.xyz / v.w; }
@@ -174,12 +190,117 @@ void calculateKernelParameters(float cpd, out int kernelSize, out float scale)
 }
 
 
+// -------------------------------------------------------------------------
+
+// Returns weight of bank kernel tap i, 0..2 * kernelRadius
+float getKernelWeight(int i) { return kernelWeights[i >> 2][i & 3]; }
+
+#if (LOW_PASS_MODE == LOW_PASS_SEPARABLE)
+
+// Texels loaded around the thread block. Kernels reaching further fall back to direct taps.
+#define LOW_PASS_APRON (8)
+#define LOW_PASS_TILE (BLOCK_SIZE + 2 * LOW_PASS_APRON)
+
+groupshared float4 lowPassTile[LOW_PASS_TILE][LOW_PASS_TILE];  // Source texels of block and apron
+groupshared float4 lowPassRows[LOW_PASS_TILE][BLOCK_SIZE];     // Horizontal tap sums
+
+// Returns true if taps stay within the apron
+bool fitsLowPassApron(int kernelD, float2 tapScale) { return (kernelD * 0.5 - 0.5) * max(tapScale.x, tapScale.y) + 2.0 <= LOW_PASS_APRON; }
+
+// Sum of the same bilinear taps as the direct loop in horizontal and vertical passes through group
+// shared memory. Tap fractions are the same for every texel, so clamped texel loads followed by
+// manual lerps match the clamp sampler. Box kernels average the taps, bank kernels weight them with
+// the bank weights. Must be called from uniform flow control.
+float4 separableLowPass(int2 thisThread, int2 groupThread, uint groupIndex, int kernelD, float2 tapScale, bool bankWeights)
+{
+    const int2 tileOrigin = thisThread - groupThread - LOW_PASS_APRON;
+    for (int i = groupIndex; i < LOW_PASS_TILE * LOW_PASS_TILE; i += BLOCK_SIZE * BLOCK_SIZE) {
+        const int2 t = int2(i % LOW_PASS_TILE, i / LOW_PASS_TILE);
+        lowPassTile[t.y][t.x] = inputTex.Load(int3(clamp(tileOrigin + t, int2(0, 0), sourceSize - 1), 0));
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    const float kernelOffs = kernelD * 0.5 - 0.5;
+    for (int row = groupThread.y; row < LOW_PASS_TILE; row += BLOCK_SIZE) {
+        float4 sum = float4(0.0, 0.0, 0.0, 0.0);
+        for (int k = 0; k < kernelD; k++) {
+            const float pos = (k - kernelOffs) * tapScale.x - 0.5;
+            const float base = floor(pos);
+            const int x = groupThread.x + LOW_PASS_APRON + (int)base;
+            sum += (bankWeights ? getKernelWeight(k) : 1.0) * lerp(lowPassTile[row][x], lowPassTile[row][x + 1], pos - base);
+        }
+        lowPassRows[row][groupThread.x] = sum;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    float4 sum = float4(0.0, 0.0, 0.0, 0.0);
+    for (int k = 0; k < kernelD; k++) {
+        const float pos = (k - kernelOffs) * tapScale.y - 0.5;
+        const float base = floor(pos);
+        const int y = groupThread.y + LOW_PASS_APRON + (int)base;
+        sum += (bankWeights ? getKernelWeight(k) : 1.0) * lerp(lowPassRows[y][groupThread.x], lowPassRows[y + 1][groupThread.x], pos - base);
+    }
+    return bankWeights ? sum : sum / (kernelD * kernelD);
+}
+
+#endif
+
+// Low pass with bank kernel weights, same as FilterCPU: taps kernelStep texels apart centered on the
+// texel, each weighted by the product of the separable weights. Bank radius is capped on CPU to
+// FilterCPU::c_maxBankRadius, so this costs at most as many taps as the widest box kernel.
+float4 bankLowPass(int2 thisThread, float2 kernelScale)
+{
+    const float2 uv = (float2(thisThread) + 0.5) / sourceSize;
+    float4 sum = float4(0.0, 0.0, 0.0, 0.0);
+    for (int y = -kernelRadius; y <= kernelRadius; y++) {
+        const float weightY = getKernelWeight(y + kernelRadius);
+        for (int x = -kernelRadius; x <= kernelRadius; x++) {
+            const float2 uvOffs = float2(x, y) * kernelStep * kernelScale;
+            sum += (weightY * getKernelWeight(x + kernelRadius)) * inputTex.SampleLevel(SamplerLinearClamp, uv + uvOffs, 0.0);
+        }
+    }
+    return sum;
+}
+
+// Bilateral grid taps on each side of the center, half a grid cell apart
+#define BILATERAL_TAP_RADIUS (4)
+
+// Gaussian extent in taps of spatial and in bins of luminance weights, matching the blur and
+// trilinear slicing of the grid on CPU
+#define BILATERAL_SPATIAL_SIGMA (2.2)
+#define BILATERAL_RANGE_SIGMA (1.1)
+
+// BT.601 luma weights. Must match BilateralGrid.
+static const float3 LUMA_WEIGHTS = float3(0.299, 0.587, 0.114);
+
+// Bilateral grid edge enhancement, same as BilateralGrid on CPU: edge preserving base minus spatial
+// low pass added to the original. Post processing is a single dispatch, so the grid is not built;
+// both are summed directly from taps half a cell apart, the base weighted by luminance difference.
+float4 bilateralEnhance(int2 thisThread, float4 origColor, float2 kernelScale)
+{
+    const float2 uv = (float2(thisThread) + 0.5) / sourceSize;
+    const float lum = saturate(dot(origColor.rgb, LUMA_WEIGHTS));
+    const float tapStep = 0.5 * gridCellSize;
+    float4 base = float4(0.0, 0.0, 0.0, 0.0);
+    float4 lowPass = float4(0.0, 0.0, 0.0, 0.0);
+    for (int y = -BILATERAL_TAP_RADIUS; y <= BILATERAL_TAP_RADIUS; y++) {
+        for (int x = -BILATERAL_TAP_RADIUS; x <= BILATERAL_TAP_RADIUS; x++) {
+            const float4 color = float4(inputTex.SampleLevel(SamplerLinearClamp, uv + float2(x, y) * tapStep * kernelScale, 0.0).rgb, 1.0);
+            const float spatial = exp(-0.5 * (x * x + y * y) / (BILATERAL_SPATIAL_SIGMA * BILATERAL_SPATIAL_SIGMA));
+            const float bins = (saturate(dot(color.rgb, LUMA_WEIGHTS)) - lum) * gridRangeBins / BILATERAL_RANGE_SIGMA;
+            base += (spatial * exp(-0.5 * bins * bins)) * color;
+            lowPass += spatial * color;
+        }
+    }
+    return float4(origColor.rgb + enhanceGain * (base.rgb / base.a - lowPass.rgb / lowPass.a), origColor.a);
+}
+
 // -------------------------------------------------------------------------
 #define PI 3.1415926535897932384626433832795
 
 // Compute shader for high pass filtering
 [numthreads(BLOCK_SIZE, BLOCK_SIZE, 1)]
-void main(uint3 dispatchThreadID : SV_DispatchThreadID) {
+void main(uint3 dispatchThreadID : SV_DispatchThreadID, uint3 groupThreadID : SV_GroupThreadID, uint groupIndex : SV_GroupIndex) {
     // Calculate thread coordinates
     const int2 thisThread = dispatchThreadID.xy + int2(destRect.xy);
 
@@ -239,20 +360,51 @@ void main(uint3 dispatchThreadID : SV_DispatchThreadID) {
                 kernelScale = float2(1.0, 1.0) / float2(focusSize);
             }
 
-            // Kernel radius and count
-            const int kernelD = kernelSize; //blurKernelSize;
-            const int kernelR = (kernelD >> 1);
-            const int kernelN = (kernelD * kernelD);
-            const float2 kernelOffs = (float2(kernelD, kernelD) * 0.5 - 0.5);
-
-            lowPassColor = float4(0.0, 0.0, 0.0, 0.0);
-            for (int y = 0; y < kernelD; y++) {
-                for (int x = 0; x < kernelD; x++) {
-                    const float2 uvOffs = ((float2(x, y) - kernelOffs) * myBlurScale) * kernelScale;
-                    lowPassColor += inputTex.SampleLevel(SamplerLinearClamp, uv + uvOffs, 0.0, 0.0);
+            if (kernelShape != KERNEL_SHAPE_BOX) {
+                // Gaussian or windowed sinc looked up from the kernel bank on CPU. Separable builds sum
+                // the taps in two passes through group shared memory when they fit the apron.
+#if (LOW_PASS_MODE == LOW_PASS_SEPARABLE)
+                const int bankD = 2 * kernelRadius + 1;
+                const float2 bankTapScale = kernelStep * kernelScale * float2(sourceSize);
+                if (fitsLowPassApron(bankD, bankTapScale)) {
+                    lowPassColor = separableLowPass(thisThread, int2(groupThreadID.xy), groupIndex, bankD, bankTapScale, true);
+                } else
+#endif
+                {
+                    lowPassColor = bankLowPass(thisThread, kernelScale);
+                }
+            } else {
+                // Kernel radius and count. Strided taps cover the same area with fewer taps at wider spacing.
+#if (LOW_PASS_MODE == LOW_PASS_REDUCED)
+                // Half the taps per axis at double spacing, each bilinear tap averaging two texels
+                const int stride = 2 * max(tapStride, 1);
+#else
+                const int stride = max(tapStride, 1);
+#endif
+                const int kernelD = (kernelSize + stride - 1) / stride; //blurKernelSize;
+                const float tapScale = stride * myBlurScale;
+                const int kernelR = (kernelD >> 1);
+                const int kernelN = (kernelD * kernelD);
+                const float2 kernelOffs = (float2(kernelD, kernelD) * 0.5 - 0.5);
+
+#if (LOW_PASS_MODE == LOW_PASS_SEPARABLE)
+                // Tap spacing in source texels
+                const float2 texelTapScale = tapScale * kernelScale * float2(sourceSize);
+                if (fitsLowPassApron(kernelD, texelTapScale)) {
+                    lowPassColor = separableLowPass(thisThread, int2(groupThreadID.xy), groupIndex, kernelD, texelTapScale, false);
+                } else
+#endif
+                {
+                    lowPassColor = float4(0.0, 0.0, 0.0, 0.0);
+                    for (int y = 0; y < kernelD; y++) {
+                        for (int x = 0; x < kernelD; x++) {
+                            const float2 uvOffs = ((float2(x, y) - kernelOffs) * tapScale) * kernelScale;
+                            lowPassColor += inputTex.SampleLevel(SamplerLinearClamp, uv + uvOffs, 0.0, 0.0);
+                        }
+                    }
+                    lowPassColor /= kernelN;
                 }
             }
-            lowPassColor /= kernelN;
         }
 
         if (filterType == 1 || filterType == 5) { //regular high pass filter
@@ -277,6 +429,21 @@ void main(uint3 dispatchThreadID : SV_DispatchThreadID) {
         }
     } //end high/low pass logic
 
+    // Bilateral grid edge enhancement
+    if (filterType == 6) {
+        float2 kernelScale = float2(1.0, 1.0) / sourceSize;
+        if (viewIndex == VIEW_FOCUS_L || viewIndex == VIEW_FOCUS_R) {
+            float2 focusSize = sourceFocusRect.zw - sourceFocusRect.xy;
+            kernelScale = float2(1.0, 1.0) / float2(focusSize);
+        }
+        finalColor = bilateralEnhance(thisThread, origColor, kernelScale);
+    }
+
+    // Color grading from baked LUT
+    if (colorFactor > 0.0) {
+        finalColor.rgb = lerp(finalColor.rgb, sampleColorLut(finalColor.rgb), colorFactor);
+    }
+
     // Write output pixel. Alpha is preserved from the original.
     outputTex[thisThread.xy] = float4(finalColor.rgb, origColor.a);
 }
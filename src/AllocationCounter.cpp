@@ -0,0 +1,127 @@
+#include "AllocationCounter.hpp"
+
+#if (USE_ALLOCATION_CHECK)
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace
+{
+thread_local uint64_t t_allocationCount = 0;
+
+void* allocate(size_t size)
+{
+    t_allocationCount++;
+    return std::malloc(size ? size : 1);
+}
+
+#ifdef __cpp_aligned_new
+
+void* allocateAligned(size_t size, std::align_val_t alignment)
+{
+    t_allocationCount++;
+    size = size ? size : 1;
+#ifdef _WIN32
+    return _aligned_malloc(size, static_cast<size_t>(alignment));
+#else
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, std::max(static_cast<size_t>(alignment), sizeof(void*)), size) == 0 ? ptr : nullptr;
+#endif
+}
+
+void freeAligned(void* ptr)
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+#endif
+
+}  // namespace
+
+uint64_t AllocationCounter::getThreadCount() { return t_allocationCount; }
+
+void* operator new(size_t size)
+{
+    if (void* ptr = allocate(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    if (void* ptr = allocate(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+#ifdef __cpp_aligned_new
+
+// Over-aligned types, e.g. alignas(64) members, use these. Aligned blocks must be freed with the
+// matching aligned free on Windows, so both sides are replaced together.
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (void* ptr = allocateAligned(size, alignment)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    if (void* ptr = allocateAligned(size, alignment)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment); }
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { freeAligned(ptr); }
+
+void operator delete[](void* ptr, std::align_val_t) noexcept { freeAligned(ptr); }
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { freeAligned(ptr); }
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { freeAligned(ptr); }
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(ptr); }
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(ptr); }
+
+#endif
+
+#else
+
+uint64_t AllocationCounter::getThreadCount() { return 0; }
+
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+// Compile time flag to replace global operator new and delete with counting versions. Off by default,
+// as the application then pays a thread local increment per allocation. Benchmark and test targets
+// define it on the command line. In the application, steady state frames that allocate are logged
+// and asserted.
+#ifndef USE_ALLOCATION_CHECK
+#define USE_ALLOCATION_CHECK 0
+#endif
+
+//! Counts global operator new calls, for checking that hot paths do not touch the heap.
+//!
+//! With USE_ALLOCATION_CHECK, AllocationCounter.cpp replaces all global operator new and delete
+//! forms, aligned ones included, with malloc and free plus a thread local counter increment. Counts
+//! are per thread, so a frame loop can check its own allocations without seeing those of other
+//! threads. Without it, nothing is replaced and counts stay zero.
+namespace AllocationCounter
+{
+//! Returns true if allocations are counted on this build
+constexpr bool isEnabled() { return USE_ALLOCATION_CHECK != 0; }
+
+//! Returns number of global operator new calls made by the calling thread
+uint64_t getThreadCount();
+
+}  // namespace AllocationCounter
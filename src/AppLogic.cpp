@@ -2,7 +2,12 @@
 
 #include "AppLogic.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
 #include <cstdio>
+#include <fstream>
+#include <sstream>
 #include <vector>
 #include <string>
 
@@ -11,12 +16,20 @@
 #include <Varjo_mr.h>
 #include <Varjo_mr_experimental.h>
 #include <Varjo_gl.h>
+#include <d3dcompiler.h>
 
 #include "D3D11Renderer.hpp"
 #include "D3D11MultiLayerView.hpp"
 
 #include "Shaders.hpp"
 #include "TestScene.hpp"
+#include "FrameProfiler.hpp"
+#include "ShaderCache.hpp"
+#include "TraceRecorder.hpp"
+#include "FilterBenchD3D11.hpp"
+#include "FrameArena.hpp"
+#include "AllocationCounter.hpp"
+#include "ThreadPool.hpp"
 
 #include "TestTextureGL.hpp"
 #include "TestTextureD3D11.hpp"
@@ -33,12 +46,73 @@ namespace
 // The default value is 0, so we go way less than that.
 constexpr int32_t c_appOrderBg = -1000;
 
+// Directory for compiled shaders, relative to working directory
+const std::string c_shaderCacheDirectory = "shader_cache";
+
+// Post process shader compile target
+constexpr const char* c_postProcessShaderTarget = "cs_5_0";
+
+// Compiler identity for shader cache keys
+const std::string c_compilerIdentity = "D3DCompiler_" + std::to_string(D3D_COMPILER_VERSION);
+
+// Shader setting matching BLOCK_SIZE and LOW_PASS_MODE defaults in the shader and c_postProcessShaderParams
+const FilterTuner::Setting c_defaultShaderSetting = {8, FilterCPU::LowPassDirect};
+
+// Video view sizes to tune the post process shader for: context and full camera resolution
+const std::vector<glm::ivec2> c_tuningViewSizes = {{1152, 1152}, {2880, 2720}};
+
+// Blue noise atlas: 16 tiles of 64x64 texels, repeated over the noise texture
+const BlueNoise::Params c_blueNoiseParams = {64, 16, 1.5f, 1};
+
+// Frames after a state change before frames are expected to make no heap allocations
+constexpr int64_t c_allocationWarmupFrames = 90;
+
+// Returns post process shader source file. Development builds prefer the file in the source tree
+// so that edits are hot reloaded without copying it next to the executable.
+std::string getShaderSourceFile()
+{
+#ifdef SHADER_SOURCE_DIR
+    const std::string sourceTreeFile = SHADER_SOURCE_DIR "/vstPostProcess.hlsl";
+    if (std::ifstream(sourceTreeFile)) {
+        return sourceTreeFile;
+    }
+#endif
+    return c_postProcessShaderSources.at(PostProcess::ShaderSource::Source);
+}
+
+// Returns true if file contents equal given data
+bool fileEquals(const std::string& path, const std::vector<uint8_t>& data)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file || static_cast<size_t>(file.tellg()) != data.size()) {
+        return false;
+    }
+    file.seekg(0);
+    std::vector<uint8_t> contents(data.size());
+    return file.read(reinterpret_cast<char*>(contents.data()), contents.size()) && contents == data;
+}
+
 }  // namespace
 
 //---------------------------------------------------------------------------
 
 AppLogic::~AppLogic()
 {
+    // Stop camera timestamps before the session goes away
+    stopCameraTimestamps();
+
+    // Stop shader hot reload. Waits for compile in progress to finish.
+    m_shaderReloader.reset();
+
+    // Free cached pipelines. Waits for background build to finish.
+    m_texture = nullptr;
+    m_lutTexture = nullptr;
+    m_pipelines.reset();
+
+    const auto cacheStats = ShaderCache::instance().getStats();
+    LOG_INFO("Shader cache: %llu memory hits, %llu disk hits, %llu misses", static_cast<unsigned long long>(cacheStats.memoryHits),
+        static_cast<unsigned long long>(cacheStats.diskHits), static_cast<unsigned long long>(cacheStats.misses));
+
     // Free post processor
     m_postProcess.reset();
 
@@ -78,6 +152,24 @@ bool AppLogic::init(MultiGfxContext& context)
     // Create video post process instance
     m_postProcess = std::make_unique<PostProcess>(m_session);
 
+    // Latency is measured on the Varjo clock, the time base of camera timestamps
+    varjo_Session* session = m_session;
+    m_latency = std::make_unique<LatencyTracker>([session]() { return static_cast<int64_t>(varjo_GetCurrentTime(session)); });
+
+    // Compiled shaders are cached on disk so that later runs skip compiling
+    if (!ShaderCache::instance().setDirectory(c_shaderCacheDirectory)) {
+        LOG_ERROR("Creating shader cache directory failed: %s", c_shaderCacheDirectory.c_str());
+    }
+    m_shaderSetting = c_defaultShaderSetting;
+
+    // Blue noise atlas is generated once and cached, frames only copy from it
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        const bool loaded = m_blueNoise.loadOrGenerate(c_blueNoiseParams, ThreadPool::instance());
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        LOG_INFO("Blue noise atlas %s in %.2f ms", loaded ? "loaded from cache" : "generated", ms);
+    }
+
     // NOTICE! In this example we always do VR scene rendering using the D3D11 graphics API.
     //
     // Still, we want to showcase video-see-through post processing API with D3D11, OpenGL and
@@ -138,6 +230,16 @@ bool AppLogic::init(MultiGfxContext& context)
 #endif
     }
 
+    // Find fastest post process shader setting for this machine on first launch. Runs before the
+    // frame loop starts, so tuning delays startup instead of stalling frames.
+    tuneShader();
+
+    // Create pipeline cache for test textures. Color LUT goes to its own shader input texture.
+    m_pipelines = std::make_unique<PipelineCache>([this](const PipelineCache::Key& key) {
+        const int64_t textureIndex = (key.textureType == TestTexture::Type::ColorLut) ? c_colorLutTextureIndex : c_noiseTextureIndex;
+        return createTexture(textureIndex, key.textureType, key.graphicsAPI);
+    });
+
     // Check if Mixed Reality features are available.
     varjo_Bool mixedRealityAvailable = varjo_False;
     varjo_SyncProperties(m_session);
@@ -166,6 +268,7 @@ void AppLogic::setState(const AppState& state, bool force)
     // Store previous state and set new one
     const auto prevState = m_appState;
     m_appState = state;
+    m_steadyFrames = 0;
 
     // Check for mixed reality availability
     if (!m_appState.general.mrAvailable) {
@@ -198,7 +301,7 @@ void AppLogic::setState(const AppState& state, bool force)
             LOG_ERROR("Loading post processor failed.");
             m_postProcess->reset();
         }
-        m_appState.postProcess.shaderSource = m_postProcess->getShaderSource();
+        m_appState.postProcess.shaderSource = getLoadedShaderSource();
         m_appState.postProcess.graphicsAPI = state.postProcess.graphicsAPI;
         m_appState.postProcess.textureType = state.postProcess.textureType;
     }
@@ -217,6 +320,26 @@ void AppLogic::setState(const AppState& state, bool force)
 #endif
 }
 
+void AppLogic::prebuildPipelines(const std::vector<AppState::PostProcess>& configs)
+{
+    std::vector<PipelineCache::Key> keys;
+    const auto addKey = [&keys](const PipelineCache::Key& key) {
+        if (std::find(keys.begin(), keys.end(), key) == keys.end()) {
+            keys.push_back(key);
+        }
+    };
+
+    for (const auto& config : configs) {
+        if (config.shaderSource != PostProcess::ShaderSource::None) {
+            addKey({config.graphicsAPI, config.textureType});
+            addKey({config.graphicsAPI, TestTexture::Type::ColorLut});
+        }
+    }
+
+    LOG_INFO("Prebuilding %d post process pipelines.", static_cast<int>(keys.size()));
+    m_pipelines->prebuild(keys);
+}
+
 bool AppLogic::loadPostProcessing(PostProcess::ShaderSource shaderSource, PostProcess::GraphicsAPI graphicsAPI, TestTexture::Type textureType)
 {
     if (!m_appState.general.mrAvailable) {
@@ -224,89 +347,366 @@ bool AppLogic::loadPostProcessing(PostProcess::ShaderSource shaderSource, PostPr
         return false;
     }
 
-    // Reset noise texture
-    m_texture.reset();
+    const auto startTime = std::chrono::steady_clock::now();
+
+    // Varjo runs a single post process shader, so it is reloaded when its source or graphics API
+    // changes. Input textures come prebuilt from the pipeline cache.
+    const bool reloadShader = shaderSource != getLoadedShaderSource() || graphicsAPI != m_shaderGraphicsAPI;
+    if (reloadShader) {
+        m_texture = nullptr;
+        m_lutTexture = nullptr;
+
+        // HLSL source is compiled with tuned setting through the shader cache and loaded as binary.
+        // Falls back to letting post processor compile the source with defaults if that fails.
+        bool loaded = false;
+        FilterTuner::Setting setting = getTunedShaderSetting();
+        if (shaderSource == PostProcess::ShaderSource::Source) {
+            const std::string binaryFile = getCachedShaderBinary(getShaderSourceFile(), setting);
+            loaded = !binaryFile.empty() &&
+                     m_postProcess->loadShader(graphicsAPI, PostProcess::ShaderSource::Binary, binaryFile, getPostProcessShaderParams(setting.tileSize));
+        }
 
-    // Load shader
-    if (!m_postProcess->loadShader(graphicsAPI, shaderSource, c_postProcessShaderSources.at(shaderSource), c_postProcessShaderParams)) {
-        LOG_ERROR("Loading shader failed.");
-        m_postProcess->reset();
-        return false;
+        // Load shader
+        if (!loaded && !m_postProcess->loadShader(graphicsAPI, shaderSource, c_postProcessShaderSources.at(shaderSource), c_postProcessShaderParams)) {
+            LOG_ERROR("Loading shader failed.");
+            m_postProcess->reset();
+            return false;
+        }
+        m_shaderSource = shaderSource;
+        m_shaderGraphicsAPI = graphicsAPI;
+        m_shaderSetting = loaded ? setting : c_defaultShaderSetting;
+
+        // Hot reload edits to HLSL source. Reloader also compiles tuned variants, so that neither
+        // edits nor moving the cutoff compile on the frame thread.
+        if (shaderSource != PostProcess::ShaderSource::Source) {
+            m_shaderReloader.reset();
+        } else if (!m_shaderReloader) {
+            std::vector<FilterTuner::Setting> variants;
+            for (const auto& range : m_filterTuner.getResults(FilterTuner::Target::GPU, m_gpuIdentity)) {
+                variants.push_back(range.setting);
+            }
+            m_shaderReloader = std::make_unique<ShaderReloader>(getShaderSourceFile(), m_shaderSetting, variants,
+                [this](const std::string& sourceFile, const FilterTuner::Setting& setting) { return getCachedShaderBinary(sourceFile, setting); });
+            LOG_INFO("Watching shader source for changes: %s", m_shaderReloader->getSourceFile().c_str());
+        }
     }
 
-    // Generate a new noise tex and update it to Varjo API.
     if (m_postProcess->getShaderSource() != PostProcess::ShaderSource::None) {
-        LOG_DEBUG("Create new post process texture..");
-
-        // Check texture format support
-        const auto& texParams = c_postProcessShaderParams.textures[0];
-        if (!m_postProcess->checkTextureFormat(graphicsAPI, texParams.format)) {
-            LOG_ERROR("Input texture format not supported: %d", static_cast<int>(texParams.format));
+        // Swap in test texture
+        TestTexture* texture = getTexture(c_noiseTextureIndex, textureType, graphicsAPI);
+        if (!texture) {
+            m_texture = nullptr;
+            m_lutTexture = nullptr;
             m_postProcess->reset();
             return false;
         }
 
-        // Lock varjo texture for copying
-        const int64_t textureIndex = 0;
-        varjo_Texture varjoTexture;
-        if (!m_postProcess->lockTextureBuffer(textureIndex, varjoTexture)) {
-            LOG_ERROR("Getting varjo texture failed.");
+        // Swap in color grading LUT texture
+        TestTexture* lutTexture = getTexture(c_colorLutTextureIndex, TestTexture::Type::ColorLut, graphicsAPI);
+        if (!lutTexture) {
+            m_texture = nullptr;
+            m_lutTexture = nullptr;
             m_postProcess->reset();
             return false;
         }
 
+        // Write swapped in textures once, later updates only write enabled effects
+        const bool swapped = texture != m_texture || lutTexture != m_lutTexture;
+        m_texture = texture;
+        m_lutTexture = lutTexture;
+        if (swapped) {
+            uploadInputTextures();
+        }
+    } else {
+        m_texture = nullptr;
+        m_lutTexture = nullptr;
+    }
+
+    if (m_postProcess->getShaderSource() != PostProcess::ShaderSource::None && m_appState.postProcess.enabled) {
+        m_postProcess->setEnabled(true);
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    LOG_INFO("Post process pipeline applied in %.2f ms%s", ms, reloadShader ? " (shader reloaded)" : "");
+
+    return true;
+}
+
+PostProcess::ShaderSource AppLogic::getLoadedShaderSource() const
+{
+    // Post processor reports shaders compiled through the shader cache as binary
+    return (m_postProcess->getShaderSource() != PostProcess::ShaderSource::None) ? m_shaderSource : PostProcess::ShaderSource::None;
+}
+
+void AppLogic::applyShaderReload()
+{
+    ShaderReloader::Result result;
+    if (!m_shaderReloader || !m_shaderReloader->takeResult(result) || getLoadedShaderSource() != PostProcess::ShaderSource::Source) {
+        return;
+    }
+
+    TRACE_SCOPE("AppLogic::applyShaderReload");
+    const auto startTime = std::chrono::steady_clock::now();
+
+    // Binary is swapped in as compiled. If the tuned setting changed meanwhile, the next
+    // applyTunedShaderSetting requests that variant from the reloader.
+    if (!swapShaderBinary(result.binaryFile, result.setting)) {
+        return;
+    }
+
+    const auto endTime = std::chrono::steady_clock::now();
+    const double swapMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    const double latencyMs = std::chrono::duration<double, std::milli>(endTime - result.changeTime).count();
+    if (result.sourceChanged) {
+        LOG_INFO("Post process shader reloaded %.0f ms after change (compile %.0f ms, swap %.2f ms)", latencyMs, result.compileMs, swapMs);
+    } else {
+        LOG_INFO("Post process shader switched to block size %d, low pass mode %d %.0f ms after request (swap %.2f ms)", result.setting.tileSize,
+            result.setting.lowPassMode, latencyMs, swapMs);
+    }
+}
+
+bool AppLogic::swapShaderBinary(const std::string& binaryFile, const FilterTuner::Setting& setting)
+{
+    // Creating shader from compiled binary is fast, so swapping does not stall the frame
+    if (binaryFile.empty() ||
+        !m_postProcess->loadShader(m_shaderGraphicsAPI, PostProcess::ShaderSource::Binary, binaryFile, getPostProcessShaderParams(setting.tileSize))) {
+        LOG_ERROR("Swapping in shader failed: %s", binaryFile.c_str());
+        m_texture = nullptr;
+        m_lutTexture = nullptr;
+        m_postProcess->reset();
+        m_appState.postProcess.shaderSource = getLoadedShaderSource();
+        return false;
+    }
+    m_shaderSetting = setting;
+    m_steadyFrames = 0;
+
+    // Shader input textures are recreated with the shader, so they must be written again
+    uploadInputTextures();
+    if (m_appState.postProcess.enabled) {
+        m_postProcess->setEnabled(true);
+    }
+    return true;
+}
+
+void AppLogic::tuneShader()
+{
+    TRACE_SCOPE("AppLogic::tuneShader");
+
+    // Tuned variants are compiled from HLSL source
+    const std::string sourceFile = getShaderSourceFile();
+    std::ifstream file(sourceFile, std::ios::binary);
+    if (!file) {
+        LOG_ERROR("Reading shader source failed, using default shader setting: %s", sourceFile.c_str());
+        return;
+    }
+    std::stringstream stream;
+    stream << file.rdbuf();
+    const std::string source = stream.str();
+
+    auto d3d11Device = m_postProcess->getD3D11Device();
+    m_gpuIdentity = FilterBenchD3D11::getIdentity(d3d11Device, source);
+    m_filterTuner.load(FilterTuner::c_defaultFile);
+    if (!m_filterTuner.hasResults(FilterTuner::Target::GPU, m_gpuIdentity)) {
+        LOG_INFO("Tuning post process shader for this machine..");
+        const auto startTime = std::chrono::steady_clock::now();
         try {
-            glm::ivec2 texSize(texParams.width, texParams.height);
+            FilterBenchD3D11 bench(d3d11Device, source, c_tuningViewSizes);
+            m_filterTuner.tune(FilterTuner::Target::GPU, m_gpuIdentity, FilterBenchD3D11::getCandidates(),
+                [&bench](const FilterTuner::Setting& setting, float cutoff) { return bench.measure(setting, cutoff); });
+        } catch (const std::runtime_error&) {
+            LOG_ERROR("Tuning post process shader failed, using default shader setting.");
+            return;
+        }
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        LOG_INFO("Post process shader tuned in %.0f ms", ms);
 
-            switch (m_appState.postProcess.graphicsAPI) {
-                case PostProcess::GraphicsAPI::D3D11: {
-                    auto d3d11Device = m_postProcess->getD3D11Device();
-                    auto dxgiFormat = static_cast<DXGI_FORMAT>(m_postProcess->toDXGIFormat(texParams.format));
-                    m_texture = std::make_unique<TestTextureD3D11>(textureType, texParams.format, texSize, d3d11Device, dxgiFormat);
-                } break;
-                case PostProcess::GraphicsAPI::OpenGL: {
-                    auto glFormat = m_postProcess->toGLFormat(texParams.format);
-                    m_texture = std::make_unique<TestTextureGL>(textureType, texParams.format, texSize, glFormat.baseFormat, glFormat.internalFormat);
-                } break;
-                case PostProcess::GraphicsAPI::D3D12: {
-                    auto d3d12CommandQueue = m_postProcess->getD3D12CommandQueue();
-                    auto dxgiFormat = static_cast<DXGI_FORMAT>(m_postProcess->toDXGIFormat(texParams.format));
-                    m_texture = std::make_unique<TestTextureD3D12>(textureType, texParams.format, texSize, d3d12CommandQueue, dxgiFormat);
-                } break;
-                default: {
-                    LOG_ERROR("Unsupported graphics API: %d", m_appState.postProcess.graphicsAPI);
-                    return false;
-                }
+        if (!m_filterTuner.save(FilterTuner::c_defaultFile)) {
+            LOG_ERROR("Writing tuning results failed: %s", FilterTuner::c_defaultFile);
+        }
+    }
+
+    // Compile tuned variants ahead of time, so that moving the cutoff between ranges is a cache hit
+    for (const auto& range : m_filterTuner.getResults(FilterTuner::Target::GPU, m_gpuIdentity)) {
+        LOG_INFO("Post process shader for kernel size %d: block size %d, low pass mode %d, %.3f ms", range.maxKernelSize,
+            range.setting.tileSize, range.setting.lowPassMode, range.ms);
+        getCachedShaderBinary(sourceFile, range.setting);
+    }
+}
+
+FilterTuner::Setting AppLogic::getTunedShaderSetting() const
+{
+    return m_filterTuner.getSetting(FilterTuner::Target::GPU, m_gpuIdentity, m_appState.postProcess.highPassCutoffFreq, c_defaultShaderSetting);
+}
+
+void AppLogic::applyTunedShaderSetting()
+{
+    // Only shaders compiled through the shader cache have tuned variants
+    if (getLoadedShaderSource() != PostProcess::ShaderSource::Source || !m_shaderReloader) {
+        return;
+    }
+
+    // Current shader keeps running until the reloader has the variant ready. Even a cache hit
+    // reads and hashes the source, so that is left to the reloader thread too.
+    m_shaderReloader->requestSetting(getTunedShaderSetting());
+}
+
+std::string AppLogic::getCachedShaderBinary(const std::string& sourceFile, const FilterTuner::Setting& setting)
+{
+    TRACE_SCOPE("AppLogic::getCachedShaderBinary");
+
+    std::ifstream file(sourceFile, std::ios::binary);
+    if (!file) {
+        LOG_ERROR("Reading shader source failed: %s", sourceFile.c_str());
+        return {};
+    }
+    std::stringstream stream;
+    stream << FilterTuner::getShaderDefines(setting) << file.rdbuf();
+    const std::string source = stream.str();
+
+    const uint64_t key = ShaderCache::makeKey(source, c_postProcessShaderTarget, c_compilerIdentity);
+    const std::string binaryFile = ShaderCache::instance().getFilePath(key, "vstPostProcess_", ".cso");
+    if (binaryFile.empty()) {
+        return {};
+    }
+
+    // Reuse binary compiled by earlier run. The raw file the post processor loads has no header, so it
+    // is only trusted if it matches the cache entry validated against header and checksum.
+    auto& cache = ShaderCache::instance();
+    if (const auto binary = cache.find(key)) {
+        if (!fileEquals(binaryFile, binary->data)) {
+            LOG_WARNING("Post process shader file missing or corrupted, rewriting from shader cache: %s", binaryFile.c_str());
+            if (!ShaderCache::writeFile(binaryFile, binary->data.data(), binary->data.size())) {
+                LOG_ERROR("Writing post process shader to shader cache failed: %s", binaryFile.c_str());
+                return {};
+            }
+        }
+        LOG_DEBUG("Post process shader found in shader cache: %s", binaryFile.c_str());
+        return binaryFile;
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    ComPtr<ID3DBlob> shaderBlob = D3D11Renderer::compileShader("vstPostProcess", source.c_str(), c_postProcessShaderTarget);
+    if (!shaderBlob) {
+        LOG_ERROR("Compiling post process shader failed.");
+        return {};
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    LOG_INFO("Post process shader compiled in %.2f ms", ms);
+
+    // Validated cache entry first, so that a raw file is never trusted without one
+    if (!cache.store(key, 0, shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize()) ||
+        !ShaderCache::writeFile(binaryFile, shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize())) {
+        LOG_ERROR("Writing post process shader to shader cache failed: %s", binaryFile.c_str());
+        return {};
+    }
+    return binaryFile;
+}
+
+std::unique_ptr<TestTexture> AppLogic::createTexture(int64_t textureIndex, TestTexture::Type textureType, PostProcess::GraphicsAPI graphicsAPI)
+{
+    const auto& texParams = c_postProcessShaderParams.textures[textureIndex];
+
+    std::unique_ptr<TestTexture> texture;
+
+    try {
+        glm::ivec2 texSize(texParams.width, texParams.height);
+
+        switch (graphicsAPI) {
+            case PostProcess::GraphicsAPI::D3D11: {
+                auto d3d11Device = m_postProcess->getD3D11Device();
+                auto dxgiFormat = static_cast<DXGI_FORMAT>(m_postProcess->toDXGIFormat(texParams.format));
+                texture = std::make_unique<TestTextureD3D11>(textureType, texParams.format, texSize, d3d11Device, dxgiFormat);
+            } break;
+            case PostProcess::GraphicsAPI::OpenGL: {
+                auto glFormat = m_postProcess->toGLFormat(texParams.format);
+                texture = std::make_unique<TestTextureGL>(textureType, texParams.format, texSize, glFormat.baseFormat, glFormat.internalFormat);
+            } break;
+            case PostProcess::GraphicsAPI::D3D12: {
+                auto d3d12CommandQueue = m_postProcess->getD3D12CommandQueue();
+                auto dxgiFormat = static_cast<DXGI_FORMAT>(m_postProcess->toDXGIFormat(texParams.format));
+                texture = std::make_unique<TestTextureD3D12>(textureType, texParams.format, texSize, d3d12CommandQueue, dxgiFormat);
+            } break;
+            default: {
+                LOG_ERROR("Unsupported graphics API: %d", graphicsAPI);
+                return nullptr;
             }
+        }
+
+        // Color LUT and blue noise textures copy from our LUT and atlas
+        texture->setColorLut(&m_colorLut);
+        texture->setBlueNoise(&m_blueNoise);
+
+    } catch (const std::runtime_error&) {
+        LOG_ERROR("Creating test texture failed.");
+        return nullptr;
+    }
 
-            // Update locked texture on once CPU and GPU just to catch possible errors
-            m_texture->update(varjoTexture, false);
-            m_texture->update(varjoTexture, true);
+    return texture;
+}
 
+TestTexture* AppLogic::getTexture(int64_t textureIndex, TestTexture::Type textureType, PostProcess::GraphicsAPI graphicsAPI)
+{
+    // Check texture format support
+    const auto& texParams = c_postProcessShaderParams.textures[textureIndex];
+    if (!m_postProcess->checkTextureFormat(graphicsAPI, texParams.format)) {
+        LOG_ERROR("Input texture format not supported: %d", static_cast<int>(texParams.format));
+        return nullptr;
+    }
+
+    return m_pipelines->get({graphicsAPI, textureType});
+}
+
+void AppLogic::updateTexture(TestTexture& texture, int64_t textureIndex, bool useGPU, std::vector<int32_t>& updatedTextures)
+{
+    // Lock varjo texture for copying
+    varjo_Texture varjoTexture;
+    if (m_postProcess->lockTextureBuffer(textureIndex, varjoTexture)) {
+        try {
+            // Update texture
+            PROFILE_SCOPE(TextureUpdate);
+            texture.update(varjoTexture, useGPU);
         } catch (const std::runtime_error&) {
-            LOG_ERROR("Creating test texture failed.");
-            m_postProcess->reset();
-            return false;
+            LOG_ERROR("Updating texture failed.");
         }
 
-        // Unlock shader input texture
+        // Flag texture that has been updated
+        updatedTextures.push_back(static_cast<int32_t>(textureIndex));
+
+        // Unlock texture
         m_postProcess->unlockTextureBuffer(textureIndex);
+    }
+}
+
+void AppLogic::uploadInputTextures()
+{
+    TRACE_SCOPE("AppLogic::uploadInputTextures");
 
-        // Release textures
-        std::vector<int32_t> updatedIndices;
-        updatedIndices.push_back(textureIndex);
-        m_postProcess->applyInputBuffers(nullptr, 0, updatedIndices);
+    auto& updatedTextures = m_updatedTextures;
+    updatedTextures.clear();
+
+    // Noise texture with the same generator as the per frame update
+    if (m_texture) {
+        const auto& state = m_appState.postProcess;
+        const bool useGPU = state.textureGeneratedOnGPU && state.textureType != TestTexture::Type::BlueNoise;
+        updateTexture(*m_texture, c_noiseTextureIndex, useGPU, updatedTextures);
     }
 
-    if (m_postProcess->getShaderSource() != PostProcess::ShaderSource::None && m_appState.postProcess.enabled) {
-        m_postProcess->setEnabled(true);
+    // Color LUT with the last baked parameters, or defaults before the first bake
+    if (m_lutTexture) {
+        if (!m_colorLut.isValid()) {
+            m_colorLut.bake(ColorLut::Params());
+        }
+        updateTexture(*m_lutTexture, c_colorLutTextureIndex, false, updatedTextures);
     }
 
-    return true;
+    // Release textures
+    m_postProcess->applyInputBuffers(nullptr, 0, updatedTextures);
 }
 
 void AppLogic::updatePostProcessing()
 {
+    TRACE_SCOPE("AppLogic::updatePostProcessing");
+
     // Early exit if not enabled
     if (!m_appState.general.mrAvailable || !m_postProcess->isActive()) {
         return;
@@ -337,29 +737,33 @@ void AppLogic::updatePostProcessing()
     cBuffer.highPassCutoffFreq = state.highPassCutoffFreq;
     cBuffer.blurKernelSize = state.blurKernelSize;
     cBuffer.filterType = state.filterType;
+    cBuffer.kernelShape = state.kernelShape;
+    cBuffer.gridCellSize = state.gridCellSize;
+    cBuffer.gridRangeBins = state.gridRangeBins;
+    cBuffer.enhanceGain = state.enhanceGain;
+
+    // Adaptive quality level
+    const auto& quality = m_qualityController.getLevel();
+    cBuffer.tapStride = quality.tapStride;
+
+    // Bank kernel weights for the cutoff and tap stride. Looked up at the fixed XR-3 PPD, not per view.
+    setKernelConstants(cBuffer, KernelBank::c_defaultPpd);
+
+    // List of shader input texture indices updated. Capacity is kept between frames.
+    auto& updatedTextures = m_updatedTextures;
+    updatedTextures.clear();
+
+    // Update texture if noise enabled. Adaptive quality can reuse it for several frames.
+    const bool textureDue = (m_appState.general.frameCount % quality.textureUpdateInterval) == 0;
+    if (m_texture && m_appState.postProcess.textureEnabled && textureDue) {
+        // Blue noise atlas frames are copied on CPU
+        const bool useGPU = state.textureGeneratedOnGPU && state.textureType != TestTexture::Type::BlueNoise;
+        updateTexture(*m_texture, c_noiseTextureIndex, useGPU, updatedTextures);
+    }
 
-    // List of shader input texture indices updated
-    std::vector<int32_t> updatedTextures;
-
-    // Update texture if noise enabled
-    if (m_texture && m_appState.postProcess.textureEnabled) {
-        // Lock varjo texture for copying
-        constexpr int64_t textureIndex = 0;
-        varjo_Texture varjoTexture;
-        if (m_postProcess->lockTextureBuffer(textureIndex, varjoTexture)) {
-            try {
-                // Update texture
-                m_texture->update(varjoTexture, m_appState.postProcess.textureGeneratedOnGPU);
-            } catch (const std::runtime_error&) {
-                LOG_ERROR("Updating texture failed.");
-            }
-
-            // Flag texture that has been updated
-            updatedTextures.push_back(textureIndex);
-
-            // Unlock texture
-            m_postProcess->unlockTextureBuffer(textureIndex);
-        }
+    // Re-bake and upload color grading LUT only when its parameters change
+    if (m_lutTexture && state.colorEnabled && m_colorLut.bake(getColorLutParams(cBuffer))) {
+        updateTexture(*m_lutTexture, c_colorLutTextureIndex, false, updatedTextures);
     }
 
     // Update constant buffer
@@ -368,11 +772,24 @@ void AppLogic::updatePostProcessing()
 
 void AppLogic::update()
 {
+    TRACE_SCOPE("AppLogic::update");
+
+    // Frame boundary: release frame arena and count heap allocations of this frame
+    FrameArena::forThread().reset();
+    const uint64_t allocationsBefore = AllocationCounter::getThreadCount();
+
     // Check for new mixed reality events
     checkEvents();
 
     // Sync frame
-    m_varjoView->syncFrame();
+    {
+        PROFILE_SCOPE(SyncFrame);
+        m_varjoView->syncFrame();
+    }
+    m_latency->beginFrame(m_varjoView->getFrameNumber());
+
+    // Frame work is measured from frame sync to submit for adaptive quality
+    const auto workStart = std::chrono::steady_clock::now();
 
     // Update frame time
     m_appState.general.frameTime += m_varjoView->getDeltaTime();
@@ -383,21 +800,35 @@ void AppLogic::update()
         m_appState.postProcess.animTime += m_appState.postProcess.animFreq * m_varjoView->getDeltaTime();
     }
 
+    // Swap in hot reloaded or retuned shader between frames
+    if (m_appState.general.mrAvailable) {
+        applyShaderReload();
+        applyTunedShaderSetting();
+    }
+
     // Update video post processing if active
     if (m_appState.general.mrAvailable && m_postProcess->isActive()) {
+        PROFILE_SCOPE(UpdatePostProcessing);
         updatePostProcessing();
+        m_latency->mark(LatencyTracker::Event::Apply);
     }
 
 #if (!USE_HEADLESS_MODE)
 
     // Update scene
-    m_scene->update(m_varjoView->getFrameTime(), m_varjoView->getDeltaTime(), m_varjoView->getFrameNumber(), Scene::UpdateParams());
+    {
+        PROFILE_SCOPE(SceneUpdate);
+        m_scene->setStressObjectCount(m_appState.general.stressObjectCount);
+        m_scene->update(m_varjoView->getFrameTime(), m_varjoView->getDeltaTime(), m_varjoView->getFrameNumber(), Scene::UpdateParams());
+    }
 
     // Begin frame
     m_varjoView->beginFrame();
 
     // Render layer
     if (m_appState.general.vrEnabled) {
+        PROFILE_SCOPE(LayerRender);
+
         // Get layer for rendering
         constexpr int layerIndex = 0;
         auto& layer = m_varjoView->getLayer(layerIndex);
@@ -426,20 +857,108 @@ void AppLogic::update()
     }
 
     // End and submit frame
-    m_varjoView->endFrame();
+    {
+        PROFILE_SCOPE(EndFrame);
+        m_varjoView->endFrame();
+    }
+
+#endif
 
+    m_latency->mark(LatencyTracker::Event::Submit);
+    m_latency->endFrame();
+
+    const double workMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - workStart).count();
+    updateQuality(workMs, m_varjoView->getDeltaTime() * 1000.0);
+
+    checkFrameAllocations(AllocationCounter::getThreadCount() - allocationsBefore);
+}
+
+void AppLogic::checkFrameAllocations(uint64_t allocations)
+{
+    // State changes, shader swaps and quality steps allocate, so frames right after are not steady
+    if (++m_steadyFrames <= c_allocationWarmupFrames || allocations == 0) {
+        return;
+    }
+
+    if (m_allocatingFrames++ == 0) {
+        LOG_ERROR("Heap allocations in steady state frame: %llu (frame %lld)", static_cast<unsigned long long>(allocations),
+            static_cast<long long>(m_appState.general.frameCount));
+    }
+#if (USE_ALLOCATION_CHECK)
+    assert(allocations == 0 && "Heap allocation in steady state frame");
 #endif
 }
 
+void AppLogic::startCameraTimestamps()
+{
+    if (m_cameraStreamId >= 0) {
+        return;
+    }
+
+    // Distorted color stream delivers camera image timestamps in its metadata
+    const int32_t configCount = varjo_GetDataStreamConfigCount(m_session);
+    std::vector<varjo_StreamConfig> configs(std::max(configCount, 0));
+    varjo_GetDataStreamConfigs(m_session, configs.data(), static_cast<int32_t>(configs.size()));
+    CHECK_VARJO_ERR(m_session);
+
+    const auto it = std::find_if(configs.begin(), configs.end(), [](const varjo_StreamConfig& config) { return config.streamType == varjo_StreamType_DistortedColor; });
+    if (it == configs.end()) {
+        LOG_ERROR("Camera stream not available, latency tracking disabled.");
+        return;
+    }
+
+    // Only frame metadata is read, image buffers are never locked
+    const auto callback = [](const varjo_StreamFrame* frame, varjo_Session*, void* userData) {
+        if (frame->type == varjo_StreamType_DistortedColor) {
+            static_cast<LatencyTracker*>(userData)->setCameraTime(frame->metadata.distortedColor.timestamp);
+        }
+    };
+    varjo_StartDataStream(m_session, it->streamId, varjo_ChannelFlag_Left, callback, m_latency.get());
+    if (CHECK_VARJO_ERR(m_session) != varjo_NoError) {
+        LOG_ERROR("Starting camera stream failed, latency tracking disabled.");
+        return;
+    }
+    m_cameraStreamId = it->streamId;
+}
+
+void AppLogic::stopCameraTimestamps()
+{
+    if (m_cameraStreamId >= 0) {
+        varjo_StopDataStream(m_session, m_cameraStreamId);
+        CHECK_VARJO_ERR(m_session);
+        m_cameraStreamId = -1;
+    }
+}
+
+void AppLogic::updateQuality(double workMs, double intervalMs)
+{
+    if (!m_appState.general.adaptiveQuality) {
+        if (m_qualityController.getLevelIndex() != 0) {
+            m_qualityController.reset();
+            LOG_INFO("Adaptive quality off, back to full quality");
+        }
+        return;
+    }
+
+    if (m_qualityController.addFrame(workMs, intervalMs)) {
+        m_steadyFrames = 0;
+        const auto metrics = m_qualityController.getMetrics();
+        const auto& level = m_qualityController.getLevel();
+        LOG_INFO("Adaptive quality level %d/%d: tap stride %d, texture update interval %d (work %.2f ms, smoothed %.2f ms, interval %.2f ms)",
+            metrics.level, metrics.levelCount - 1, level.tapStride, level.textureUpdateInterval, workMs, metrics.smoothedMs, intervalMs);
+    }
+}
+
 void AppLogic::onMixedRealityAvailable(bool available, bool forceSetState)
 {
     m_appState.general.mrAvailable = available;
 
     if (available) {
-        // Update stuff here if needed
+        // Camera timestamps for latency tracking
+        startCameraTimestamps();
     } else {
         LOG_ERROR("Mixed Reality features not available.");
-        // Update stuff here if needed
+        stopCameraTimestamps();
     }
 
     // Force set state when MR becomes active
@@ -451,6 +970,8 @@ void AppLogic::onMixedRealityAvailable(bool available, bool forceSetState)
 
 void AppLogic::checkEvents()
 {
+    PROFILE_SCOPE(CheckEvents);
+
     varjo_Bool ret = varjo_False;
 
     do {
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <glm/glm.hpp>
 #include <GL/glew.h>
 
@@ -16,6 +17,14 @@
 #include "PostProcess.hpp"
 #include "MultiGfxContext.hpp"
 #include "TestTexture.hpp"
+#include "ColorLut.hpp"
+#include "BlueNoise.hpp"
+#include "TestScene.hpp"
+#include "PipelineCache.hpp"
+#include "ShaderReloader.hpp"
+#include "FilterTuner.hpp"
+#include "QualityController.hpp"
+#include "LatencyTracker.hpp"
 
 //! Application logic class
 class AppLogic
@@ -48,6 +57,15 @@ public:
     //! Update application
     void update();
 
+    //! Build post process pipelines used by given configurations ahead of time
+    void prebuildPipelines(const std::vector<AppState::PostProcess>& configs);
+
+    //! Returns adaptive quality metrics. Can be called from any thread.
+    QualityController::Metrics getQualityMetrics() const { return m_qualityController.getMetrics(); }
+
+    //! Returns motion-to-photon latency tracker. Valid after init.
+    const LatencyTracker& getLatencyTracker() const { return *m_latency; }
+
 private:
     //! Enable/disable VST rendering
     void setVSTRendering(bool enabled);
@@ -56,6 +74,55 @@ private:
     bool loadPostProcessing(
         VarjoExamples::PostProcess::ShaderSource shaderSource, VarjoExamples::PostProcess::GraphicsAPI graphicsAPI, TestTexture::Type textureType);
 
+    //! Start camera stream delivering camera image timestamps for latency tracking
+    void startCameraTimestamps();
+
+    //! Stop camera timestamp stream
+    void stopCameraTimestamps();
+
+    //! Check heap allocations made by the frame loop during a frame
+    void checkFrameAllocations(uint64_t allocations);
+
+    //! Feed measured frame to adaptive quality controller and log level changes
+    void updateQuality(double workMs, double intervalMs);
+
+    //! Create test texture for given shader input texture index. Called from pipeline cache, possibly on a background thread.
+    std::unique_ptr<TestTexture> createTexture(int64_t textureIndex, TestTexture::Type textureType, VarjoExamples::PostProcess::GraphicsAPI graphicsAPI);
+
+    //! Returns source of loaded post process shader as requested, or None if no shader is loaded
+    VarjoExamples::PostProcess::ShaderSource getLoadedShaderSource() const;
+
+    //! Returns path of compiled binary for given HLSL shader source file and tuned setting from shader
+    //! cache, compiling and storing it on cache miss. Returns empty string on failure.
+    std::string getCachedShaderBinary(const std::string& sourceFile, const FilterTuner::Setting& setting);
+
+    //! Swap in hot reloaded post process shader if one finished compiling. Call at frame boundary.
+    void applyShaderReload();
+
+    //! Swap in compiled shader binary built with given setting. Returns false on failure.
+    bool swapShaderBinary(const std::string& binaryFile, const FilterTuner::Setting& setting);
+
+    //! Tune post process shader block size and low pass strategy, unless tuned earlier on this machine.
+    //! Blocks for seconds when tuning, as the GPU bench shares the immediate context with rendering.
+    //! Results are keyed by shader source too, so the first launch after a shader edit tunes again.
+    void tuneShader();
+
+    //! Returns tuned shader setting for current cutoff frequency
+    FilterTuner::Setting getTunedShaderSetting() const;
+
+    //! Request shader compiled with tuned setting for current cutoff frequency from the shader reloader.
+    //! Swapped in by applyShaderReload once ready. Call at frame boundary.
+    void applyTunedShaderSetting();
+
+    //! Returns cached test texture for given shader input texture index, or nullptr if not supported
+    TestTexture* getTexture(int64_t textureIndex, TestTexture::Type textureType, VarjoExamples::PostProcess::GraphicsAPI graphicsAPI);
+
+    //! Update test texture contents to given shader input texture index
+    void updateTexture(TestTexture& texture, int64_t textureIndex, bool useGPU, std::vector<int32_t>& updatedTextures);
+
+    //! Write active test and LUT textures once and apply them. Per frame updates skip disabled effects.
+    void uploadInputTextures();
+
     //! Update post processing
     void updatePostProcessing();
 
@@ -69,12 +136,28 @@ private:
 #if (!USE_HEADLESS_MODE)
     std::unique_ptr<VarjoExamples::Renderer> m_renderer;         //!< Renderer instance
     std::unique_ptr<VarjoExamples::MultiLayerView> m_varjoView;  //!< Varjo layer view instance
-    std::unique_ptr<VarjoExamples::Scene> m_scene;               //!< Application scene instance
+    std::unique_ptr<TestScene> m_scene;                          //!< Application scene instance
 #else
     std::unique_ptr<VarjoExamples::HeadlessView> m_varjoView;  //!< Varjo headless view instance
 #endif
 
-    std::unique_ptr<VarjoExamples::PostProcess> m_postProcess;  //!< VST post processor
-    std::unique_ptr<TestTexture> m_texture;                     //!< Test texture instance
-    AppState m_appState;                                        //!< Application state
+    std::unique_ptr<VarjoExamples::PostProcess> m_postProcess;      //!< VST post processor
+    VarjoExamples::PostProcess::ShaderSource m_shaderSource{};      //!< Requested source of loaded shader
+    VarjoExamples::PostProcess::GraphicsAPI m_shaderGraphicsAPI{};  //!< Graphics API of loaded shader
+    std::unique_ptr<PipelineCache> m_pipelines;                     //!< Prebuilt test texture pipelines
+    std::unique_ptr<ShaderReloader> m_shaderReloader;               //!< Post process shader hot reload, active for HLSL source
+    FilterTuner m_filterTuner;                                      //!< Tuned shader settings
+    uint64_t m_gpuIdentity = 0;                                     //!< GPU and shader identity of tuning results
+    FilterTuner::Setting m_shaderSetting;                           //!< Tuned setting of loaded shader
+    TestTexture* m_texture = nullptr;                               //!< Active test texture from pipeline cache
+    TestTexture* m_lutTexture = nullptr;                            //!< Active color grading LUT texture from pipeline cache
+    ColorLut m_colorLut;                                            //!< Color grading LUT baked on CPU
+    BlueNoise m_blueNoise;                                          //!< Blue noise atlas built at startup
+    AppState m_appState;                                            //!< Application state
+    QualityController m_qualityController;                          //!< Adaptive quality for holding the frame budget
+    std::unique_ptr<LatencyTracker> m_latency;                      //!< Motion-to-photon latency from camera timestamps
+    int64_t m_cameraStreamId = -1;                                  //!< Camera stream for timestamps, -1 if not started
+    std::vector<int32_t> m_updatedTextures;                         //!< Shader input textures updated this frame, reused
+    int64_t m_steadyFrames = 0;                                     //!< Frames since last event that may allocate
+    uint64_t m_allocatingFrames = 0;                                //!< Steady state frames that made heap allocations
 };
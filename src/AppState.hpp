@@ -8,6 +8,11 @@
 // but does not render anything by itself.
 #define USE_HEADLESS_MODE 0
 
+// Compile time flag to run application logic and Varjo frame loop on a dedicated render thread.
+// UI then runs at its own lower rate and exchanges application state with the render thread
+// through lock-free state channels.
+#define USE_RENDER_THREAD 1
+
 #include <glm/glm.hpp>
 
 #include "Globals.hpp"
@@ -18,13 +23,24 @@
 struct AppState {
     // General params structure
     struct General {
-        double frameTime{0.0};    //!< Current frame time
-        int64_t frameCount{0};    //!< Current frame count
-        bool mrAvailable{false};  //!< Mixed reality available flag
-        bool vstEnabled{true};    //!< Render VST image flag
+        double frameTime{0.0};       //!< Current frame time
+        int64_t frameCount{0};       //!< Current frame count
+        bool mrAvailable{false};     //!< Mixed reality available flag
+        bool vstEnabled{true};       //!< Render VST image flag
+        bool adaptiveQuality{true};  //!< Lower filter quality to hold the frame budget
+#if (!USE_HEADLESS_MODE)
+        bool vrEnabled{true};      //!< Render VR scene flag
+        int stressObjectCount{0};  //!< VR scene stress test object count
+#endif
+
+        bool operator==(const General& other) const
+        {
+            return frameTime == other.frameTime && frameCount == other.frameCount && mrAvailable == other.mrAvailable &&
 #if (!USE_HEADLESS_MODE)
-        bool vrEnabled{true};  //!< Render VR scene flag
+                   vrEnabled == other.vrEnabled && stressObjectCount == other.stressObjectCount &&
 #endif
+                   vstEnabled == other.vstEnabled && adaptiveQuality == other.adaptiveQuality;
+        }
     };
 
     // VST Post process params
@@ -32,10 +48,10 @@ struct AppState {
         bool enabled{false};
         VarjoExamples::PostProcess::ShaderSource shaderSource{VarjoExamples::PostProcess::ShaderSource::None};
         VarjoExamples::PostProcess::GraphicsAPI graphicsAPI{VarjoExamples::PostProcess::GraphicsAPI::None};
-        TestTexture::Type textureType{TestTexture::Type::Noise};
+        TestTexture::Type textureType{TestTexture::Type::BlueNoise};
 
-        // Color grading params
-        bool colorEnabled{true};
+        // Color grading params. Off by default, so that output matches the ungraded camera image.
+        bool colorEnabled{false};
         float colorFactor{1.0f};
         float colorPreserveSaturated{1.0f};
         glm::vec4 colorValue{0.4f, 0.5f, 0.7f, 1.0f};
@@ -66,8 +82,32 @@ struct AppState {
 
 	//Filter
 	int filterType{0};
+	int kernelShape{0};       // Low pass kernel shape, FilterCPU::KernelShape
+	int gridCellSize{16};     // Bilateral grid cell size in pixels
+	int gridRangeBins{8};     // Bilateral grid luminance bins
+	float enhanceGain{1.0f};  // Bilateral grid edge enhancement gain
+
+        bool operator==(const PostProcess& other) const
+        {
+            return enabled == other.enabled && shaderSource == other.shaderSource && graphicsAPI == other.graphicsAPI &&
+                   textureType == other.textureType &&  //
+                   colorEnabled == other.colorEnabled && colorFactor == other.colorFactor &&
+                   colorPreserveSaturated == other.colorPreserveSaturated && colorValue == other.colorValue && colorExp == other.colorExp &&
+                   colorScale == other.colorScale && colorExpScale == other.colorExpScale &&  //
+                   textureEnabled == other.textureEnabled && textureGeneratedOnGPU == other.textureGeneratedOnGPU &&
+                   textureAmount == other.textureAmount && textureScale == other.textureScale &&  //
+                   blurEnabled == other.blurEnabled && blurScale == other.blurScale && blurKernelSize == other.blurKernelSize &&
+                   highPassCutoffFreq == other.highPassCutoffFreq &&  //
+                   animate == other.animate && animFreq == other.animFreq && animAmpl == other.animAmpl && animOffs == other.animOffs &&
+                   animTime == other.animTime &&  //
+                   filterType == other.filterType && kernelShape == other.kernelShape && gridCellSize == other.gridCellSize &&
+                   gridRangeBins == other.gridRangeBins && enhanceGain == other.enhanceGain;
+        }
     };
 
     General general{};
     PostProcess postProcess{};
+
+    bool operator==(const AppState& other) const { return general == other.general && postProcess == other.postProcess; }
+    bool operator!=(const AppState& other) const { return !(*this == other); }
 };
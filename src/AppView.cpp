@@ -3,19 +3,22 @@
 #include "AppView.hpp"
 
 #include <unordered_map>
+#include <algorithm>
 #include <tchar.h>
 #include <iostream>
 #include <imgui_internal.h>
 #include <map>
-#include <chrono>
+#include <fstream>
+#include <sstream>
+
+#include "FilterCPU.hpp"
+#include "FrameProfiler.hpp"
+#include "TraceRecorder.hpp"
 
 // Application title text
 #define APP_TITLE_TEXT "Video Post Process Test Client"
 #define APP_COPYRIGHT_TEXT "(C) 2020 Varjo Technologies"
 
-// Enable debug frame timing
-#define DEBUG_FRAME_TIMING 0
-
 // VarjoExamples namespace contains simple example wrappers for using Varjo API features.
 // These are only meant to be used in SDK example applications. In your own application,
 // use your own production quality integration layer.
@@ -28,6 +31,9 @@ enum class Action {
     None = 0,
     Help,
     ToggleTestPresets,
+    ToggleProfiler,
+    SaveProfile,
+    SaveTrace,
     ApplyPreset_0,
     ApplyPreset_1,
     ApplyPreset_2,
@@ -55,6 +61,9 @@ const std::map<Action, ActionInfo> c_actions = {
     {Action::None, {"None", 0, "(no action)"}},
     {Action::Help, {"Help", VK_F1, "F1   Print help"}},
     {Action::ToggleTestPresets, {"Toggle test presets", 'T', "T    Toggle test presets"}},
+    {Action::ToggleProfiler, {"Toggle profiler", 'P', "P    Toggle frame profiler"}},
+    {Action::SaveProfile, {"Save profile", 'O', "O    Save frame profile as JSON"}},
+    {Action::SaveTrace, {"Save trace", 'K', "K    Save timeline trace as Chrome trace JSON"}},
     {Action::ApplyPreset_0, {"Apply Preset 0", '0', "0    Apply preset 0"}},
     {Action::ApplyPreset_1, {"Apply Preset 1", '1', "1    Apply preset 1"}},
     {Action::ApplyPreset_2, {"Apply Preset 2", '2', "2    Apply preset 2"}},
@@ -74,14 +83,29 @@ constexpr int c_windowMargin = 8;
 constexpr glm::ivec2 c_windowClientSize(720, 900);
 constexpr int c_logHeight = 230;
 
+#if (USE_RENDER_THREAD)
+// UI frame interval when running separate from the render thread (30 Hz)
+constexpr std::chrono::microseconds c_uiFrameInterval(1000000 / 30);
+#endif
+
 // Default preset
 constexpr int c_defaultPresetIndex = 1;
 
-// Post process GUI presets
+// Frame profile output filename
+const char* c_profileFilename = "frame_profile.json";
+
+// Timeline trace output filename
+const char* c_traceFilename = "frame_trace.json";
+
+// Latency histograms and timeline output filename
+const char* c_latencyFilename = "frame_latency.json";
+
+// Post process GUI presets. Color grading amount is zero so that presets show the camera image
+// ungraded, as before the shader applied grading. Tone settings are kept for when it is enabled.
 const std::vector<std::pair<std::string, AppState::PostProcess>> c_guiPresets = {
     {"Off",
         {
-            false, PostProcess::ShaderSource::None, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::Noise,  //
+            false, PostProcess::ShaderSource::None, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::BlueNoise,  //
             false, 0.0f, 0.0f, glm::vec4(0.0f), glm::vec4(0.0f), 0.0f, 0.0f,                                    // Color
             false, true, 0.0f, 0.0f,                                                                            // Noise
             false, 0.0f, 0, 0.5f,                                                                                    // Blur
@@ -89,40 +113,40 @@ const std::vector<std::pair<std::string, AppState::PostProcess>> c_guiPresets =
         }},
     {"Default",
         {
-            true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::Noise,                                  //
-            true, 1.0f, 0.0f, glm::vec4(210.0f, 220.0f, 130.0f, 255.0f) / 255.0f, glm::vec4(20.0f, 80.0f, 140.0f, 255.0f) / 255.0f, 1.0f, 2.0f,  // Color
+            true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::BlueNoise,                              //
+            true, 0.0f, 0.0f, glm::vec4(210.0f, 220.0f, 130.0f, 255.0f) / 255.0f, glm::vec4(20.0f, 80.0f, 140.0f, 255.0f) / 255.0f, 1.0f, 2.0f,  // Color
             true, true, 0.1f, 1.0f,                                                                                                              // Noise
             true, 5.0f, 7, 0.5f,                                                                                                                      // Blur
             true, 3.0f, 0.5f, 0.75f                                                                                                              // Animate
         }},
     {"Night Light",
         {
-            true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::Noise,                                  //
-            true, 1.0f, 1.0f, glm::vec4(28.0f, 97.0f, 225.0f, 255.0f) / 255.0f, glm::vec4(150.0f, 178.0f, 230.0f, 255.0f) / 255.0f, 0.4f, 4.0f,  // Color
+            true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::BlueNoise,                              //
+            true, 0.0f, 1.0f, glm::vec4(28.0f, 97.0f, 225.0f, 255.0f) / 255.0f, glm::vec4(150.0f, 178.0f, 230.0f, 255.0f) / 255.0f, 0.4f, 4.0f,  // Color
             false, true, 0.0f, 0.0f,                                                                                                             // Noise
             false, 0.0f, 0, 0.5f,                                                                                                                     // Blur
             true, 1.5f, 0.2f, 0.9f                                                                                                               // Animate
         }},
     {"IR Goggles",
         {
-            true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::Noise,  //
-            true, 1.0f, 0.0f, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), 1.2f, 1.0f,  // Color
+            true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::BlueNoise,  //
+            true, 0.0f, 0.0f, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), 1.2f, 1.0f,  // Color
             true, true, 0.1f, 1.0f,                                                                              // Noise
             true, 1.5f, 3, 0.5f,                                                                                      // Blur
             true, 6.0f, 0.15f, 1.0f                                                                              // Animate
         }},
     {"Purple Haze",
         {
-            true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::Noise,                                  //
-            true, 1.0f, 0.0f, glm::vec4(120.0f, 50.0f, 165.0f, 255.0f) / 255.0f, glm::vec4(190.0f, 50.0f, 225.0f, 255.0f) / 255.0f, 1.5f, 0.8f,  // Color
+            true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::BlueNoise,                              //
+            true, 0.0f, 0.0f, glm::vec4(120.0f, 50.0f, 165.0f, 255.0f) / 255.0f, glm::vec4(190.0f, 50.0f, 225.0f, 255.0f) / 255.0f, 1.5f, 0.8f,  // Color
             true, true, 0.1f, 0.06f,                                                                                                             // Noise
             true, 2.0f, 5, 0.5f,                                                                                                                      // Blur
             true, 4.0f, 0.4f, 1.0f                                                                                                               // Animate
         }},
     {"Sunshine",
         {
-            true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::Noise,                                    //
-            true, 1.0f, 0.0f, glm::vec4(224.0f, 220.0f, 155.0f, 255.0f) / 255.0f, glm::vec4(224.0f, 177.0f, 124.0f, 255.0f) / 255.0f, 2.0f, 1.0f,  // Color
+            true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::BlueNoise,                                //
+            true, 0.0f, 0.0f, glm::vec4(224.0f, 220.0f, 155.0f, 255.0f) / 255.0f, glm::vec4(224.0f, 177.0f, 124.0f, 255.0f) / 255.0f, 2.0f, 1.0f,  // Color
             true, true, 0.03f, 0.07f,                                                                                                              // Noise
             false, 0.0f, 0, 0.5f,                                                                                                                        // Blur
             true, 3.0f, 0.2f, 0.8f                                                                                                                 // Animate
@@ -151,7 +175,7 @@ const std::vector<std::pair<std::string, AppState::PostProcess>> c_testPresets =
     {"Binary Blob",
         {
             true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::Gradient,       //
-            true, 1.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
+            true, 0.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
             true, true, 1.0f, 2.0f,                                                                                      // Noise
             true, 5.0f, 6,                                                                                               // Blur
             false, 0.0f, 1.0f, 1.0f                                                                                      // Animate
@@ -159,7 +183,7 @@ const std::vector<std::pair<std::string, AppState::PostProcess>> c_testPresets =
     {"HLSL Source",
         {
             true, PostProcess::ShaderSource::Source, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::Gradient,       //
-            true, 1.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
+            true, 0.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
             true, true, 1.0f, 2.0f,                                                                                      // Noise
             true, 5.0f, 6,                                                                                               // Blur
             false, 0.0f, 1.0f, 1.0f                                                                                      // Animate
@@ -167,7 +191,7 @@ const std::vector<std::pair<std::string, AppState::PostProcess>> c_testPresets =
     {"D3D11-CPU",
         {
             true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::Gradient,       //
-            true, 1.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
+            true, 0.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
             true, false, 1.0f, 2.0f,                                                                                     // Noise
             true, 5.0f, 6,                                                                                               // Blur
             false, 0.0f, 1.0f, 1.0f                                                                                      // Animate
@@ -175,7 +199,7 @@ const std::vector<std::pair<std::string, AppState::PostProcess>> c_testPresets =
     {"D3D11-GPU",
         {
             true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D11, TestTexture::Type::Gradient,       //
-            true, 1.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
+            true, 0.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
             true, true, 1.0f, 2.0f,                                                                                      // Noise
             true, 5.0f, 6,                                                                                               // Blur
             false, 0.0f, 1.0f, 1.0f                                                                                      // Animate
@@ -183,7 +207,7 @@ const std::vector<std::pair<std::string, AppState::PostProcess>> c_testPresets =
     {"GL-CPU",
         {
             true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::OpenGL, TestTexture::Type::Gradient,      //
-            true, 1.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
+            true, 0.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
             true, false, 1.0f, 2.0f,                                                                                     // Noise
             true, 5.0f, 6,                                                                                               // Blur
             false, 0.0f, 1.0f, 1.0f                                                                                      // Animate
@@ -191,7 +215,7 @@ const std::vector<std::pair<std::string, AppState::PostProcess>> c_testPresets =
     {"GL-GPU",
         {
             true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::OpenGL, TestTexture::Type::Gradient,      //
-            true, 1.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
+            true, 0.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
             true, true, 1.0f, 2.0f,                                                                                      // Noise
             true, 5.0f, 6,                                                                                               // Blur
             false, 0.0f, 1.0f, 1.0f                                                                                      // Animate
@@ -199,7 +223,7 @@ const std::vector<std::pair<std::string, AppState::PostProcess>> c_testPresets =
     {"D3D12-CPU",
         {
             true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D12, TestTexture::Type::Gradient,       //
-            true, 1.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
+            true, 0.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
             true, false, 1.0f, 2.0f,                                                                                     // Noise
             true, 5.0f, 6,                                                                                               // Blur
             false, 0.0f, 1.0f, 1.0f                                                                                      // Animate
@@ -208,7 +232,7 @@ const std::vector<std::pair<std::string, AppState::PostProcess>> c_testPresets =
     //{"D3D12-GPU",
     //    {
     //        true, PostProcess::ShaderSource::Binary, PostProcess::GraphicsAPI::D3D12, TestTexture::Type::Gradient,       //
-    //        true, 1.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
+    //        true, 0.0f, 0.0f, glm::vec4(255, 192, 128, 255) / 255.0f, glm::vec4(32, 64, 128, 255) / 255.0f, 1.0f, 2.0f,  // Color
     //        true, true, 1.0f, 2.0f,                                                                                      // Noise
     //        true, 5.0f, 6,                                                                                               // Blur
     //        false, 0.0f, 1.0f, 1.0f                                                                                      // Animate
@@ -233,12 +257,16 @@ AppView::AppView(AppLogic& logic)
         std::bind(&AppView::onKeyPress, this, std::placeholders::_1, std::placeholders::_2),  //
         _T("Varjo Demo Application"), c_windowClientSize.x, c_windowClientSize.y, c_vsync);
 
-    // Set log function
-    LOG_INIT(std::bind(&UI::writeLogEntry, m_ui.get(), std::placeholders::_1, std::placeholders::_2), LogLevel::Info);
+    // Set log function. Lines are queued and written to UI log when drained on UI pass.
+    m_log = std::make_unique<AsyncLog>(std::bind(&UI::writeLogEntry, m_ui.get(), std::placeholders::_1, std::placeholders::_2));
+    LOG_INIT([this](LogLevel level, const std::string& line) { m_log->write(level, line); }, LogLevel::Info);
 
     // Create contexts
     m_context = std::make_unique<MultiGfxContext>(m_ui->getWindowHandle());
 
+    // Name main thread in timeline traces
+    TraceRecorder::instance().setThreadName("Main");
+
     // Additional ImgUi setup
     auto& io = ImGui::GetIO();
 
@@ -252,8 +280,10 @@ AppView::AppView(AppLogic& logic)
 
 AppView::~AppView()
 {
-    // Deinit logger
+    // Deinit logger and flush remaining lines
     LOG_DEINIT();
+    m_log->drain();
+    m_log.reset();
 
     // Free UI
     m_ui.reset();
@@ -266,6 +296,15 @@ bool AppView::init()
         return false;
     }
 
+    // Build pipelines of all presets ahead of time so that applying a preset does not stall
+    std::vector<AppState::PostProcess> presetConfigs;
+    for (const auto* presets : {&c_guiPresets, &c_testPresets}) {
+        for (const auto& preset : *presets) {
+            presetConfigs.push_back(preset.second);
+        }
+    }
+    m_logic.prebuildPipelines(presetConfigs);
+
     // Reset states
     m_uiState = {};
     AppState appState;
@@ -282,8 +321,24 @@ void AppView::run()
 {
     LOG_DEBUG("Entering main loop.");
 
+#if (USE_RENDER_THREAD)
+    // Hand GL context over to render thread and start it
+    m_logicState = m_logic.getState();
+    m_nextUiFrame = std::chrono::steady_clock::now();
+    m_context->makeCurrentGL(false);
+    m_renderQuit = false;
+    m_renderThread = std::thread(&AppView::renderMain, this);
+#endif
+
     // Run UI main loop
     m_ui->run();
+
+#if (USE_RENDER_THREAD)
+    // Stop render thread and take GL context back for cleanup
+    m_renderQuit = true;
+    m_renderThread.join();
+    m_context->makeCurrentGL(true);
+#endif
 }
 
 bool AppView::onFrame(UI& ui)
@@ -293,45 +348,116 @@ bool AppView::onFrame(UI& ui)
         return false;
     }
 
-#if DEBUG_FRAME_TIMING
-    static std::chrono::nanoseconds maxDuration{0};
-    static std::chrono::nanoseconds totDuration{0};
-    static int frameCount = 0;
-    const auto frameStartTime = std::chrono::high_resolution_clock::now();
-#endif
+#if (USE_RENDER_THREAD)
+    // Quit if render thread stopped
+    if (m_renderFailed) {
+        return false;
+    }
+
+    // Limit UI rate, render thread keeps running at headset rate
+    m_nextUiFrame += c_uiFrameInterval;
+    const auto now = std::chrono::steady_clock::now();
+    if (m_nextUiFrame > now) {
+        std::this_thread::sleep_until(m_nextUiFrame);
+    } else {
+        m_nextUiFrame = now;
+    }
+
+    // Take latest logic state once render thread has applied all states sent by UI. Until then
+    // keep showing our own changes instead of older logic state.
+    LogicSnapshot snapshot;
+    if (m_renderToUi.fetch(snapshot) && snapshot.uiVersion == m_uiVersion) {
+        m_logicState = snapshot.state;
+    }
+
+    // Update UI and send changes to logic
+    {
+        PROFILE_SCOPE(UpdateUI);
+        updateUI();
+    }
+#else
+    PROFILE_SCOPE(Frame);
 
     // Check for varjo events
     m_logic.checkEvents();
 
     // Update state to logic state
-    updateUI();
+    {
+        PROFILE_SCOPE(UpdateUI);
+        updateUI();
+    }
 
     // Update application logic
     m_logic.update();
-
-#if DEBUG_FRAME_TIMING
-    // Frame timing
-    const auto frameEndTime = std::chrono::high_resolution_clock::now();
-    const auto frameDuration = frameEndTime - frameStartTime;
-    totDuration += frameDuration;
-    maxDuration = std::max(frameDuration, maxDuration);
-    frameCount++;
-
-    // Report frame timing
-    static const std::chrono::seconds c_frameReportInterval(1);
-    if (totDuration >= c_frameReportInterval) {
-        LOG_INFO("Timing: frames=%d, fps=%f, avg=%f ms, max=%f ms, tot=%f ms", frameCount, 1e9f * frameCount / totDuration.count(),
-            0.000001 * totDuration.count() / frameCount, 0.000001 * maxDuration.count(), 0.000001 * totDuration.count());
-        maxDuration = {0};
-        totDuration = {0};
-        frameCount = 0;
-    }
 #endif
 
     // Return true to continue running
     return true;
 }
 
+#if (USE_RENDER_THREAD)
+void AppView::renderMain()
+{
+    TraceRecorder::instance().setThreadName("Render");
+
+    // GL post processing runs on this thread
+    m_context->makeCurrentGL(true);
+
+    try {
+        AppState uiState;
+        while (!m_renderQuit) {
+            PROFILE_SCOPE(Frame);
+
+            // Apply new UI state only when UI has sent one
+            if (m_uiToRender.fetch(uiState)) {
+                // UI state can be frames behind, so keep values owned by logic
+                const auto& state = m_logic.getState();
+                uiState.general.frameTime = state.general.frameTime;
+                uiState.general.frameCount = state.general.frameCount;
+                uiState.general.mrAvailable = state.general.mrAvailable;
+                uiState.postProcess.animTime = state.postProcess.animTime;
+                m_logic.setState(uiState, false);
+            }
+
+            // Update application logic. Waits for headset frame sync.
+            m_logic.update();
+
+            // Publish logic state for UI
+            m_renderToUi.publish({m_logic.getState(), m_uiToRender.getVersion()});
+        }
+    } catch (const std::runtime_error& e) {
+        LOG_ERROR("Critical error caught on render thread: %s", e.what());
+        m_renderFailed = true;
+    }
+
+    m_context->makeCurrentGL(false);
+}
+#endif
+
+const AppState& AppView::getLogicState() const
+{
+#if (USE_RENDER_THREAD)
+    return m_logicState;
+#else
+    return m_logic.getState();
+#endif
+}
+
+void AppView::submitState(const AppState& state)
+{
+#if (USE_RENDER_THREAD)
+    // Only send actual changes so that UI state built from an older snapshot can't revert
+    // changes made by logic in the meantime
+    if (state != m_logicState) {
+        m_uiToRender.publish(state);
+        m_uiVersion++;
+        m_logicState = state;
+    }
+#else
+    m_logic.setState(state, false);
+#endif
+}
+
 void AppView::onKeyPress(UI& ui, int keyCode)
 {
     if (m_uiState.anyItemActive) {
@@ -340,7 +466,7 @@ void AppView::onKeyPress(UI& ui, int keyCode)
     }
 
     bool stateDirty = false;
-    auto appState = m_logic.getState();
+    auto appState = getLogicState();
 
     // Check for input action
     Action action = Action::None;
@@ -370,6 +496,17 @@ void AppView::onKeyPress(UI& ui, int keyCode)
             m_uiState.testPresets = !m_uiState.testPresets;
             LOG_INFO("Test presets: %s", (m_uiState.testPresets ? "ON" : "OFF"));
         } break;
+        case Action::ToggleProfiler: {
+            auto& profiler = FrameProfiler::instance();
+            profiler.setEnabled(!profiler.isEnabled());
+            LOG_INFO("Frame profiler: %s", (profiler.isEnabled() ? "ON" : "OFF"));
+        } break;
+        case Action::SaveProfile: {
+            saveProfile();
+        } break;
+        case Action::SaveTrace: {
+            saveTrace();
+        } break;
         case Action::ApplyPreset_0:
         case Action::ApplyPreset_1:
         case Action::ApplyPreset_2:
@@ -401,7 +538,7 @@ void AppView::onKeyPress(UI& ui, int keyCode)
 
     // Update state if changed
     if (stateDirty) {
-        m_logic.setState(appState, false);
+        submitState(appState);
     }
 }
 
@@ -423,7 +560,7 @@ void AppView::updateUI()
     }
 
     // Update from logic state
-    AppState appState = m_logic.getState();
+    AppState appState = getLogicState();
 
     // Update UI state from logic state
     m_uiState.postProcessShaderSourceIndex = static_cast<int>(appState.postProcess.shaderSource);
@@ -450,12 +587,24 @@ void AppView::updateUI()
 #if (!USE_HEADLESS_MODE)
         //ImGui::SameLine();
         //ImGui::Checkbox("Render VR scene", &appState.general.vrEnabled);
-	appState.general.vrEnabled = false;
 #endif
 
         ImGui::SameLine();
         ImGui::Checkbox("Post process video", &appState.postProcess.enabled);
 
+#if (!USE_HEADLESS_MODE)
+        // VR scene is only rendered as a stress test
+        {
+            const std::array<int, 5> counts = {0, 1000, 10000, 100000, TestScene::c_maxStressObjectCount};
+            std::array<char*, 5> items = {"Off", "1k objects", "10k objects", "100k objects", "1M objects"};
+            int index = static_cast<int>(std::find(counts.begin(), counts.end(), appState.general.stressObjectCount) - counts.begin());
+            index = std::min(index, static_cast<int>(counts.size()) - 1);
+            ImGui::Combo("VR stress scene", &index, items.data(), static_cast<int>(items.size()));
+            appState.general.stressObjectCount = counts[index];
+            appState.general.vrEnabled = (appState.general.stressObjectCount > 0);
+        }
+#endif
+
         {
             std::array<char*, 3> items = {"None", "Binary Blob", "HLSL Source"};
             //ImGui::Combo("Shader source", &m_uiState.postProcessShaderSourceIndex, items.data(), static_cast<int>(items.size()));
@@ -469,7 +618,7 @@ void AppView::updateUI()
         }
 
         {
-            std::array<char*, 2> items = {"Noise", "Gradient"};
+            std::array<char*, 3> items = {"Noise", "Gradient", "Blue noise"};
 //             ImGui::Combo("Texture type", &m_uiState.textureTypeIndex, items.data(), static_cast<int>(items.size()));
             appState.postProcess.textureType = static_cast<TestTexture::Type>(1 + m_uiState.textureTypeIndex);
         }
@@ -526,7 +675,8 @@ void AppView::updateUI()
 	    FILTER_LOW_PASS,
 	    FILTER_INVERT,
 	    FILTER_KALEIDOSCOPE,
-	    FILTER_HIGH_PASS_SPECIAL
+	    FILTER_HIGH_PASS_SPECIAL,
+	    FILTER_BILATERAL_GRID
 	};
 
 	// Radio buttons for selecting the filter mode
@@ -536,6 +686,7 @@ void AppView::updateUI()
 	ImGui::RadioButton("Invert Colors", &appState.postProcess.filterType, FILTER_INVERT);
 	ImGui::RadioButton("Kaleidoscope", &appState.postProcess.filterType, FILTER_KALEIDOSCOPE);
 	ImGui::RadioButton("SPECIAL High Pass Filter", &appState.postProcess.filterType, FILTER_HIGH_PASS_SPECIAL);
+	ImGui::RadioButton("Edge Enhancement (Bilateral Grid)", &appState.postProcess.filterType, FILTER_BILATERAL_GRID);
 
 	// Depending on the selected filter mode, show appropriate sliders
 	if (appState.postProcess.filterType == FILTER_HIGH_PASS) {
@@ -554,6 +705,23 @@ void AppView::updateUI()
 	    // Add any other relevant sliders or settings for Low Pass Filter
 	}
 
+	// Bilateral grid enhances edges without amplifying noise. Larger cells and fewer bins are faster.
+	if (appState.postProcess.filterType == FILTER_BILATERAL_GRID) {
+	    ImGui::SliderFloat("Edge Enhancement Gain" _TAG, &appState.postProcess.enhanceGain, 0.0f, 4.0f);
+	    ImGui::SliderInt("Grid Cell Size" _TAG, &appState.postProcess.gridCellSize, 4, 64);
+	    ImGui::SliderInt("Grid Luminance Bins" _TAG, &appState.postProcess.gridRangeBins, 2, 32);
+	}
+
+	// Low pass kernel shape for the pass filters. Gaussian and windowed sinc come from the kernel bank.
+	if (appState.postProcess.filterType == FILTER_HIGH_PASS || appState.postProcess.filterType == FILTER_LOW_PASS ||
+	    appState.postProcess.filterType == FILTER_HIGH_PASS_SPECIAL) {
+	    ImGui::RadioButton("Box Kernel" _TAG, &appState.postProcess.kernelShape, FilterCPU::KernelBox);
+	    ImGui::SameLine();
+	    ImGui::RadioButton("Gaussian Kernel" _TAG, &appState.postProcess.kernelShape, FilterCPU::KernelGaussian);
+	    ImGui::SameLine();
+	    ImGui::RadioButton("Windowed Sinc Kernel" _TAG, &appState.postProcess.kernelShape, FilterCPU::KernelSinc);
+	}
+
 	ImGui::Dummy(ImVec2(0.0f, h));
 
 // Define section tag for unique names
@@ -595,6 +763,67 @@ void AppView::updateUI()
             ImGui::GetIO().Framerate,                                         //
             1000.0f / ImGui::GetIO().Framerate,                               //
             appState.general.frameTime, appState.general.frameCount);
+
+        // Adaptive quality
+        {
+            const auto quality = m_logic.getQualityMetrics();
+            ImGui::Checkbox("Adaptive quality##quality", &appState.general.adaptiveQuality);
+            ImGui::SameLine();
+            ImGui::Text("Level %d/%d, smoothed %.2f ms, %llu/%llu frames over budget, %llu steps down, %llu up", quality.level,
+                quality.levelCount - 1, quality.smoothedMs, static_cast<unsigned long long>(quality.overBudget),
+                static_cast<unsigned long long>(quality.frames), static_cast<unsigned long long>(quality.stepsDown),
+                static_cast<unsigned long long>(quality.stepsUp));
+        }
+
+#define _TAG "##profiler"
+
+        // Frame profiler
+        {
+            auto& profiler = FrameProfiler::instance();
+            bool profilerEnabled = profiler.isEnabled();
+            ImGui::Checkbox("Frame profiler" _TAG, &profilerEnabled);
+            profiler.setEnabled(profilerEnabled);
+            ImGui::SameLine();
+            if (ImGui::Button("Reset" _TAG)) {
+                profiler.reset();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Save JSON" _TAG)) {
+                saveProfile();
+            }
+
+            auto& tracer = TraceRecorder::instance();
+            bool traceEnabled = tracer.isEnabled();
+            ImGui::Checkbox("Timeline trace" _TAG, &traceEnabled);
+            tracer.setEnabled(traceEnabled);
+            ImGui::SameLine();
+            if (ImGui::Button("Save trace" _TAG)) {
+                saveTrace();
+            }
+
+            if (profilerEnabled) {
+                ImGui::Text("%-22s %8s %8s %8s %8s %8s %6s", "Stage", "Count", "p50 ms", "p95 ms", "p99 ms", "max ms", ">11ms");
+                for (int i = 0; i < static_cast<int>(FrameProfiler::Stage::Count); i++) {
+                    const auto stage = static_cast<FrameProfiler::Stage>(i);
+                    const auto stats = profiler.getStats(stage);
+                    ImGui::Text("%-22s %8llu %8.3f %8.3f %8.3f %8.3f %6llu", FrameProfiler::getStageName(stage), static_cast<unsigned long long>(stats.count),
+                        stats.p50, stats.p95, stats.p99, stats.max, static_cast<unsigned long long>(stats.overBudget));
+                }
+
+                // Camera image age at frame events
+                const auto& latency = m_logic.getLatencyTracker();
+                ImGui::Text("%-22s %8s %8s %8s %8s %8s  >%.0fms", "Latency", "Count", "p50 ms", "p95 ms", "p99 ms", "max ms", 1e-6 * latency.getBudgetNs());
+                for (int i = 0; i < static_cast<int>(LatencyTracker::Event::Count); i++) {
+                    const auto event = static_cast<LatencyTracker::Event>(i);
+                    const auto stats = latency.getStats(event);
+                    ImGui::Text("%-22s %8llu %8.3f %8.3f %8.3f %8.3f %6llu", LatencyTracker::getEventName(event), static_cast<unsigned long long>(stats.count),
+                        stats.p50, stats.p95, stats.p99, stats.max, static_cast<unsigned long long>(stats.overBudget));
+                }
+            }
+        }
+
+#undef _TAG
+
         ImGui::End();
     }
 
@@ -612,6 +841,7 @@ void AppView::updateUI()
             ImGui::SetWindowSize(ImVec2(w - 2 * m, h1 - m), ImGuiCond_FirstUseEver);
         }
 
+        m_log->drain();
         m_ui->drawLog();
         ImGui::End();
     }
@@ -620,5 +850,40 @@ void AppView::updateUI()
     m_uiState.anyItemActive = ImGui::IsAnyItemActive();
 
     // Update state from UI back to logic
-    m_logic.setState(appState, false);
+    submitState(appState);
+}
+
+void AppView::saveProfile()
+{
+    std::ostringstream json;
+    FrameProfiler::instance().writeJson(json);
+
+    std::ofstream file(c_profileFilename);
+    file << json.str() << std::endl;
+    if (file) {
+        LOG_INFO("Frame profile saved: %s", c_profileFilename);
+    } else {
+        LOG_ERROR("Saving frame profile failed: %s", c_profileFilename);
+    }
+
+    std::ofstream latencyFile(c_latencyFilename);
+    m_logic.getLatencyTracker().writeJson(latencyFile);
+    latencyFile << std::endl;
+    if (latencyFile) {
+        LOG_INFO("Frame latency saved: %s", c_latencyFilename);
+    } else {
+        LOG_ERROR("Saving frame latency failed: %s", c_latencyFilename);
+    }
+}
+
+void AppView::saveTrace()
+{
+    std::ofstream file(c_traceFilename);
+    TraceRecorder::instance().writeChromeTrace(file);
+    file << std::endl;
+    if (file) {
+        LOG_INFO("Timeline trace saved: %s", c_traceFilename);
+    } else {
+        LOG_ERROR("Saving timeline trace failed: %s", c_traceFilename);
+    }
 }
@@ -2,7 +2,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <thread>
 #include <glm/glm.hpp>
 #include <imgui.h>
 #include <GL/glew.h>
@@ -12,6 +15,8 @@
 
 #include "MultiGfxContext.hpp"
 #include "AppLogic.hpp"
+#include "AsyncLog.hpp"
+#include "StateChannel.hpp"
 
 //! Application view class
 class AppView
@@ -55,9 +60,44 @@ private:
     //! Updates UI based on logic state and writes changes back to it.
     void updateUI();
 
+    //! Returns logic state as seen by UI
+    const AppState& getLogicState() const;
+
+    //! Send state changed by UI to logic
+    void submitState(const AppState& state);
+
+#if (USE_RENDER_THREAD)
+    //! Render thread main loop running application logic at headset frame rate
+    void renderMain();
+#endif
+
+    //! Save frame profiler statistics as JSON
+    void saveProfile();
+
+    //! Save timeline trace as Chrome trace JSON
+    void saveTrace();
+
 private:
     AppLogic& m_logic;                           //!< App logic instance
     std::unique_ptr<VarjoExamples::UI> m_ui;     //!< User interface wrapper
+    std::unique_ptr<AsyncLog> m_log;             //!< Asynchronous logger feeding UI log
     std::unique_ptr<MultiGfxContext> m_context;  //!< Graphics contexts
     UIState m_uiState{};                         //!< UI specific states
+
+#if (USE_RENDER_THREAD)
+    //! Logic state snapshot published by render thread
+    struct LogicSnapshot {
+        AppState state;          //!< Logic state
+        uint64_t uiVersion = 0;  //!< Version of the latest UI state applied to logic
+    };
+
+    std::thread m_renderThread;                             //!< Render thread running application logic
+    std::atomic<bool> m_renderQuit{false};                  //!< Render thread quit request
+    std::atomic<bool> m_renderFailed{false};                //!< Set if render thread stopped on error
+    StateChannel<AppState> m_uiToRender;                    //!< States changed by UI
+    StateChannel<LogicSnapshot> m_renderToUi;               //!< Logic state snapshots
+    AppState m_logicState;                                  //!< Latest logic state on UI thread
+    uint64_t m_uiVersion = 0;                               //!< Number of states sent by UI
+    std::chrono::steady_clock::time_point m_nextUiFrame{};  //!< UI frame deadline
+#endif
 };
@@ -0,0 +1,48 @@
+#include "AsyncLog.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+AsyncLog::AsyncLog(const Sink& sink)
+    : m_sink(sink)
+    , m_queue(c_capacity)
+{
+    m_line.reserve(c_maxLineLength);
+}
+
+bool AsyncLog::write(LogLevel level, const std::string& line)
+{
+    const bool queued = m_queue.tryPushWith([&](Entry& entry) {
+        entry.level = level;
+        entry.length = static_cast<uint32_t>(std::min(line.size(), c_maxLineLength));
+        std::memcpy(entry.text, line.data(), entry.length);
+    });
+
+    if (!queued) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    return queued;
+}
+
+void AsyncLog::drain()
+{
+    // Only drain lines queued so far so that lines logged by the sink itself can't keep us here
+    for (size_t n = m_queue.size(); n > 0; n--) {
+        LogLevel level;
+        const bool popped = m_queue.tryPopWith([&](Entry& entry) {
+            level = entry.level;
+            m_line.assign(entry.text, entry.length);
+        });
+        if (!popped) {
+            break;
+        }
+        m_sink(level, m_line);
+    }
+
+    // Report dropped lines after the lines that made it through
+    const uint64_t dropped = getDroppedCount();
+    if (dropped != m_reportedDropped) {
+        m_sink(LogLevel::Warning, "Log overflow: " + std::to_string(dropped - m_reportedDropped) + " lines dropped.");
+        m_reportedDropped = dropped;
+    }
+}
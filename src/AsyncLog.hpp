@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "Globals.hpp"
+#include "LockFreeQueue.hpp"
+
+//! Asynchronous logger. Log calls copy the formatted line into a lock-free ring and return
+//! immediately, and the lines are passed to the sink when the owner drains the ring.
+//!
+//! Queueing a line never blocks or allocates: write copies into a preallocated ring slot. The
+//! LOG_* macros still format the line into a std::string before calling write, so a log call may
+//! allocate, but it no longer waits for the sink. If the ring is full the line is dropped and
+//! counted, and the drop count is reported through the sink on the next drain.
+class AsyncLog
+{
+public:
+    //! Log line sink
+    using Sink = std::function<void(LogLevel, const std::string&)>;
+
+    //! Ring capacity in lines
+    static constexpr size_t c_capacity = 1024;
+
+    //! Maximum line length in characters. Longer lines are truncated.
+    static constexpr size_t c_maxLineLength = 512;
+
+    //! Constructor
+    explicit AsyncLog(const Sink& sink);
+
+    // Disable copy and assign
+    AsyncLog(const AsyncLog& other) = delete;
+    AsyncLog& operator=(const AsyncLog& other) = delete;
+
+    //! Queue log line. Safe to call from any thread. Returns false if line was dropped.
+    bool write(LogLevel level, const std::string& line);
+
+    //! Pass queued lines to the sink. Call from the thread owning the sink.
+    void drain();
+
+    //! Returns total number of dropped lines
+    uint64_t getDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    //! Queued log line
+    struct Entry {
+        LogLevel level;              //!< Log level
+        uint32_t length;             //!< Text length
+        char text[c_maxLineLength];  //!< Text, not null terminated
+    };
+
+    Sink m_sink;                         //!< Log line sink
+    LockFreeQueue<Entry> m_queue;        //!< Queued lines
+    std::atomic<uint64_t> m_dropped{0};  //!< Dropped line count
+    uint64_t m_reportedDropped = 0;      //!< Dropped line count already reported
+    std::string m_line;                  //!< Drain line buffer
+};
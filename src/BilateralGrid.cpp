@@ -0,0 +1,249 @@
+#include "BilateralGrid.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "FrameArena.hpp"
+#include "ThreadPool.hpp"
+#include "TraceRecorder.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <emmintrin.h>
+#define BILATERAL_GRID_SSE2 1
+#else
+#define BILATERAL_GRID_SSE2 0
+#endif
+
+namespace
+{
+// BT.601 luma weights. Same as in the shader.
+constexpr float c_lumaR = 0.299f;
+constexpr float c_lumaG = 0.587f;
+constexpr float c_lumaB = 0.114f;
+
+// Blur weights of cell offsets -2..2. Cells are homogeneous, so the weights need no normalization.
+constexpr int c_blurRadius = 2;
+constexpr float c_blurWeights[2 * c_blurRadius + 1] = {1.0f, 4.0f, 6.0f, 4.0f, 1.0f};
+
+// Smallest pixel count slicing divides by
+constexpr float c_minCount = 1e-6f;
+
+// Returns luminance of color clamped to [0, 1]
+inline float getLuminance(const float* rgb) { return std::min(std::max(c_lumaR * rgb[0] + c_lumaG * rgb[1] + c_lumaB * rgb[2], 0.0f), 1.0f); }
+
+// Cell arithmetic, one cell of color sums and pixel count per vector
+#if BILATERAL_GRID_SSE2
+using Vec4 = __m128;
+
+inline Vec4 load4(const float* p) { return _mm_loadu_ps(p); }
+inline void store4(float* p, Vec4 v) { _mm_storeu_ps(p, v); }
+inline Vec4 zero4() { return _mm_setzero_ps(); }
+inline Vec4 add4(Vec4 a, Vec4 b) { return _mm_add_ps(a, b); }
+inline Vec4 sub4(Vec4 a, Vec4 b) { return _mm_sub_ps(a, b); }
+inline Vec4 mul4(Vec4 a, float s) { return _mm_mul_ps(a, _mm_set1_ps(s)); }
+inline Vec4 mulAdd4(Vec4 a, Vec4 b, float s) { return _mm_add_ps(a, _mm_mul_ps(b, _mm_set1_ps(s))); }
+
+// Returns cell of one pixel: color and count of one in place of alpha
+inline Vec4 makePixelCell(const float* rgba)
+{
+    const Vec4 colorMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    return _mm_or_ps(_mm_and_ps(_mm_loadu_ps(rgba), colorMask), _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f));
+}
+
+// Returns color of cell divided by its count
+inline Vec4 normalize4(Vec4 cell)
+{
+    const Vec4 count = _mm_max_ps(_mm_shuffle_ps(cell, cell, _MM_SHUFFLE(3, 3, 3, 3)), _mm_set1_ps(c_minCount));
+    return _mm_div_ps(cell, count);
+}
+#else
+struct Vec4 {
+    float v[4];
+};
+
+inline Vec4 load4(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void store4(float* p, Vec4 a) { p[0] = a.v[0], p[1] = a.v[1], p[2] = a.v[2], p[3] = a.v[3]; }
+inline Vec4 zero4() { return {{0.0f, 0.0f, 0.0f, 0.0f}}; }
+inline Vec4 add4(Vec4 a, Vec4 b) { return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}}; }
+inline Vec4 sub4(Vec4 a, Vec4 b) { return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}}; }
+inline Vec4 mul4(Vec4 a, float s) { return {{a.v[0] * s, a.v[1] * s, a.v[2] * s, a.v[3] * s}}; }
+inline Vec4 mulAdd4(Vec4 a, Vec4 b, float s) { return {{a.v[0] + b.v[0] * s, a.v[1] + b.v[1] * s, a.v[2] + b.v[2] * s, a.v[3] + b.v[3] * s}}; }
+
+inline Vec4 makePixelCell(const float* rgba) { return {{rgba[0], rgba[1], rgba[2], 1.0f}}; }
+
+inline Vec4 normalize4(Vec4 cell) { return mul4(cell, 1.0f / std::max(cell.v[3], c_minCount)); }
+#endif
+
+// Returns linear interpolation of cells
+inline Vec4 lerp4(Vec4 a, Vec4 b, float t) { return mulAdd4(a, sub4(b, a), t); }
+
+}  // namespace
+
+BilateralGrid::Params BilateralGrid::getParams(const FilterCPU::Params& params)
+{
+    Params grid;
+    grid.cellSize = params.gridCellSize;
+    grid.rangeBins = params.gridRangeBins;
+    grid.gain = params.enhanceGain;
+    grid.bandHeight = params.bandHeight;
+    return grid;
+}
+
+void BilateralGrid::process(const ImageRGBA& src, ImageRGBA& dst, const Params& params)
+{
+    TRACE_SCOPE("BilateralGrid::process");
+
+    if (dst.width != src.width || dst.height != src.height) {
+        dst.resize(src.width, src.height);
+    }
+    if (src.width <= 0 || src.height <= 0) {
+        return;
+    }
+
+    // Splat indices reach (size - 1 + half cell) / cell size, slicing reads one cell further.
+    // Luminance is splatted to bins + 1 cells.
+    Params p = params;
+    p.cellSize = std::max(p.cellSize, 1);
+    p.rangeBins = std::max(p.rangeBins, 1);
+    p.bandHeight = std::max(p.bandHeight, 1);
+    m_sizeX = (src.width - 1 + p.cellSize / 2) / p.cellSize + 2;
+    m_sizeY = (src.height - 1 + p.cellSize / 2) / p.cellSize + 2;
+    m_sizeZ = p.rangeBins + 2;
+    const size_t cellFloats = static_cast<size_t>(m_sizeX) * m_sizeY * m_sizeZ * 4;
+    m_cells.resize(cellFloats);
+    m_blurred.resize(cellFloats);
+    m_lowPass.resize(static_cast<size_t>(m_sizeX) * m_sizeY * 4);
+
+    // Spatial low pass is taken before the luminance blur, which only moves counts between bins
+    splat(src, p);
+    blur(m_cells, m_blurred, 0);
+    blur(m_blurred, m_cells, 1);
+    sumLuminance();
+    blur(m_cells, m_blurred, 2);
+
+    const int bandCount = (src.height + p.bandHeight - 1) / p.bandHeight;
+    ThreadPool::instance().parallelFor(bandCount, [&](int band) {
+        TRACE_SCOPE("BilateralGrid::slice");
+        const int y0 = band * p.bandHeight;
+        sliceRows(src, dst, p, y0, std::min(y0 + p.bandHeight, src.height));
+    });
+}
+
+void BilateralGrid::splat(const ImageRGBA& src, const Params& params)
+{
+    TRACE_SCOPE("BilateralGrid::splat");
+
+    // Each work item owns one row of cells and the source rows nearest to it, so no two items
+    // accumulate into the same cell
+    const int cell = params.cellSize;
+    const int half = cell / 2;
+    const float bins = static_cast<float>(params.rangeBins);
+    ThreadPool::instance().parallelFor(m_sizeY, [&](int gridY) {
+        float* slab = m_cells.data() + getCellIndex(0, gridY, 0);
+        std::fill(slab, slab + static_cast<size_t>(m_sizeZ) * m_sizeX * 4, 0.0f);
+
+        const int y0 = std::max(gridY * cell - half, 0);
+        const int y1 = std::min(gridY * cell - half + cell, src.height);
+        for (int y = y0; y < y1; y++) {
+            const float* row = src.row(y);
+            for (int gridX = 0, x = 0; x < src.width; gridX++) {
+                const int x1 = std::min(gridX * cell - half + cell, src.width);
+                for (; x < x1; x++) {
+                    const float* pixel = row + x * 4;
+                    const int gridZ = static_cast<int>(getLuminance(pixel) * bins + 0.5f);
+                    float* target = slab + (static_cast<size_t>(gridZ) * m_sizeX + gridX) * 4;
+                    store4(target, add4(load4(target), makePixelCell(pixel)));
+                }
+            }
+        }
+    });
+}
+
+void BilateralGrid::blur(const std::vector<float>& src, std::vector<float>& dst, int axis) const
+{
+    TRACE_SCOPE("BilateralGrid::blur");
+
+    // Cells outside the grid are empty, so taps past the ends are skipped
+    const int size = axis == 0 ? m_sizeX : (axis == 1 ? m_sizeY : m_sizeZ);
+    const ptrdiff_t stride = axis == 0 ? 4 : static_cast<ptrdiff_t>(axis == 1 ? m_sizeZ * m_sizeX : m_sizeX) * 4;
+    ThreadPool::instance().parallelFor(m_sizeY, [&](int y) {
+        for (int z = 0; z < m_sizeZ; z++) {
+            for (int x = 0; x < m_sizeX; x++) {
+                const int i = axis == 0 ? x : (axis == 1 ? y : z);
+                const int k0 = std::max(-c_blurRadius, -i);
+                const int k1 = std::min(c_blurRadius, size - 1 - i);
+                const size_t index = getCellIndex(x, y, z);
+                Vec4 sum = zero4();
+                for (int k = k0; k <= k1; k++) {
+                    sum = mulAdd4(sum, load4(src.data() + index + k * stride), c_blurWeights[k + c_blurRadius]);
+                }
+                store4(dst.data() + index, sum);
+            }
+        }
+    });
+}
+
+void BilateralGrid::sumLuminance()
+{
+    ThreadPool::instance().parallelFor(m_sizeY, [&](int y) {
+        for (int x = 0; x < m_sizeX; x++) {
+            Vec4 sum = zero4();
+            for (int z = 0; z < m_sizeZ; z++) {
+                sum = add4(sum, load4(m_cells.data() + getCellIndex(x, y, z)));
+            }
+            store4(m_lowPass.data() + (static_cast<size_t>(y) * m_sizeX + x) * 4, sum);
+        }
+    });
+}
+
+void BilateralGrid::sliceRows(const ImageRGBA& src, ImageRGBA& dst, const Params& params, int y0, int y1) const
+{
+    const float scale = 1.0f / params.cellSize;
+    const float bins = static_cast<float>(params.rangeBins);
+    const size_t slabFloats = static_cast<size_t>(m_sizeZ) * m_sizeX * 4;
+    const size_t planeFloats = static_cast<size_t>(m_sizeX) * 4;
+
+    // Cells interpolated along y for the current row, so that each pixel interpolates along x and luminance only
+    FrameArena::Scope scope(FrameArena::forThread());
+    ArenaVector<float> slab(slabFloats);
+    ArenaVector<float> plane(planeFloats);
+
+    for (int y = y0; y < y1; y++) {
+        const float fy = y * scale;
+        const int gridY = static_cast<int>(fy);
+        const float ty = fy - gridY;
+        const float* cells = m_blurred.data() + getCellIndex(0, gridY, 0);
+        for (size_t i = 0; i < slabFloats; i += 4) {
+            store4(slab.data() + i, lerp4(load4(cells + i), load4(cells + slabFloats + i), ty));
+        }
+        const float* lowPass = m_lowPass.data() + static_cast<size_t>(gridY) * planeFloats;
+        for (size_t i = 0; i < planeFloats; i += 4) {
+            store4(plane.data() + i, lerp4(load4(lowPass + i), load4(lowPass + planeFloats + i), ty));
+        }
+
+        const float* srcRow = src.row(y);
+        float* dstRow = dst.row(y);
+        for (int x = 0; x < src.width; x++) {
+            const float* orig = srcRow + x * 4;
+            const float fx = x * scale;
+            const int gridX = static_cast<int>(fx);
+            const float tx = fx - gridX;
+            const float fz = getLuminance(orig) * bins;
+            const int gridZ = static_cast<int>(fz);
+            const float tz = fz - gridZ;
+
+            // Edge preserving base at pixel luminance and spatial low pass
+            const float* c = slab.data() + (static_cast<size_t>(gridZ) * m_sizeX + gridX) * 4;
+            const Vec4 c0 = lerp4(load4(c), load4(c + 4), tx);
+            const Vec4 c1 = lerp4(load4(c + planeFloats), load4(c + planeFloats + 4), tx);
+            const Vec4 base = normalize4(lerp4(c0, c1, tz));
+            const float* l = plane.data() + static_cast<size_t>(gridX) * 4;
+            const Vec4 spatial = normalize4(lerp4(load4(l), load4(l + 4), tx));
+
+            // Edge contrast added to the original. Alpha is preserved from the original.
+            float* out = dstRow + x * 4;
+            store4(out, mulAdd4(load4(orig), sub4(base, spatial), params.gain));
+            out[3] = orig[3];
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+
+#include "FilterCPU.hpp"
+
+//! Edge preserving detail enhancement on a bilateral grid.
+//!
+//! Pixels are splatted to the nearest cell of a coarse 3D grid over image position and luminance,
+//! the grid is blurred with a separable 1-4-6-4-1 kernel along all three axes, and each pixel slices
+//! the grid with trilinear interpolation at its own position and luminance. Cells store color sums and
+//! pixel count as homogeneous coordinates, so slicing divides by the count. The sliced base image is
+//! smoothed within regions of similar luminance but keeps edges between them.
+//!
+//! The same grid summed over luminance before the luminance blur is a plain spatial low pass. The
+//! difference of the two is the edge contrast lost by low pass filtering, which is added to the
+//! original scaled by gain. Unlike the high pass filters, noise within a region is smoothed away from
+//! both and is not amplified.
+//!
+//! Cost of blur and slice is independent of the spatial extent. Cell size and luminance bins set the
+//! grid resolution: larger cells and fewer bins are faster and smooth more.
+class BilateralGrid
+{
+public:
+    //! Grid parameters
+    struct Params {
+        int cellSize = 16;    //!< Cell size in pixels along both image axes, spatial extent of smoothing
+        int rangeBins = 8;    //!< Luminance bins over [0, 1], edges below 1 / bins contrast are smoothed
+        float gain = 1.0f;    //!< Edge enhancement gain: 0=original
+        int bandHeight = 16;  //!< Rows per parallel work item when slicing
+    };
+
+    //! Returns grid parameters from filter parameters
+    static Params getParams(const FilterCPU::Params& params);
+
+    //! Enhance source image to destination image. Destination is resized to match the source, alpha
+    //! is preserved. Grid storage is kept between calls.
+    void process(const ImageRGBA& src, ImageRGBA& dst, const Params& params);
+
+    //! Returns grid cells along image x, image y and luminance of the last call
+    int getSizeX() const { return m_sizeX; }
+    int getSizeY() const { return m_sizeY; }
+    int getSizeZ() const { return m_sizeZ; }
+
+private:
+    //! Accumulate pixels of source rows nearest to each cell row into the grid
+    void splat(const ImageRGBA& src, const Params& params);
+
+    //! Blur grid along given axis from source cells to destination cells: 0=x, 1=y, 2=luminance
+    void blur(const std::vector<float>& src, std::vector<float>& dst, int axis) const;
+
+    //! Sum grid over luminance to the spatial low pass plane
+    void sumLuminance();
+
+    //! Slice base and low pass at source pixels of given rows and write enhanced rows
+    void sliceRows(const ImageRGBA& src, ImageRGBA& dst, const Params& params, int y0, int y1) const;
+
+    //! Returns index of first float of cell at grid position. Cells are rows of x along luminance
+    //! along y, four floats each: color sums and pixel count.
+    size_t getCellIndex(int x, int y, int z) const { return ((static_cast<size_t>(y) * m_sizeZ + z) * m_sizeX + x) * 4; }
+
+    int m_sizeX = 0;               //!< Cells along image x
+    int m_sizeY = 0;               //!< Cells along image y
+    int m_sizeZ = 0;               //!< Cells along luminance
+    std::vector<float> m_cells;    //!< Splatted cells, blurred along image axes after the second blur pass
+    std::vector<float> m_blurred;  //!< Cells blurred along x, fully blurred after the last blur pass
+    std::vector<float> m_lowPass;  //!< Spatial low pass plane: cells summed over luminance, four floats per cell
+};
@@ -0,0 +1,370 @@
+#include "BlueNoise.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "Hash.hpp"
+#include "ShaderCache.hpp"
+#include "ThreadPool.hpp"
+#include "TraceRecorder.hpp"
+
+namespace
+{
+// Generator identity for cache keys. Bump when generated tiles change.
+const std::string c_generatorIdentity = "BlueNoise void-and-cluster 1";
+
+// Atlas file header magic and version. Bump version when the file layout changes.
+constexpr uint32_t c_fileMagic = 0x4e424e56;  // "VNBN"
+constexpr uint32_t c_fileVersion = 1;
+
+// Atlas file header, followed by the ranks of all tiles
+struct FileHeader {
+    uint32_t magic;     // File magic
+    uint32_t version;   // File layout version
+    uint64_t key;       // Hash of generator identity and parameters
+    uint64_t checksum;  // Hash of rank data
+    uint64_t size;      // Rank data size in bytes
+};
+
+// Read ranks of expected size from atlas file. Returns false if missing, truncated, corrupted or written for another key.
+bool loadAtlas(const std::string& path, uint64_t key, std::vector<uint16_t>& ranks, size_t expectedSize)
+{
+    std::ifstream file(path, std::ios::binary);
+    FileHeader header{};
+    if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != c_fileMagic || header.version != c_fileVersion ||
+        header.key != key || header.size != expectedSize) {
+        return false;
+    }
+
+    ranks.resize(expectedSize / sizeof(uint16_t));
+    if (!file.read(reinterpret_cast<char*>(ranks.data()), expectedSize) || Hash::fnv1a(ranks.data(), expectedSize) != header.checksum) {
+        ranks.clear();
+        return false;
+    }
+    return true;
+}
+
+// Write atlas file with header
+bool saveAtlas(const std::string& path, uint64_t key, const std::vector<uint16_t>& ranks)
+{
+    FileHeader header{};
+    header.magic = c_fileMagic;
+    header.version = c_fileVersion;
+    header.key = key;
+    header.size = ranks.size() * sizeof(uint16_t);
+    header.checksum = Hash::fnv1a(ranks.data(), header.size);
+
+    std::vector<uint8_t> data(sizeof(header) + header.size);
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + sizeof(header), ranks.data(), header.size);
+    return ShaderCache::writeFile(path, data.data(), data.size());
+}
+
+// Plastic constant based R2 sequence steps, decorrelating offsets of consecutive frames
+constexpr double c_r2StepX = 0.7548776662466927;
+constexpr double c_r2StepY = 0.5698402909980532;
+
+// Returns true if value is a power of two
+bool isPowerOfTwo(int value) { return value > 0 && (value & (value - 1)) == 0; }
+
+// Void-and-cluster generator state for one tile
+class TileGenerator
+{
+public:
+    TileGenerator(int size, float sigma)
+        : m_size(size)
+        , m_mask(size - 1)
+        , m_filter(size * size)
+        , m_pattern(size * size, 0)
+        , m_energy(size * size, 0.0f)
+    {
+        // Gaussian energy filter on the torus, indexed by wrapped offset
+        const float scale = -1.0f / (2.0f * sigma * sigma);
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                const int dx = std::min(x, size - x);
+                const int dy = std::min(y, size - y);
+                m_filter[y * size + x] = std::exp(static_cast<float>(dx * dx + dy * dy) * scale);
+            }
+        }
+    }
+
+    // Set or clear texel and update energy
+    void set(int index, uint8_t value)
+    {
+        m_pattern[index] = value;
+        splat(index, value ? 1.0f : -1.0f);
+    }
+
+    // Add filter centered at texel to energy of all texels, with given sign
+    void splat(int index, float sign)
+    {
+        const int px = index % m_size;
+        const int py = index / m_size;
+        for (int y = 0; y < m_size; y++) {
+            const float* filter = &m_filter[((y - py) & m_mask) * m_size];
+            float* energy = &m_energy[y * m_size];
+            for (int x = 0; x < m_size; x++) {
+                energy[x] += sign * filter[(x - px) & m_mask];
+            }
+        }
+    }
+
+    // Returns texel with given value that has the highest energy, the tightest cluster. Such texel must exist.
+    int findCluster(uint8_t value) const
+    {
+        int best = 0;
+        float bestEnergy = -std::numeric_limits<float>::infinity();
+        for (int i = 0; i < static_cast<int>(m_energy.size()); i++) {
+            if (m_pattern[i] == value && m_energy[i] > bestEnergy) {
+                best = i;
+                bestEnergy = m_energy[i];
+            }
+        }
+        return best;
+    }
+
+    // Returns texel with given value that has the lowest energy, the largest void. Such texel must exist.
+    int findVoid(uint8_t value) const
+    {
+        int best = 0;
+        float bestEnergy = std::numeric_limits<float>::infinity();
+        for (int i = 0; i < static_cast<int>(m_energy.size()); i++) {
+            if (m_pattern[i] == value && m_energy[i] < bestEnergy) {
+                best = i;
+                bestEnergy = m_energy[i];
+            }
+        }
+        return best;
+    }
+
+    // Recompute energy from texels with given value
+    void rebuildEnergy(uint8_t value)
+    {
+        std::fill(m_energy.begin(), m_energy.end(), 0.0f);
+        for (int i = 0; i < static_cast<int>(m_pattern.size()); i++) {
+            if (m_pattern[i] == value) {
+                splat(i, 1.0f);
+            }
+        }
+    }
+
+    int m_size;                      // Tile size
+    int m_mask;                      // Coordinate wrap mask
+    std::vector<float> m_filter;     // Energy filter by wrapped offset
+    std::vector<uint8_t> m_pattern;  // Binary pattern
+    std::vector<float> m_energy;     // Filtered pattern energy per texel
+};
+
+}  // namespace
+
+void BlueNoise::generateTile(int size, float sigma, uint32_t seed, uint16_t* ranks)
+{
+    const int n = size * size;
+    TileGenerator gen(size, sigma);
+
+    // Initial pattern: a tenth of the texels set at random
+    std::mt19937 rng(seed);
+    const int ones = std::max(1, n / 10);
+    for (int placed = 0; placed < ones;) {
+        const int index = static_cast<int>(rng() % n);
+        if (!gen.m_pattern[index]) {
+            gen.set(index, 1);
+            placed++;
+        }
+    }
+
+    // Relax to an evenly distributed prototype: move tightest cluster to largest void until they meet
+    for (int i = 0; i < n; i++) {
+        const int cluster = gen.findCluster(1);
+        gen.set(cluster, 0);
+        const int largestVoid = gen.findVoid(0);
+        gen.set(largestVoid, 1);
+        if (largestVoid == cluster) {
+            break;
+        }
+    }
+    const auto prototypePattern = gen.m_pattern;
+    const auto prototypeEnergy = gen.m_energy;
+
+    // Phase 1: rank prototype texels by removing tightest clusters
+    for (int rank = ones - 1; rank >= 0; rank--) {
+        const int cluster = gen.findCluster(1);
+        gen.set(cluster, 0);
+        ranks[cluster] = static_cast<uint16_t>(rank);
+    }
+
+    // Phase 2: from the prototype, fill largest voids up to half of the texels
+    gen.m_pattern = prototypePattern;
+    gen.m_energy = prototypeEnergy;
+    int rank = ones;
+    for (; rank < n / 2; rank++) {
+        const int largestVoid = gen.findVoid(0);
+        gen.set(largestVoid, 1);
+        ranks[largestVoid] = static_cast<uint16_t>(rank);
+    }
+
+    // Phase 3: unset texels are now the minority, so fill their tightest clusters instead
+    gen.rebuildEnergy(0);
+    for (; rank < n; rank++) {
+        const int cluster = gen.findCluster(0);
+        // Energy follows the unset texels, so setting one removes its contribution
+        gen.m_pattern[cluster] = 1;
+        gen.splat(cluster, -1.0f);
+        ranks[cluster] = static_cast<uint16_t>(rank);
+    }
+}
+
+void BlueNoise::generate(const Params& params, ThreadPool& pool)
+{
+    TRACE_SCOPE("BlueNoise::generate");
+
+    if (!isPowerOfTwo(params.tileSize) || params.tileSize > 256 || params.tileCount <= 0) {
+        m_ranks.clear();
+        return;
+    }
+
+    m_params = params;
+    const size_t tileTexels = static_cast<size_t>(params.tileSize) * params.tileSize;
+    m_ranks.assign(tileTexels * params.tileCount, 0);
+
+    // Tiles are independent, so each one is a job of its own
+    pool.parallelFor(params.tileCount, [&](int tile) {
+        generateTile(params.tileSize, params.sigma, params.seed + 0x9e3779b9u * static_cast<uint32_t>(tile), &m_ranks[tile * tileTexels]);
+    });
+}
+
+bool BlueNoise::loadOrGenerate(const Params& params, ThreadPool& pool)
+{
+    // Atlas has its own file in the cache directory, named by hash of generator identity and parameters
+    const std::string identity = c_generatorIdentity + " " + std::to_string(params.tileSize) + " " + std::to_string(params.tileCount) + " " +
+                                 std::to_string(params.sigma) + " " + std::to_string(params.seed);
+    const uint64_t key = Hash::fnv1a(identity.data(), identity.size());
+    const size_t expectedSize = static_cast<size_t>(std::max(params.tileSize, 0)) * std::max(params.tileSize, 0) * std::max(params.tileCount, 0) *
+                                sizeof(uint16_t);
+    const std::string path = ShaderCache::instance().getFilePath(key, "blueNoise_", ".bin");
+
+    if (!path.empty() && expectedSize > 0 && loadAtlas(path, key, m_ranks, expectedSize)) {
+        m_params = params;
+        return true;
+    }
+
+    generate(params, pool);
+    if (isValid() && !path.empty()) {
+        saveAtlas(path, key, m_ranks);
+    }
+    return false;
+}
+
+BlueNoise::Frame BlueNoise::getFrame(int64_t frameIndex) const
+{
+    Frame frame;
+    if (!isValid()) {
+        return frame;
+    }
+
+    // Offsets from the R2 sequence cover the tile evenly over consecutive frames
+    const double n = static_cast<double>(frameIndex % (int64_t(1) << 24));
+    const double fx = std::fmod(0.5 + c_r2StepX * n, 1.0);
+    const double fy = std::fmod(0.5 + c_r2StepY * n, 1.0);
+    frame.tile = static_cast<int>(frameIndex % m_params.tileCount);
+    frame.offsetX = static_cast<int>(fx * m_params.tileSize);
+    frame.offsetY = static_cast<int>(fy * m_params.tileSize);
+    return frame;
+}
+
+float BlueNoise::sample(int tile, int x, int y) const
+{
+    const int size = m_params.tileSize;
+    const int mask = size - 1;
+    const size_t index = (static_cast<size_t>(tile) * size + (y & mask)) * size + (x & mask);
+    return (m_ranks[index] + 0.5f) / static_cast<float>(size * size);
+}
+
+template <typename T>
+void BlueNoise::writeFrame(int64_t frameIndex, int x0, int y0, int width, int height, int numChannels, T* target, size_t rowPitch, T maxValue) const
+{
+    if (!isValid()) {
+        return;
+    }
+
+    const Frame frame = getFrame(frameIndex);
+    const int size = m_params.tileSize;
+    const int mask = size - 1;
+    const size_t tileTexels = static_cast<size_t>(size) * size;
+
+    // Each channel takes the next tile, so channels are uncorrelated
+    constexpr int c_maxChannels = 4;
+    const uint16_t* tiles[c_maxChannels] = {};
+    numChannels = std::min(numChannels, c_maxChannels);
+    for (int c = 0; c < numChannels; c++) {
+        tiles[c] = &m_ranks[((frame.tile + c) % m_params.tileCount) * tileTexels];
+    }
+
+    // Rank to value at texel center
+    const double scale = static_cast<double>(maxValue) / tileTexels;
+    const auto getRow = [&](int y) { return reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(target) + y * rowPitch); };
+
+    // Convert one tile period, the rest of the region repeats it
+    const int offsetX = frame.offsetX + x0;
+    const int offsetY = frame.offsetY + y0;
+    const int tileWidth = std::min(width, size);
+    const int tileHeight = std::min(height, size);
+    for (int y = 0; y < tileHeight; y++) {
+        T* row = getRow(y);
+        const size_t tileRow = static_cast<size_t>((y + offsetY) & mask) * size;
+        for (int x = 0; x < tileWidth; x++) {
+            const size_t index = tileRow + ((x + offsetX) & mask);
+            for (int c = 0; c < numChannels; c++) {
+                row[x * numChannels + c] = static_cast<T>((tiles[c][index] + 0.5) * scale);
+            }
+        }
+
+        // Repeat horizontally, doubling the copied span
+        for (int x = tileWidth; x < width;) {
+            const int count = std::min(x, width - x);
+            std::memcpy(row + x * numChannels, row, count * numChannels * sizeof(T));
+            x += count;
+        }
+    }
+
+    // Repeat vertically
+    for (int y = tileHeight; y < height; y++) {
+        std::memcpy(getRow(y), getRow(y - tileHeight), width * numChannels * sizeof(T));
+    }
+}
+
+void BlueNoise::writeTexture(int64_t frameIndex, int width, int height, int numChannels, uint8_t* target, size_t rowPitch) const
+{
+    writeFrame<uint8_t>(frameIndex, 0, 0, width, height, numChannels, target, rowPitch, 255);
+}
+
+void BlueNoise::writeTexture(int64_t frameIndex, int width, int height, int numChannels, float* target, size_t rowPitch) const
+{
+    writeFrame<float>(frameIndex, 0, 0, width, height, numChannels, target, rowPitch, 1.0f);
+}
+
+void BlueNoise::writeTexture(int64_t frameIndex, int width, int height, int numChannels, uint32_t* target, size_t rowPitch) const
+{
+    writeFrame<uint32_t>(frameIndex, 0, 0, width, height, numChannels, target, rowPitch, 0xffffffffu);
+}
+
+void BlueNoise::writeRegion(int64_t frameIndex, int x0, int y0, int width, int height, int numChannels, uint8_t* target, size_t rowPitch) const
+{
+    writeFrame<uint8_t>(frameIndex, x0, y0, width, height, numChannels, target, rowPitch, 255);
+}
+
+void BlueNoise::writeRegion(int64_t frameIndex, int x0, int y0, int width, int height, int numChannels, float* target, size_t rowPitch) const
+{
+    writeFrame<float>(frameIndex, x0, y0, width, height, numChannels, target, rowPitch, 1.0f);
+}
+
+void BlueNoise::writeRegion(int64_t frameIndex, int x0, int y0, int width, int height, int numChannels, uint32_t* target, size_t rowPitch) const
+{
+    writeFrame<uint32_t>(frameIndex, x0, y0, width, height, numChannels, target, rowPitch, 0xffffffffu);
+}
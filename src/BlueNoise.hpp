@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+//! Atlas of tileable blue noise tiles generated with the void-and-cluster method.
+//!
+//! Tiles are generated once at startup, one tile per thread pool job, or loaded from the atlas
+//! file an earlier run wrote to the shader cache directory. Per frame the texture is animated by
+//! picking a tile and a toroidal offset from a low discrepancy sequence, so consecutive frames are
+//! decorrelated while each frame keeps its blue noise spectrum. Writing a frame is a strided copy
+//! with no random number generation.
+class BlueNoise
+{
+public:
+    //! Atlas parameters
+    struct Params {
+        int tileSize = 64;   //!< Tile width and height in texels, power of two up to 256
+        int tileCount = 16;  //!< Number of tiles
+        float sigma = 1.5f;  //!< Void-and-cluster energy filter deviation in texels
+        uint32_t seed = 1;   //!< Initial pattern seed
+
+        bool operator==(const Params& other) const
+        {
+            return tileSize == other.tileSize && tileCount == other.tileCount && sigma == other.sigma && seed == other.seed;
+        }
+        bool operator!=(const Params& other) const { return !(*this == other); }
+    };
+
+    //! Tile and toroidal offset used for a frame
+    struct Frame {
+        int tile = 0;     //!< Tile of first channel, later channels use the following tiles
+        int offsetX = 0;  //!< Horizontal offset in texels
+        int offsetY = 0;  //!< Vertical offset in texels
+    };
+
+    //! Constructor. Atlas is empty until generated or loaded.
+    BlueNoise() = default;
+
+    //! Generate atlas with given parameters, tiles in parallel on given pool
+    void generate(const Params& params, ThreadPool& pool);
+
+    //! Load atlas from its file in the shader cache directory, or generate it and write the file.
+    //! Returns true if loaded from file.
+    bool loadOrGenerate(const Params& params, ThreadPool& pool);
+
+    //! Returns true if atlas has been generated or loaded
+    bool isValid() const { return !m_ranks.empty(); }
+
+    //! Returns atlas parameters
+    const Params& getParams() const { return m_params; }
+
+    //! Returns tile and offset for given frame index
+    Frame getFrame(int64_t frameIndex) const;
+
+    //! Returns threshold value in [0, 1) of given tile texel. Coordinates wrap around.
+    float sample(int tile, int x, int y) const;
+
+    //! Write frame as texture of given size, row pitch in bytes. Tiles repeat over the texture.
+    void writeTexture(int64_t frameIndex, int width, int height, int numChannels, uint8_t* target, size_t rowPitch) const;
+
+    //! Write frame as texture of given size, row pitch in bytes. Tiles repeat over the texture.
+    void writeTexture(int64_t frameIndex, int width, int height, int numChannels, float* target, size_t rowPitch) const;
+
+    //! Write frame as texture of given size, row pitch in bytes. Tiles repeat over the texture.
+    void writeTexture(int64_t frameIndex, int width, int height, int numChannels, uint32_t* target, size_t rowPitch) const;
+
+    //! Write region of frame texture with top left pixel at x0, y0. Target points to the top left pixel.
+    //! Regions of a frame can be written in any order and in parallel.
+    void writeRegion(int64_t frameIndex, int x0, int y0, int width, int height, int numChannels, uint8_t* target, size_t rowPitch) const;
+
+    //! Write region of frame texture with top left pixel at x0, y0. Target points to the top left pixel.
+    void writeRegion(int64_t frameIndex, int x0, int y0, int width, int height, int numChannels, float* target, size_t rowPitch) const;
+
+    //! Write region of frame texture with top left pixel at x0, y0. Target points to the top left pixel.
+    void writeRegion(int64_t frameIndex, int x0, int y0, int width, int height, int numChannels, uint32_t* target, size_t rowPitch) const;
+
+    //! Generate ranks of one tile of given power of two size: each texel gets a unique rank in [0, size^2)
+    static void generateTile(int size, float sigma, uint32_t seed, uint16_t* ranks);
+
+private:
+    //! Write frame region with texel values scaled to given maximum
+    template <typename T>
+    void writeFrame(int64_t frameIndex, int x0, int y0, int width, int height, int numChannels, T* target, size_t rowPitch, T maxValue) const;
+
+private:
+    Params m_params{};              //!< Atlas parameters
+    std::vector<uint16_t> m_ranks;  //!< Texel ranks, index (tile * size + y) * size + x
+};
@@ -0,0 +1,320 @@
+#include "Bvh.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define BVH_USE_SSE2 1
+#else
+#define BVH_USE_SSE2 0
+#endif
+
+#include "TraceRecorder.hpp"
+
+namespace
+{
+// Traversal stack size. Median split keeps depth at log2 of leaf count.
+constexpr int c_stackSize = 64;
+
+}  // namespace
+
+Aabb transformBounds(const glm::mat4& transform, const Aabb& local)
+{
+    const glm::vec3 center = 0.5f * (local.min + local.max);
+    const glm::vec3 extent = 0.5f * (local.max - local.min);
+
+    Aabb result;
+    for (int r = 0; r < 3; r++) {
+        const float c = transform[0][r] * center.x + transform[1][r] * center.y + transform[2][r] * center.z + transform[3][r];
+        const float e = std::abs(transform[0][r]) * extent.x + std::abs(transform[1][r]) * extent.y + std::abs(transform[2][r]) * extent.z;
+        result.min[r] = c - e;
+        result.max[r] = c + e;
+    }
+    return result;
+}
+
+Frustum::Frustum(const glm::mat4& viewProj)
+{
+    // Rows of the column major matrix
+    glm::vec4 rows[4];
+    for (int r = 0; r < 4; r++) {
+        rows[r] = glm::vec4(viewProj[0][r], viewProj[1][r], viewProj[2][r], viewProj[3][r]);
+    }
+
+    // Left, right, bottom, top, near, far. Near plane uses -w <= z which also holds
+    // for zero to one depth range, so culling stays conservative for both conventions.
+    const glm::vec4 planes[6] = {
+        rows[3] + rows[0],
+        rows[3] - rows[0],
+        rows[3] + rows[1],
+        rows[3] - rows[1],
+        rows[3] + rows[2],
+        rows[3] - rows[2],
+    };
+
+    for (int i = 0; i < c_planeCount; i++) {
+        const glm::vec4 p = i < 6 ? planes[i] : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        m_nx[i] = p.x;
+        m_ny[i] = p.y;
+        m_nz[i] = p.z;
+        m_d[i] = p.w;
+    }
+}
+
+Frustum::Result Frustum::test(const float* center, const float* extent) const
+{
+#if BVH_USE_SSE2
+    const __m128 cx = _mm_set1_ps(center[0]);
+    const __m128 cy = _mm_set1_ps(center[1]);
+    const __m128 cz = _mm_set1_ps(center[2]);
+    const __m128 ex = _mm_set1_ps(extent[0]);
+    const __m128 ey = _mm_set1_ps(extent[1]);
+    const __m128 ez = _mm_set1_ps(extent[2]);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+    // Four planes at a time: box is outside a plane if its center is further behind
+    // the plane than its projected radius
+    __m128 outside = _mm_setzero_ps();
+    __m128 intersect = _mm_setzero_ps();
+    for (int i = 0; i < c_planeCount; i += 4) {
+        const __m128 nx = _mm_load_ps(m_nx + i);
+        const __m128 ny = _mm_load_ps(m_ny + i);
+        const __m128 nz = _mm_load_ps(m_nz + i);
+        const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_add_ps(_mm_mul_ps(nz, cz), _mm_load_ps(m_d + i)));
+        const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, absMask), ex), _mm_mul_ps(_mm_and_ps(ny, absMask), ey)),
+            _mm_mul_ps(_mm_and_ps(nz, absMask), ez));
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, radius), _mm_setzero_ps()));
+        intersect = _mm_or_ps(intersect, _mm_cmplt_ps(dist, radius));
+    }
+
+    if (_mm_movemask_ps(outside)) {
+        return Result::Outside;
+    }
+    return _mm_movemask_ps(intersect) ? Result::Intersect : Result::Inside;
+#else
+    bool intersect = false;
+    for (int i = 0; i < c_planeCount; i++) {
+        const float dist = m_nx[i] * center[0] + m_ny[i] * center[1] + m_nz[i] * center[2] + m_d[i];
+        const float radius = std::abs(m_nx[i]) * extent[0] + std::abs(m_ny[i]) * extent[1] + std::abs(m_nz[i]) * extent[2];
+        if (dist + radius < 0.0f) {
+            return Result::Outside;
+        }
+        intersect |= (dist < radius);
+    }
+    return intersect ? Result::Intersect : Result::Inside;
+#endif
+}
+
+Bvh::Box Bvh::toBox(const Aabb& bounds)
+{
+    Box box;
+    for (int c = 0; c < 3; c++) {
+        box.center[c] = 0.5f * (bounds.min[c] + bounds.max[c]);
+        box.extent[c] = 0.5f * (bounds.max[c] - bounds.min[c]);
+    }
+    return box;
+}
+
+void Bvh::build(const std::vector<Aabb>& bounds)
+{
+    TRACE_SCOPE("Bvh::build");
+
+    const uint32_t count = static_cast<uint32_t>(bounds.size());
+
+    m_nodes.clear();
+    m_refitNodes.clear();
+    m_objects.resize(count);
+    m_objectSlot.resize(count);
+    m_objectLeaf.resize(count);
+    m_objectBoxes.resize(count);
+
+    if (count == 0) {
+        m_refitFlags.clear();
+        return;
+    }
+
+    // Object centers are partitioned in place next to object indices for cache friendly access
+    std::vector<BuildItem> items(count);
+    for (uint32_t i = 0; i < count; i++) {
+        items[i] = {0.5f * (bounds[i].min + bounds[i].max), i};
+    }
+
+    m_nodes.reserve(2 * (count / c_maxLeafSize + 1));
+    buildNode(0, count, 0, items);
+
+    // Store object boxes in leaf order for cache friendly leaf tests
+    for (uint32_t slot = 0; slot < count; slot++) {
+        const uint32_t object = items[slot].object;
+        m_objects[slot] = object;
+        m_objectSlot[object] = slot;
+        m_objectBoxes[slot] = toBox(bounds[object]);
+    }
+
+    // Children always follow their parent, so fit bounds bottom up in reverse order
+    for (size_t i = m_nodes.size(); i-- > 0;) {
+        updateBounds(static_cast<uint32_t>(i));
+    }
+
+    m_refitFlags.assign(m_nodes.size(), 0);
+}
+
+uint32_t Bvh::buildNode(uint32_t first, uint32_t count, uint32_t parent, std::vector<BuildItem>& items)
+{
+    const uint32_t index = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+    m_nodes[index].first = first;
+    m_nodes[index].count = count;
+    m_nodes[index].right = 0;
+    m_nodes[index].parent = parent;
+
+    if (count <= c_maxLeafSize) {
+        for (uint32_t i = first; i < first + count; i++) {
+            m_objectLeaf[items[i].object] = index;
+        }
+        return index;
+    }
+
+    // Split at median along the largest axis of object centers
+    glm::vec3 centerMin(FLT_MAX);
+    glm::vec3 centerMax(-FLT_MAX);
+    for (uint32_t i = first; i < first + count; i++) {
+        centerMin = glm::min(centerMin, items[i].center);
+        centerMax = glm::max(centerMax, items[i].center);
+    }
+    const glm::vec3 size = centerMax - centerMin;
+    const int axis = (size.x >= size.y && size.x >= size.z) ? 0 : (size.y >= size.z ? 1 : 2);
+
+    const uint32_t half = count / 2;
+    const auto begin = items.begin() + first;
+    std::nth_element(begin, begin + half, begin + count, [axis](const BuildItem& a, const BuildItem& b) { return a.center[axis] < b.center[axis]; });
+
+    buildNode(first, half, index, items);
+    const uint32_t right = buildNode(first + half, count - half, index, items);
+    m_nodes[index].right = right;
+    return index;
+}
+
+void Bvh::updateBounds(uint32_t index)
+{
+    Node& node = m_nodes[index];
+
+    glm::vec3 boundsMin(FLT_MAX);
+    glm::vec3 boundsMax(-FLT_MAX);
+    const auto expand = [&](const float* center, const float* extent) {
+        for (int c = 0; c < 3; c++) {
+            boundsMin[c] = std::min(boundsMin[c], center[c] - extent[c]);
+            boundsMax[c] = std::max(boundsMax[c], center[c] + extent[c]);
+        }
+    };
+
+    if (node.right == 0) {
+        for (uint32_t i = node.first; i < node.first + node.count; i++) {
+            expand(m_objectBoxes[i].center, m_objectBoxes[i].extent);
+        }
+    } else {
+        expand(m_nodes[index + 1].center, m_nodes[index + 1].extent);
+        expand(m_nodes[node.right].center, m_nodes[node.right].extent);
+    }
+
+    for (int c = 0; c < 3; c++) {
+        node.center[c] = 0.5f * (boundsMin[c] + boundsMax[c]);
+        node.extent[c] = 0.5f * (boundsMax[c] - boundsMin[c]);
+    }
+}
+
+void Bvh::refit(const std::vector<Aabb>& bounds, const std::vector<uint32_t>& changed)
+{
+    if (changed.empty() || m_nodes.empty()) {
+        return;
+    }
+
+    TRACE_SCOPE("Bvh::refit");
+
+    // Update object boxes and flag their leaves
+    for (const uint32_t object : changed) {
+        m_objectBoxes[m_objectSlot[object]] = toBox(bounds[object]);
+
+        const uint32_t leaf = m_objectLeaf[object];
+        if (!m_refitFlags[leaf]) {
+            m_refitFlags[leaf] = 1;
+            m_refitNodes.push_back(leaf);
+        }
+    }
+
+    // Children have larger indices than their parents, so refit in descending order
+    if (m_refitNodes.size() * 16 < m_nodes.size()) {
+        // Few changes: flag ancestors and refit only flagged nodes
+        const size_t leafCount = m_refitNodes.size();
+        for (size_t i = 0; i < leafCount; i++) {
+            uint32_t index = m_refitNodes[i];
+            while (index != 0) {
+                index = m_nodes[index].parent;
+                if (m_refitFlags[index]) {
+                    break;
+                }
+                m_refitFlags[index] = 1;
+                m_refitNodes.push_back(index);
+            }
+        }
+
+        std::sort(m_refitNodes.begin(), m_refitNodes.end(), std::greater<uint32_t>());
+        for (const uint32_t index : m_refitNodes) {
+            updateBounds(index);
+            m_refitFlags[index] = 0;
+        }
+    } else {
+        // Many changes: single pass over all nodes propagating flags to parents
+        for (size_t i = m_nodes.size(); i-- > 0;) {
+            if (m_refitFlags[i]) {
+                updateBounds(static_cast<uint32_t>(i));
+                m_refitFlags[i] = 0;
+                m_refitFlags[m_nodes[i].parent] = 1;
+            }
+        }
+        m_refitFlags[0] = 0;
+    }
+    m_refitNodes.clear();
+}
+
+void Bvh::cull(const Frustum& frustum, std::vector<uint32_t>& visible) const
+{
+    if (m_nodes.empty()) {
+        return;
+    }
+
+    TRACE_SCOPE("Bvh::cull");
+
+    uint32_t stack[c_stackSize];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const uint32_t index = stack[--stackSize];
+        const Node& node = m_nodes[index];
+
+        const auto result = frustum.test(node.center, node.extent);
+        if (result == Frustum::Result::Outside) {
+            continue;
+        }
+
+        // Accept whole subtree without further tests
+        if (result == Frustum::Result::Inside) {
+            visible.insert(visible.end(), m_objects.begin() + node.first, m_objects.begin() + node.first + node.count);
+            continue;
+        }
+
+        if (node.right == 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                if (frustum.test(m_objectBoxes[i].center, m_objectBoxes[i].extent) != Frustum::Result::Outside) {
+                    visible.push_back(m_objects[i]);
+                }
+            }
+        } else {
+            stack[stackSize++] = node.right;
+            stack[stackSize++] = index + 1;
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+//! Axis aligned bounding box
+struct Aabb {
+    glm::vec3 min{0.0f};  //!< Minimum corner
+    glm::vec3 max{0.0f};  //!< Maximum corner
+};
+
+//! Returns world space bounds of local bounds transformed by given affine matrix
+Aabb transformBounds(const glm::mat4& transform, const Aabb& local);
+
+//! View frustum planes extracted from a view projection matrix
+class Frustum
+{
+public:
+    //! Constructor. Planes are extracted from given view projection matrix.
+    explicit Frustum(const glm::mat4& viewProj);
+
+    //! Box test result
+    enum class Result {
+        Outside = 0,  //!< Box fully outside
+        Intersect,    //!< Box intersects frustum boundary
+        Inside,       //!< Box fully inside
+    };
+
+    //! Test box given by center and half extent against frustum planes
+    Result test(const float* center, const float* extent) const;
+
+private:
+    //! Plane count padded for SIMD. Padding planes always pass.
+    static constexpr int c_planeCount = 8;
+
+    // Plane equations in structure of arrays layout
+    alignas(16) float m_nx[c_planeCount];  //!< Plane normal x
+    alignas(16) float m_ny[c_planeCount];  //!< Plane normal y
+    alignas(16) float m_nz[c_planeCount];  //!< Plane normal z
+    alignas(16) float m_d[c_planeCount];   //!< Plane distance
+};
+
+//! Bounding volume hierarchy over object bounds for view frustum culling.
+//!
+//! Built once for a set of objects with median splits and refitted in place when objects move.
+//! Subtrees fully inside the frustum are accepted without testing their contents.
+class Bvh
+{
+public:
+    //! Maximum objects per leaf node
+    static constexpr uint32_t c_maxLeafSize = 4;
+
+    //! Build hierarchy for given object bounds
+    void build(const std::vector<Aabb>& bounds);
+
+    //! Refit hierarchy for changed objects. Bounds must have the same object count as in build.
+    void refit(const std::vector<Aabb>& bounds, const std::vector<uint32_t>& changed);
+
+    //! Append indices of objects intersecting the frustum
+    void cull(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+
+    //! Returns object count
+    size_t getObjectCount() const { return m_objects.size(); }
+
+    //! Returns node count
+    size_t getNodeCount() const { return m_nodes.size(); }
+
+private:
+    //! Box as center and half extent for plane tests
+    struct Box {
+        float center[3];  //!< Box center
+        float extent[3];  //!< Box half extent
+    };
+
+    //! Hierarchy node. Bounds stored as center and half extent for plane tests.
+    struct Node {
+        float center[3];  //!< Bounds center
+        uint32_t first;   //!< First object in object list
+        float extent[3];  //!< Bounds half extent
+        uint32_t count;   //!< Object count in subtree
+        uint32_t right;   //!< Right child node index, zero for leaves. Left child follows the node.
+        uint32_t parent;  //!< Parent node index
+    };
+
+    //! Object reference used while building
+    struct BuildItem {
+        glm::vec3 center;  //!< Object bounds center
+        uint32_t object;   //!< Object index
+    };
+
+    //! Build subtree for build item range and return its node index
+    uint32_t buildNode(uint32_t first, uint32_t count, uint32_t parent, std::vector<BuildItem>& items);
+
+    //! Convert bounds to center and half extent box
+    static Box toBox(const Aabb& bounds);
+
+    //! Recompute node bounds from its children or objects
+    void updateBounds(uint32_t index);
+
+private:
+    std::vector<Node> m_nodes;           //!< Nodes in depth first order
+    std::vector<uint32_t> m_objects;     //!< Object indices ordered by leaf
+    std::vector<uint32_t> m_objectSlot;  //!< Object list position per object
+    std::vector<uint32_t> m_objectLeaf;  //!< Leaf node index per object
+    std::vector<Box> m_objectBoxes;      //!< Object boxes in object list order
+    std::vector<uint8_t> m_refitFlags;   //!< Nodes pending refit
+    std::vector<uint32_t> m_refitNodes;  //!< Indices of nodes pending refit
+};
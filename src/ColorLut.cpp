@@ -0,0 +1,254 @@
+#include "ColorLut.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define COLOR_LUT_USE_SSE2 1
+#else
+#define COLOR_LUT_USE_SSE2 0
+#endif
+
+#include "ThreadPool.hpp"
+#include "TraceRecorder.hpp"
+
+namespace
+{
+constexpr int c_size = ColorLut::c_size;
+constexpr int c_entryCount = c_size * c_size * c_size;
+
+// Small epsilon to avoid division by zero in saturation. Same as in the shader HSV helpers.
+constexpr float c_epsilon = 1e-10f;
+
+inline float clamp01(float v) { return std::min(std::max(v, 0.0f), 1.0f); }
+
+#if COLOR_LUT_USE_SSE2
+
+// Vectorized log2 for positive finite values. Max abs error ~2e-5.
+inline __m128 log2Ps(__m128 x)
+{
+    const __m128i bits = _mm_castps_si128(x);
+    const __m128i expBits = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+    const __m128 e = _mm_cvtepi32_ps(expBits);
+
+    // Mantissa in [1, 2)
+    const __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+
+    // log2(m) = 2 / ln(2) * atanh(t), t = (m - 1) / (m + 1) in [0, 1/3]
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 t = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one));
+    const __m128 t2 = _mm_mul_ps(t, t);
+    __m128 p = _mm_set1_ps(1.0f / 7.0f);
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(1.0f / 5.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(1.0f / 3.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, t2), one);
+    p = _mm_mul_ps(_mm_mul_ps(p, t), _mm_set1_ps(2.0f / 0.69314718f));
+
+    return _mm_add_ps(e, p);
+}
+
+// Vectorized exp2. Max relative error ~2e-5.
+inline __m128 exp2Ps(__m128 y)
+{
+    y = _mm_min_ps(_mm_max_ps(y, _mm_set1_ps(-126.0f)), _mm_set1_ps(126.0f));
+
+    // Split to integer and fractional parts, floor for negative values too
+    __m128i i = _mm_cvttps_epi32(y);
+    __m128 fi = _mm_cvtepi32_ps(i);
+    const __m128 adjust = _mm_and_ps(_mm_cmpgt_ps(fi, y), _mm_set1_ps(1.0f));
+    fi = _mm_sub_ps(fi, adjust);
+    i = _mm_cvtps_epi32(fi);
+    const __m128 z = _mm_mul_ps(_mm_sub_ps(y, fi), _mm_set1_ps(0.69314718f));
+
+    // exp(z) for z in [0, ln(2)) with Taylor series
+    __m128 p = _mm_set1_ps(1.0f / 720.0f);
+    p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(1.0f / 120.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(1.0f / 24.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(1.0f / 6.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(0.5f));
+    p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(1.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(1.0f));
+
+    // Scale by 2^i
+    const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(i, _mm_set1_epi32(127)), 23));
+    return _mm_mul_ps(p, scale);
+}
+
+// Vectorized pow(x, e) for x >= 0 and e > 0
+inline __m128 powPs(__m128 x, __m128 e)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 positive = _mm_cmpgt_ps(x, zero);
+    const __m128 safeX = _mm_max_ps(x, _mm_set1_ps(1e-30f));
+    return _mm_and_ps(exp2Ps(_mm_mul_ps(log2Ps(safeX), e)), positive);
+}
+
+#endif
+
+}  // namespace
+
+ColorLut::ColorLut()
+    : m_data(static_cast<size_t>(c_entryCount) * 4, 0.0f)
+{
+}
+
+void ColorLut::grade(const Params& params, const float* rgb, float* out)
+{
+    const float x[3] = {clamp01(rgb[0]), clamp01(rgb[1]), clamp01(rgb[2])};
+
+    // HSV saturation: chroma / value
+    const float maxC = std::max(x[0], std::max(x[1], x[2]));
+    const float minC = std::min(x[0], std::min(x[1], x[2]));
+    const float saturation = (maxC - minC) / (maxC + c_epsilon);
+
+    // Grading weight: saturated colors are preserved by the given factor
+    const float weight = 1.0f - params.preserveSaturated * saturation;
+
+    for (int c = 0; c < 3; c++) {
+        const float graded = params.value[c] * std::pow(x[c], params.exponent[c]);
+        out[c] = clamp01(x[c] + weight * (graded - x[c]));
+    }
+}
+
+bool ColorLut::bake(const Params& params)
+{
+    if (m_valid && params == m_params) {
+        return false;
+    }
+
+    TRACE_SCOPE("ColorLut::bake");
+
+    m_params = params;
+
+    // Bake blue slices in parallel
+    ThreadPool::instance().parallelFor(c_size, [this](int b) {
+        for (int g = 0; g < c_size; g++) {
+            bakeRow(g, b);
+        }
+    });
+
+    m_valid = true;
+    return true;
+}
+
+void ColorLut::bakeRow(int g, int b)
+{
+    constexpr float step = 1.0f / (c_size - 1);
+    const float gv = g * step;
+    const float bv = b * step;
+    float* row = &m_data[static_cast<size_t>((b * c_size + g) * c_size) * 4];
+
+    int r = 0;
+
+#if COLOR_LUT_USE_SSE2
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 gs = _mm_set1_ps(gv);
+    const __m128 bs = _mm_set1_ps(bv);
+    const __m128 preserve = _mm_set1_ps(m_params.preserveSaturated);
+    const __m128 values[3] = {_mm_set1_ps(m_params.value[0]), _mm_set1_ps(m_params.value[1]), _mm_set1_ps(m_params.value[2])};
+    const __m128 exponents[3] = {_mm_set1_ps(m_params.exponent[0]), _mm_set1_ps(m_params.exponent[1]), _mm_set1_ps(m_params.exponent[2])};
+
+    // Four red entries at a time. The last group is padded, so every entry uses the same pow
+    // approximation and texels don't differ by column.
+    for (; r < c_size; r += 4) {
+        const __m128 rs = _mm_mul_ps(_mm_setr_ps(float(r), float(r + 1), float(r + 2), float(r + 3)), _mm_set1_ps(step));
+        const __m128 x[3] = {rs, gs, bs};
+
+        const __m128 maxC = _mm_max_ps(rs, _mm_max_ps(gs, bs));
+        const __m128 minC = _mm_min_ps(rs, _mm_min_ps(gs, bs));
+        const __m128 saturation = _mm_div_ps(_mm_sub_ps(maxC, minC), _mm_add_ps(maxC, _mm_set1_ps(c_epsilon)));
+        const __m128 weight = _mm_sub_ps(one, _mm_mul_ps(preserve, saturation));
+
+        __m128 out[3];
+        for (int c = 0; c < 3; c++) {
+            const __m128 graded = _mm_mul_ps(values[c], powPs(x[c], exponents[c]));
+            const __m128 v = _mm_add_ps(x[c], _mm_mul_ps(weight, _mm_sub_ps(graded, x[c])));
+            out[c] = _mm_min_ps(_mm_max_ps(v, zero), one);
+        }
+
+        // Transpose SoA to RGBA entries
+        __m128 a = one;
+        _MM_TRANSPOSE4_PS(out[0], out[1], out[2], a);
+        if (r + 4 <= c_size) {
+            _mm_storeu_ps(row + (r + 0) * 4, out[0]);
+            _mm_storeu_ps(row + (r + 1) * 4, out[1]);
+            _mm_storeu_ps(row + (r + 2) * 4, out[2]);
+            _mm_storeu_ps(row + (r + 3) * 4, a);
+        } else {
+            alignas(16) float entries[16];
+            _mm_store_ps(entries + 0, out[0]);
+            _mm_store_ps(entries + 4, out[1]);
+            _mm_store_ps(entries + 8, out[2]);
+            _mm_store_ps(entries + 12, a);
+            std::copy(entries, entries + (c_size - r) * 4, row + r * 4);
+        }
+    }
+#endif
+
+    // Scalar fallback without SSE2
+    for (; r < c_size; r++) {
+        const float rgb[3] = {r * step, gv, bv};
+        grade(m_params, rgb, row + r * 4);
+        row[r * 4 + 3] = 1.0f;
+    }
+}
+
+void ColorLut::sample(const float* rgb, float* out) const
+{
+    constexpr float maxIndex = static_cast<float>(c_size - 1);
+
+    int i0[3];
+    float f[3];
+    for (int c = 0; c < 3; c++) {
+        const float v = clamp01(rgb[c]) * maxIndex;
+        i0[c] = std::min(static_cast<int>(v), c_size - 2);
+        f[c] = v - static_cast<float>(i0[c]);
+    }
+
+    const size_t strideG = c_size * 4;
+    const size_t strideB = c_size * c_size * 4;
+    const float* p = &m_data[i0[2] * strideB + i0[1] * strideG + i0[0] * 4];
+
+    for (int c = 0; c < 3; c++) {
+        const float c00 = p[c] + f[0] * (p[4 + c] - p[c]);
+        const float c10 = p[strideG + c] + f[0] * (p[strideG + 4 + c] - p[strideG + c]);
+        const float c01 = p[strideB + c] + f[0] * (p[strideB + 4 + c] - p[strideB + c]);
+        const float c11 = p[strideB + strideG + c] + f[0] * (p[strideB + strideG + 4 + c] - p[strideB + strideG + c]);
+        const float c0 = c00 + f[1] * (c10 - c00);
+        const float c1 = c01 + f[1] * (c11 - c01);
+        out[c] = c0 + f[2] * (c1 - c0);
+    }
+}
+
+void ColorLut::apply(float* rgba, size_t count, float factor) const
+{
+    if (!m_valid || factor <= 0.0f) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++, rgba += 4) {
+        float graded[3];
+        sample(rgba, graded);
+        for (int c = 0; c < 3; c++) {
+            rgba[c] += factor * (graded[c] - rgba[c]);
+        }
+    }
+}
+
+void ColorLut::writeTexture(uint8_t* target, size_t rowPitch) const
+{
+    for (int g = 0; g < c_size; g++) {
+        uint8_t* dst = target + g * rowPitch;
+        for (int b = 0; b < c_size; b++) {
+            const float* src = &m_data[static_cast<size_t>((b * c_size + g) * c_size) * 4];
+            for (int r = 0; r < c_size; r++, dst += 4, src += 4) {
+                dst[0] = static_cast<uint8_t>(src[0] * 255.0f + 0.5f);
+                dst[1] = static_cast<uint8_t>(src[1] * 255.0f + 0.5f);
+                dst[2] = static_cast<uint8_t>(src[2] * 255.0f + 0.5f);
+                dst[3] = 255;
+            }
+        }
+    }
+}
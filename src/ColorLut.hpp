@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//! Color grading 3D look-up table baked on CPU from post process color parameters.
+//!
+//! The LUT stores the fully graded color (colorFactor = 1). Applying it is a trilinear
+//! fetch followed by a linear blend with the original color by colorFactor, which is
+//! exactly equivalent to blending inside the grading formula. This way animated
+//! colorFactor does not require re-baking.
+class ColorLut
+{
+public:
+    //! LUT resolution per axis
+    static constexpr int c_size = 33;
+
+    //! Baked color grading parameters. Value and exponent as in post process constant buffer.
+    struct Params {
+        std::array<float, 3> value{1.0f, 1.0f, 1.0f};     //!< Color grading value
+        std::array<float, 3> exponent{1.0f, 1.0f, 1.0f};  //!< Color grading exponent
+        float preserveSaturated = 0.0f;                   //!< Saturated color preservation factor
+
+        bool operator==(const Params& other) const
+        {
+            return value == other.value && exponent == other.exponent && preserveSaturated == other.preserveSaturated;
+        }
+        bool operator!=(const Params& other) const { return !(*this == other); }
+    };
+
+    //! Constructor
+    ColorLut();
+
+    //! Bake LUT from given parameters. Returns true if the LUT contents changed.
+    bool bake(const Params& params);
+
+    //! Invalidate LUT so that next bake is done regardless of parameters
+    void invalidate() { m_valid = false; }
+
+    //! Returns true if LUT has been baked
+    bool isValid() const { return m_valid; }
+
+    //! Returns parameters used for the last bake
+    const Params& getParams() const { return m_params; }
+
+    //! Sample graded color with trilinear interpolation. Input is clamped to [0, 1].
+    void sample(const float* rgb, float* out) const;
+
+    //! Grade interleaved RGBA pixels in place, blending graded color by given factor. Alpha is preserved.
+    void apply(float* rgba, size_t count, float factor) const;
+
+    //! Write LUT as RGBA8 2D texture with blue slices laid side by side: size^2 x size texels.
+    void writeTexture(uint8_t* target, size_t rowPitch) const;
+
+    //! Evaluate grading formula directly for given color. Used as reference for baking.
+    static void grade(const Params& params, const float* rgb, float* out);
+
+private:
+    //! Bake one LUT row of red values for given green and blue indices
+    void bakeRow(int g, int b);
+
+private:
+    Params m_params{};           //!< Parameters of the current LUT contents
+    bool m_valid = false;        //!< LUT baked flag
+    std::vector<float> m_data;   //!< LUT entries as RGBA floats, index ((b * size + g) * size + r)
+};
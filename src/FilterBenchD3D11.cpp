@@ -0,0 +1,240 @@
+#include "FilterBenchD3D11.hpp"
+
+#include <cstring>
+#include <thread>
+#include <d3dcompiler.h>
+
+#include "Hash.hpp"
+#include "Shaders.hpp"
+#include "D3D11Renderer.hpp"
+#include "TraceRecorder.hpp"
+
+// VarjoExamples namespace contains simple example wrappers for using Varjo API features.
+// These are only meant to be used in SDK example applications. In your own application,
+// use your own production quality integration layer.
+using namespace VarjoExamples;
+
+namespace
+{
+// Post process shader compile target
+constexpr const char* c_shaderTarget = "cs_5_0";
+
+// Thread block sizes to try. Group shared memory of the separable low pass limits these to 16.
+const std::vector<int> c_blockSizes = {8, 16};
+
+// Low pass strategies implemented in the shader
+const std::vector<int> c_lowPassModes = {FilterCPU::LowPassDirect, FilterCPU::LowPassSeparable, FilterCPU::LowPassReduced};
+
+// Dispatches per view and measurement, averages out timestamp resolution
+constexpr int c_dispatchesPerMeasure = 4;
+
+// Varjo generic constants. Must match constant buffer b0 in the shader.
+struct GenericConstants {
+    glm::ivec2 sourceSize;         // Source texture dimensions
+    float sourceTime;              // Source texture timestamp
+    int32_t viewIndex;             // View to be rendered: 0=LC, 1=RC, 2=LF, 3=RF
+    glm::ivec4 destRect;           // Destination rectangle: x, y, w, h
+    glm::mat4 projection;          // Projection matrix used for the source texture
+    glm::mat4 inverseProjection;   // Inverse projection matrix
+    glm::mat4 view;                // View matrix used for the source texture
+    glm::mat4 inverseView;         // Inverse view matrix
+    glm::ivec4 sourceFocusRect;    // Area of the focus view within the context texture
+    glm::ivec2 sourceContextSize;  // Context texture size
+    glm::ivec2 padding;            // Unused
+};
+
+// Create constant buffer with given initial contents
+ComPtr<ID3D11Buffer> createConstantBuffer(ID3D11Device* device, const void* data, size_t size)
+{
+    CD3D11_BUFFER_DESC desc(static_cast<UINT>(size), D3D11_BIND_CONSTANT_BUFFER);
+    D3D11_SUBRESOURCE_DATA initData{data, 0, 0};
+    ComPtr<ID3D11Buffer> buffer;
+    HRESULT hr = 0;
+    if (FAILED(hr = device->CreateBuffer(&desc, &initData, &buffer))) {
+        CRITICAL("Creating constant buffer failed (%d): %s", hr, std::system_category().message(hr).c_str());
+    }
+    return buffer;
+}
+
+}  // namespace
+
+FilterBenchD3D11::FilterBenchD3D11(ComPtr<ID3D11Device>& d3dDevice, const std::string& shaderSource, const std::vector<glm::ivec2>& viewSizes)
+    : m_d3dDevice(d3dDevice)
+    , m_shaderSource(shaderSource)
+{
+    HRESULT hr = 0;
+    m_d3dDevice->GetImmediateContext(&m_d3dContext);
+
+    for (const auto& size : viewSizes) {
+        View view;
+        view.size = size;
+
+        // Synthetic camera image: gradient with grid lines like the test texture
+        std::vector<uint32_t> pixels(static_cast<size_t>(size.x) * size.y);
+        for (int y = 0; y < size.y; y++) {
+            for (int x = 0; x < size.x; x++) {
+                const bool grid = ((x & 15) == 8) || ((y & 15) == 8);
+                const uint32_t r = grid ? 0 : x * 255 / size.x;
+                const uint32_t g = grid ? 0 : y * 255 / size.y;
+                const uint32_t b = grid ? 0 : ((size.x - x) + (size.y - y)) * 255 / (size.x + size.y);
+                pixels[static_cast<size_t>(y) * size.x + x] = r | (g << 8) | (b << 16) | 0xff000000u;
+            }
+        }
+
+        CD3D11_TEXTURE2D_DESC inputDesc(DXGI_FORMAT_R8G8B8A8_UNORM, static_cast<UINT>(size.x), static_cast<UINT>(size.y), 1, 1);
+        D3D11_SUBRESOURCE_DATA initData{pixels.data(), static_cast<UINT>(size.x * sizeof(uint32_t)), 0};
+        ComPtr<ID3D11Texture2D> inputTexture;
+        if (FAILED(hr = m_d3dDevice->CreateTexture2D(&inputDesc, &initData, &inputTexture)) ||
+            FAILED(hr = m_d3dDevice->CreateShaderResourceView(inputTexture.Get(), nullptr, &view.input))) {
+            CRITICAL("Creating benchmark input texture failed (%d): %s", hr, std::system_category().message(hr).c_str());
+        }
+
+        CD3D11_TEXTURE2D_DESC outputDesc(DXGI_FORMAT_R8G8B8A8_UNORM, static_cast<UINT>(size.x), static_cast<UINT>(size.y), 1, 1,
+            D3D11_BIND_UNORDERED_ACCESS);
+        ComPtr<ID3D11Texture2D> outputTexture;
+        if (FAILED(hr = m_d3dDevice->CreateTexture2D(&outputDesc, nullptr, &outputTexture)) ||
+            FAILED(hr = m_d3dDevice->CreateUnorderedAccessView(outputTexture.Get(), nullptr, &view.output))) {
+            CRITICAL("Creating benchmark output texture failed (%d): %s", hr, std::system_category().message(hr).c_str());
+        }
+
+        // Left context view covering the whole source
+        GenericConstants constants{};
+        constants.sourceSize = size;
+        constants.viewIndex = 0;
+        constants.destRect = {0, 0, size.x, size.y};
+        constants.projection = constants.inverseProjection = constants.view = constants.inverseView = glm::mat4(1.0f);
+        constants.sourceFocusRect = {0, 0, size.x, size.y};
+        constants.sourceContextSize = size;
+        view.constants = createConstantBuffer(m_d3dDevice.Get(), &constants, sizeof(constants));
+
+        m_views.push_back(view);
+    }
+
+    PostProcessConstantBuffer shaderConstants{};
+    m_shaderConstants = createConstantBuffer(m_d3dDevice.Get(), &shaderConstants, sizeof(shaderConstants));
+
+    CD3D11_SAMPLER_DESC samplerDesc(D3D11_DEFAULT);
+    samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    if (FAILED(hr = m_d3dDevice->CreateSamplerState(&samplerDesc, &m_samplerClamp))) {
+        CRITICAL("Creating sampler failed (%d): %s", hr, std::system_category().message(hr).c_str());
+    }
+    samplerDesc.AddressU = samplerDesc.AddressV = samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+    if (FAILED(hr = m_d3dDevice->CreateSamplerState(&samplerDesc, &m_samplerWrap))) {
+        CRITICAL("Creating sampler failed (%d): %s", hr, std::system_category().message(hr).c_str());
+    }
+
+    const CD3D11_QUERY_DESC disjointDesc(D3D11_QUERY_TIMESTAMP_DISJOINT);
+    const CD3D11_QUERY_DESC timestampDesc(D3D11_QUERY_TIMESTAMP);
+    if (FAILED(hr = m_d3dDevice->CreateQuery(&disjointDesc, &m_disjointQuery)) ||
+        FAILED(hr = m_d3dDevice->CreateQuery(&timestampDesc, &m_startQuery)) ||
+        FAILED(hr = m_d3dDevice->CreateQuery(&timestampDesc, &m_endQuery))) {
+        CRITICAL("Creating timestamp queries failed (%d): %s", hr, std::system_category().message(hr).c_str());
+    }
+}
+
+std::vector<FilterTuner::Setting> FilterBenchD3D11::getCandidates()
+{
+    std::vector<FilterTuner::Setting> candidates;
+    for (int mode : c_lowPassModes) {
+        for (int blockSize : c_blockSizes) {
+            candidates.push_back({blockSize, mode});
+        }
+    }
+    return candidates;
+}
+
+uint64_t FilterBenchD3D11::getIdentity(ComPtr<ID3D11Device>& d3dDevice, const std::string& shaderSource)
+{
+    // Adapter, driver version and shader source. Retuned when any of these change.
+    DXGI_ADAPTER_DESC adapterDesc{};
+    LARGE_INTEGER driverVersion{};
+    ComPtr<IDXGIDevice> dxgiDevice;
+    ComPtr<IDXGIAdapter> adapter;
+    if (SUCCEEDED(d3dDevice.As(&dxgiDevice)) && SUCCEEDED(dxgiDevice->GetAdapter(&adapter))) {
+        adapter->GetDesc(&adapterDesc);
+        adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion);
+    }
+
+    uint64_t identity = Hash::fnv1a(adapterDesc.Description, sizeof(adapterDesc.Description));
+    identity = Hash::fnv1a(&adapterDesc.VendorId, sizeof(adapterDesc.VendorId), identity);
+    identity = Hash::fnv1a(&adapterDesc.DeviceId, sizeof(adapterDesc.DeviceId), identity);
+    identity = Hash::fnv1a(&driverVersion, sizeof(driverVersion), identity);
+    return Hash::fnv1a(shaderSource.data(), shaderSource.size(), identity);
+}
+
+ID3D11ComputeShader* FilterBenchD3D11::getShader(const FilterTuner::Setting& setting)
+{
+    const auto key = std::make_pair(setting.tileSize, setting.lowPassMode);
+    auto it = m_shaders.find(key);
+    if (it == m_shaders.end()) {
+        // Failed compiles are stored as null so that they are not retried
+        const std::string source = FilterTuner::getShaderDefines(setting) + m_shaderSource;
+        ComPtr<ID3DBlob> shaderBlob = D3D11Renderer::compileShader("vstPostProcess", source.c_str(), c_shaderTarget);
+        ComPtr<ID3D11ComputeShader> shader;
+        if (!shaderBlob || FAILED(m_d3dDevice->CreateComputeShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, &shader))) {
+            LOG_ERROR("Compiling post process shader variant failed: block size %d, low pass mode %d", setting.tileSize, setting.lowPassMode);
+        }
+        it = m_shaders.emplace(key, shader).first;
+    }
+    return it->second.Get();
+}
+
+double FilterBenchD3D11::measure(const FilterTuner::Setting& setting, float cutoff)
+{
+    TRACE_SCOPE("FilterBenchD3D11::measure");
+
+    ID3D11ComputeShader* shader = getShader(setting);
+    if (!shader) {
+        return -1.0;
+    }
+
+    PostProcessConstantBuffer shaderConstants{};
+    shaderConstants.colorFactor = 0.0f;
+    shaderConstants.highPassCutoffFreq = cutoff;
+    shaderConstants.filterType = FilterCPU::FilterHighPass;
+    m_d3dContext->UpdateSubresource(m_shaderConstants.Get(), 0, nullptr, &shaderConstants, 0, 0);
+
+    ID3D11SamplerState* samplers[] = {m_samplerClamp.Get(), m_samplerWrap.Get()};
+    m_d3dContext->CSSetShader(shader, nullptr, 0);
+    m_d3dContext->CSSetSamplers(0, 2, samplers);
+
+    m_d3dContext->Begin(m_disjointQuery.Get());
+    m_d3dContext->End(m_startQuery.Get());
+    for (const auto& view : m_views) {
+        // Noise and color grading LUT textures are bound to the camera image, neither is sampled
+        ID3D11ShaderResourceView* srvs[] = {view.input.Get(), view.input.Get(), view.input.Get()};
+        ID3D11UnorderedAccessView* uavs[] = {view.output.Get()};
+        ID3D11Buffer* cbs[] = {view.constants.Get(), m_shaderConstants.Get()};
+        m_d3dContext->CSSetShaderResources(0, 3, srvs);
+        m_d3dContext->CSSetUnorderedAccessViews(0, 1, uavs, nullptr);
+        m_d3dContext->CSSetConstantBuffers(0, 2, cbs);
+
+        const UINT groupsX = static_cast<UINT>((view.size.x + setting.tileSize - 1) / setting.tileSize);
+        const UINT groupsY = static_cast<UINT>((view.size.y + setting.tileSize - 1) / setting.tileSize);
+        for (int i = 0; i < c_dispatchesPerMeasure; i++) {
+            m_d3dContext->Dispatch(groupsX, groupsY, 1);
+        }
+    }
+    m_d3dContext->End(m_endQuery.Get());
+    m_d3dContext->End(m_disjointQuery.Get());
+
+    // Unbind so that resources can be released and reused by the application
+    ID3D11ShaderResourceView* nullSrvs[3] = {};
+    ID3D11UnorderedAccessView* nullUavs[1] = {};
+    m_d3dContext->CSSetShaderResources(0, 3, nullSrvs);
+    m_d3dContext->CSSetUnorderedAccessViews(0, 1, nullUavs, nullptr);
+    m_d3dContext->CSSetShader(nullptr, nullptr, 0);
+
+    // Wait for GPU to finish
+    D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint{};
+    while (m_d3dContext->GetData(m_disjointQuery.Get(), &disjoint, sizeof(disjoint), 0) == S_FALSE) {
+        std::this_thread::yield();
+    }
+    UINT64 startTime = 0;
+    UINT64 endTime = 0;
+    if (disjoint.Disjoint || m_d3dContext->GetData(m_startQuery.Get(), &startTime, sizeof(startTime), 0) != S_OK ||
+        m_d3dContext->GetData(m_endQuery.Get(), &endTime, sizeof(endTime), 0) != S_OK) {
+        return -1.0;
+    }
+    return static_cast<double>(endTime - startTime) * 1000.0 / disjoint.Frequency / c_dispatchesPerMeasure;
+}
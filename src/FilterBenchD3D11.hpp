@@ -0,0 +1,55 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <d3d11_1.h>
+
+#include "Globals.hpp"
+#include "FilterTuner.hpp"
+
+//! Times post process shader variants on D3D11 for the filter autotuner.
+//!
+//! Variants are dispatched on synthetic camera images of representative view sizes with the same
+//! bindings Varjo uses for the post process shader, and timed with GPU timestamp queries.
+class FilterBenchD3D11
+{
+public:
+    //! Constructor. Throws std::runtime_error if resources can not be created.
+    FilterBenchD3D11(ComPtr<ID3D11Device>& d3dDevice, const std::string& shaderSource, const std::vector<glm::ivec2>& viewSizes);
+
+    //! Returns candidates: thread block sizes times low pass strategies supported by the shader
+    static std::vector<FilterTuner::Setting> getCandidates();
+
+    //! Returns identity of GPU, driver and shader source, for looking up tuning results
+    static uint64_t getIdentity(ComPtr<ID3D11Device>& d3dDevice, const std::string& shaderSource);
+
+    //! Dispatch shader variant on all view sizes. Returns GPU time in milliseconds, negative on failure.
+    double measure(const FilterTuner::Setting& setting, float cutoff);
+
+private:
+    //! Benchmark view
+    struct View {
+        glm::ivec2 size;                           //!< View size
+        ComPtr<ID3D11ShaderResourceView> input;    //!< Synthetic camera image
+        ComPtr<ID3D11UnorderedAccessView> output;  //!< Output image
+        ComPtr<ID3D11Buffer> constants;            //!< Varjo generic constants
+    };
+
+    //! Returns compiled shader variant for setting, or nullptr if compiling failed
+    ID3D11ComputeShader* getShader(const FilterTuner::Setting& setting);
+
+private:
+    ComPtr<ID3D11Device> m_d3dDevice;                                      //!< D3D11 device
+    ComPtr<ID3D11DeviceContext> m_d3dContext;                              //!< D3D11 context
+    std::string m_shaderSource;                                            //!< Post process shader source
+    std::vector<View> m_views;                                             //!< Benchmark views
+    ComPtr<ID3D11Buffer> m_shaderConstants;                                //!< Post process shader constants
+    ComPtr<ID3D11SamplerState> m_samplerClamp;                             //!< Linear clamp sampler
+    ComPtr<ID3D11SamplerState> m_samplerWrap;                              //!< Linear wrap sampler
+    ComPtr<ID3D11Query> m_disjointQuery;                                   //!< Timestamp frequency query
+    ComPtr<ID3D11Query> m_startQuery;                                      //!< Start timestamp query
+    ComPtr<ID3D11Query> m_endQuery;                                        //!< End timestamp query
+    std::map<std::pair<int, int>, ComPtr<ID3D11ComputeShader>> m_shaders;  //!< Compiled variants
+};
@@ -0,0 +1,427 @@
+#include "FilterCPU.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "BilateralGrid.hpp"
+#include "ColorLut.hpp"
+#include "FrameArena.hpp"
+#include "ThreadPool.hpp"
+#include "TraceRecorder.hpp"
+
+namespace
+{
+// Constant added to high pass output. Same as in the shader.
+constexpr float c_highPassNormalizer = 0.35f;
+
+constexpr float c_pi = 3.1415926535897932384626433832795f;
+
+// Bilinear sample with clamp addressing at texel space coordinate (texel centers at integers)
+inline void sampleLinearClamp(const ImageRGBA& img, float fx, float fy, float* out)
+{
+    const float x0f = std::floor(fx);
+    const float y0f = std::floor(fy);
+    const float ax = fx - x0f;
+    const float ay = fy - y0f;
+
+    const int x0 = std::min(std::max(static_cast<int>(x0f), 0), img.width - 1);
+    const int y0 = std::min(std::max(static_cast<int>(y0f), 0), img.height - 1);
+    const int x1 = std::min(std::max(static_cast<int>(x0f) + 1, 0), img.width - 1);
+    const int y1 = std::min(std::max(static_cast<int>(y0f) + 1, 0), img.height - 1);
+
+    const float* r0 = img.row(y0);
+    const float* r1 = img.row(y1);
+    for (int c = 0; c < 4; c++) {
+        const float top = r0[x0 * 4 + c] + ax * (r0[x1 * 4 + c] - r0[x0 * 4 + c]);
+        const float bottom = r1[x0 * 4 + c] + ax * (r1[x1 * 4 + c] - r1[x0 * 4 + c]);
+        out[c] += top + ay * (bottom - top);
+    }
+}
+
+// Bilinear tap along one axis: weights for texels at offset and offset + 1 from the output texel
+struct Tap {
+    int offset;      // Offset of first texel
+    float weight0;  // Weight of first texel
+    float weight1;  // Weight of second texel
+};
+
+// Returns taps sampling at (i - offs) * step - 0.5 texels from the output texel, i = 0..count-1.
+// The fraction is the same for every output texel, so each tap is two weighted texel reads.
+std::vector<Tap> makeTaps(int count, float step)
+{
+    const float offs = count * 0.5f - 0.5f;
+    std::vector<Tap> taps;
+    for (int i = 0; i < count; i++) {
+        const float pos = (i - offs) * step - 0.5f;
+        const float base = std::floor(pos);
+        taps.push_back({static_cast<int>(base), 1.0f - (pos - base), pos - base});
+    }
+    return taps;
+}
+
+// Returns taps of bank kernel at given spacing in texels, centered on the output texel
+std::vector<Tap> makeBankTaps(const KernelBank::Kernel& kernel, float step)
+{
+    std::vector<Tap> taps;
+    for (int i = -kernel.radius; i <= kernel.radius; i++) {
+        const float pos = i * step;
+        const float base = std::floor(pos);
+        const float weight = kernel.weights[i + kernel.radius];
+        taps.push_back({static_cast<int>(base), weight * (1.0f - (pos - base)), weight * (pos - base)});
+    }
+    return taps;
+}
+
+// Sum taps horizontally over one row with clamp addressing
+void sumTapsRow(const float* src, int w, const std::vector<Tap>& taps, float* dst)
+{
+    for (int x = 0; x < w; x++) {
+        float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (const auto& tap : taps) {
+            const float* p0 = src + std::min(std::max(x + tap.offset, 0), w - 1) * 4;
+            const float* p1 = src + std::min(std::max(x + tap.offset + 1, 0), w - 1) * 4;
+            for (int c = 0; c < 4; c++) {
+                sum[c] += tap.weight0 * p0[c] + tap.weight1 * p1[c];
+            }
+        }
+        for (int c = 0; c < 4; c++) {
+            dst[x * 4 + c] = sum[c];
+        }
+    }
+}
+
+// Sum taps vertically for output row y with clamp addressing, scaled by norm
+void sumTapsColumn(const ImageRGBA& src, int y, const std::vector<Tap>& taps, float norm, float* dst)
+{
+    const size_t count = static_cast<size_t>(src.width) * 4;
+    std::fill(dst, dst + count, 0.0f);
+    for (const auto& tap : taps) {
+        const float* r0 = src.row(std::min(std::max(y + tap.offset, 0), src.height - 1));
+        const float* r1 = src.row(std::min(std::max(y + tap.offset + 1, 0), src.height - 1));
+        for (size_t i = 0; i < count; i++) {
+            dst[i] += tap.weight0 * r0[i] + tap.weight1 * r1[i];
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        dst[i] *= norm;
+    }
+}
+
+// Position in an integral line, split into texel index and fraction from the texel start
+struct AreaEdge {
+    int index;       // Texel index, clamped to line
+    float fraction;  // Distance from texel start, extends past the line ends
+};
+
+// Returns area edge at offset texels from the center of texel x in a line of n texels
+inline AreaEdge makeAreaEdge(int x, float offset, int n)
+{
+    const float t = x + offset + 0.5f;
+    const int index = std::min(std::max(static_cast<int>(std::floor(t)), 0), n - 1);
+    return {index, t - index};
+}
+
+// Integral of clamped line from its start to given edge: prefix of whole texels plus the partial texel
+inline float integrate(const float* prefix, const float* values, const AreaEdge& edge, int c)
+{
+    return prefix[edge.index * 4 + c] + edge.fraction * values[edge.index * 4 + c];
+}
+
+}  // namespace
+
+void FilterCPU::calculateKernelParameters(float cpd, int& kernelSize, float& scale)
+{
+    // Varjo XR-3 specific PPD
+    const float ppd = KernelBank::c_defaultPpd;
+
+    // Convert CPD to spatial frequency in pixels
+    const float freqInPixels = cpd * ppd;
+
+    // Minimum kernel size of 3 and odd for symmetric kernel application
+    kernelSize = std::max(3, static_cast<int>(ppd / freqInPixels));
+    kernelSize = kernelSize + (kernelSize % 2 == 0 ? 1 : 0);
+
+    scale = 1.0f - std::min(cpd / ppd, 1.0f);
+}
+
+KernelBank::Lookup FilterCPU::findKernel(const Params& params)
+{
+    const auto shape = params.kernelShape == KernelSinc ? KernelBank::Shape::Sinc : KernelBank::Shape::Gaussian;
+    return KernelBank::find(shape, params.highPassCutoffFreq, params.ppd, params.tapStride, c_maxBankRadius);
+}
+
+bool FilterCPU::usesLowPassImage(const Params& params)
+{
+    const bool passFilter =
+        params.filterType == FilterHighPass || params.filterType == FilterLowPass || params.filterType == FilterHighPassSpecial;
+    return (passFilter && params.highPassCutoffFreq > 0.0f && (params.lowPassMode != LowPassDirect || params.kernelShape != KernelBox)) ||
+           params.filterType == FilterBilateralGrid;
+}
+
+void FilterCPU::process(const ImageRGBA& src, ImageRGBA& dst, const Params& params, const ColorLut* colorLut)
+{
+    if (dst.width != src.width || dst.height != src.height) {
+        dst.resize(src.width, src.height);
+    }
+
+    // Low pass strategies other than direct taps, bank kernels and the bilateral grid precalculate their image
+    thread_local ImageRGBA t_lowPass;
+    const ImageRGBA* lowPass = nullptr;
+    if (usesLowPassImage(params)) {
+        calculateLowPass(src, t_lowPass, params);
+        lowPass = &t_lowPass;
+    }
+
+    const int bandHeight = std::max(params.bandHeight, 1);
+    const int bandCount = (src.height + bandHeight - 1) / bandHeight;
+    ThreadPool::instance().parallelFor(bandCount, [&](int band) {
+        TRACE_SCOPE("FilterCPU::band");
+        const int y0 = band * bandHeight;
+        const int y1 = std::min(y0 + bandHeight, src.height);
+        processRows(src, dst, params, colorLut, lowPass, y0, y1);
+    });
+}
+
+void FilterCPU::calculateLowPass(const ImageRGBA& src, ImageRGBA& lowPass, const Params& params)
+{
+    TRACE_SCOPE("FilterCPU::calculateLowPass");
+
+    // Bilateral grid enhancement is calculated as a whole, grid storage is kept between frames
+    if (params.filterType == FilterBilateralGrid) {
+        thread_local BilateralGrid t_grid;
+        t_grid.process(src, lowPass, BilateralGrid::getParams(params));
+        return;
+    }
+
+    const int w = src.width;
+    const int h = src.height;
+    const int bandHeight = std::max(params.bandHeight, 1);
+    const int bandCount = (h + bandHeight - 1) / bandHeight;
+
+    int kernelD = 0;
+    float blurScale = 0.0f;
+    calculateKernelParameters(params.highPassCutoffFreq, kernelD, blurScale);
+    const float step = blurScale * params.kernelScale;
+
+    if (lowPass.width != w || lowPass.height != h) {
+        lowPass.resize(w, h);
+    }
+    thread_local ImageRGBA t_horizontal;
+    if (t_horizontal.width != w || t_horizontal.height != h) {
+        t_horizontal.resize(w, h);
+    }
+    ImageRGBA& horizontal = t_horizontal;
+
+    if (params.lowPassMode == LowPassIntegral && params.kernelShape == KernelBox) {
+        // Average over the area the taps cover, kernel size times step texels per axis
+        const float halfWidth = std::max(0.5f * kernelD * step, 0.5f);
+        const float norm = 1.0f / (2.0f * halfWidth);
+
+        // Horizontal pass: per row prefix sums
+        ThreadPool::instance().parallelFor(bandCount, [&](int band) {
+            FrameArena::Scope scope(FrameArena::forThread());
+            ArenaVector<float> prefix(static_cast<size_t>(w) * 4);
+            for (int y = band * bandHeight; y < std::min((band + 1) * bandHeight, h); y++) {
+                const float* srcRow = src.row(y);
+                float* dstRow = horizontal.row(y);
+                float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                for (int x = 0; x < w; x++) {
+                    for (int c = 0; c < 4; c++) {
+                        prefix[x * 4 + c] = sum[c];
+                        sum[c] += srcRow[x * 4 + c];
+                    }
+                }
+                for (int x = 0; x < w; x++) {
+                    const AreaEdge left = makeAreaEdge(x, -0.5f - halfWidth, w);
+                    const AreaEdge right = makeAreaEdge(x, -0.5f + halfWidth, w);
+                    for (int c = 0; c < 4; c++) {
+                        dstRow[x * 4 + c] = (integrate(prefix.data(), srcRow, right, c) - integrate(prefix.data(), srcRow, left, c)) * norm;
+                    }
+                }
+            }
+        });
+
+        // Vertical pass: column prefix sums, one row of sums per image row
+        thread_local ImageRGBA t_prefix;
+        if (t_prefix.width != w || t_prefix.height != h) {
+            t_prefix.resize(w, h);
+        }
+        ImageRGBA& prefix = t_prefix;
+        const int columnCount = w * 4;
+        const int chunkSize = 256;
+        ThreadPool::instance().parallelFor((columnCount + chunkSize - 1) / chunkSize, [&](int chunk) {
+            const int i0 = chunk * chunkSize;
+            const int i1 = std::min(i0 + chunkSize, columnCount);
+            std::fill(prefix.row(0) + i0, prefix.row(0) + i1, 0.0f);
+            for (int y = 1; y < h; y++) {
+                const float* prev = prefix.row(y - 1);
+                const float* values = horizontal.row(y - 1);
+                float* row = prefix.row(y);
+                for (int i = i0; i < i1; i++) {
+                    row[i] = prev[i] + values[i];
+                }
+            }
+        });
+
+        ThreadPool::instance().parallelFor(bandCount, [&](int band) {
+            for (int y = band * bandHeight; y < std::min((band + 1) * bandHeight, h); y++) {
+                const AreaEdge top = makeAreaEdge(y, -0.5f - halfWidth, h);
+                const AreaEdge bottom = makeAreaEdge(y, -0.5f + halfWidth, h);
+                const float* topPrefix = prefix.row(top.index);
+                const float* topValues = horizontal.row(top.index);
+                const float* bottomPrefix = prefix.row(bottom.index);
+                const float* bottomValues = horizontal.row(bottom.index);
+                float* dstRow = lowPass.row(y);
+                for (int i = 0; i < columnCount; i++) {
+                    const float upper = topPrefix[i] + top.fraction * topValues[i];
+                    const float lower = bottomPrefix[i] + bottom.fraction * bottomValues[i];
+                    dstRow[i] = (lower - upper) * norm;
+                }
+            }
+        });
+        return;
+    }
+
+    // Separable and reduced taps. Reduced halves the taps per axis and doubles their spacing, so
+    // that the kernel covers the same area with each bilinear tap averaging two texels. Tap stride
+    // thins out taps further the same way. Bank kernels are separable regardless of the mode.
+    std::vector<Tap> taps;
+    float norm = 1.0f;
+    if (params.kernelShape != KernelBox) {
+        const auto kernel = findKernel(params);
+        taps = makeBankTaps(*kernel.kernel, kernel.step * params.kernelScale);
+    } else {
+        const int stride = (params.lowPassMode == LowPassReduced ? 2 : 1) * std::max(params.tapStride, 1);
+        const int tapCount = std::max((kernelD + stride - 1) / stride, 1);
+        taps = makeTaps(tapCount, stride * step);
+        norm = 1.0f / (tapCount * tapCount);
+    }
+
+    ThreadPool::instance().parallelFor(bandCount, [&](int band) {
+        for (int y = band * bandHeight; y < std::min((band + 1) * bandHeight, h); y++) {
+            sumTapsRow(src.row(y), w, taps, horizontal.row(y));
+        }
+    });
+    ThreadPool::instance().parallelFor(bandCount, [&](int band) {
+        for (int y = band * bandHeight; y < std::min((band + 1) * bandHeight, h); y++) {
+            sumTapsColumn(horizontal, y, taps, norm, lowPass.row(y));
+        }
+    });
+}
+
+void FilterCPU::processRows(
+    const ImageRGBA& src, ImageRGBA& dst, const Params& params, const ColorLut* colorLut, const ImageRGBA* lowPassImage, int y0, int y1)
+{
+    const int w = src.width;
+    const int h = src.height;
+    const int filterType = params.filterType;
+    const bool passFilter = (filterType == FilterHighPass || filterType == FilterLowPass || filterType == FilterHighPassSpecial);
+
+    // Kernel parameters are constant over the image
+    int kernelD = 0;
+    float blurScale = 0.0f;
+    if (passFilter && params.highPassCutoffFreq > 0.0f) {
+        calculateKernelParameters(params.highPassCutoffFreq, kernelD, blurScale);
+    }
+    const int tapStride = std::max(params.tapStride, 1);
+    kernelD = (kernelD + tapStride - 1) / tapStride;
+    const float kernelOffs = kernelD * 0.5f - 0.5f;
+    const float kernelStep = tapStride * blurScale * params.kernelScale;
+    const float kernelNorm = kernelD > 0 ? 1.0f / (kernelD * kernelD) : 0.0f;
+
+    for (int y = y0; y < y1; y++) {
+        const float* srcRow = src.row(y);
+        float* dstRow = dst.row(y);
+
+        for (int x = 0; x < w; x++) {
+            const float* orig = srcRow + x * 4;
+            float color[4] = {orig[0], orig[1], orig[2], orig[3]};
+
+            // Invert filter
+            if (filterType == FilterInvert) {
+                for (int c = 0; c < 3; c++) {
+                    color[c] = 1.0f - orig[c];
+                }
+            }
+
+            // Kaleidoscope filter
+            if (filterType == FilterKaleidoscope) {
+                const float u = (static_cast<float>(x) - 0.5f * w) / h;
+                const float v = (static_cast<float>(y) - 0.5f * h) / h;
+                const float radius = std::sqrt(u * u + v * v);
+                const float angle = std::atan2(v, u);
+
+                constexpr int numSegments = 3;
+                constexpr float segmentAngle = 2.0f * c_pi / numSegments;
+                const float mirroredAngle = std::abs(std::fmod(angle + segmentAngle / 2, segmentAngle) - segmentAngle / 2);
+                const float newAngle = mirroredAngle * numSegments;
+
+                const int tx = static_cast<int>(0.5f * h * radius * std::cos(newAngle) + 0.5f * w);
+                const int ty = static_cast<int>(0.5f * h * radius * std::sin(newAngle) + 0.5f * h);
+                if (tx >= 0 && tx < w && ty >= 0 && ty < h) {
+                    const float* s = src.row(ty) + tx * 4;
+                    color[0] = s[0], color[1] = s[1], color[2] = s[2], color[3] = s[3];
+                } else {
+                    color[0] = color[1] = color[2] = color[3] = 0.0f;
+                }
+            }
+
+            // Bilateral grid enhancement from the precalculated image
+            if (filterType == FilterBilateralGrid && lowPassImage) {
+                const float* e = lowPassImage->row(y) + x * 4;
+                color[0] = e[0], color[1] = e[1], color[2] = e[2];
+            }
+
+            // High and low pass filters
+            if (passFilter) {
+                float lowPass[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                if (lowPassImage) {
+                    const float* l = lowPassImage->row(y) + x * 4;
+                    lowPass[0] = l[0], lowPass[1] = l[1], lowPass[2] = l[2], lowPass[3] = l[3];
+                } else if (kernelD > 0) {
+                    // Shader samples at pixel corner uv, i.e. half texel offset
+                    const float cx = static_cast<float>(x) - 0.5f;
+                    const float cy = static_cast<float>(y) - 0.5f;
+                    for (int ky = 0; ky < kernelD; ky++) {
+                        const float oy = (ky - kernelOffs) * kernelStep;
+                        for (int kx = 0; kx < kernelD; kx++) {
+                            const float ox = (kx - kernelOffs) * kernelStep;
+                            sampleLinearClamp(src, cx + ox, cy + oy, lowPass);
+                        }
+                    }
+                    for (int c = 0; c < 4; c++) {
+                        lowPass[c] *= kernelNorm;
+                    }
+                }
+
+                for (int c = 0; c < 4; c++) {
+                    if (filterType == FilterLowPass) {
+                        color[c] = lowPass[c];
+                    } else {
+                        color[c] = orig[c] - lowPass[c];
+                    }
+                    if (filterType == FilterHighPass) {
+                        color[c] += c_highPassNormalizer;
+                    }
+                    if (filterType == FilterHighPassSpecial) {
+                        color[c] = std::min(std::abs(color[c]) * 5.0f, 1.0f);
+                    }
+                }
+            }
+
+            float* out = dstRow + x * 4;
+            out[0] = color[0];
+            out[1] = color[1];
+            out[2] = color[2];
+
+            // Alpha is preserved from the original
+            out[3] = orig[3];
+        }
+
+        // Color grading through baked LUT
+        if (colorLut) {
+            colorLut->apply(dstRow, static_cast<size_t>(w), params.colorFactor);
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "KernelBank.hpp"
+
+class ColorLut;
+
+//! Interleaved float RGBA image used by the CPU filter engine
+struct ImageRGBA {
+    int width = 0;              //!< Image width in pixels
+    int height = 0;             //!< Image height in pixels
+    std::vector<float> pixels;  //!< Pixel data, 4 floats per pixel
+
+    //! Resize image, contents are cleared
+    void resize(int w, int h)
+    {
+        width = w;
+        height = h;
+        pixels.assign(static_cast<size_t>(w) * h * 4, 0.0f);
+    }
+
+    //! Returns pointer to the first pixel of given row
+    float* row(int y) { return pixels.data() + static_cast<size_t>(y) * width * 4; }
+    const float* row(int y) const { return pixels.data() + static_cast<size_t>(y) * width * 4; }
+};
+
+//! CPU implementation of the filter chain in vstPostProcess.hlsl.
+//! Used for offline processing and as a reference for the shader.
+class FilterCPU
+{
+public:
+    //! Filter types. Must match filterType values in the shader.
+    enum FilterType {
+        FilterNone = 0,
+        FilterHighPass,
+        FilterLowPass,
+        FilterInvert,
+        FilterKaleidoscope,
+        FilterHighPassSpecial,
+        FilterBilateralGrid,
+        FilterTypeCount
+    };
+
+    //! Low pass strategies. Must match LOW_PASS_MODE values in the shader.
+    enum LowPassMode {
+        LowPassDirect = 0,  //!< Box of bilinear taps as in the shader. Kernel size squared taps per pixel.
+        LowPassSeparable,   //!< Same taps summed in horizontal and vertical passes. Same result as direct.
+        LowPassIntegral,    //!< Area average from integral image. Cost independent of kernel size, approximate.
+        LowPassReduced,     //!< Half the taps per axis at double spacing, each tap averaging two texels. Approximate.
+        LowPassModeCount
+    };
+
+    //! Low pass kernel shapes. Must match kernelShape values in the shader.
+    enum KernelShape {
+        KernelBox = 0,   //!< Box of kernel size taps per axis at fractional spacing as in the shader, uses low pass mode
+        KernelGaussian,  //!< Gaussian from KernelBank, separable
+        KernelSinc,      //!< Windowed sinc from KernelBank, separable
+        KernelShapeCount
+    };
+
+    //! Largest bank kernel radius the filters use. Wider kernels spread their taps by octaves instead,
+    //! so a bank kernel costs at most the 11 x 11 taps of the box kernel at the lowest UI cutoff in the
+    //! shader's direct loop.
+    static constexpr int c_maxBankRadius = 5;
+
+    //! Filter parameters, subset of the post process constant buffer
+    struct Params {
+        int filterType = FilterNone;           //!< Filter type
+        float highPassCutoffFreq = 0.5f;       //!< High/low pass cutoff frequency
+        float colorFactor = 0.0f;              //!< Color grading amount: 0=off, 1=full
+        float kernelScale = 1.0f;              //!< Kernel offset scale in texels. Source size / focus size for focus views.
+        int lowPassMode = LowPassDirect;       //!< Low pass strategy
+        int bandHeight = 16;                   //!< Rows per parallel work item
+        int tapStride = 1;                     //!< Low pass tap stride: taps per axis divided by this over the same area
+        int kernelShape = KernelBox;           //!< Low pass kernel shape
+        float ppd = KernelBank::c_defaultPpd;  //!< View pixels per degree for kernel bank lookup
+        int gridCellSize = 16;                 //!< Bilateral grid cell size in pixels
+        int gridRangeBins = 8;                 //!< Bilateral grid luminance bins
+        float enhanceGain = 1.0f;              //!< Bilateral grid edge enhancement gain
+    };
+
+    //! Filter source image to destination image. Destination is resized to match the source.
+    static void process(const ImageRGBA& src, ImageRGBA& dst, const Params& params, const ColorLut* colorLut = nullptr);
+
+    //! Calculate box kernel size and offset scale for given cutoff frequency. Same as in the shader.
+    static void calculateKernelParameters(float cpd, int& kernelSize, float& scale);
+
+    //! Returns kernel bank lookup for given parameters, radius at most c_maxBankRadius. Kernel shape must not be box.
+    static KernelBank::Lookup findKernel(const Params& params);
+
+    //! Returns true if filters with given parameters read a low pass image from calculateLowPass
+    //! instead of direct taps
+    static bool usesLowPassImage(const Params& params);
+
+    //! Calculate low pass image for pass filters with strategies other than direct, or the enhanced
+    //! image for the bilateral grid filter. Building block of process, also used by FilterGraph passes.
+    static void calculateLowPass(const ImageRGBA& src, ImageRGBA& lowPass, const Params& params);
+
+    //! Filter given range of rows. Low pass image is used instead of direct taps if given.
+    //! Building block of process, also used by FilterGraph passes.
+    static void processRows(
+        const ImageRGBA& src, ImageRGBA& dst, const Params& params, const ColorLut* colorLut, const ImageRGBA* lowPass, int y0, int y1);
+};
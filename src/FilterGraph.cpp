@@ -0,0 +1,342 @@
+#include "FilterGraph.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "ColorLut.hpp"
+#include "ThreadPool.hpp"
+#include "TraceRecorder.hpp"
+
+namespace
+{
+// Constant added to high pass output. Same as in the shader.
+constexpr float c_highPassNormalizer = 0.35f;
+
+// Gain of the high pass special abs and clamp. Same as in the shader.
+constexpr float c_highPassSpecialGain = 5.0f;
+
+// Stage names used in descriptions, indexed by stage type
+const char* const c_stageNames[] = {
+    "invert", "gain", "absclamp", "lut", "lowpass", "highpass", "highpass-special", "kaleidoscope", "bilateral-grid"};
+static_assert(sizeof(c_stageNames) / sizeof(c_stageNames[0]) == static_cast<size_t>(FilterGraph::StageType::Count), "Stage name missing");
+
+// Returns text with leading and trailing spaces removed
+std::string trim(const std::string& text)
+{
+    const size_t begin = text.find_first_not_of(" \t");
+    const size_t end = text.find_last_not_of(" \t");
+    return begin == std::string::npos ? std::string() : text.substr(begin, end - begin + 1);
+}
+
+// Returns text split at given separator
+std::vector<std::string> split(const std::string& text, char separator)
+{
+    std::vector<std::string> items;
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        const size_t end = std::min(text.find(separator, pos), text.size());
+        items.push_back(trim(text.substr(pos, end - pos)));
+        pos = end + 1;
+    }
+    return items;
+}
+
+// Append name to names joined by separator
+void appendName(std::string& names, const std::string& name, const char* separator)
+{
+    if (!name.empty()) {
+        names += (names.empty() ? "" : separator) + name;
+    }
+}
+
+}  // namespace
+
+void FilterGraph::clear()
+{
+    m_stages.clear();
+    m_passes.clear();
+}
+
+const char* FilterGraph::getStageName(StageType type)
+{
+    const size_t index = static_cast<size_t>(type);
+    return index < static_cast<size_t>(StageType::Count) ? c_stageNames[index] : "unknown";
+}
+
+bool FilterGraph::parse(const std::string& description, std::string& error)
+{
+    m_stages.clear();
+    m_passes.clear();
+    for (const auto& item : split(description, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        const std::vector<std::string> parts = split(item, ':');
+        const auto it = std::find_if(std::begin(c_stageNames), std::end(c_stageNames), [&](const char* name) { return parts[0] == name; });
+        if (it == std::end(c_stageNames)) {
+            error = "Unknown filter stage: " + parts[0];
+            return false;
+        }
+
+        Stage stage;
+        stage.type = static_cast<StageType>(it - std::begin(c_stageNames));
+        const auto getParameter = [&](size_t index, float def) {
+            return index < parts.size() && !parts[index].empty() ? static_cast<float>(std::atof(parts[index].c_str())) : def;
+        };
+        stage.gain = getParameter(1, stage.gain);
+        stage.offset = getParameter(2, stage.offset);
+        stage.factor = getParameter(1, stage.factor);
+        stage.cutoffFreq = getParameter(1, stage.cutoffFreq);
+        stage.cellSize = static_cast<int>(getParameter(2, static_cast<float>(stage.cellSize)));
+        stage.rangeBins = static_cast<int>(getParameter(3, static_cast<float>(stage.rangeBins)));
+        m_stages.push_back(stage);
+    }
+    return true;
+}
+
+FilterGraph FilterGraph::fromParams(const FilterCPU::Params& params)
+{
+    FilterGraph graph;
+    Stage stage;
+    stage.cutoffFreq = params.highPassCutoffFreq;
+    switch (params.filterType) {
+        case FilterCPU::FilterHighPass: stage.type = StageType::HighPass; break;
+        case FilterCPU::FilterLowPass: stage.type = StageType::LowPass; break;
+        case FilterCPU::FilterInvert: stage.type = StageType::Invert; break;
+        case FilterCPU::FilterKaleidoscope: stage.type = StageType::Kaleidoscope; break;
+        case FilterCPU::FilterHighPassSpecial: stage.type = StageType::HighPassSpecial; break;
+        case FilterCPU::FilterBilateralGrid:
+            stage.type = StageType::BilateralGrid;
+            stage.gain = params.enhanceGain;
+            stage.cellSize = params.gridCellSize;
+            stage.rangeBins = params.gridRangeBins;
+            break;
+        case FilterCPU::FilterNone: stage.type = StageType::Count; break;
+        default: throw std::invalid_argument("Filter type without graph stage: " + std::to_string(params.filterType));
+    }
+    if (stage.type != StageType::Count) {
+        graph.addStage(stage);
+    }
+
+    Stage grading;
+    grading.type = StageType::ColorLut;
+    grading.factor = params.colorFactor;
+    graph.addStage(grading);
+    return graph;
+}
+
+void FilterGraph::appendOp(Pass& pass, const PointOp& op, bool fuse)
+{
+    if (fuse && op.kind == PointOp::Affine && !pass.ops.empty() && pass.ops.back().kind == PointOp::Affine) {
+        // (x * s1 + o1) * s2 + o2 = x * (s1 * s2) + (o1 * s2 + o2)
+        PointOp& last = pass.ops.back();
+        for (int c = 0; c < 4; c++) {
+            last.scale[c] *= op.scale[c];
+            last.offset[c] = last.offset[c] * op.scale[c] + op.offset[c];
+        }
+        appendName(last.name, op.name, " + ");
+        return;
+    }
+    pass.ops.push_back(op);
+}
+
+void FilterGraph::compile(const FilterCPU::Params& engine, const ColorLut* colorLut, bool fuse)
+{
+    m_passes.clear();
+    m_bandHeight = std::max(engine.bandHeight, 1);
+
+    Pass current;
+    bool open = false;
+    const auto flush = [&]() {
+        if (open) {
+            m_passes.push_back(current);
+            current = Pass();
+            open = false;
+        }
+    };
+
+    for (const auto& stage : m_stages) {
+        PointOp op;
+        op.name = getStageName(stage.type);
+        Source source = Source::Copy;
+        switch (stage.type) {
+            case StageType::Invert:
+                op.scale = {-1.0f, -1.0f, -1.0f, 1.0f};
+                op.offset = {1.0f, 1.0f, 1.0f, 0.0f};
+                break;
+            case StageType::Gain:
+                op.scale = {stage.gain, stage.gain, stage.gain, 1.0f};
+                op.offset = {stage.offset, stage.offset, stage.offset, 0.0f};
+                break;
+            case StageType::AbsClamp:
+                op.kind = PointOp::AbsClamp;
+                op.gain = stage.gain;
+                break;
+            case StageType::ColorLut:
+                op.kind = PointOp::Lut;
+                op.lut = colorLut;
+                op.factor = stage.factor;
+                break;
+            case StageType::LowPass: source = Source::LowPass; break;
+            case StageType::HighPass:
+            case StageType::HighPassSpecial: source = Source::Difference; break;
+            case StageType::Kaleidoscope: source = Source::Kaleidoscope; break;
+            case StageType::BilateralGrid: source = Source::Enhanced; break;
+            default: continue;
+        }
+
+        // Point stage: runs on the rows of the current pass
+        if (source == Source::Copy) {
+            if (op.kind == PointOp::Lut && !colorLut) {
+                continue;
+            }
+            if (!fuse) {
+                flush();
+            }
+            appendOp(current, op, fuse);
+            open = true;
+            continue;
+        }
+
+        // Neighborhood stage: starts a new pass unless the current one is affine only and the stage is linear
+        const bool linear = source == Source::LowPass || source == Source::Difference;
+        const bool affineOnly = std::all_of(current.ops.begin(), current.ops.end(), [](const PointOp& o) { return o.kind == PointOp::Affine; });
+        std::vector<PointOp> folded;
+        if (fuse && open && current.source == Source::Copy && linear && affineOnly) {
+            folded = current.ops;
+            current = Pass();
+        } else {
+            flush();
+        }
+        current.source = source;
+        current.name = getStageName(stage.type);
+        current.params = engine;
+        current.params.filterType = source == Source::Kaleidoscope ? FilterCPU::FilterKaleidoscope
+                                    : source == Source::Enhanced   ? FilterCPU::FilterBilateralGrid
+                                                                   : FilterCPU::FilterLowPass;
+        current.params.highPassCutoffFreq = stage.cutoffFreq;
+        current.params.enhanceGain = stage.gain;
+        current.params.gridCellSize = stage.cellSize;
+        current.params.gridRangeBins = stage.rangeBins;
+        open = true;
+
+        // Affine operations before the stage move after it. High pass cancels their offset.
+        for (auto& f : folded) {
+            if (source == Source::Difference) {
+                f.offset = {0.0f, 0.0f, 0.0f, 0.0f};
+            }
+            f.name = "(" + f.name + ")";
+            appendOp(current, f, fuse);
+        }
+
+        // Fixed operations of the shader filter types
+        if (stage.type == StageType::HighPass) {
+            PointOp normalizer;
+            normalizer.offset = {c_highPassNormalizer, c_highPassNormalizer, c_highPassNormalizer, 0.0f};
+            appendOp(current, normalizer, fuse);
+        } else if (stage.type == StageType::HighPassSpecial) {
+            PointOp clamp;
+            clamp.kind = PointOp::AbsClamp;
+            clamp.gain = c_highPassSpecialGain;
+            appendOp(current, clamp, fuse);
+        }
+    }
+    flush();
+
+    // Empty graph copies the source
+    if (m_passes.empty()) {
+        m_passes.push_back(Pass());
+    }
+}
+
+std::string FilterGraph::describePasses() const
+{
+    std::string text;
+    for (const auto& pass : m_passes) {
+        std::string names = pass.name;
+        for (const auto& op : pass.ops) {
+            appendName(names, op.name, " + ");
+        }
+        appendName(text, names.empty() ? std::string("copy") : names, " | ");
+    }
+    return text;
+}
+
+void FilterGraph::process(const ImageRGBA& src, ImageRGBA& dst)
+{
+    if (m_passes.empty()) {
+        dst = src;
+        return;
+    }
+
+    for (size_t i = 0; i < m_passes.size(); i++) {
+        const Pass& pass = m_passes[i];
+        const ImageRGBA& input = i == 0 ? src : m_intermediate[(i - 1) % 2];
+        ImageRGBA& output = i + 1 == m_passes.size() ? dst : m_intermediate[i % 2];
+        if (output.width != input.width || output.height != input.height) {
+            output.resize(input.width, input.height);
+        }
+
+        // Low pass strategies other than direct taps, bank kernels and the bilateral grid precalculate their image of the pass input
+        const ImageRGBA* lowPass = nullptr;
+        if (FilterCPU::usesLowPassImage(pass.params)) {
+            FilterCPU::calculateLowPass(input, m_lowPass, pass.params);
+            lowPass = &m_lowPass;
+        }
+
+        const int bandCount = (input.height + m_bandHeight - 1) / m_bandHeight;
+        ThreadPool::instance().parallelFor(bandCount, [&](int band) {
+            TRACE_SCOPE("FilterGraph::band");
+            const int y0 = band * m_bandHeight;
+            processRows(pass, input, output, lowPass, y0, std::min(y0 + m_bandHeight, input.height));
+        });
+    }
+}
+
+void FilterGraph::processRows(const Pass& pass, const ImageRGBA& src, ImageRGBA& dst, const ImageRGBA* lowPass, int y0, int y1) const
+{
+    const int w = src.width;
+    for (int y = y0; y < y1; y++) {
+        const float* srcRow = src.row(y);
+        float* dstRow = dst.row(y);
+
+        // Neighborhood source, alpha preserved from the input
+        if (pass.source == Source::Copy) {
+            std::copy(srcRow, srcRow + static_cast<size_t>(w) * 4, dstRow);
+        } else {
+            FilterCPU::processRows(src, dst, pass.params, nullptr, lowPass, y, y + 1);
+        }
+        if (pass.source == Source::Difference) {
+            for (int x = 0; x < w; x++) {
+                for (int c = 0; c < 3; c++) {
+                    dstRow[x * 4 + c] = srcRow[x * 4 + c] - dstRow[x * 4 + c];
+                }
+            }
+        }
+
+        // Point operations while the row is in cache
+        for (const auto& op : pass.ops) {
+            switch (op.kind) {
+                case PointOp::Affine:
+                    for (int x = 0; x < w; x++) {
+                        float* p = dstRow + x * 4;
+                        for (int c = 0; c < 4; c++) {
+                            p[c] = p[c] * op.scale[c] + op.offset[c];
+                        }
+                    }
+                    break;
+                case PointOp::AbsClamp:
+                    for (int x = 0; x < w; x++) {
+                        float* p = dstRow + x * 4;
+                        for (int c = 0; c < 3; c++) {
+                            p[c] = std::min(std::abs(p[c]) * op.gain, 1.0f);
+                        }
+                    }
+                    break;
+                case PointOp::Lut: op.lut->apply(dstRow, static_cast<size_t>(w), op.factor); break;
+            }
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "FilterCPU.hpp"
+
+class ColorLut;
+
+//! Runtime description of a CPU filter chain as a list of stages, compiled into passes over the image.
+//!
+//! The shader composes filters only implicitly, like the high pass normalizer after the high pass.
+//! A graph chains any stages, for example invert, then high pass, then color grading. Compiling
+//! fuses stages into as few passes over memory as the data dependencies allow:
+//!
+//! - Point stages (invert, gain, clamp, color LUT) only read their own pixel, so they run on each
+//!   row right after the previous stage produced it, while the row is still in cache.
+//! - Neighborhood stages (low pass, high pass, kaleidoscope, bilateral grid) read other rows of their
+//!   input, so their input must be complete in memory and each one starts a new pass. Affine point
+//!   stages before a linear neighborhood stage (low and high pass) are folded through it instead,
+//!   since box weights sum to one: lowPass(a * x + b) = a * lowPass(x) + b and highPass(a * x + b)
+//!   = a * highPass(x). Results then differ from unfused execution by float rounding only.
+//!
+//! Stages work on color channels, alpha is preserved from the source like in FilterCPU.
+class FilterGraph
+{
+public:
+    //! Stage types
+    enum class StageType {
+        Invert = 0,       //!< 1 - color
+        Gain,             //!< color * gain + offset
+        AbsClamp,         //!< min(abs(color) * gain, 1)
+        ColorLut,         //!< Color grading through baked LUT, blended by factor
+        LowPass,          //!< Box low pass at cutoff frequency
+        HighPass,         //!< Color minus low pass, plus the shader high pass normalizer
+        HighPassSpecial,  //!< High pass with abs and clamp as in the shader
+        Kaleidoscope,     //!< Mirrored segments around the image center
+        BilateralGrid,    //!< Bilateral grid edge enhancement
+        Count
+    };
+
+    //! Stage description
+    struct Stage {
+        StageType type = StageType::Invert;  //!< Stage type
+        float gain = 1.0f;                   //!< Gain, AbsClamp multiplier and BilateralGrid enhancement gain
+        float offset = 0.0f;                 //!< Gain offset
+        float cutoffFreq = 0.5f;             //!< Pass filter cutoff frequency
+        float factor = 1.0f;                 //!< ColorLut blend factor
+        int cellSize = 16;                   //!< BilateralGrid cell size in pixels
+        int rangeBins = 8;                   //!< BilateralGrid luminance bins
+    };
+
+    //! Append stage
+    void addStage(const Stage& stage) { m_stages.push_back(stage); }
+
+    //! Remove all stages and passes
+    void clear();
+
+    //! Returns stages
+    const std::vector<Stage>& getStages() const { return m_stages; }
+
+    //! Parse stages from comma separated list of name[:parameter[:parameter]] items, for example
+    //! "invert,highpass:0.5,lut:1". Parameters are gain:G:O, absclamp:G, lut:F, lowpass:C,
+    //! highpass:C, highpass-special:C and bilateral-grid:G:S:B for gain, cell size and luminance
+    //! bins. Returns false with error message on unknown names.
+    bool parse(const std::string& description, std::string& error);
+
+    //! Returns graph equivalent to FilterCPU::process with given parameters: the filter type stage
+    //! followed by color grading. Throws std::invalid_argument on filter types without a stage.
+    static FilterGraph fromParams(const FilterCPU::Params& params);
+
+    //! Returns name of stage type as used by parse
+    static const char* getStageName(StageType type);
+
+    //! Compile stages to passes. Pass filter stages use the low pass strategy, kernel scale, tap
+    //! stride and band height of the given engine parameters. ColorLut stages are skipped if no LUT
+    //! is given. Without fusion every stage is a pass of its own.
+    void compile(const FilterCPU::Params& engine, const ColorLut* colorLut, bool fuse = true);
+
+    //! Returns number of compiled passes
+    int getPassCount() const { return static_cast<int>(m_passes.size()); }
+
+    //! Returns compiled passes as text, passes separated by " | ", fused stages by " + ". Affine stages
+    //! folded through a pass filter are in parentheses.
+    std::string describePasses() const;
+
+    //! Run compiled passes from source to destination image. Destination is resized to match the source.
+    void process(const ImageRGBA& src, ImageRGBA& dst);
+
+private:
+    //! Per pixel operation of a pass
+    struct PointOp {
+        enum Kind { Affine, AbsClamp, Lut };
+        Kind kind = Affine;                                   //!< Operation
+        std::array<float, 4> scale{1.0f, 1.0f, 1.0f, 1.0f};   //!< Affine scale, alpha stays 1
+        std::array<float, 4> offset{0.0f, 0.0f, 0.0f, 0.0f};  //!< Affine offset, alpha stays 0
+        float gain = 1.0f;                                    //!< AbsClamp multiplier
+        float factor = 1.0f;                                  //!< Lut blend factor
+        const ColorLut* lut = nullptr;                        //!< Lut
+        std::string name;                                     //!< Source stage names for describePasses
+    };
+
+    //! Neighborhood part of a pass
+    enum class Source {
+        Copy = 0,      //!< Input pixel
+        LowPass,       //!< Low pass of the input
+        Difference,    //!< Input minus low pass of the input
+        Kaleidoscope,  //!< Kaleidoscope gather from the input
+        Enhanced,      //!< Bilateral grid enhancement of the input
+    };
+
+    //! Compiled pass: neighborhood source read from the pass input, then point operations in order
+    struct Pass {
+        Source source = Source::Copy;  //!< Neighborhood source
+        FilterCPU::Params params;      //!< Source filter parameters
+        std::vector<PointOp> ops;      //!< Point operations
+        std::string name;              //!< Source stage name for describePasses
+    };
+
+    //! Append point operation to pass, composing consecutive affine operations if fusing
+    static void appendOp(Pass& pass, const PointOp& op, bool fuse);
+
+    //! Run pass for given rows
+    void processRows(const Pass& pass, const ImageRGBA& src, ImageRGBA& dst, const ImageRGBA* lowPass, int y0, int y1) const;
+
+private:
+    std::vector<Stage> m_stages;              //!< Stage description
+    std::vector<Pass> m_passes;               //!< Compiled passes
+    int m_bandHeight = 16;                    //!< Rows per parallel work item
+    std::array<ImageRGBA, 2> m_intermediate;  //!< Pass outputs between passes, used in turns
+    ImageRGBA m_lowPass;                      //!< Low pass image for strategies other than direct, or enhanced image
+};
@@ -0,0 +1,270 @@
+#include "FilterTuner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#define FILTER_TUNER_X64 1
+#else
+#define FILTER_TUNER_X64 0
+#endif
+
+#include "Hash.hpp"
+#include "TestPattern.hpp"
+#include "ThreadPool.hpp"
+
+namespace
+{
+// Largest kernel size of each tuned range. Cutoffs of the UI sliders give kernel sizes up to 11.
+// Larger kernels use the last range.
+const std::vector<int> c_kernelRanges = {3, 5, 7, 11};
+
+// Timed runs per candidate after a warm up run
+constexpr int c_timedRuns = 3;
+
+// Candidates slower than this factor of the best so far are not timed further
+constexpr double c_giveUpFactor = 1.5;
+
+// Minimum PSNR of approximate low pass strategies against direct taps, in dB
+constexpr double c_minPsnr = 40.0;
+
+// Image size for checking accuracy of approximate low pass strategies
+constexpr int c_validationSize = 256;
+
+// CPU band heights to try
+const std::vector<int> c_cpuBandHeights = {4, 16, 64};
+
+const char* getTargetName(FilterTuner::Target target) { return (target == FilterTuner::Target::GPU) ? "gpu" : "cpu"; }
+
+// Returns kernel size range index for cutoff frequency
+size_t getRangeIndex(float cutoff)
+{
+    int kernelSize = 0;
+    float scale = 0.0f;
+    FilterCPU::calculateKernelParameters(cutoff, kernelSize, scale);
+    for (size_t i = 0; i < c_kernelRanges.size(); i++) {
+        if (kernelSize <= c_kernelRanges[i]) {
+            return i;
+        }
+    }
+    return c_kernelRanges.size() - 1;
+}
+
+// Returns the test texture gradient with its grid lines, so that approximations are checked on edges too
+ImageRGBA makeTestImage(int width, int height)
+{
+    ImageRGBA image;
+    image.resize(width, height);
+    TestPattern::generateGradient(width, height, 4, image.pixels.data(), static_cast<size_t>(width) * 4 * sizeof(float));
+    return image;
+}
+
+// Returns PSNR of image against reference in dB
+double calculatePsnr(const ImageRGBA& image, const ImageRGBA& reference)
+{
+    double squaredError = 0.0;
+    for (size_t i = 0; i < image.pixels.size(); i++) {
+        const double error = image.pixels[i] - reference.pixels[i];
+        squaredError += error * error;
+    }
+    const double mse = squaredError / std::max<size_t>(image.pixels.size(), 1);
+    return mse > 0.0 ? 10.0 * std::log10(1.0 / mse) : 200.0;
+}
+
+// Returns true if low pass strategy stays close to direct taps at cutoff. The shader implements the
+// same taps, so the CPU result stands for the GPU too.
+bool isAccurate(int lowPassMode, float cutoff)
+{
+    if (lowPassMode == FilterCPU::LowPassDirect || lowPassMode == FilterCPU::LowPassSeparable) {
+        return true;
+    }
+
+    const ImageRGBA source = makeTestImage(c_validationSize, c_validationSize);
+    FilterCPU::Params params;
+    params.filterType = FilterCPU::FilterHighPass;
+    params.highPassCutoffFreq = cutoff;
+    ImageRGBA reference;
+    FilterCPU::process(source, reference, params);
+
+    params.lowPassMode = lowPassMode;
+    ImageRGBA output;
+    FilterCPU::process(source, output, params);
+    return calculatePsnr(output, reference) >= c_minPsnr;
+}
+
+}  // namespace
+
+bool FilterTuner::load(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream stream(line);
+        std::string targetName;
+        Entry entry;
+        stream >> targetName >> std::hex >> entry.identity >> std::dec >> entry.range.maxKernelSize >> entry.range.setting.tileSize >>
+            entry.range.setting.lowPassMode >> entry.range.ms;
+        if (!stream || (targetName != "cpu" && targetName != "gpu") || entry.range.setting.lowPassMode < 0 ||
+            entry.range.setting.lowPassMode >= FilterCPU::LowPassModeCount || entry.range.setting.tileSize <= 0) {
+            continue;
+        }
+        entry.target = (targetName == "gpu") ? Target::GPU : Target::CPU;
+        m_entries.push_back(entry);
+    }
+    return true;
+}
+
+bool FilterTuner::save(const std::string& path) const
+{
+    std::ofstream file(path);
+    file << "# Filter autotuning results, delete to retune: target identity maxKernelSize tileSize lowPassMode ms\n";
+    for (const auto& entry : m_entries) {
+        file << getTargetName(entry.target) << " " << std::hex << entry.identity << std::dec << " " << entry.range.maxKernelSize << " "
+             << entry.range.setting.tileSize << " " << entry.range.setting.lowPassMode << " " << entry.range.ms << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+bool FilterTuner::hasResults(Target target, uint64_t identity) const { return getResults(target, identity).size() == c_kernelRanges.size(); }
+
+std::vector<FilterTuner::Range> FilterTuner::getResults(Target target, uint64_t identity) const
+{
+    std::vector<Range> ranges;
+    for (const auto& entry : m_entries) {
+        if (entry.target == target && entry.identity == identity) {
+            ranges.push_back(entry.range);
+        }
+    }
+    std::sort(ranges.begin(), ranges.end(), [](const Range& a, const Range& b) { return a.maxKernelSize < b.maxKernelSize; });
+    return ranges;
+}
+
+void FilterTuner::tune(Target target, uint64_t identity, const std::vector<Setting>& candidates, const Measure& measure)
+{
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(),
+                        [&](const Entry& entry) { return entry.target == target && entry.identity == identity; }),
+        m_entries.end());
+
+    for (int maxKernelSize : c_kernelRanges) {
+        // Cutoff giving the largest kernel of the range
+        const float cutoff = 1.0f / maxKernelSize;
+
+        std::map<int, bool> accurate;
+        Entry best{target, identity, {maxKernelSize, Setting(), -1.0}};
+        for (const auto& candidate : candidates) {
+            auto it = accurate.find(candidate.lowPassMode);
+            if (it == accurate.end()) {
+                it = accurate.emplace(candidate.lowPassMode, isAccurate(candidate.lowPassMode, cutoff)).first;
+            }
+
+            // Warm up run
+            if (!it->second || measure(candidate, cutoff) < 0.0) {
+                continue;
+            }
+
+            double minMs = -1.0;
+            for (int run = 0; run < c_timedRuns; run++) {
+                const double ms = measure(candidate, cutoff);
+                if (ms < 0.0) {
+                    continue;
+                }
+                minMs = (minMs < 0.0) ? ms : std::min(minMs, ms);
+                if (best.range.ms >= 0.0 && ms > best.range.ms * c_giveUpFactor) {
+                    break;
+                }
+            }
+            if (minMs >= 0.0 && (best.range.ms < 0.0 || minMs < best.range.ms)) {
+                best.range.setting = candidate;
+                best.range.ms = minMs;
+            }
+        }
+
+        if (best.range.ms >= 0.0) {
+            m_entries.push_back(best);
+        }
+    }
+}
+
+FilterTuner::Setting FilterTuner::getSetting(Target target, uint64_t identity, float cutoff, const Setting& defaultSetting) const
+{
+    const auto ranges = getResults(target, identity);
+    const size_t index = getRangeIndex(cutoff);
+    for (const auto& range : ranges) {
+        if (range.maxKernelSize == c_kernelRanges[index]) {
+            return range.setting;
+        }
+    }
+    return defaultSetting;
+}
+
+std::vector<FilterTuner::Setting> FilterTuner::getCPUCandidates()
+{
+    std::vector<Setting> candidates;
+    for (int mode = 0; mode < FilterCPU::LowPassModeCount; mode++) {
+        for (int bandHeight : c_cpuBandHeights) {
+            candidates.push_back({bandHeight, mode});
+        }
+    }
+    return candidates;
+}
+
+FilterTuner::Measure FilterTuner::makeCPUMeasure(int width, int height)
+{
+    auto source = std::make_shared<ImageRGBA>(makeTestImage(width, height));
+    auto output = std::make_shared<ImageRGBA>();
+
+    return [source, output](const Setting& setting, float cutoff) {
+        FilterCPU::Params params;
+        params.filterType = FilterCPU::FilterHighPass;
+        params.highPassCutoffFreq = cutoff;
+        params.lowPassMode = setting.lowPassMode;
+        params.bandHeight = setting.tileSize;
+
+        const auto startTime = std::chrono::steady_clock::now();
+        FilterCPU::process(*source, *output, params);
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    };
+}
+
+uint64_t FilterTuner::getCPUIdentity()
+{
+    // Processor brand string and worker count
+    char brand[49] = {};
+#if FILTER_TUNER_X64
+    for (unsigned int i = 0; i < 3; i++) {
+#ifdef _MSC_VER
+        int regs[4];
+        __cpuid(regs, static_cast<int>(0x80000002 + i));
+#else
+        unsigned int regs[4] = {};
+        __get_cpuid(0x80000002 + i, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+        std::memcpy(brand + i * 16, regs, 16);
+    }
+#endif
+    const int threadCount = ThreadPool::instance().getThreadCount();
+    return Hash::fnv1a(&threadCount, sizeof(threadCount), Hash::fnv1a(brand, std::strlen(brand)));
+}
+
+std::string FilterTuner::getShaderDefines(const Setting& setting)
+{
+    return "#define BLOCK_SIZE (" + std::to_string(setting.tileSize) + ")\n#define LOW_PASS_MODE (" + std::to_string(setting.lowPassMode) + ")\n";
+}
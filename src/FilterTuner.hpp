@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "FilterCPU.hpp"
+
+//! Autotuner for filter tile size and low pass strategy.
+//!
+//! Candidate settings are timed at a representative cutoff of each low pass kernel size range and the
+//! fastest one is kept per range. Results are stored per target and machine identity in a text file,
+//! so tuning only runs on first launch on each machine, or after the machine or shader changes.
+class FilterTuner
+{
+public:
+    //! Default results file, relative to working directory
+    static constexpr const char* c_defaultFile = "filter_tuning.txt";
+
+    //! Tuning target
+    enum class Target { CPU = 0, GPU };
+
+    //! Tunable settings
+    struct Setting {
+        int tileSize = 0;                            //!< CPU band height or GPU thread block size
+        int lowPassMode = FilterCPU::LowPassDirect;  //!< Low pass strategy
+
+        bool operator==(const Setting& other) const { return tileSize == other.tileSize && lowPassMode == other.lowPassMode; }
+        bool operator!=(const Setting& other) const { return !(*this == other); }
+    };
+
+    //! Tuning result for one kernel size range
+    struct Range {
+        int maxKernelSize = 0;  //!< Largest kernel size in range
+        Setting setting;        //!< Fastest setting
+        double ms = 0.0;        //!< Time per frame with fastest setting
+    };
+
+    //! Runs filter once with given setting and cutoff frequency. Returns time in milliseconds, or a
+    //! negative value if setting can not be used.
+    using Measure = std::function<double(const Setting& setting, float cutoff)>;
+
+    //! Load results from file. Returns false if file could not be read.
+    bool load(const std::string& path);
+
+    //! Save results of all targets and machines to file. Returns false on failure.
+    bool save(const std::string& path) const;
+
+    //! Returns true if there are results for target on machine with given identity
+    bool hasResults(Target target, uint64_t identity) const;
+
+    //! Returns results for target on machine with given identity, sorted by kernel size
+    std::vector<Range> getResults(Target target, uint64_t identity) const;
+
+    //! Time candidates on each kernel size range and store the fastest, replacing earlier results.
+    //! Approximate low pass strategies are skipped on ranges where they are not accurate enough.
+    void tune(Target target, uint64_t identity, const std::vector<Setting>& candidates, const Measure& measure);
+
+    //! Returns tuned setting for cutoff frequency, or given default if there are no results
+    Setting getSetting(Target target, uint64_t identity, float cutoff, const Setting& defaultSetting) const;
+
+    //! Returns CPU candidates: band heights times all low pass strategies
+    static std::vector<Setting> getCPUCandidates();
+
+    //! Returns measure running CPU filter chain on image of given size
+    static Measure makeCPUMeasure(int width, int height);
+
+    //! Returns identity of this CPU
+    static uint64_t getCPUIdentity();
+
+    //! Returns shader defines selecting given setting, to be prepended to shader source
+    static std::string getShaderDefines(const Setting& setting);
+
+private:
+    //! Stored result
+    struct Entry {
+        Target target;      //!< Tuning target
+        uint64_t identity;  //!< Machine identity
+        Range range;        //!< Result
+    };
+
+    std::vector<Entry> m_entries;  //!< Results of all targets and machines
+};
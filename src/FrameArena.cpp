@@ -0,0 +1,69 @@
+#include "FrameArena.hpp"
+
+#include <algorithm>
+
+FrameArena::FrameArena(size_t initialSize)
+    : m_initialSize(initialSize)
+{
+}
+
+FrameArena& FrameArena::forThread()
+{
+    thread_local FrameArena t_arena;
+    return t_arena;
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+    while (true) {
+        if (m_current < m_blocks.size()) {
+            Block& block = m_blocks[m_current];
+            const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+            const size_t offset = static_cast<size_t>(((base + m_offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base);
+            if (offset + size <= block.size) {
+                m_offset = offset + size;
+                return block.data.get() + offset;
+            }
+            if (m_current + 1 < m_blocks.size() || m_offset > 0) {
+                // Continue in next block, kept from an earlier rollback or added below
+                m_usedBefore += m_offset;
+                m_offset = 0;
+                m_current++;
+                continue;
+            }
+        }
+
+        // Overflow block, doubling the reserve. Merged into one block on next reset.
+        Block block;
+        block.size = std::max({size + alignment, m_initialSize, getCapacity()});
+        block.data.reset(new uint8_t[block.size]);
+        m_blocks.push_back(std::move(block));
+        m_current = m_blocks.size() - 1;
+    }
+}
+
+void FrameArena::reset()
+{
+    // Frame overflowed the first block, so replace all blocks with one that holds the whole frame
+    if (m_blocks.size() > 1) {
+        Block block;
+        block.size = getCapacity();
+        block.data.reset(new uint8_t[block.size]);
+        m_blocks.clear();
+        m_blocks.push_back(std::move(block));
+    }
+    m_current = 0;
+    m_offset = 0;
+    m_usedBefore = 0;
+}
+
+size_t FrameArena::getUsed() const { return m_usedBefore + m_offset; }
+
+size_t FrameArena::getCapacity() const
+{
+    size_t capacity = 0;
+    for (const auto& block : m_blocks) {
+        capacity += block.size;
+    }
+    return capacity;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//! Bump allocator for memory that lives at most until the end of the frame.
+//!
+//! Allocation is a pointer bump, and freeing is a no-op until the arena is reset at the frame
+//! boundary, or rolled back by a scope. When a frame needs more than the current block, an overflow
+//! block is allocated, and the next reset merges all blocks into one large enough for the whole
+//! frame. Once the arena has grown to the peak frame, it never touches the heap again. Blocks are never
+//! shrunk, so an arena keeps the memory of its largest frame until destroyed, and a thread arena until
+//! its thread exits.
+//!
+//! Each thread has its own arena, so thread pool workers allocate without synchronization. Workers
+//! have no frame boundary of their own, so they release with scopes.
+class FrameArena
+{
+public:
+    //! Rolls arena back to where it was on construction. Scopes must nest.
+    class Scope
+    {
+    public:
+        explicit Scope(FrameArena& arena)
+            : m_arena(arena)
+            , m_current(arena.m_current)
+            , m_offset(arena.m_offset)
+            , m_usedBefore(arena.m_usedBefore)
+        {
+        }
+
+        ~Scope()
+        {
+            m_arena.m_current = m_current;
+            m_arena.m_offset = m_offset;
+            m_arena.m_usedBefore = m_usedBefore;
+        }
+
+        Scope(const Scope& other) = delete;
+        Scope& operator=(const Scope& other) = delete;
+
+    private:
+        FrameArena& m_arena;  //!< Arena to roll back
+        size_t m_current;     //!< Current block at construction
+        size_t m_offset;      //!< Offset in current block at construction
+        size_t m_usedBefore;  //!< Bytes used before current block at construction
+    };
+
+    //! Constructor. Initial block is allocated on first use.
+    explicit FrameArena(size_t initialSize = c_defaultSize);
+
+    // Disable copy and assign
+    FrameArena(const FrameArena& other) = delete;
+    FrameArena& operator=(const FrameArena& other) = delete;
+
+    //! Returns arena of calling thread
+    static FrameArena& forThread();
+
+    //! Allocate given number of bytes with given alignment. Never returns nullptr.
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    //! Release all allocations. Call at frame boundary when nothing allocated from the arena is in use.
+    void reset();
+
+    //! Returns bytes allocated since last reset
+    size_t getUsed() const;
+
+    //! Returns bytes reserved in all blocks
+    size_t getCapacity() const;
+
+private:
+    //! Default initial block size
+    static constexpr size_t c_defaultSize = 64 * 1024;
+
+    //! Memory block
+    struct Block {
+        std::unique_ptr<uint8_t[]> data;  //!< Block memory
+        size_t size = 0;                  //!< Block size in bytes
+    };
+
+private:
+    std::vector<Block> m_blocks;  //!< Blocks in allocation order
+    size_t m_current = 0;         //!< Block allocations are made from
+    size_t m_offset = 0;          //!< Offset of next allocation in current block
+    size_t m_usedBefore = 0;      //!< Bytes used in blocks before the current one
+    size_t m_initialSize;         //!< Size of first block
+};
+
+//! STL allocator allocating from a frame arena. Deallocation is a no-op.
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(FrameArena& arena = FrameArena::forThread())
+        : m_arena(&arena)
+    {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other)
+        : m_arena(other.getArena())
+    {
+    }
+
+    T* allocate(size_t count) { return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T))); }
+
+    void deallocate(T*, size_t) {}
+
+    FrameArena* getArena() const { return m_arena; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const
+    {
+        return m_arena == other.getArena();
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const
+    {
+        return m_arena != other.getArena();
+    }
+
+private:
+    FrameArena* m_arena;  //!< Arena to allocate from
+};
+
+//! Vector allocating from a frame arena, for per frame scratch data
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
@@ -0,0 +1,506 @@
+#include "FrameIO.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#include "PixelConvert.hpp"
+#include "TraceRecorder.hpp"
+
+namespace
+{
+// Y4M stream and frame header magic
+constexpr const char* c_y4mMagic = "YUV4MPEG2";
+constexpr const char* c_y4mFrameMagic = "FRAME";
+
+// Longest accepted Y4M header line
+constexpr size_t c_maxHeaderLength = 1024;
+
+// BT.601 YUV to RGB coefficients
+constexpr float c_crToR = 1.402f;
+constexpr float c_cbToG = 0.344136f;
+constexpr float c_crToG = 0.714136f;
+constexpr float c_cbToB = 1.772f;
+
+// BT.601 luma weights
+constexpr float c_lumaR = 0.299f;
+constexpr float c_lumaG = 0.587f;
+constexpr float c_lumaB = 0.114f;
+
+inline float clamp01(float v) { return std::min(std::max(v, 0.0f), 1.0f); }
+
+// YUV range scaling. Video range maps luma to [16, 235] and chroma to [16, 240].
+struct YuvRange {
+    float lumaOffset;
+    float lumaScale;
+    float chromaScale;
+
+    explicit YuvRange(bool fullRange)
+        : lumaOffset(fullRange ? 0.0f : 16.0f)
+        , lumaScale(fullRange ? 255.0f : 219.0f)
+        , chromaScale(fullRange ? 255.0f : 224.0f)
+    {
+    }
+};
+
+// Returns true if path contains a printf style frame number
+bool isSequencePattern(const std::string& path) { return path.find('%') != std::string::npos; }
+
+// Returns file path for frame number in sequence pattern
+std::string getSequencePath(const std::string& pattern, int frameIndex)
+{
+    std::vector<char> path(pattern.size() + 32);
+    std::snprintf(path.data(), path.size(), pattern.c_str(), frameIndex);
+    return path.data();
+}
+
+// File handle closed on destruction, except for standard streams
+class File
+{
+public:
+    File() = default;
+    ~File() { close(); }
+
+    File(const File& other) = delete;
+    File& operator=(const File& other) = delete;
+
+    File(File&& other)
+        : m_file(other.m_file)
+        , m_owned(other.m_owned)
+    {
+        other.m_file = nullptr;
+    }
+
+    bool open(const std::string& path, bool write)
+    {
+        close();
+        if (path == "-") {
+            m_file = write ? stdout : stdin;
+#ifdef _WIN32
+            _setmode(_fileno(m_file), _O_BINARY);
+#endif
+            m_owned = false;
+        } else {
+            m_file = std::fopen(path.c_str(), write ? "wb" : "rb");
+            m_owned = true;
+        }
+        return m_file != nullptr;
+    }
+
+    void close()
+    {
+        if (m_file && m_owned) {
+            std::fclose(m_file);
+        }
+        m_file = nullptr;
+    }
+
+    // Read exactly size bytes. Returns number of bytes read.
+    size_t read(void* data, size_t size) { return std::fread(data, 1, size, m_file); }
+
+    // Write size bytes. Returns false on failure.
+    bool write(const void* data, size_t size) { return std::fwrite(data, 1, size, m_file) == size; }
+
+    // Read line without newline. Returns false at end of file or if line is too long.
+    bool readLine(std::string& line)
+    {
+        line.clear();
+        int c;
+        while ((c = std::fgetc(m_file)) != EOF && c != '\n') {
+            if (line.size() >= c_maxHeaderLength) {
+                return false;
+            }
+            line.push_back(static_cast<char>(c));
+        }
+        return c == '\n' || !line.empty();
+    }
+
+private:
+    FILE* m_file = nullptr;
+    bool m_owned = false;
+};
+
+// Raw RGBA8 frames, back to back in one file or one frame per numbered file
+class RawReader : public FrameReader
+{
+public:
+    RawReader(const std::string& path, int width, int height, File file, std::vector<uint8_t> prefix)
+        : m_path(path)
+        , m_file(std::move(file))
+        , m_prefix(std::move(prefix))
+    {
+        m_info.width = width;
+        m_info.height = height;
+        m_buffer.resize(static_cast<size_t>(width) * height * 4);
+    }
+
+    bool isY4M() const override { return false; }
+
+    bool read(ImageRGBA& frame) override
+    {
+        TRACE_SCOPE("RawReader::read");
+
+        if (isSequencePattern(m_path) && !m_file.open(getSequencePath(m_path, m_frameIndex), false)) {
+            return false;
+        }
+
+        // Bytes consumed while detecting the format come first
+        const size_t prefixSize = std::min(m_prefix.size(), m_buffer.size());
+        std::memcpy(m_buffer.data(), m_prefix.data(), prefixSize);
+        m_prefix.erase(m_prefix.begin(), m_prefix.begin() + prefixSize);
+
+        const size_t size = prefixSize + m_file.read(m_buffer.data() + prefixSize, m_buffer.size() - prefixSize);
+        if (size == 0) {
+            return false;
+        }
+        if (size != m_buffer.size()) {
+            throw std::runtime_error("Truncated raw frame " + std::to_string(m_frameIndex));
+        }
+        m_frameIndex++;
+
+        if (frame.width != m_info.width || frame.height != m_info.height) {
+            frame.resize(m_info.width, m_info.height);
+        }
+        const size_t pitch = static_cast<size_t>(m_info.width) * 4;
+        PixelConvert::convert(PixelFormat::RGBA8Unorm, m_buffer.data(), pitch, PixelFormat::RGBA32Float, frame.pixels.data(), pitch * sizeof(float),
+            m_info.width, m_info.height, PixelConvert::Store::Cached);
+        return true;
+    }
+
+private:
+    std::string m_path;             // File path or sequence pattern
+    File m_file;                    // Open file
+    int m_frameIndex = 0;           // Next frame number
+    std::vector<uint8_t> m_prefix;  // Bytes read ahead when detecting format
+    std::vector<uint8_t> m_buffer;  // Frame read buffer
+};
+
+// Returns chroma plane size for stream
+void getChromaSize(const FrameStreamInfo& info, int& width, int& height)
+{
+    switch (info.chroma) {
+        case FrameStreamInfo::Chroma::C420: width = (info.width + 1) / 2, height = (info.height + 1) / 2; break;
+        case FrameStreamInfo::Chroma::C444: width = info.width, height = info.height; break;
+        default: width = height = 0; break;
+    }
+}
+
+// 8-bit Y4M video
+class Y4MReader : public FrameReader
+{
+public:
+    explicit Y4MReader(File file)
+        : m_file(std::move(file))
+    {
+    }
+
+    bool isY4M() const override { return true; }
+
+    void parseHeader(const std::string& header)
+    {
+        std::istringstream tokens(header);
+        std::string token;
+        tokens >> token;
+        while (tokens >> token) {
+            const std::string value = token.substr(1);
+            switch (token[0]) {
+                case 'W': m_info.width = std::atoi(value.c_str()); break;
+                case 'H': m_info.height = std::atoi(value.c_str()); break;
+                case 'F': std::sscanf(value.c_str(), "%d:%d", &m_info.fpsNum, &m_info.fpsDen); break;
+                case 'I':
+                    if (value != "p" && value != "?") {
+                        throw std::runtime_error("Unsupported Y4M interlacing: " + value);
+                    }
+                    break;
+                case 'C':
+                    if (value == "420jpeg" || value == "420paldv" || value == "420mpeg2" || value == "420") {
+                        m_info.chroma = FrameStreamInfo::Chroma::C420;
+                    } else if (value == "444") {
+                        m_info.chroma = FrameStreamInfo::Chroma::C444;
+                    } else if (value == "mono") {
+                        m_info.chroma = FrameStreamInfo::Chroma::Mono;
+                    } else {
+                        throw std::runtime_error("Unsupported Y4M chroma format: " + value);
+                    }
+                    break;
+                case 'X':
+                    if (value == "COLORRANGE=FULL") {
+                        m_info.fullRange = true;
+                    }
+                    break;
+                default: break;
+            }
+        }
+
+        if (m_info.width <= 0 || m_info.height <= 0) {
+            throw std::runtime_error("Invalid Y4M frame size");
+        }
+        if (m_info.fpsNum <= 0 || m_info.fpsDen <= 0) {
+            m_info.fpsNum = 30, m_info.fpsDen = 1;
+        }
+
+        int chromaWidth, chromaHeight;
+        getChromaSize(m_info, chromaWidth, chromaHeight);
+        m_lumaSize = static_cast<size_t>(m_info.width) * m_info.height;
+        m_chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+        m_buffer.resize(m_lumaSize + 2 * m_chromaSize);
+    }
+
+    bool read(ImageRGBA& frame) override
+    {
+        TRACE_SCOPE("Y4MReader::read");
+
+        std::string frameHeader;
+        if (!m_file.readLine(frameHeader)) {
+            return false;
+        }
+        if (frameHeader.compare(0, std::strlen(c_y4mFrameMagic), c_y4mFrameMagic) != 0) {
+            throw std::runtime_error("Invalid Y4M frame header");
+        }
+        if (m_file.read(m_buffer.data(), m_buffer.size()) != m_buffer.size()) {
+            throw std::runtime_error("Truncated Y4M frame");
+        }
+
+        if (frame.width != m_info.width || frame.height != m_info.height) {
+            frame.resize(m_info.width, m_info.height);
+        }
+
+        const YuvRange range(m_info.fullRange);
+        const float lumaScale = 1.0f / range.lumaScale;
+        const float chromaScale = 1.0f / range.chromaScale;
+        const bool subsampled = m_info.chroma == FrameStreamInfo::Chroma::C420;
+        const int chromaWidth = subsampled ? (m_info.width + 1) / 2 : m_info.width;
+
+        const uint8_t* lumaPlane = m_buffer.data();
+        const uint8_t* cbPlane = lumaPlane + m_lumaSize;
+        const uint8_t* crPlane = cbPlane + m_chromaSize;
+
+        for (int y = 0; y < m_info.height; y++) {
+            const uint8_t* lumaRow = lumaPlane + static_cast<size_t>(y) * m_info.width;
+            const size_t chromaRow = static_cast<size_t>(subsampled ? y / 2 : y) * chromaWidth;
+            float* dst = frame.row(y);
+
+            for (int x = 0; x < m_info.width; x++) {
+                const float luma = (lumaRow[x] - range.lumaOffset) * lumaScale;
+                float cb = 0.0f;
+                float cr = 0.0f;
+                if (m_chromaSize > 0) {
+                    const size_t c = chromaRow + (subsampled ? x / 2 : x);
+                    cb = (cbPlane[c] - 128.0f) * chromaScale;
+                    cr = (crPlane[c] - 128.0f) * chromaScale;
+                }
+                dst[x * 4 + 0] = clamp01(luma + c_crToR * cr);
+                dst[x * 4 + 1] = clamp01(luma - c_cbToG * cb - c_crToG * cr);
+                dst[x * 4 + 2] = clamp01(luma + c_cbToB * cb);
+                dst[x * 4 + 3] = 1.0f;
+            }
+        }
+        return true;
+    }
+
+private:
+    File m_file;                    // Open file
+    size_t m_lumaSize = 0;          // Luma plane size in bytes
+    size_t m_chromaSize = 0;        // Chroma plane size in bytes
+    std::vector<uint8_t> m_buffer;  // Frame read buffer
+};
+
+// Raw RGBA8 frames, back to back in one file or one frame per numbered file
+class RawWriter : public FrameWriter
+{
+public:
+    RawWriter(const std::string& path, const FrameStreamInfo& info)
+        : m_path(path)
+    {
+        m_info = info;
+        m_buffer.resize(static_cast<size_t>(info.width) * info.height * 4);
+        if (!isSequencePattern(m_path) && !m_file.open(m_path, true)) {
+            throw std::runtime_error("Opening output failed: " + m_path);
+        }
+    }
+
+    void write(const ImageRGBA& frame) override
+    {
+        TRACE_SCOPE("RawWriter::write");
+
+        if (isSequencePattern(m_path)) {
+            const std::string path = getSequencePath(m_path, m_frameIndex);
+            if (!m_file.open(path, true)) {
+                throw std::runtime_error("Opening output failed: " + path);
+            }
+        }
+        m_frameIndex++;
+
+        const size_t pitch = static_cast<size_t>(m_info.width) * 4;
+        PixelConvert::convert(PixelFormat::RGBA32Float, frame.pixels.data(), pitch * sizeof(float), PixelFormat::RGBA8Unorm, m_buffer.data(), pitch,
+            m_info.width, m_info.height, PixelConvert::Store::Cached);
+        if (!m_file.write(m_buffer.data(), m_buffer.size())) {
+            throw std::runtime_error("Writing output failed: " + m_path);
+        }
+    }
+
+private:
+    std::string m_path;             // File path or sequence pattern
+    File m_file;                    // Open file
+    int m_frameIndex = 0;           // Next frame number
+    std::vector<uint8_t> m_buffer;  // Frame write buffer
+};
+
+// 8-bit Y4M video
+class Y4MWriter : public FrameWriter
+{
+public:
+    Y4MWriter(const std::string& path, const FrameStreamInfo& info)
+    {
+        m_info = info;
+        if (!m_file.open(path, true)) {
+            throw std::runtime_error("Opening output failed: " + path);
+        }
+
+        const char* chroma = "420jpeg";
+        if (info.chroma == FrameStreamInfo::Chroma::C444) {
+            chroma = "444";
+        } else if (info.chroma == FrameStreamInfo::Chroma::Mono) {
+            chroma = "mono";
+        }
+        const std::string header = std::string(c_y4mMagic) + " W" + std::to_string(info.width) + " H" + std::to_string(info.height) + " F" +
+                                   std::to_string(info.fpsNum) + ":" + std::to_string(info.fpsDen) + " Ip A1:1 C" + chroma +
+                                   (info.fullRange ? " XCOLORRANGE=FULL" : "") + "\n";
+        if (!m_file.write(header.data(), header.size())) {
+            throw std::runtime_error("Writing output failed: " + path);
+        }
+
+        int chromaWidth, chromaHeight;
+        getChromaSize(m_info, chromaWidth, chromaHeight);
+        m_lumaSize = static_cast<size_t>(m_info.width) * m_info.height;
+        m_chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+        m_buffer.resize(m_lumaSize + 2 * m_chromaSize);
+    }
+
+    void write(const ImageRGBA& frame) override
+    {
+        TRACE_SCOPE("Y4MWriter::write");
+
+        const YuvRange range(m_info.fullRange);
+        const int w = m_info.width;
+        const int h = m_info.height;
+        uint8_t* lumaPlane = m_buffer.data();
+        uint8_t* cbPlane = lumaPlane + m_lumaSize;
+        uint8_t* crPlane = cbPlane + m_chromaSize;
+
+        // Chroma differences scaled to [-0.5, 0.5]
+        const float cbScale = 0.5f / (1.0f - c_lumaB);
+        const float crScale = 0.5f / (1.0f - c_lumaR);
+        const auto luma = [](const float* p) { return c_lumaR * clamp01(p[0]) + c_lumaG * clamp01(p[1]) + c_lumaB * clamp01(p[2]); };
+        const auto chromaByte = [&range](float c) { return static_cast<uint8_t>(std::min(std::max(c * range.chromaScale + 128.0f, 0.0f), 255.0f) + 0.5f); };
+
+        for (int y = 0; y < h; y++) {
+            const float* src = frame.row(y);
+            uint8_t* lumaRow = lumaPlane + static_cast<size_t>(y) * w;
+            for (int x = 0; x < w; x++) {
+                lumaRow[x] = static_cast<uint8_t>(luma(src + x * 4) * range.lumaScale + range.lumaOffset + 0.5f);
+            }
+        }
+
+        if (m_info.chroma == FrameStreamInfo::Chroma::C444) {
+            for (int y = 0; y < h; y++) {
+                const float* src = frame.row(y);
+                for (int x = 0; x < w; x++) {
+                    const float* p = src + x * 4;
+                    const float l = luma(p);
+                    cbPlane[static_cast<size_t>(y) * w + x] = chromaByte((clamp01(p[2]) - l) * cbScale);
+                    crPlane[static_cast<size_t>(y) * w + x] = chromaByte((clamp01(p[0]) - l) * crScale);
+                }
+            }
+        } else if (m_info.chroma == FrameStreamInfo::Chroma::C420) {
+            // Average 2x2 blocks, clamped at odd edges
+            const int cw = (w + 1) / 2;
+            const int ch = (h + 1) / 2;
+            for (int cy = 0; cy < ch; cy++) {
+                for (int cx = 0; cx < cw; cx++) {
+                    float cb = 0.0f;
+                    float cr = 0.0f;
+                    for (int dy = 0; dy < 2; dy++) {
+                        const float* src = frame.row(std::min(cy * 2 + dy, h - 1));
+                        for (int dx = 0; dx < 2; dx++) {
+                            const float* p = src + std::min(cx * 2 + dx, w - 1) * 4;
+                            const float l = luma(p);
+                            cb += (clamp01(p[2]) - l) * cbScale;
+                            cr += (clamp01(p[0]) - l) * crScale;
+                        }
+                    }
+                    cbPlane[static_cast<size_t>(cy) * cw + cx] = chromaByte(0.25f * cb);
+                    crPlane[static_cast<size_t>(cy) * cw + cx] = chromaByte(0.25f * cr);
+                }
+            }
+        }
+
+        const std::string frameHeader = std::string(c_y4mFrameMagic) + "\n";
+        if (!m_file.write(frameHeader.data(), frameHeader.size()) || !m_file.write(m_buffer.data(), m_buffer.size())) {
+            throw std::runtime_error("Writing output failed");
+        }
+    }
+
+private:
+    File m_file;                    // Open file
+    size_t m_lumaSize = 0;          // Luma plane size in bytes
+    size_t m_chromaSize = 0;        // Chroma plane size in bytes
+    std::vector<uint8_t> m_buffer;  // Frame write buffer
+};
+
+}  // namespace
+
+std::unique_ptr<FrameReader> FrameReader::open(const std::string& path, int rawWidth, int rawHeight)
+{
+    // Numbered raw frame files
+    if (isSequencePattern(path)) {
+        if (rawWidth <= 0 || rawHeight <= 0) {
+            throw std::runtime_error("Raw input needs frame width and height");
+        }
+        return std::make_unique<RawReader>(path, rawWidth, rawHeight, File(), std::vector<uint8_t>());
+    }
+
+    File file;
+    if (!file.open(path, false)) {
+        throw std::runtime_error("Opening input failed: " + path);
+    }
+
+    // Detect Y4M from stream header. Streams can not seek, so bytes read ahead are passed on to raw reader.
+    const size_t magicLength = std::strlen(c_y4mMagic);
+    std::vector<uint8_t> magic(magicLength);
+    magic.resize(file.read(magic.data(), magicLength));
+
+    if (magic.size() == magicLength && std::memcmp(magic.data(), c_y4mMagic, magicLength) == 0) {
+        std::string header;
+        if (!file.readLine(header)) {
+            throw std::runtime_error("Invalid Y4M header: " + path);
+        }
+        auto reader = std::make_unique<Y4MReader>(std::move(file));
+        reader->parseHeader(c_y4mMagic + header);
+        return std::unique_ptr<FrameReader>(std::move(reader));
+    }
+
+    if (rawWidth <= 0 || rawHeight <= 0) {
+        throw std::runtime_error("Raw input needs frame width and height");
+    }
+    return std::make_unique<RawReader>(path, rawWidth, rawHeight, std::move(file), std::move(magic));
+}
+
+std::unique_ptr<FrameWriter> FrameWriter::create(const std::string& path, bool y4m, const FrameStreamInfo& info)
+{
+    if (info.width <= 0 || info.height <= 0) {
+        throw std::runtime_error("Invalid output frame size");
+    }
+    if (y4m) {
+        return std::make_unique<Y4MWriter>(path, info);
+    }
+    return std::make_unique<RawWriter>(path, info);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "FilterCPU.hpp"
+
+//! Frame stream properties
+struct FrameStreamInfo {
+    //! Chroma subsampling of YUV streams
+    enum class Chroma { C420 = 0, C444, Mono };
+
+    int width = 0;                 //!< Frame width in pixels
+    int height = 0;                //!< Frame height in pixels
+    int fpsNum = 30;               //!< Frame rate numerator
+    int fpsDen = 1;                //!< Frame rate denominator
+    Chroma chroma = Chroma::C420;  //!< Chroma subsampling, YUV streams only
+    bool fullRange = false;        //!< Full range YUV instead of video range, YUV streams only
+};
+
+//! Reads frames from raw RGBA8 files or Y4M video as float RGBA images.
+//!
+//! Y4M input is detected from the stream header, other input is read as raw RGBA8 frames of given
+//! size. A path with a printf style frame number (e.g. frame_%05d.rgba) reads numbered files until
+//! one is missing, otherwise frames are read back to back from one file. Path "-" reads stdin.
+class FrameReader
+{
+public:
+    //! Open frame stream. Throws std::runtime_error on failure.
+    static std::unique_ptr<FrameReader> open(const std::string& path, int rawWidth, int rawHeight);
+
+    //! Destructor
+    virtual ~FrameReader() = default;
+
+    //! Returns stream properties
+    const FrameStreamInfo& getInfo() const { return m_info; }
+
+    //! Returns true if stream is Y4M video
+    virtual bool isY4M() const = 0;
+
+    //! Read next frame. Returns false at end of stream. Throws std::runtime_error on truncated or invalid data.
+    virtual bool read(ImageRGBA& frame) = 0;
+
+protected:
+    FrameStreamInfo m_info;  //!< Stream properties
+};
+
+//! Writes float RGBA images as raw RGBA8 files or Y4M video. Path conventions as in FrameReader.
+class FrameWriter
+{
+public:
+    //! Create frame stream writing Y4M video or raw RGBA8 frames. Throws std::runtime_error on failure.
+    static std::unique_ptr<FrameWriter> create(const std::string& path, bool y4m, const FrameStreamInfo& info);
+
+    //! Destructor
+    virtual ~FrameWriter() = default;
+
+    //! Write frame. Throws std::runtime_error on failure.
+    virtual void write(const ImageRGBA& frame) = 0;
+
+protected:
+    FrameStreamInfo m_info;  //!< Stream properties
+};
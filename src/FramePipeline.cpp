@@ -0,0 +1,324 @@
+#include "FramePipeline.hpp"
+
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+
+#include "TraceRecorder.hpp"
+
+namespace
+{
+// Spins before a waiting node starts sleeping
+constexpr int c_spinCount = 64;
+
+// Sleep between queue polls once spinning is over. Short compared to frame times.
+constexpr auto c_waitSleep = std::chrono::microseconds(100);
+
+// Returns smallest power of two not less than value, minimum 2
+size_t roundUpPow2(size_t value)
+{
+    size_t pow2 = 2;
+    while (pow2 < value) {
+        pow2 *= 2;
+    }
+    return pow2;
+}
+
+// Wait step: yield while spinning, then sleep
+void backoff(int& spins)
+{
+    if (spins < c_spinCount) {
+        spins++;
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(c_waitSleep);
+    }
+}
+
+}  // namespace
+
+FramePipeline::FramePipeline(const Config& config)
+    : m_config(config)
+{
+    if (m_config.frameCount < 1) {
+        m_config.frameCount = 1;
+    }
+
+    // Pool never fills up, so returning frames to it never waits
+    m_pool = std::make_unique<LockFreeQueue<Frame*>>(roundUpPow2(m_config.frameCount));
+    for (size_t i = 0; i < m_config.frameCount; i++) {
+        m_frames.push_back(std::make_unique<Frame>());
+        m_pool->tryPush(m_frames.back().get());
+    }
+}
+
+FramePipeline::~FramePipeline()
+{
+    stop();
+    wait();
+}
+
+void FramePipeline::setSource(const std::string& name, const Source& source)
+{
+    if (!m_nodes.empty() && m_nodes.front()->type == NodeType::Source) {
+        m_nodes.erase(m_nodes.begin());
+    }
+    auto node = std::make_unique<Node>();
+    node->type = NodeType::Source;
+    node->name = name;
+    node->source = source;
+    m_nodes.insert(m_nodes.begin(), std::move(node));
+}
+
+void FramePipeline::addStage(const std::string& name, const Stage& stage)
+{
+    auto node = std::make_unique<Node>();
+    node->type = NodeType::Stage;
+    node->name = name;
+    node->stage = stage;
+    node->input = std::make_unique<LockFreeQueue<Frame*>>(roundUpPow2(m_config.queueCapacity));
+    const bool hasSink = !m_nodes.empty() && m_nodes.back()->type == NodeType::Sink;
+    m_nodes.insert(hasSink ? m_nodes.end() - 1 : m_nodes.end(), std::move(node));
+}
+
+void FramePipeline::setSink(const std::string& name, const Sink& sink)
+{
+    if (!m_nodes.empty() && m_nodes.back()->type == NodeType::Sink) {
+        m_nodes.pop_back();
+    }
+    auto node = std::make_unique<Node>();
+    node->type = NodeType::Sink;
+    node->name = name;
+    node->sink = sink;
+    node->input = std::make_unique<LockFreeQueue<Frame*>>(roundUpPow2(m_config.queueCapacity));
+    m_nodes.push_back(std::move(node));
+}
+
+void FramePipeline::start()
+{
+    if (m_nodes.size() < 2 || m_nodes.front()->type != NodeType::Source || m_nodes.back()->type != NodeType::Sink) {
+        throw std::logic_error("Frame pipeline needs a source and a sink.");
+    }
+
+    m_stop = false;
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+        m_nodes[i]->thread = std::thread(&FramePipeline::nodeMain, this, i);
+    }
+}
+
+void FramePipeline::stop() { m_stop = true; }
+
+bool FramePipeline::wait()
+{
+    for (auto& node : m_nodes) {
+        if (node->thread.joinable()) {
+            node->thread.join();
+        }
+    }
+
+    // Return frames left in queues after stop to the pool
+    for (auto& node : m_nodes) {
+        Frame* frame = nullptr;
+        while (node->input && node->input->tryPop(frame)) {
+            if (frame != &m_endOfStream) {
+                m_pool->tryPush(frame);
+            }
+        }
+    }
+
+    return getError().empty();
+}
+
+bool FramePipeline::run()
+{
+    start();
+    return wait();
+}
+
+std::string FramePipeline::getError() const
+{
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    return m_error;
+}
+
+std::vector<FramePipeline::NodeStats> FramePipeline::getStats() const
+{
+    std::vector<NodeStats> stats;
+    for (const auto& node : m_nodes) {
+        NodeStats s;
+        s.name = node->name;
+        s.frames = node->frames.load(std::memory_order_relaxed);
+        s.busyMs = node->busyNs.load(std::memory_order_relaxed) * 1e-6;
+        s.inputStalls = node->inputStalls.load(std::memory_order_relaxed);
+        s.outputStalls = node->outputStalls.load(std::memory_order_relaxed);
+        s.drops = node->drops.load(std::memory_order_relaxed);
+        s.queueDepth = node->input ? node->input->size() : 0;
+        s.maxQueueDepth = node->maxQueueDepth.load(std::memory_order_relaxed);
+        stats.push_back(s);
+    }
+    return stats;
+}
+
+FramePipeline::Stage FramePipeline::makeFilterStage(const FilterCPU::Params& params, const ColorLut* colorLut)
+{
+    return [params, colorLut](Frame& frame) {
+        FilterCPU::process(frame.image, frame.scratch, params, colorLut);
+        std::swap(frame.image, frame.scratch);
+    };
+}
+
+FramePipeline::Source FramePipeline::makePacedSource(const Source& source, double fps)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+    auto nextTime = std::make_shared<Clock::time_point>();
+
+    return [source, interval, nextTime](Frame& frame) {
+        // Capture clock keeps running regardless of how long the previous frame took
+        const auto now = Clock::now();
+        if (*nextTime == Clock::time_point()) {
+            *nextTime = now;
+        } else if (*nextTime > now) {
+            std::this_thread::sleep_until(*nextTime);
+        }
+        frame.latency.cameraTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(nextTime->time_since_epoch()).count();
+        *nextTime += interval;
+        return source(frame);
+    };
+}
+
+void FramePipeline::fail(const Node& node, const std::string& what)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        if (m_error.empty()) {
+            m_error = node.name + ": " + what;
+        }
+    }
+    m_stop = true;
+}
+
+bool FramePipeline::push(LockFreeQueue<Frame*>& queue, Frame* frame, Node& node)
+{
+    if (queue.tryPush(frame)) {
+        return true;
+    }
+
+    node.outputStalls.fetch_add(1, std::memory_order_relaxed);
+    int spins = 0;
+    while (!m_stop) {
+        if (queue.tryPush(frame)) {
+            return true;
+        }
+        backoff(spins);
+    }
+    return false;
+}
+
+FramePipeline::Frame* FramePipeline::pop(LockFreeQueue<Frame*>& queue, Node& node)
+{
+    Frame* frame = nullptr;
+    if (!queue.tryPop(frame)) {
+        node.inputStalls.fetch_add(1, std::memory_order_relaxed);
+        int spins = 0;
+        while (!queue.tryPop(frame)) {
+            if (m_stop) {
+                return nullptr;
+            }
+            backoff(spins);
+        }
+    }
+
+    // Depth includes the frame just taken
+    const size_t depth = queue.size() + 1;
+    if (depth > node.maxQueueDepth.load(std::memory_order_relaxed)) {
+        node.maxQueueDepth.store(depth, std::memory_order_relaxed);
+    }
+    return frame;
+}
+
+void FramePipeline::runNode(Node& node, Frame& frame)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    if (node.type == NodeType::Stage) {
+        node.stage(frame);
+    } else {
+        node.sink(frame);
+    }
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+    node.busyNs.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+    node.frames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FramePipeline::nodeMain(size_t nodeIndex)
+{
+    Node& node = *m_nodes[nodeIndex];
+    Node* next = (nodeIndex + 1 < m_nodes.size()) ? m_nodes[nodeIndex + 1].get() : nullptr;
+    TraceRecorder::instance().setThreadName(node.name.c_str());
+
+    try {
+        if (node.type == NodeType::Source) {
+            for (int64_t index = 0; !m_stop; index++) {
+                Frame* frame = nullptr;
+                if (m_config.liveSource && !m_pool->tryPop(frame)) {
+                    // Consume captured frame anyway so that the source keeps its pace
+                    m_dropFrame.index = index;
+                    if (!node.source(m_dropFrame)) {
+                        break;
+                    }
+                    node.drops.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                if (!frame && !(frame = pop(*m_pool, node))) {
+                    break;
+                }
+
+                TRACE_SCOPE("FramePipeline::source");
+                const auto startTime = std::chrono::steady_clock::now();
+                frame->index = index;
+                frame->latency = LatencyTracker::Sample();
+                frame->latency.frameNumber = index;
+                const bool more = node.source(*frame);
+                if (!more) {
+                    m_pool->tryPush(frame);
+                    break;
+                }
+                const auto endTime = std::chrono::steady_clock::now();
+                const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+
+                // Frames of sources without a capture clock are captured when read
+                if (frame->latency.cameraTimeNs == 0) {
+                    frame->latency.cameraTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime.time_since_epoch()).count();
+                }
+                node.busyNs.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+                node.frames.fetch_add(1, std::memory_order_relaxed);
+
+                if (!push(*next->input, frame, node)) {
+                    m_pool->tryPush(frame);
+                    break;
+                }
+            }
+            push(*next->input, &m_endOfStream, node);
+        } else {
+            while (Frame* frame = pop(*node.input, node)) {
+                if (frame == &m_endOfStream) {
+                    if (next) {
+                        push(*next->input, frame, node);
+                    }
+                    break;
+                }
+
+                TRACE_SCOPE("FramePipeline::node");
+                runNode(node, *frame);
+
+                // Sink returns frames to the pool, which never fills up
+                if (!(next ? push(*next->input, frame, node) : m_pool->tryPush(frame))) {
+                    m_pool->tryPush(frame);
+                    break;
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        fail(node, e.what());
+    }
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FilterCPU.hpp"
+#include "LatencyTracker.hpp"
+#include "LockFreeQueue.hpp"
+
+class ColorLut;
+
+//! Streaming frame pipeline: a source, processing stages and a sink, each running on its own thread.
+//!
+//! Nodes are connected by bounded lock-free queues. A node waits when its output queue is full, so
+//! a slow stage applies backpressure upstream and throughput is set by the slowest node instead of
+//! the sum of all nodes. Frames are recycled from a fixed pool, so memory use is bounded and
+//! nothing is allocated per frame once buffers have reached their size.
+//!
+//! Live sources never wait for a free frame. When the pool is empty the captured frame is dropped
+//! and counted, like a camera that keeps running regardless of the consumer.
+class FramePipeline
+{
+public:
+    //! Frame passed between nodes
+    struct Frame {
+        int64_t index = 0;               //!< Frame number from source
+        ImageRGBA image;                 //!< Frame contents
+        ImageRGBA scratch;               //!< Scratch image for stages that can not work in place
+        LatencyTracker::Sample latency;  //!< Capture time on the steady clock and latency events, filled in by nodes
+    };
+
+    //! Frame source. Fills given frame and returns false at end of stream.
+    using Source = std::function<bool(Frame&)>;
+
+    //! Processing stage. Transforms frame image in place, using scratch image if needed.
+    using Stage = std::function<void(Frame&)>;
+
+    //! Frame sink
+    using Sink = std::function<void(const Frame&)>;
+
+    //! Pipeline configuration
+    struct Config {
+        size_t queueCapacity = 4;  //!< Capacity of queues between nodes, rounded up to a power of two
+        size_t frameCount = 6;     //!< Frames in pool, bounds memory use
+        bool liveSource = false;   //!< Drop source frames instead of waiting when pool is empty
+    };
+
+    //! Node statistics
+    struct NodeStats {
+        std::string name;           //!< Node name
+        uint64_t frames = 0;        //!< Frames processed
+        double busyMs = 0.0;        //!< Time spent processing frames
+        uint64_t inputStalls = 0;   //!< Times node waited for input
+        uint64_t outputStalls = 0;  //!< Times node waited for space in output queue
+        uint64_t drops = 0;         //!< Frames dropped, live source only
+        size_t queueDepth = 0;      //!< Current input queue depth
+        size_t maxQueueDepth = 0;   //!< Maximum observed input queue depth, free frames for source
+    };
+
+    //! Constructor
+    explicit FramePipeline(const Config& config);
+
+    //! Destructor. Stops the pipeline.
+    ~FramePipeline();
+
+    // Disable copy and assign
+    FramePipeline(const FramePipeline& other) = delete;
+    FramePipeline& operator=(const FramePipeline& other) = delete;
+
+    //! Set frame source
+    void setSource(const std::string& name, const Source& source);
+
+    //! Append processing stage
+    void addStage(const std::string& name, const Stage& stage);
+
+    //! Set frame sink
+    void setSink(const std::string& name, const Sink& sink);
+
+    //! Start node threads. Source, stages and sink must be set.
+    void start();
+
+    //! Request stop. Frames in flight are discarded.
+    void stop();
+
+    //! Wait until source ends and all frames have reached the sink, or until stopped.
+    //! Returns false if a node failed, see getError().
+    bool wait();
+
+    //! Run pipeline to completion on node threads. Same as start() followed by wait().
+    bool run();
+
+    //! Returns error of the first failed node
+    std::string getError() const;
+
+    //! Returns node statistics in pipeline order: source, stages, sink. Safe to call while running.
+    std::vector<NodeStats> getStats() const;
+
+    //! Returns stage running CPU filter chain with given parameters
+    static Stage makeFilterStage(const FilterCPU::Params& params, const ColorLut* colorLut);
+
+    //! Returns source calling given source at fixed frame rate, standing in for live capture. Frames
+    //! are stamped with their scheduled capture time.
+    static Source makePacedSource(const Source& source, double fps);
+
+private:
+    //! Node kind
+    enum class NodeType { Source, Stage, Sink };
+
+    //! Pipeline node
+    struct Node {
+        NodeType type = NodeType::Stage;               //!< Node kind
+        std::string name;                              //!< Node name
+        Source source;                                 //!< Source function
+        Stage stage;                                   //!< Stage function
+        Sink sink;                                     //!< Sink function
+        std::unique_ptr<LockFreeQueue<Frame*>> input;  //!< Input queue, null for source
+        std::atomic<uint64_t> frames{0};               //!< Frames processed
+        std::atomic<uint64_t> busyNs{0};               //!< Time spent processing frames
+        std::atomic<uint64_t> inputStalls{0};          //!< Times waited for input
+        std::atomic<uint64_t> outputStalls{0};         //!< Times waited for output space
+        std::atomic<uint64_t> drops{0};                //!< Frames dropped
+        std::atomic<size_t> maxQueueDepth{0};          //!< Maximum observed input queue depth
+        std::thread thread;                            //!< Node thread
+    };
+
+    //! Node thread main
+    void nodeMain(size_t nodeIndex);
+
+    //! Run node function, recording busy time
+    void runNode(Node& node, Frame& frame);
+
+    //! Push frame to queue, waiting while it is full. Returns false if stopped.
+    bool push(LockFreeQueue<Frame*>& queue, Frame* frame, Node& node);
+
+    //! Pop frame from queue, waiting while it is empty. Returns nullptr if stopped.
+    Frame* pop(LockFreeQueue<Frame*>& queue, Node& node);
+
+    //! Record node failure and stop pipeline
+    void fail(const Node& node, const std::string& what);
+
+private:
+    Config m_config;                                //!< Pipeline configuration
+    std::vector<std::unique_ptr<Node>> m_nodes;     //!< Nodes in pipeline order
+    std::vector<std::unique_ptr<Frame>> m_frames;   //!< Frame pool storage
+    std::unique_ptr<LockFreeQueue<Frame*>> m_pool;  //!< Free frames
+    Frame m_endOfStream;                            //!< Marker passed downstream when source ends
+    Frame m_dropFrame;                              //!< Target for dropped live source frames
+    std::atomic<bool> m_stop{false};                //!< Stop request flag
+    mutable std::mutex m_errorMutex;                //!< Error mutex
+    std::string m_error;                            //!< Error of first failed node
+};
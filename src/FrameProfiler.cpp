@@ -0,0 +1,153 @@
+#include "FrameProfiler.hpp"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+// Linear sub-buckets per power of two: 2^5 = 32 gives ~3% precision
+constexpr int c_subBucketBits = 5;
+constexpr int c_subBucketCount = 1 << c_subBucketBits;
+
+// Stage names, must match FrameProfiler::Stage
+const char* c_stageNames[] = {
+    "Frame",
+    "CheckEvents",
+    "UpdateUI",
+    "SyncFrame",
+    "UpdatePostProcessing",
+    "TextureUpdate",
+    "SceneUpdate",
+    "LayerRender",
+    "EndFrame",
+};
+static_assert(sizeof(c_stageNames) / sizeof(c_stageNames[0]) == static_cast<size_t>(FrameProfiler::Stage::Count), "Stage names mismatch");
+
+// Index of most significant set bit
+inline int msb(uint64_t v)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+}  // namespace
+
+FrameProfiler& FrameProfiler::instance()
+{
+    static FrameProfiler s_instance;
+    return s_instance;
+}
+
+int FrameProfiler::Histogram::bucketIndex(int64_t durationNs)
+{
+    const uint64_t v = static_cast<uint64_t>(std::max<int64_t>(durationNs, 0));
+    if (v < 2 * c_subBucketCount) {
+        return static_cast<int>(v);
+    }
+
+    // Log-linear: octave selects shift, top bits select linear sub-bucket
+    const int shift = msb(v) - c_subBucketBits;
+    const int index = shift * c_subBucketCount + static_cast<int>(v >> shift);
+    return std::min(index, c_bucketCount - 1);
+}
+
+double FrameProfiler::Histogram::bucketValue(int index)
+{
+    if (index < 2 * c_subBucketCount) {
+        return static_cast<double>(index);
+    }
+
+    // Bucket midpoint
+    const int shift = index / c_subBucketCount - 1;
+    const uint64_t lower = static_cast<uint64_t>(index - shift * c_subBucketCount) << shift;
+    return static_cast<double>(lower) + 0.5 * static_cast<double>(uint64_t(1) << shift);
+}
+
+void FrameProfiler::Histogram::record(int64_t durationNs, int64_t budgetNs)
+{
+    m_buckets[bucketIndex(durationNs)].fetch_add(1, std::memory_order_relaxed);
+
+    int64_t prevMax = m_max.load(std::memory_order_relaxed);
+    while (durationNs > prevMax && !m_max.compare_exchange_weak(prevMax, durationNs, std::memory_order_relaxed)) {
+    }
+
+    if (durationNs > budgetNs) {
+        m_overBudget.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void FrameProfiler::Histogram::reset()
+{
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_max.store(0, std::memory_order_relaxed);
+    m_overBudget.store(0, std::memory_order_relaxed);
+}
+
+FrameProfiler::Stats FrameProfiler::Histogram::getStats() const
+{
+    // Take a snapshot of the buckets. Concurrent records may make the total slightly off, which is fine.
+    std::array<uint32_t, c_bucketCount> counts;
+    uint64_t total = 0;
+    for (int i = 0; i < c_bucketCount; i++) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    Stats stats;
+    stats.count = total;
+    stats.max = 1e-6 * static_cast<double>(m_max.load(std::memory_order_relaxed));
+    stats.overBudget = m_overBudget.load(std::memory_order_relaxed);
+    if (total == 0) {
+        return stats;
+    }
+
+    const double quantiles[] = {0.50, 0.95, 0.99};
+    double* results[] = {&stats.p50, &stats.p95, &stats.p99};
+
+    uint64_t accum = 0;
+    int q = 0;
+    for (int i = 0; i < c_bucketCount && q < 3; i++) {
+        accum += counts[i];
+        while (q < 3 && static_cast<double>(accum) >= quantiles[q] * static_cast<double>(total)) {
+            *results[q] = std::min(1e-6 * bucketValue(i), stats.max);
+            q++;
+        }
+    }
+
+    return stats;
+}
+
+void FrameProfiler::record(Stage stage, int64_t durationNs) { m_stages[static_cast<size_t>(stage)].record(durationNs, c_frameBudgetNs); }
+
+void FrameProfiler::reset()
+{
+    for (auto& hist : m_stages) {
+        hist.reset();
+    }
+}
+
+FrameProfiler::Stats FrameProfiler::getStats(Stage stage) const { return m_stages[static_cast<size_t>(stage)].getStats(); }
+
+const char* FrameProfiler::getStageName(Stage stage) { return c_stageNames[static_cast<size_t>(stage)]; }
+
+void FrameProfiler::writeJson(std::ostream& out) const
+{
+    out << "{\"budgetMs\":" << 1e-6 * c_frameBudgetNs << ",\"stages\":[";
+    for (int i = 0; i < static_cast<int>(Stage::Count); i++) {
+        const auto stage = static_cast<Stage>(i);
+        const auto stats = getStats(stage);
+        out << (i > 0 ? "," : "") << "{\"name\":\"" << getStageName(stage) << "\",\"count\":" << stats.count << ",\"p50Ms\":" << stats.p50
+            << ",\"p95Ms\":" << stats.p95 << ",\"p99Ms\":" << stats.p99 << ",\"maxMs\":" << stats.max << ",\"overBudget\":" << stats.overBudget << "}";
+    }
+    out << "]}";
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#include "TraceRecorder.hpp"
+
+//! Runtime per-stage frame profiler.
+//!
+//! Stage durations are recorded into lock-free log-linear histograms (HDR histogram style,
+//! ~3% bucket precision) that can be queried for percentiles from any thread. Recording is
+//! a couple of relaxed atomic increments, and nothing at all when the profiler is disabled.
+//! Stage scopes are also emitted to the TraceRecorder timeline when tracing is enabled.
+class FrameProfiler
+{
+public:
+    //! Profiled frame stages
+    enum class Stage {
+        Frame = 0,             //!< Whole UI frame
+        CheckEvents,           //!< AppLogic::checkEvents
+        UpdateUI,              //!< AppView::updateUI
+        SyncFrame,             //!< Varjo view syncFrame
+        UpdatePostProcessing,  //!< AppLogic::updatePostProcessing
+        TextureUpdate,         //!< TestTexture::update for post process input textures
+        SceneUpdate,           //!< Scene update
+        LayerRender,           //!< VR layer rendering
+        EndFrame,              //!< Varjo view endFrame
+        Count
+    };
+
+    //! Percentile statistics for a stage, times in milliseconds
+    struct Stats {
+        uint64_t count = 0;       //!< Number of samples
+        double p50 = 0.0;         //!< Median
+        double p95 = 0.0;         //!< 95th percentile
+        double p99 = 0.0;         //!< 99th percentile
+        double max = 0.0;         //!< Maximum
+        uint64_t overBudget = 0;  //!< Samples over frame budget
+    };
+
+    //! Lock-free duration histogram with percentile queries
+    class Histogram
+    {
+    public:
+        //! Record duration in nanoseconds, counting it over budget if longer than given budget
+        void record(int64_t durationNs, int64_t budgetNs);
+
+        //! Clear all recorded samples
+        void reset();
+
+        //! Returns percentile statistics
+        Stats getStats() const;
+
+    private:
+        //! Bucket count. Covers durations over a minute.
+        static constexpr int c_bucketCount = 1024;
+
+        //! Returns bucket index for given duration
+        static int bucketIndex(int64_t durationNs);
+
+        //! Returns representative duration for given bucket
+        static double bucketValue(int index);
+
+    private:
+        std::array<std::atomic<uint32_t>, c_bucketCount> m_buckets{};  //!< Sample counts per bucket
+        std::atomic<int64_t> m_max{0};                                //!< Maximum duration
+        std::atomic<uint64_t> m_overBudget{0};                        //!< Samples over budget
+    };
+
+    //! Scoped stage marker
+    class Scope
+    {
+    public:
+        explicit Scope(Stage stage)
+            : m_stage(stage)
+            , m_active(FrameProfiler::instance().isEnabled())
+            , m_traced(TraceRecorder::instance().isEnabled())
+        {
+            if (m_traced) {
+                TraceRecorder::instance().begin(getStageName(m_stage));
+            }
+            if (m_active) {
+                m_start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~Scope()
+        {
+            if (m_active) {
+                const auto duration = std::chrono::steady_clock::now() - m_start;
+                FrameProfiler::instance().record(m_stage, std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+            }
+            if (m_traced) {
+                TraceRecorder::instance().end(getStageName(m_stage));
+            }
+        }
+
+        Scope(const Scope& other) = delete;
+        Scope& operator=(const Scope& other) = delete;
+
+    private:
+        Stage m_stage;                                  //!< Profiled stage
+        bool m_active;                                  //!< Profiler enabled when scope entered
+        bool m_traced;                                  //!< Tracing enabled when scope entered
+        std::chrono::steady_clock::time_point m_start;  //!< Scope start time
+    };
+
+    //! Frame budget at 90 Hz in nanoseconds
+    static constexpr int64_t c_frameBudgetNs = 1000000000 / 90;
+
+    //! Returns profiler instance
+    static FrameProfiler& instance();
+
+    //! Enable or disable recording
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+
+    //! Returns true if recording is enabled
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    //! Record stage duration in nanoseconds. Lock-free, can be called from any thread.
+    void record(Stage stage, int64_t durationNs);
+
+    //! Clear all recorded samples
+    void reset();
+
+    //! Returns percentile statistics for given stage
+    Stats getStats(Stage stage) const;
+
+    //! Returns stage name
+    static const char* getStageName(Stage stage);
+
+    //! Write statistics for all stages as JSON
+    void writeJson(std::ostream& out) const;
+
+private:
+    //! Private constructor
+    FrameProfiler() = default;
+
+private:
+    std::atomic<bool> m_enabled{false};                                 //!< Recording enabled flag
+    std::array<Histogram, static_cast<size_t>(Stage::Count)> m_stages;  //!< Histograms per stage
+};
+
+// Profile enclosing scope as given stage
+#define PROFILE_SCOPE_CONCAT_(a, b) a##b
+#define PROFILE_SCOPE_CONCAT(a, b) PROFILE_SCOPE_CONCAT_(a, b)
+#define PROFILE_SCOPE(stage) FrameProfiler::Scope PROFILE_SCOPE_CONCAT(_profileScope, __LINE__)(FrameProfiler::Stage::stage)
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//! Non-cryptographic hashing for cache keys, checksums and machine identities
+namespace Hash
+{
+//! FNV-1a 64 bit offset basis, the seed of a new hash
+constexpr uint64_t c_fnv1aSeed = 0xcbf29ce484222325ull;
+
+//! Returns FNV-1a 64 bit hash of given bytes. Pass a previous result as seed to hash several parts.
+inline uint64_t fnv1a(const void* data, size_t size, uint64_t seed = c_fnv1aSeed)
+{
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+}  // namespace Hash
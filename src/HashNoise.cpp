@@ -0,0 +1,217 @@
+#include "HashNoise.hpp"
+
+#include <algorithm>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <emmintrin.h>
+#define HASH_NOISE_SSE2 1
+#else
+#define HASH_NOISE_SSE2 0
+#endif
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+#include <arm_neon.h>
+#define HASH_NOISE_NEON 1
+#else
+#define HASH_NOISE_NEON 0
+#endif
+
+namespace
+{
+// Hash function in the common subset of HLSL and GLSL. Must match HashNoise::hash exactly.
+const char* c_shaderSource = R"(
+// pcg4d hash of pixel coordinate, frame number and seed
+uint4 hashNoise(uint4 v)
+{
+    v = v * 1664525u + 1013904223u;
+    v.x += v.y * v.w;
+    v.y += v.z * v.x;
+    v.z += v.x * v.y;
+    v.w += v.y * v.z;
+    v = v ^ (v >> 16u);
+    v.x += v.y * v.w;
+    v.y += v.z * v.x;
+    v.z += v.x * v.y;
+    v.w += v.y * v.z;
+    return v;
+}
+
+// Hash value as 8-bit unorm, top 8 bits
+float4 hashNoiseUnorm8(uint4 v) { return float4(v >> 24u) / 255.0; }
+
+// Hash value as float in [0, 1), top 24 bits
+float4 hashNoiseFloat(uint4 v) { return float4(v >> 8u) * (1.0 / 16777216.0); }
+)";
+
+// Pixels hashed per chunk before conversion to the target format
+constexpr int c_chunkSize = 64;
+
+// Single lane fallback
+struct ScalarOps {
+    using V = uint32_t;
+    static constexpr int c_width = 1;
+
+    static V set1(uint32_t v) { return v; }
+    static V ramp(uint32_t v) { return v; }
+    static V add(V a, V b) { return a + b; }
+    static V mul(V a, V b) { return a * b; }
+    static V xorShift16(V a) { return a ^ (a >> 16); }
+    static void store(V a, uint32_t* dst) { dst[0] = a; }
+};
+
+#if HASH_NOISE_SSE2
+
+// Four lanes with SSE2. There is no 32-bit multiply low before SSE4.1, so it is made from two 64-bit multiplies.
+struct Sse2Ops {
+    using V = __m128i;
+    static constexpr int c_width = 4;
+
+    static V set1(uint32_t v) { return _mm_set1_epi32(static_cast<int>(v)); }
+    static V ramp(uint32_t v) { return _mm_add_epi32(set1(v), _mm_setr_epi32(0, 1, 2, 3)); }
+    static V add(V a, V b) { return _mm_add_epi32(a, b); }
+    static V xorShift16(V a) { return _mm_xor_si128(a, _mm_srli_epi32(a, 16)); }
+    static void store(V a, uint32_t* dst) { _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), a); }
+
+    static V mul(V a, V b)
+    {
+        const __m128i even = _mm_mul_epu32(a, b);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+};
+
+#endif
+
+#if HASH_NOISE_NEON
+
+// Four lanes with NEON, always available on ARM64
+struct NeonOps {
+    using V = uint32x4_t;
+    static constexpr int c_width = 4;
+
+    static V set1(uint32_t v) { return vdupq_n_u32(v); }
+    static V add(V a, V b) { return vaddq_u32(a, b); }
+    static V mul(V a, V b) { return vmulq_u32(a, b); }
+    static V xorShift16(V a) { return veorq_u32(a, vshrq_n_u32(a, 16)); }
+    static void store(V a, uint32_t* dst) { vst1q_u32(dst, a); }
+
+    static V ramp(uint32_t v)
+    {
+        const uint32_t offsets[4] = {0, 1, 2, 3};
+        return vaddq_u32(set1(v), vld1q_u32(offsets));
+    }
+};
+
+#endif
+
+// Hash chunk of pixels starting at x with given lane operations, channels to separate arrays
+template <typename Ops>
+void hashChunk(uint32_t x, uint32_t y, uint32_t frame, uint32_t seed, uint32_t (&out)[4][c_chunkSize])
+{
+    using V = typename Ops::V;
+    const V multiplier = Ops::set1(1664525u);
+    const V increment = Ops::set1(1013904223u);
+
+    for (int i = 0; i < c_chunkSize; i += Ops::c_width) {
+        V v[4] = {Ops::ramp(x + i), Ops::set1(y), Ops::set1(frame), Ops::set1(seed)};
+        for (auto& c : v) {
+            c = Ops::add(Ops::mul(c, multiplier), increment);
+        }
+        v[0] = Ops::add(v[0], Ops::mul(v[1], v[3]));
+        v[1] = Ops::add(v[1], Ops::mul(v[2], v[0]));
+        v[2] = Ops::add(v[2], Ops::mul(v[0], v[1]));
+        v[3] = Ops::add(v[3], Ops::mul(v[1], v[2]));
+        for (auto& c : v) {
+            c = Ops::xorShift16(c);
+        }
+        v[0] = Ops::add(v[0], Ops::mul(v[1], v[3]));
+        v[1] = Ops::add(v[1], Ops::mul(v[2], v[0]));
+        v[2] = Ops::add(v[2], Ops::mul(v[0], v[1]));
+        v[3] = Ops::add(v[3], Ops::mul(v[1], v[2]));
+        for (int c = 0; c < 4; c++) {
+            Ops::store(v[c], &out[c][i]);
+        }
+    }
+}
+
+// Hash chunk with widest lane operations available
+void hashChunk(uint32_t x, uint32_t y, uint32_t frame, uint32_t seed, bool simd, uint32_t (&out)[4][c_chunkSize])
+{
+#if HASH_NOISE_SSE2
+    if (simd) {
+        hashChunk<Sse2Ops>(x, y, frame, seed, out);
+        return;
+    }
+#elif HASH_NOISE_NEON
+    if (simd) {
+        hashChunk<NeonOps>(x, y, frame, seed, out);
+        return;
+    }
+#endif
+    hashChunk<ScalarOps>(x, y, frame, seed, out);
+}
+
+// Generate texture region converting hash values with given function
+template <typename T, typename Convert>
+void generateTexture(
+    uint32_t frame, uint32_t seed, int x0, int y0, int width, int height, int numChannels, T* target, size_t rowPitch, bool simd, Convert convert)
+{
+    numChannels = std::min(std::max(numChannels, 0), 4);
+    uint32_t values[4][c_chunkSize];
+
+    for (int y = 0; y < height; y++) {
+        T* row = reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(target) + y * rowPitch);
+        for (int x = 0; x < width; x += c_chunkSize) {
+            hashChunk(static_cast<uint32_t>(x0 + x), static_cast<uint32_t>(y0 + y), frame, seed, simd, values);
+
+            // Interleave channels. Hashes past the row end are computed but not written.
+            const int count = std::min(c_chunkSize, width - x);
+            T* dst = row + x * numChannels;
+            for (int i = 0; i < count; i++) {
+                for (int c = 0; c < numChannels; c++) {
+                    dst[i * numChannels + c] = convert(values[c][i]);
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+namespace HashNoise
+{
+void generate(uint32_t frame, uint32_t seed, int width, int height, int numChannels, uint8_t* target, size_t rowPitch, bool simd)
+{
+    generateRegion(frame, seed, 0, 0, width, height, numChannels, target, rowPitch, simd);
+}
+
+void generate(uint32_t frame, uint32_t seed, int width, int height, int numChannels, float* target, size_t rowPitch, bool simd)
+{
+    generateRegion(frame, seed, 0, 0, width, height, numChannels, target, rowPitch, simd);
+}
+
+void generate(uint32_t frame, uint32_t seed, int width, int height, int numChannels, uint32_t* target, size_t rowPitch, bool simd)
+{
+    generateRegion(frame, seed, 0, 0, width, height, numChannels, target, rowPitch, simd);
+}
+
+void generateRegion(uint32_t frame, uint32_t seed, int x0, int y0, int width, int height, int numChannels, uint8_t* target, size_t rowPitch, bool simd)
+{
+    generateTexture(frame, seed, x0, y0, width, height, numChannels, target, rowPitch, simd, toUnorm8);
+}
+
+void generateRegion(uint32_t frame, uint32_t seed, int x0, int y0, int width, int height, int numChannels, float* target, size_t rowPitch, bool simd)
+{
+    generateTexture(frame, seed, x0, y0, width, height, numChannels, target, rowPitch, simd, toFloat);
+}
+
+void generateRegion(uint32_t frame, uint32_t seed, int x0, int y0, int width, int height, int numChannels, uint32_t* target, size_t rowPitch, bool simd)
+{
+    generateTexture(frame, seed, x0, y0, width, height, numChannels, target, rowPitch, simd, [](uint32_t v) { return v; });
+}
+
+bool isSimdAvailable() { return HASH_NOISE_SSE2 || HASH_NOISE_NEON; }
+
+const char* getShaderSource() { return c_shaderSource; }
+
+}  // namespace HashNoise
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//! Counter based integer hash noise, identical on CPU and GPU.
+//!
+//! Each pixel hashes its coordinate, frame number and seed with the pcg4d permutation into four
+//! independent 32-bit values, one per channel. There is no generator state, so any pixel of any
+//! frame can be generated on demand and in any order, and the same function in shader source
+//! gives bit identical textures on the GPU. Values map to 8-bit unorm as the top 8 bits and to
+//! float as the top 24 bits, both of which are exact on every target.
+namespace HashNoise
+{
+//! Default seed
+constexpr uint32_t c_defaultSeed = 0x9e3779b9u;
+
+//! Hash pixel coordinate, frame number and seed to four 32-bit values (pcg4d)
+inline void hash(uint32_t x, uint32_t y, uint32_t frame, uint32_t seed, uint32_t out[4])
+{
+    uint32_t v[4] = {x, y, frame, seed};
+    for (auto& c : v) {
+        c = c * 1664525u + 1013904223u;
+    }
+    v[0] += v[1] * v[3];
+    v[1] += v[2] * v[0];
+    v[2] += v[0] * v[1];
+    v[3] += v[1] * v[2];
+    for (auto& c : v) {
+        c ^= c >> 16;
+    }
+    v[0] += v[1] * v[3];
+    v[1] += v[2] * v[0];
+    v[2] += v[0] * v[1];
+    v[3] += v[1] * v[2];
+    for (int i = 0; i < 4; i++) {
+        out[i] = v[i];
+    }
+}
+
+//! Returns 8-bit unorm value of hash value. GPU writes it as float(value) / 255, which converts back exactly.
+inline uint8_t toUnorm8(uint32_t v) { return static_cast<uint8_t>(v >> 24); }
+
+//! Returns float value in [0, 1) of hash value. 24 bits fit the float mantissa, so conversion is exact.
+inline float toFloat(uint32_t v) { return static_cast<float>(v >> 8) * (1.0f / 16777216.0f); }
+
+//! Generate 8-bit unorm noise texture of given size, row pitch in bytes. Up to four channels.
+//! SIMD is used if available unless disabled, results are identical either way.
+void generate(uint32_t frame, uint32_t seed, int width, int height, int numChannels, uint8_t* target, size_t rowPitch, bool simd = true);
+
+//! Generate float noise texture of given size, row pitch in bytes. Up to four channels.
+void generate(uint32_t frame, uint32_t seed, int width, int height, int numChannels, float* target, size_t rowPitch, bool simd = true);
+
+//! Generate texture of raw hash values of given size, row pitch in bytes. Up to four channels.
+void generate(uint32_t frame, uint32_t seed, int width, int height, int numChannels, uint32_t* target, size_t rowPitch, bool simd = true);
+
+//! Generate region of 8-bit unorm noise texture with top left pixel at x0, y0. Target points to the top left pixel.
+//! Regions of a frame can be generated in any order and in parallel.
+void generateRegion(uint32_t frame, uint32_t seed, int x0, int y0, int width, int height, int numChannels, uint8_t* target, size_t rowPitch,
+    bool simd = true);
+
+//! Generate region of float noise texture with top left pixel at x0, y0. Target points to the top left pixel.
+void generateRegion(uint32_t frame, uint32_t seed, int x0, int y0, int width, int height, int numChannels, float* target, size_t rowPitch,
+    bool simd = true);
+
+//! Generate region of raw hash value texture with top left pixel at x0, y0. Target points to the top left pixel.
+void generateRegion(uint32_t frame, uint32_t seed, int x0, int y0, int width, int height, int numChannels, uint32_t* target, size_t rowPitch,
+    bool simd = true);
+
+//! Returns true if generate uses SIMD on this build
+bool isSimdAvailable();
+
+//! Returns shader source of the hash and value conversion functions. The source is valid HLSL, and valid
+//! GLSL when uint4 and float4 are defined as uvec4 and vec4.
+const char* getShaderSource();
+
+}  // namespace HashNoise
@@ -0,0 +1,186 @@
+#include "KernelBank.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+using KernelBank::Kernel;
+using KernelBank::Shape;
+
+constexpr double c_pi = 3.14159265358979323846;
+constexpr double c_ln2 = 0.69314718055994530942;
+
+// Gaussian sigma in texels times cutoff in cycles per texel: sqrt(ln(2) / 2) / pi. The Gaussian
+// response exp(-2 pi^2 sigma^2 f^2) is one half at the cutoff.
+constexpr double c_gaussianSigmaScale = 0.18739543378889630;
+
+// Gaussian radius in sigmas
+constexpr double c_gaussianExtent = 3.0;
+
+// Lanczos window lobes of the sinc kernel
+constexpr double c_sincLobes = 2.0;
+
+// The std math functions are not constexpr, so the bank is generated with these in double precision.
+
+// Returns e^x for x <= 0: argument halved below one half in magnitude, Taylor series, then squared back
+constexpr double constExp(double x)
+{
+    int halvings = 0;
+    while (x < -0.5) {
+        x *= 0.5;
+        halvings++;
+    }
+    double sum = 1.0;
+    double term = 1.0;
+    for (int n = 1; n < 20; n++) {
+        term *= x / n;
+        sum += term;
+    }
+    for (int i = 0; i < halvings; i++) {
+        sum *= sum;
+    }
+    return sum;
+}
+
+// Returns sin(x): argument reduced to [-pi, pi], then Taylor series
+constexpr double constSin(double x)
+{
+    while (x > c_pi) {
+        x -= 2.0 * c_pi;
+    }
+    while (x < -c_pi) {
+        x += 2.0 * c_pi;
+    }
+    double sum = x;
+    double term = x;
+    for (int n = 1; n < 20; n++) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+// Returns normalized sinc, sin(pi x) / (pi x)
+constexpr double constSinc(double x) { return x == 0.0 ? 1.0 : constSin(c_pi * x) / (c_pi * x); }
+
+// Returns smallest integer not less than non-negative x
+constexpr int constCeil(double x) { return static_cast<int>(x) < x ? static_cast<int>(x) + 1 : static_cast<int>(x); }
+
+// Returns x rounded to nearest integer, halves away from zero
+constexpr int constRound(double x) { return x < 0.0 ? -static_cast<int>(-x + 0.5) : static_cast<int>(x + 0.5); }
+
+// Returns cutoff in cycles per tap of bank entry index: 0.5 * 2^(-index / entries per octave)
+constexpr double getCutoff(int index) { return 0.5 * constExp(-index * c_ln2 / KernelBank::c_entriesPerOctave); }
+
+// Returns kernel radius for cutoff: Gaussian reaches to three sigma, sinc to the taps inside the window
+constexpr int getRadius(Shape shape, double cutoff)
+{
+    return shape == Shape::Gaussian ? constCeil(c_gaussianExtent * c_gaussianSigmaScale / cutoff) : constCeil(c_sincLobes / (2.0 * cutoff)) - 1;
+}
+
+// Generate kernel of given shape for bank entry index
+constexpr Kernel makeKernel(Shape shape, int index)
+{
+    Kernel kernel{};
+    const double cutoff = getCutoff(index);
+    const double sigma = c_gaussianSigmaScale / cutoff;
+    const double window = c_sincLobes / (2.0 * cutoff);
+    kernel.cutoff = static_cast<float>(cutoff);
+    kernel.radius = getRadius(shape, cutoff) < KernelBank::c_maxRadius ? getRadius(shape, cutoff) : KernelBank::c_maxRadius;
+
+    double weights[KernelBank::c_maxTaps]{};
+    double sum = 0.0;
+    for (int t = -kernel.radius; t <= kernel.radius; t++) {
+        const double x = t;
+        const double w = shape == Shape::Gaussian ? constExp(-0.5 * (x / sigma) * (x / sigma))
+                                                  : 2.0 * cutoff * constSinc(2.0 * cutoff * x) * constSinc(x / window);
+        weights[t + kernel.radius] = w;
+        sum += w;
+    }
+
+    // Normalize, then quantize with the rounding error of the sum moved to the center tap
+    const int one = 1 << KernelBank::c_fixedShift;
+    int fixedSum = 0;
+    for (int i = 0; i <= 2 * kernel.radius; i++) {
+        kernel.weights[i] = static_cast<float>(weights[i] / sum);
+        kernel.fixedWeights[i] = static_cast<int16_t>(constRound(weights[i] / sum * one));
+        fixedSum += kernel.fixedWeights[i];
+    }
+    kernel.fixedWeights[kernel.radius] = static_cast<int16_t>(kernel.fixedWeights[kernel.radius] + one - fixedSum);
+    return kernel;
+}
+
+// Each kernel is a constant of its own, so that compile time evaluation limits apply per kernel
+template <int Index>
+constexpr Kernel c_gaussianKernel = makeKernel(Shape::Gaussian, Index);
+
+template <int Index>
+constexpr Kernel c_sincKernel = makeKernel(Shape::Sinc, Index);
+
+// Table of bank kernels, all Gaussian entries followed by all sinc entries
+template <int... Index>
+constexpr std::array<const Kernel*, 2 * KernelBank::c_entryCount> makeTable(std::integer_sequence<int, Index...>)
+{
+    return {{&c_gaussianKernel<Index>..., &c_sincKernel<Index>...}};
+}
+
+constexpr auto c_kernels = makeTable(std::make_integer_sequence<int, KernelBank::c_entryCount>());
+
+// Returns true if fixed point weights of all kernels sum to exactly one
+constexpr bool isFixedNormalized()
+{
+    for (size_t k = 0; k < c_kernels.size(); k++) {
+        int sum = 0;
+        for (int i = 0; i < KernelBank::c_maxTaps; i++) {
+            sum += c_kernels[k]->fixedWeights[i];
+        }
+        if (sum != 1 << KernelBank::c_fixedShift) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(isFixedNormalized(), "Fixed point kernel weights must sum to one");
+static_assert(getRadius(Shape::Gaussian, getCutoff(KernelBank::c_entryCount - 1)) <= KernelBank::c_maxRadius &&
+                  getRadius(Shape::Sinc, getCutoff(KernelBank::c_entryCount - 1)) <= KernelBank::c_maxRadius,
+    "Widest kernels must fit without truncation");
+
+const char* const c_shapeNames[] = {"gaussian", "sinc"};
+
+}  // namespace
+
+const KernelBank::Kernel& KernelBank::getKernel(Shape shape, int index)
+{
+    const int clamped = std::min(std::max(index, 0), c_entryCount - 1);
+    return *c_kernels[(shape == Shape::Sinc ? c_entryCount : 0) + clamped];
+}
+
+KernelBank::Lookup KernelBank::find(Shape shape, float cutoff, float ppd, int tapStride, int maxRadius)
+{
+    // Entry position on the logarithmic grid for the cutoff in cycles per tap at the tap stride
+    const int stride = std::max(tapStride, 1);
+    const float cyclesPerTap = std::max(cutoff, 1e-6f) / std::max(ppd, 1e-6f) * stride;
+    const float position = std::max(c_entriesPerOctave * std::log2(0.5f / cyclesPerTap), 0.0f);
+
+    // Cutoffs below the bank spread taps by whole octaves
+    const float last = static_cast<float>(c_entryCount - 1);
+    int octaves = position > last + 0.5f ? std::min(static_cast<int>(std::ceil((position - last - 0.5f) / c_entriesPerOctave)), 16) : 0;
+    int index = static_cast<int>(std::lround(position)) - octaves * c_entriesPerOctave;
+
+    // Kernels over the radius limit spread taps by further octaves
+    while (getKernel(shape, index).radius > maxRadius && index >= c_entriesPerOctave && octaves < 16) {
+        index -= c_entriesPerOctave;
+        octaves++;
+    }
+    return {&getKernel(shape, index), static_cast<float>(stride * (1 << octaves))};
+}
+
+const char* KernelBank::getName(Shape shape)
+{
+    const size_t index = static_cast<size_t>(shape);
+    return index < static_cast<size_t>(Shape::Count) ? c_shapeNames[index] : "unknown";
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+
+//! Bank of normalized separable low pass kernels generated at compile time.
+//!
+//! Kernels are stored for cutoff frequencies in cycles per texel on a logarithmic grid of
+//! c_entriesPerOctave entries per octave from Nyquist down. A kernel for cutoff c with taps s texels
+//! apart is the same as the kernel for cutoff c * s with taps one texel apart, so lower cutoffs use
+//! the bank kernels with taps spread out by whole octaves, like the tap stride of the box filter.
+//! Filters look kernels up once per frame by cutoff in cycles per degree and view pixels per degree.
+//!
+//! The CPU engine reads the float weights directly and the shader gets the same floats through the
+//! constant buffer, so both filter with identical weights. Weights are also quantized to fixed point
+//! with c_fixedShift fraction bits, rounded so that each kernel sums to exactly one.
+namespace KernelBank
+{
+//! Kernel shapes
+enum class Shape {
+    Gaussian = 0,  //!< Gaussian with half amplitude response at the cutoff, three sigma radius
+    Sinc,          //!< Sinc low pass windowed by the two lobe Lanczos window
+    Count
+};
+
+//! Largest kernel radius in taps
+constexpr int c_maxRadius = 16;
+
+//! Largest number of taps
+constexpr int c_maxTaps = 2 * c_maxRadius + 1;
+
+//! Bank entries per octave of cutoff
+constexpr int c_entriesPerOctave = 4;
+
+//! Bank entries per shape, cutoffs 0.5 to 1/16 cycles per texel
+constexpr int c_entryCount = 3 * c_entriesPerOctave + 1;
+
+//! Fraction bits of fixed point weights
+constexpr int c_fixedShift = 14;
+
+//! Pixels per degree of Varjo XR-3 views. Same as FilterCPU::calculateKernelParameters.
+constexpr float c_defaultPpd = 70.0f;
+
+//! Kernel of one bank entry
+struct Kernel {
+    float cutoff;                     //!< Cutoff frequency in cycles per tap
+    int radius;                       //!< Taps on each side of the center tap
+    float weights[c_maxTaps];         //!< Weights of taps -radius..radius at index tap + radius, sum is one
+    int16_t fixedWeights[c_maxTaps];  //!< Weights in fixed point, sum is exactly 1 << c_fixedShift
+};
+
+//! Kernel and tap spacing found for a cutoff
+struct Lookup {
+    const Kernel* kernel;  //!< Bank kernel
+    float step;            //!< Tap spacing in texels
+};
+
+//! Returns bank kernel of given shape and entry index, clamped to the bank
+const Kernel& getKernel(Shape shape, int index);
+
+//! Returns kernel nearest to given cutoff in cycles per degree for a view of given pixels per degree.
+//! Taps are at least tap stride texels apart, like the box filter taps with adaptive quality. Kernels
+//! wider than max radius are replaced by the kernel an octave higher with taps twice as far apart.
+Lookup find(Shape shape, float cutoff, float ppd, int tapStride = 1, int maxRadius = c_maxRadius);
+
+//! Returns name of shape
+const char* getName(Shape shape);
+
+}  // namespace KernelBank
@@ -0,0 +1,120 @@
+#include "LatencyTracker.hpp"
+
+#include <chrono>
+
+namespace
+{
+// Event names, must match LatencyTracker::Event
+const char* c_eventNames[] = {
+    "Sync",
+    "Apply",
+    "Submit",
+};
+static_assert(sizeof(c_eventNames) / sizeof(c_eventNames[0]) == static_cast<size_t>(LatencyTracker::Event::Count), "Event names mismatch");
+
+}  // namespace
+
+LatencyTracker::LatencyTracker(const Clock& clock, int64_t budgetNs)
+    : m_clock(clock)
+    , m_budgetNs(budgetNs)
+{
+    m_timeline.reserve(c_timelineSize);
+}
+
+LatencyTracker::Clock LatencyTracker::makeSteadyClock()
+{
+    return []() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); };
+}
+
+void LatencyTracker::beginFrame(int64_t frameNumber)
+{
+    m_frame = Sample();
+    m_frame.frameNumber = frameNumber;
+    m_frame.cameraTimeNs = m_cameraTimeNs.load(std::memory_order_relaxed);
+    mark(Event::Sync);
+}
+
+void LatencyTracker::mark(Event event)
+{
+    // Nothing to correlate with before the first camera image
+    if (m_frame.cameraTimeNs > 0) {
+        m_frame.latencyNs[static_cast<size_t>(event)] = m_clock() - m_frame.cameraTimeNs;
+    }
+}
+
+void LatencyTracker::endFrame()
+{
+    if (m_frame.cameraTimeNs > 0) {
+        addSample(m_frame);
+    }
+}
+
+void LatencyTracker::addSample(const Sample& sample)
+{
+    for (size_t i = 0; i < static_cast<size_t>(Event::Count); i++) {
+        if (sample.latencyNs[i] >= 0) {
+            m_histograms[i].record(sample.latencyNs[i], m_budgetNs);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_timelineMutex);
+    if (m_timeline.size() < c_timelineSize) {
+        m_timeline.push_back(sample);
+    } else {
+        m_timeline[m_timelineNext] = sample;
+    }
+    m_timelineNext = (m_timelineNext + 1) % c_timelineSize;
+}
+
+FrameProfiler::Stats LatencyTracker::getStats(Event event) const { return m_histograms[static_cast<size_t>(event)].getStats(); }
+
+std::vector<LatencyTracker::Sample> LatencyTracker::getTimeline() const
+{
+    std::lock_guard<std::mutex> lock(m_timelineMutex);
+    if (m_timeline.size() < c_timelineSize) {
+        return m_timeline;
+    }
+    std::vector<Sample> timeline(m_timeline.begin() + m_timelineNext, m_timeline.end());
+    timeline.insert(timeline.end(), m_timeline.begin(), m_timeline.begin() + m_timelineNext);
+    return timeline;
+}
+
+void LatencyTracker::reset()
+{
+    for (auto& histogram : m_histograms) {
+        histogram.reset();
+    }
+    std::lock_guard<std::mutex> lock(m_timelineMutex);
+    m_timeline.clear();
+    m_timelineNext = 0;
+}
+
+const char* LatencyTracker::getEventName(Event event) { return c_eventNames[static_cast<size_t>(event)]; }
+
+void LatencyTracker::writeJson(std::ostream& out) const
+{
+    out << "{\"budgetMs\":" << 1e-6 * m_budgetNs << ",\"events\":[";
+    for (int i = 0; i < static_cast<int>(Event::Count); i++) {
+        const auto event = static_cast<Event>(i);
+        const auto stats = getStats(event);
+        out << (i > 0 ? "," : "") << "{\"name\":\"" << getEventName(event) << "\",\"count\":" << stats.count << ",\"p50Ms\":" << stats.p50
+            << ",\"p95Ms\":" << stats.p95 << ",\"p99Ms\":" << stats.p99 << ",\"maxMs\":" << stats.max << ",\"overBudget\":" << stats.overBudget << "}";
+    }
+
+    // Timeline rows: frame number, camera timestamp and age at each event, -1 if not recorded
+    out << "],\"timelineColumns\":[\"frame\",\"cameraTimeNs\"";
+    for (int i = 0; i < static_cast<int>(Event::Count); i++) {
+        out << ",\"" << getEventName(static_cast<Event>(i)) << "Ms\"";
+    }
+    out << "],\"timeline\":[";
+    const auto timeline = getTimeline();
+    for (size_t i = 0; i < timeline.size(); i++) {
+        const auto& sample = timeline[i];
+        out << (i > 0 ? "," : "") << "[" << sample.frameNumber << "," << sample.cameraTimeNs;
+        for (size_t e = 0; e < static_cast<size_t>(Event::Count); e++) {
+            out << "," << (sample.latencyNs[e] >= 0 ? 1e-6 * sample.latencyNs[e] : -1.0);
+        }
+        out << "]";
+    }
+    out << "]}";
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "FrameProfiler.hpp"
+
+//! Motion-to-photon latency tracker for the video pass through.
+//!
+//! Camera image timestamps are correlated with frame loop events on the same clock: the age of the
+//! latest camera image is recorded at frame sync, post process apply and frame submit. Ages go to
+//! lock-free per event histograms and to a timeline of recent frames. The clock is injected, so
+//! that replay can drive the tracker with a stand-in clock instead of a Varjo session.
+class LatencyTracker
+{
+public:
+    //! Clock returning time in nanoseconds, in the same time base as camera timestamps
+    using Clock = std::function<int64_t()>;
+
+    //! Tracked frame events
+    enum class Event {
+        Sync = 0,  //!< Frame sync, frame loop starts working on the latest camera image
+        Apply,     //!< Post process parameters applied
+        Submit,    //!< Frame submitted
+        Count
+    };
+
+    //! Per frame timeline sample
+    struct Sample {
+        int64_t frameNumber = 0;                                              //!< Frame number
+        int64_t cameraTimeNs = 0;                                             //!< Camera image timestamp, 0 if unknown
+        int64_t latencyNs[static_cast<size_t>(Event::Count)] = {-1, -1, -1};  //!< Camera image age at each event, -1 if not recorded
+    };
+
+    //! Default latency budget from camera exposure to submit in nanoseconds
+    static constexpr int64_t c_defaultBudgetNs = 20000000;
+
+    //! Timeline length in frames, ten seconds at 90 Hz
+    static constexpr size_t c_timelineSize = 900;
+
+    //! Constructor
+    explicit LatencyTracker(const Clock& clock, int64_t budgetNs = c_defaultBudgetNs);
+
+    //! Returns clock reading the steady clock, standing in for the Varjo clock in replay
+    static Clock makeSteadyClock();
+
+    //! Set timestamp of latest camera image. Can be called from any thread, e.g. a camera stream callback.
+    void setCameraTime(int64_t timeNs) { m_cameraTimeNs.store(timeNs, std::memory_order_relaxed); }
+
+    //! Begin frame in frame loop. Takes latest camera timestamp and records sync event.
+    void beginFrame(int64_t frameNumber);
+
+    //! Record event of frame begun with beginFrame()
+    void mark(Event event);
+
+    //! End frame begun with beginFrame() and add it to histograms and timeline
+    void endFrame();
+
+    //! Add complete frame sample to histograms and timeline. Can be called from any thread.
+    void addSample(const Sample& sample);
+
+    //! Returns current clock time in nanoseconds
+    int64_t now() const { return m_clock(); }
+
+    //! Returns latency budget in nanoseconds
+    int64_t getBudgetNs() const { return m_budgetNs; }
+
+    //! Returns latency statistics for given event. Can be called from any thread.
+    FrameProfiler::Stats getStats(Event event) const;
+
+    //! Returns recent frames, oldest first
+    std::vector<Sample> getTimeline() const;
+
+    //! Clear histograms and timeline
+    void reset();
+
+    //! Returns event name
+    static const char* getEventName(Event event);
+
+    //! Write statistics and timeline as JSON
+    void writeJson(std::ostream& out) const;
+
+private:
+    const Clock m_clock;                                                       //!< Clock in camera time base
+    const int64_t m_budgetNs;                                                  //!< Latency budget
+    std::atomic<int64_t> m_cameraTimeNs{0};                                    //!< Latest camera image timestamp
+    Sample m_frame;                                                            //!< Frame begun with beginFrame()
+    FrameProfiler::Histogram m_histograms[static_cast<size_t>(Event::Count)];  //!< Latency histograms per event
+    mutable std::mutex m_timelineMutex;                                        //!< Timeline mutex
+    std::vector<Sample> m_timeline;                                            //!< Recent frames ring buffer
+    size_t m_timelineNext = 0;                                                 //!< Next ring buffer slot
+};
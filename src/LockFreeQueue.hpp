@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+//! Bounded lock-free multi-producer multi-consumer queue (Vyukov). Capacity must be a power of two.
+//!
+//! Elements live in preallocated cells and are written and read in place, so pushing and popping
+//! never allocates. Push fails instead of blocking when the queue is full.
+template <typename T>
+class LockFreeQueue
+{
+public:
+    //! Constructor
+    explicit LockFreeQueue(size_t capacity)
+        : m_cells(new Cell[capacity])
+        , m_mask(capacity - 1)
+    {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("Queue capacity must be a power of two.");
+        }
+        for (size_t i = 0; i < capacity; i++) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Disable copy and assign
+    LockFreeQueue(const LockFreeQueue& other) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue& other) = delete;
+
+    //! Returns queue capacity
+    size_t capacity() const { return m_mask + 1; }
+
+    //! Returns approximate number of queued elements
+    size_t size() const
+    {
+        const size_t enqueuePos = m_enqueuePos.load(std::memory_order_relaxed);
+        const size_t dequeuePos = m_dequeuePos.load(std::memory_order_relaxed);
+        return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+    }
+
+    //! Push element by writing it in place with writer(T&). Returns false if queue is full.
+    template <typename Writer>
+    bool tryPushWith(Writer&& writer)
+    {
+        Cell* cell;
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &m_cells[pos & m_mask];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        writer(cell->data);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! Push element. Returns false if queue is full.
+    bool tryPush(T value)
+    {
+        return tryPushWith([&](T& data) { data = std::move(value); });
+    }
+
+    //! Pop element by reading it in place with reader(T&). Returns false if queue is empty.
+    template <typename Reader>
+    bool tryPopWith(Reader&& reader)
+    {
+        Cell* cell;
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &m_cells[pos & m_mask];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        reader(cell->data);
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! Pop element. Returns false if queue is empty.
+    bool tryPop(T& value)
+    {
+        return tryPopWith([&](T& data) { value = std::move(data); });
+    }
+
+private:
+    //! Queue cell
+    struct Cell {
+        std::atomic<size_t> sequence{0};  //!< Cell sequence number
+        T data{};                         //!< Cell data
+    };
+
+    std::unique_ptr<Cell[]> m_cells;             //!< Preallocated cells
+    const size_t m_mask;                         //!< Capacity - 1
+    alignas(64) std::atomic<size_t> m_enqueuePos{0};  //!< Next enqueue position
+    alignas(64) std::atomic<size_t> m_dequeuePos{0};  //!< Next dequeue position
+};
@@ -19,6 +19,14 @@ void MultiGfxContext::init(IDXGIAdapter* adapter)
     initD3D12(adapter);
 }
 
+void MultiGfxContext::makeCurrentGL(bool current)
+{
+    // GL context can be current on one thread at a time
+    if (wglMakeCurrent(current ? getDC() : NULL, current ? m_hglrc : NULL) == false) {
+        CRITICAL("Failed to change current OpenGL context.");
+    }
+}
+
 void MultiGfxContext::initD3D12(IDXGIAdapter* adapter)
 {
     HRESULT hr = 0;
@@ -26,6 +26,9 @@ public:
     //! Initialize gfx sessions
     void init(IDXGIAdapter* adapter) override;
 
+    //! Make GL context current on the calling thread or release it from the calling thread
+    void makeCurrentGL(bool current);
+
     //! Returns D3D12 command queue
     ComPtr<ID3D12CommandQueue> getD3D12CommandQueue() const { return m_d3d12Queue; }
 
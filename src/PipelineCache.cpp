@@ -0,0 +1,118 @@
+#include "PipelineCache.hpp"
+
+#include <algorithm>
+
+#include "TraceRecorder.hpp"
+
+// VarjoExamples namespace contains simple example wrappers for using Varjo API features.
+// These are only meant to be used in SDK example applications. In your own application,
+// use your own production quality integration layer.
+using namespace VarjoExamples;
+
+PipelineCache::PipelineCache(const Factory& factory)
+    : m_factory(factory)
+{
+}
+
+PipelineCache::~PipelineCache()
+{
+    if (m_buildThread.joinable()) {
+        m_buildThread.join();
+    }
+}
+
+bool PipelineCache::isBackgroundSafe(PostProcess::GraphicsAPI graphicsAPI)
+{
+    // D3D devices are free threaded. GL objects can only be created with the context current.
+    return graphicsAPI == PostProcess::GraphicsAPI::D3D11 || graphicsAPI == PostProcess::GraphicsAPI::D3D12;
+}
+
+PipelineCache::Entry* PipelineCache::find(const Key& key)
+{
+    const auto it = std::find_if(m_entries.begin(), m_entries.end(), [&key](const std::unique_ptr<Entry>& e) { return e->key == key; });
+    return it != m_entries.end() ? it->get() : nullptr;
+}
+
+void PipelineCache::prebuild(const std::vector<Key>& keys)
+{
+    // Previous background build must finish before starting a new one
+    if (m_buildThread.joinable()) {
+        m_buildThread.join();
+    }
+
+    std::vector<Key> backgroundKeys;
+    std::vector<Key> localKeys;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& key : keys) {
+            if (find(key)) {
+                continue;
+            }
+            m_entries.push_back(std::make_unique<Entry>());
+            m_entries.back()->key = key;
+            (isBackgroundSafe(key.graphicsAPI) ? backgroundKeys : localKeys).push_back(key);
+        }
+    }
+
+    if (!backgroundKeys.empty()) {
+        LOG_DEBUG("Prebuilding %d pipelines in background..", static_cast<int>(backgroundKeys.size()));
+        m_buildThread = std::thread(&PipelineCache::buildMain, this, std::move(backgroundKeys));
+    }
+
+    for (const auto& key : localKeys) {
+        build(key);
+    }
+}
+
+void PipelineCache::buildMain(std::vector<Key> keys)
+{
+    TraceRecorder::instance().setThreadName("PipelineBuild");
+
+    for (const auto& key : keys) {
+        build(key);
+    }
+}
+
+void PipelineCache::build(const Key& key)
+{
+    TRACE_SCOPE("PipelineCache::build");
+
+    std::unique_ptr<TestTexture> texture = m_factory(key);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry* entry = find(key);
+    if (!entry) {
+        m_entries.push_back(std::make_unique<Entry>());
+        entry = m_entries.back().get();
+        entry->key = key;
+    }
+    entry->state = texture ? State::Built : State::Failed;
+    entry->texture = std::move(texture);
+    m_builtCond.notify_all();
+}
+
+TestTexture* PipelineCache::get(const Key& key)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const Entry* entry = find(key);
+        if (entry) {
+            m_builtCond.wait(lock, [entry] { return entry->state != State::Queued; });
+            return entry->texture.get();
+        }
+    }
+
+    // Not prebuilt, build now
+    LOG_DEBUG("Pipeline not in cache, building..");
+    build(key);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return find(key)->texture.get();
+}
+
+size_t PipelineCache::getBuiltCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<size_t>(
+        std::count_if(m_entries.begin(), m_entries.end(), [](const std::unique_ptr<Entry>& e) { return e->state == State::Built; }));
+}
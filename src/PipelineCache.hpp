@@ -0,0 +1,86 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "PostProcess.hpp"
+#include "TestTexture.hpp"
+
+//! Cache of prebuilt post process input texture pipelines (generator shaders and GPU resources)
+//! per graphics API and texture type.
+//!
+//! Pipelines are built ahead of time so that switching between them does not compile or create
+//! anything. Pipelines for APIs with free threaded devices are built on a background thread, others
+//! on the thread requesting the prebuild, which must have the API context current.
+class PipelineCache
+{
+public:
+    //! Pipeline key
+    struct Key {
+        VarjoExamples::PostProcess::GraphicsAPI graphicsAPI;  //!< Graphics API
+        TestTexture::Type textureType;                        //!< Texture type
+
+        bool operator==(const Key& other) const { return graphicsAPI == other.graphicsAPI && textureType == other.textureType; }
+    };
+
+    //! Pipeline factory. Returns nullptr on failure.
+    using Factory = std::function<std::unique_ptr<TestTexture>(const Key&)>;
+
+    //! Constructor
+    explicit PipelineCache(const Factory& factory);
+
+    //! Destructor. Waits for background build to finish.
+    ~PipelineCache();
+
+    // Disable copy and assign
+    PipelineCache(const PipelineCache& other) = delete;
+    PipelineCache& operator=(const PipelineCache& other) = delete;
+
+    //! Build given pipelines ahead of time. Keys already in cache are skipped.
+    void prebuild(const std::vector<Key>& keys);
+
+    //! Returns pipeline for given key, building it on the calling thread if not in cache.
+    //! Waits if the pipeline is being built in background. Returns nullptr if building failed.
+    TestTexture* get(const Key& key);
+
+    //! Returns number of pipelines built
+    size_t getBuiltCount() const;
+
+private:
+    //! Pipeline build state
+    enum class State {
+        Queued = 0,  //!< Waiting for background build
+        Built,       //!< Built successfully
+        Failed,      //!< Building failed
+    };
+
+    //! Cache entry
+    struct Entry {
+        Key key;                               //!< Pipeline key
+        State state = State::Queued;           //!< Build state
+        std::unique_ptr<TestTexture> texture;  //!< Built pipeline
+    };
+
+    //! Returns true if pipelines for given API can be built on a background thread
+    static bool isBackgroundSafe(VarjoExamples::PostProcess::GraphicsAPI graphicsAPI);
+
+    //! Returns entry for key or nullptr. Call with mutex held.
+    Entry* find(const Key& key);
+
+    //! Build pipeline and store it to entry for key
+    void build(const Key& key);
+
+    //! Background build thread main
+    void buildMain(std::vector<Key> keys);
+
+private:
+    Factory m_factory;                              //!< Pipeline factory
+    mutable std::mutex m_mutex;                     //!< Entry list mutex
+    std::condition_variable m_builtCond;            //!< Signaled when entry build finishes
+    std::vector<std::unique_ptr<Entry>> m_entries;  //!< Cache entries
+    std::thread m_buildThread;                      //!< Background build thread
+};
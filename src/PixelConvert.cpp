@@ -0,0 +1,496 @@
+#include "PixelConvert.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <emmintrin.h>
+#define PIXEL_CONVERT_SSE2 1
+#else
+#define PIXEL_CONVERT_SSE2 0
+#endif
+
+namespace
+{
+// Pixels converted per chunk. Chunk bytes are a multiple of 16 in every format.
+constexpr int c_chunkSize = 64;
+
+constexpr float c_unorm8Scale = 1.0f / 255.0f;
+
+// Clamp to [0, 1], NaN to zero like the SSE2 path
+inline float saturate(float v) { return v > 0.0f ? (v < 1.0f ? v : 1.0f) : 0.0f; }
+
+// Load and store of unaligned values
+template <typename T>
+inline T load(const uint8_t* src)
+{
+    T value;
+    std::memcpy(&value, src, sizeof(T));
+    return value;
+}
+
+template <typename T>
+inline void store(uint8_t* dst, T value)
+{
+    std::memcpy(dst, &value, sizeof(T));
+}
+
+// Float bits of 2^-13, below the first sRGB encode threshold. Encode buckets start here.
+constexpr uint32_t c_srgbMinBits = (127u - 13u) << 23;
+
+// Encode bucket of float bits: exponent and top 8 mantissa bits. Relative bucket width is 2^-8, less than
+// the relative distance of sRGB thresholds, so a bucket holds at most one threshold.
+constexpr int c_srgbBucketShift = 15;
+constexpr int c_srgbBucketCount = ((0x3f800000u - c_srgbMinBits) >> c_srgbBucketShift) + 1;
+
+// sRGB transfer tables. Decoding is a lookup. Encoding finds the code whose linear value is nearest,
+// so decoded values encode back to the same code.
+struct SrgbTables {
+    float decode[256];                      // Linear value of code
+    float threshold[256];                   // Linear value from which code k + 1 is nearer than code k, infinity for the last code
+    uint8_t bucketCode[c_srgbBucketCount];  // Code at start of encode bucket
+
+    SrgbTables()
+    {
+        double linear[256];
+        for (int i = 0; i < 256; i++) {
+            const double c = i / 255.0;
+            linear[i] = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+            decode[i] = static_cast<float>(linear[i]);
+        }
+        for (int i = 0; i < 255; i++) {
+            threshold[i] = static_cast<float>(0.5 * (linear[i] + linear[i + 1]));
+        }
+        threshold[255] = std::numeric_limits<float>::infinity();
+
+        for (int i = 0; i < c_srgbBucketCount; i++) {
+            const uint32_t bits = c_srgbMinBits + (static_cast<uint32_t>(i) << c_srgbBucketShift);
+            float v;
+            std::memcpy(&v, &bits, sizeof(v));
+            bucketCode[i] = static_cast<uint8_t>(std::upper_bound(threshold, threshold + 255, v) - threshold);
+        }
+    }
+};
+
+const SrgbTables& getSrgbTables()
+{
+    static const SrgbTables tables;
+    return tables;
+}
+
+inline uint8_t encodeSrgb(const SrgbTables& tables, float v)
+{
+    v = saturate(v);
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    if (bits < c_srgbMinBits) {
+        return 0;
+    }
+    const uint32_t code = tables.bucketCode[(bits - c_srgbMinBits) >> c_srgbBucketShift];
+    return static_cast<uint8_t>(code + (v >= tables.threshold[code] ? 1 : 0));
+}
+
+#if PIXEL_CONVERT_SSE2
+
+// Half float bits in 32-bit lanes to floats
+inline __m128 halfToFloat4(__m128i h)
+{
+    const __m128i expMant = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+    const __m128i sign = _mm_slli_epi32(_mm_xor_si128(h, expMant), 16);
+    const __m128i notInfNan = _mm_cmpgt_epi32(_mm_set1_epi32(0x7bff), expMant);
+
+    // Rebias exponent by multiplying, which also normalizes denormals
+    const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+    const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMant, 13)), magic);
+    const __m128 infNanExp = _mm_andnot_ps(_mm_castsi128_ps(notInfNan), _mm_castsi128_ps(_mm_set1_epi32(255 << 23)));
+    return _mm_or_ps(scaled, _mm_or_ps(_mm_castsi128_ps(sign), infNanExp));
+}
+
+// Floats to half float bits in 32-bit lanes, sign extended from bit 15, round to nearest even
+inline __m128i floatToHalf4(__m128 f)
+{
+    const __m128 justSign = _mm_and_ps(f, _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u))));
+    const __m128 absF = _mm_xor_ps(f, justSign);
+    const __m128i absInt = _mm_castps_si128(absF);
+
+    // Infinity for overflow, quiet NaN for NaN
+    const __m128i isRegular = _mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), absInt);
+    const __m128i nanBit = _mm_and_si128(_mm_castps_si128(_mm_cmpunord_ps(absF, absF)), _mm_set1_epi32(0x200));
+    const __m128i infOrNan = _mm_or_si128(nanBit, _mm_set1_epi32(0x7c00));
+
+    // Denormal results: adding a magic value rounds the mantissa in place
+    const __m128i isDenormal = _mm_cmpgt_epi32(_mm_set1_epi32((127 - 14) << 23), absInt);
+    const __m128i denormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absF, _mm_castsi128_ps(denormalMagic))), denormalMagic);
+
+    // Normal results: rebias exponent and round, biased up by one if the result mantissa is odd
+    const __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(absInt, 31 - 13), 31);
+    const __m128i rounded = _mm_sub_epi32(_mm_add_epi32(absInt, _mm_set1_epi32(0xfff - ((127 - 15) << 23))), mantissaOdd);
+    const __m128i normal = _mm_srli_epi32(rounded, 13);
+
+    const __m128i finite = _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, normal));
+    const __m128i joined = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, infOrNan));
+    return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(justSign), 16));
+}
+
+// Floats to 8-bit unorm values in 32-bit lanes
+inline __m128i floatToUnorm8x4(const float* src)
+{
+    const __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+#endif
+
+// Value kernels over n values. SIMD handles blocks of 16 bytes or values, scalar code the rest.
+
+void unorm8ToFloat(const uint8_t* src, int n, float* dst, bool simd)
+{
+    int i = 0;
+#if PIXEL_CONVERT_SSE2
+    if (simd) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 scale = _mm_set1_ps(c_unorm8Scale);
+        for (; i + 16 <= n; i += 16) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+            const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+            _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+            _mm_storeu_ps(dst + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+            _mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = src[i] * c_unorm8Scale;
+    }
+}
+
+void floatToUnorm8(const float* src, int n, uint8_t* dst, bool simd)
+{
+    int i = 0;
+#if PIXEL_CONVERT_SSE2
+    if (simd) {
+        for (; i + 16 <= n; i += 16) {
+            const __m128i lo = _mm_packs_epi32(floatToUnorm8x4(src + i), floatToUnorm8x4(src + i + 4));
+            const __m128i hi = _mm_packs_epi32(floatToUnorm8x4(src + i + 8), floatToUnorm8x4(src + i + 12));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = static_cast<uint8_t>(saturate(src[i]) * 255.0f + 0.5f);
+    }
+}
+
+void halfToFloat(const uint8_t* src, int n, float* dst, bool simd)
+{
+    int i = 0;
+#if PIXEL_CONVERT_SSE2
+    if (simd) {
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 8 <= n; i += 8) {
+            const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * sizeof(uint16_t)));
+            _mm_storeu_ps(dst + i, halfToFloat4(_mm_unpacklo_epi16(h, zero)));
+            _mm_storeu_ps(dst + i + 4, halfToFloat4(_mm_unpackhi_epi16(h, zero)));
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = PixelConvert::halfToFloat(load<uint16_t>(src + i * sizeof(uint16_t)));
+    }
+}
+
+void floatToHalf(const float* src, int n, uint8_t* dst, bool simd)
+{
+    int i = 0;
+#if PIXEL_CONVERT_SSE2
+    if (simd) {
+        for (; i + 8 <= n; i += 8) {
+            const __m128i h = _mm_packs_epi32(floatToHalf4(_mm_loadu_ps(src + i)), floatToHalf4(_mm_loadu_ps(src + i + 4)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * sizeof(uint16_t)), h);
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        store(dst + i * sizeof(uint16_t), PixelConvert::floatToHalf(src[i]));
+    }
+}
+
+// Single channel to RGBA and back
+
+void expandRed(const float* red, int count, float* rgba)
+{
+    for (int i = 0; i < count; i++) {
+        rgba[i * 4 + 0] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = red[i];
+        rgba[i * 4 + 3] = 1.0f;
+    }
+}
+
+void extractRed(const float* rgba, int count, float* red)
+{
+    for (int i = 0; i < count; i++) {
+        red[i] = rgba[i * 4];
+    }
+}
+
+// Format decoders to count RGBA float pixels and encoders from them
+
+void decodeRgba8Unorm(const uint8_t* src, int count, float* rgba, bool simd) { unorm8ToFloat(src, count * 4, rgba, simd); }
+
+void decodeRgba8Srgb(const uint8_t* src, int count, float* rgba, bool)
+{
+    const SrgbTables& tables = getSrgbTables();
+    for (int i = 0; i < count * 4; i += 4) {
+        rgba[i + 0] = tables.decode[src[i + 0]];
+        rgba[i + 1] = tables.decode[src[i + 1]];
+        rgba[i + 2] = tables.decode[src[i + 2]];
+        rgba[i + 3] = src[i + 3] * c_unorm8Scale;
+    }
+}
+
+void decodeA8Unorm(const uint8_t* src, int count, float* rgba, bool simd)
+{
+    float red[c_chunkSize];
+    unorm8ToFloat(src, count, red, simd);
+    expandRed(red, count, rgba);
+}
+
+void decodeR32Float(const uint8_t* src, int count, float* rgba, bool)
+{
+    float red[c_chunkSize];
+    std::memcpy(red, src, count * sizeof(float));
+    expandRed(red, count, rgba);
+}
+
+void decodeRgba32Float(const uint8_t* src, int count, float* rgba, bool) { std::memcpy(rgba, src, count * 4 * sizeof(float)); }
+
+void decodeRgba16Float(const uint8_t* src, int count, float* rgba, bool simd) { halfToFloat(src, count * 4, rgba, simd); }
+
+void encodeRgba8Unorm(const float* rgba, int count, uint8_t* dst, bool simd) { floatToUnorm8(rgba, count * 4, dst, simd); }
+
+void encodeRgba8Srgb(const float* rgba, int count, uint8_t* dst, bool)
+{
+    const SrgbTables& tables = getSrgbTables();
+    for (int i = 0; i < count * 4; i += 4) {
+        dst[i + 0] = encodeSrgb(tables, rgba[i + 0]);
+        dst[i + 1] = encodeSrgb(tables, rgba[i + 1]);
+        dst[i + 2] = encodeSrgb(tables, rgba[i + 2]);
+        dst[i + 3] = static_cast<uint8_t>(saturate(rgba[i + 3]) * 255.0f + 0.5f);
+    }
+}
+
+void encodeA8Unorm(const float* rgba, int count, uint8_t* dst, bool simd)
+{
+    float red[c_chunkSize];
+    extractRed(rgba, count, red);
+    floatToUnorm8(red, count, dst, simd);
+}
+
+void encodeR32Float(const float* rgba, int count, uint8_t* dst, bool)
+{
+    float red[c_chunkSize];
+    extractRed(rgba, count, red);
+    std::memcpy(dst, red, count * sizeof(float));
+}
+
+void encodeRgba32Float(const float* rgba, int count, uint8_t* dst, bool) { std::memcpy(dst, rgba, count * 4 * sizeof(float)); }
+
+void encodeRgba16Float(const float* rgba, int count, uint8_t* dst, bool simd) { floatToHalf(rgba, count * 4, dst, simd); }
+
+// Format properties and kernels, in PixelFormat order
+struct FormatInfo {
+    const char* name;
+    int channels;
+    size_t pixelSize;
+    void (*decode)(const uint8_t* src, int count, float* rgba, bool simd);
+    void (*encode)(const float* rgba, int count, uint8_t* dst, bool simd);
+};
+
+const FormatInfo c_formats[] = {
+    {"rgba8", 4, 4, decodeRgba8Unorm, encodeRgba8Unorm},
+    {"rgba8-srgb", 4, 4, decodeRgba8Srgb, encodeRgba8Srgb},
+    {"a8", 1, 1, decodeA8Unorm, encodeA8Unorm},
+    {"r32f", 1, 4, decodeR32Float, encodeR32Float},
+    {"r32u", 1, 4, decodeR32Float, encodeR32Float},
+    {"rgba32f", 4, 16, decodeRgba32Float, encodeRgba32Float},
+    {"rgba16f", 4, 8, decodeRgba16Float, encodeRgba16Float},
+};
+static_assert(sizeof(c_formats) / sizeof(c_formats[0]) == static_cast<size_t>(PixelFormat::Count), "Format table must match PixelFormat");
+
+const FormatInfo* getInfo(PixelFormat format)
+{
+    const auto index = static_cast<size_t>(format);
+    return index < static_cast<size_t>(PixelFormat::Count) ? &c_formats[index] : nullptr;
+}
+
+bool isFloatAligned(const void* ptr) { return reinterpret_cast<uintptr_t>(ptr) % alignof(float) == 0; }
+
+// Copy bytes with non-temporal stores for the 16 byte aligned part of the target
+void copyStreaming(uint8_t* dst, const uint8_t* src, size_t bytes)
+{
+#if PIXEL_CONVERT_SSE2
+    const size_t head = std::min(bytes, (16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15);
+    std::memcpy(dst, src, head);
+    size_t i = head;
+    for (; i + 16 <= bytes; i += 16) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+    }
+    std::memcpy(dst + i, src + i, bytes - i);
+#else
+    std::memcpy(dst, src, bytes);
+#endif
+}
+
+}  // namespace
+
+namespace PixelConvert
+{
+int getChannelCount(PixelFormat format)
+{
+    const FormatInfo* info = getInfo(format);
+    return info ? info->channels : 0;
+}
+
+size_t getPixelSize(PixelFormat format)
+{
+    const FormatInfo* info = getInfo(format);
+    return info ? info->pixelSize : 0;
+}
+
+const char* getName(PixelFormat format)
+{
+    const FormatInfo* info = getInfo(format);
+    return info ? info->name : "invalid";
+}
+
+size_t getRowPitch(PixelFormat format, int width, size_t alignment)
+{
+    const size_t bytes = getPixelSize(format) * static_cast<size_t>(std::max(width, 0));
+    return (bytes + alignment - 1) & ~(alignment - 1);
+}
+
+bool convert(
+    PixelFormat srcFormat, const void* src, size_t srcPitch, PixelFormat dstFormat, void* dst, size_t dstPitch, int width, int height, Store store, bool simd)
+{
+    const FormatInfo* srcInfo = getInfo(srcFormat);
+    const FormatInfo* dstInfo = getInfo(dstFormat);
+    if (!srcInfo || !dstInfo) {
+        return false;
+    }
+
+    const bool streaming = PIXEL_CONVERT_SSE2 && (store == Store::Streaming || (store == Store::Auto && dstPitch * height >= c_streamingThreshold));
+    const size_t dstRowBytes = dstInfo->pixelSize * width;
+
+    alignas(16) float chunk[c_chunkSize * 4];
+    alignas(16) uint8_t staging[c_chunkSize * 16];
+
+    for (int y = 0; y < height; y++) {
+        const uint8_t* srcRow = static_cast<const uint8_t*>(src) + y * srcPitch;
+        uint8_t* dstRow = static_cast<uint8_t*>(dst) + y * dstPitch;
+
+        // Same format is a copy
+        if (srcFormat == dstFormat) {
+            if (streaming) {
+                copyStreaming(dstRow, srcRow, dstRowBytes);
+            } else {
+                std::memcpy(dstRow, srcRow, dstRowBytes);
+            }
+            continue;
+        }
+
+        for (int x = 0; x < width; x += c_chunkSize) {
+            const int count = std::min(c_chunkSize, width - x);
+            const uint8_t* srcPixels = srcRow + x * srcInfo->pixelSize;
+            uint8_t* dstPixels = dstRow + x * dstInfo->pixelSize;
+            uint8_t* target = streaming ? staging : dstPixels;
+
+            // Working float format is read or written in place instead of through the chunk
+            if (srcFormat == PixelFormat::RGBA32Float && isFloatAligned(srcPixels)) {
+                dstInfo->encode(reinterpret_cast<const float*>(srcPixels), count, target, simd);
+            } else if (dstFormat == PixelFormat::RGBA32Float && isFloatAligned(target)) {
+                srcInfo->decode(srcPixels, count, reinterpret_cast<float*>(target), simd);
+            } else {
+                srcInfo->decode(srcPixels, count, chunk, simd);
+                dstInfo->encode(chunk, count, target, simd);
+            }
+
+            if (streaming) {
+                copyStreaming(dstPixels, staging, count * dstInfo->pixelSize);
+            }
+        }
+    }
+
+#if PIXEL_CONVERT_SSE2
+    // Make non-temporal stores visible before the target is used, for example by an upload
+    if (streaming) {
+        _mm_sfence();
+    }
+#endif
+    return true;
+}
+
+uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint32_t result;
+    if (bits >= (127u + 16u) << 23) {
+        // Overflow to infinity, NaN to quiet NaN
+        result = bits > 0x7f800000u ? 0x7e00u : 0x7c00u;
+    } else if (bits < (127u - 14u) << 23) {
+        // Denormal or zero: adding a magic value rounds the mantissa in place
+        const uint32_t magicBits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+        float magic;
+        float absValue;
+        std::memcpy(&magic, &magicBits, sizeof(magic));
+        std::memcpy(&absValue, &bits, sizeof(absValue));
+        absValue += magic;
+        std::memcpy(&result, &absValue, sizeof(result));
+        result -= magicBits;
+    } else {
+        // Normal: rebias exponent and round to nearest even
+        const uint32_t mantissaOdd = (bits >> 13) & 1u;
+        bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xfffu + mantissaOdd;
+        result = bits >> 13;
+    }
+    return static_cast<uint16_t>(result | (sign >> 16));
+}
+
+float halfToFloat(uint16_t value)
+{
+    constexpr uint32_t shiftedExp = 0x7c00u << 13;
+    uint32_t bits = (value & 0x7fffu) << 13;
+    const uint32_t exp = bits & shiftedExp;
+    bits += (127u - 15u) << 23;
+
+    if (exp == shiftedExp) {
+        // Infinity or NaN
+        bits += (128u - 16u) << 23;
+    } else if (exp == 0) {
+        // Zero or denormal: renormalize by subtracting the implicit one
+        const uint32_t magicBits = 113u << 23;
+        float magic;
+        float f;
+        bits += 1u << 23;
+        std::memcpy(&magic, &magicBits, sizeof(magic));
+        std::memcpy(&f, &bits, sizeof(f));
+        f -= magic;
+        std::memcpy(&bits, &f, sizeof(bits));
+    }
+    bits |= static_cast<uint32_t>(value & 0x8000u) << 16;
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+bool isSimdAvailable() { return PIXEL_CONVERT_SSE2; }
+
+}  // namespace PixelConvert
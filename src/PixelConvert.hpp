@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//! Pixel formats of post process textures. The first five match the Varjo texture formats the
+//! application handles, the last two are working formats for CPU side processing.
+enum class PixelFormat {
+    RGBA8Unorm = 0,  //!< varjo_TextureFormat_R8G8B8A8_UNORM
+    RGBA8Srgb,       //!< varjo_TextureFormat_R8G8B8A8_SRGB, color channels sRGB encoded, alpha linear
+    A8Unorm,         //!< varjo_MaskTextureFormat_A8_UNORM
+    R32Float,        //!< varjo_TextureFormat_R32_FLOAT
+    R32Uint,         //!< varjo_TextureFormat_R32_UINT holding float bits, the post process shader reads it as float
+    RGBA32Float,     //!< Working format, 4 floats per pixel like ImageRGBA
+    RGBA16Float,     //!< Working format, 4 IEEE half floats per pixel
+    Count
+};
+
+//! Conversion between pixel formats with SIMD kernels.
+//!
+//! Rows are converted in chunks through linear RGBA floats that stay in L1 cache, so each format
+//! needs one decoder and one encoder instead of a kernel per format pair. Single channel formats
+//! map to the red channel: expanding writes the value to red, green and blue with alpha one, and
+//! reducing keeps red. Unorm and half float conversions round to nearest and give identical
+//! results with and without SIMD. Rows may have any pitch, for example a D3D12 upload footprint,
+//! and large targets can be written with non-temporal stores that bypass the cache.
+namespace PixelConvert
+{
+//! Store mode for the target
+enum class Store {
+    Auto = 0,   //!< Streaming for targets of at least c_streamingThreshold bytes
+    Cached,     //!< Regular stores
+    Streaming,  //!< Non-temporal stores where alignment allows
+};
+
+//! Target size from which Store::Auto uses non-temporal stores. Larger than a typical L2 cache,
+//! so the target would be evicted before anyone reads it back from cache anyway.
+constexpr size_t c_streamingThreshold = 4 * 1024 * 1024;
+
+//! Returns number of channels of format
+int getChannelCount(PixelFormat format);
+
+//! Returns bytes per pixel of format
+size_t getPixelSize(PixelFormat format);
+
+//! Returns short name of format
+const char* getName(PixelFormat format);
+
+//! Returns row pitch in bytes of given width rounded up to alignment, which must be a power of two.
+//! Use D3D12_TEXTURE_DATA_PITCH_ALIGNMENT for D3D12 upload footprints.
+size_t getRowPitch(PixelFormat format, int width, size_t alignment = 1);
+
+//! Convert image of given size between formats, pitches in bytes. Returns false if a format is invalid.
+//! SIMD is used if available unless disabled, results are identical either way.
+bool convert(PixelFormat srcFormat, const void* src, size_t srcPitch, PixelFormat dstFormat, void* dst, size_t dstPitch, int width, int height,
+    Store store = Store::Auto, bool simd = true);
+
+//! Returns half float bits of float, round to nearest even
+uint16_t floatToHalf(float value);
+
+//! Returns float value of half float bits
+float halfToFloat(uint16_t value);
+
+//! Returns true if convert uses SIMD on this build
+bool isSimdAvailable();
+
+}  // namespace PixelConvert
@@ -0,0 +1,120 @@
+#include "QualityController.hpp"
+
+#include <algorithm>
+
+namespace
+{
+// Quality ladder from full quality down. Reusing the noise texture is barely visible, so it goes
+// first, then low pass taps are thinned out.
+const std::vector<QualityController::Level> c_levels = {
+    {1, 1},
+    {1, 2},
+    {2, 2},
+    {2, 4},
+    {3, 4},
+    {4, 8},
+};
+
+// Smoothing factor of frame work time moving average
+constexpr double c_smoothing = 0.1;
+
+// Frame interval over this factor of the budget is a missed frame
+constexpr double c_missedIntervalFactor = 1.5;
+
+// Over budget frames needed for stepping down. Decays by one on each frame within budget.
+constexpr int c_downFrames = 4;
+
+// Smoothed work time under this factor of the budget counts as headroom
+constexpr double c_headroomFactor = 0.75;
+
+// Consecutive headroom frames needed for stepping up, two seconds at 90 Hz
+constexpr int c_upFrames = 180;
+
+// Upper limit of headroom frames needed for stepping up after oscillation
+constexpr int c_maxUpFrames = 16 * c_upFrames;
+
+// Frames to wait after a level change for its effect to show in measurements
+constexpr int c_settleFrames = 10;
+
+}  // namespace
+
+QualityController::QualityController(double budgetMs)
+    : m_levels(c_levels)
+    , m_budgetMs(budgetMs)
+    , m_upFrames(c_upFrames)
+{
+}
+
+bool QualityController::addFrame(double workMs, double intervalMs)
+{
+    m_smoothedMs = (m_metricFrames.load(std::memory_order_relaxed) == 0) ? workMs : m_smoothedMs + c_smoothing * (workMs - m_smoothedMs);
+    m_metricSmoothedMs.store(m_smoothedMs, std::memory_order_relaxed);
+    m_metricFrames.fetch_add(1, std::memory_order_relaxed);
+    m_framesSinceChange++;
+
+    const bool overBudget = workMs > m_budgetMs || intervalMs > m_budgetMs * c_missedIntervalFactor;
+    if (overBudget) {
+        m_metricOverBudget.fetch_add(1, std::memory_order_relaxed);
+        m_overFrames++;
+        m_headroomFrames = 0;
+    } else {
+        m_overFrames = std::max(m_overFrames - 1, 0);
+        m_headroomFrames = (m_smoothedMs < m_budgetMs * c_headroomFactor) ? m_headroomFrames + 1 : 0;
+    }
+
+    if (m_framesSinceChange < c_settleFrames) {
+        return false;
+    }
+
+    if (m_overFrames >= c_downFrames && m_level + 1 < static_cast<int>(m_levels.size())) {
+        // Level the machine could not hold right after stepping up needs longer headroom next time
+        if (m_lastStepUp && m_framesSinceChange < m_upFrames) {
+            m_upFrames = std::min(m_upFrames * 2, c_maxUpFrames);
+        }
+        m_lastStepUp = false;
+        m_metricStepsDown.fetch_add(1, std::memory_order_relaxed);
+        setLevel(m_level + 1);
+        return true;
+    }
+
+    if (m_headroomFrames >= m_upFrames && m_level > 0) {
+        // Level held long enough since the last step down, so oscillation has settled
+        if (!m_lastStepUp && m_framesSinceChange >= c_maxUpFrames) {
+            m_upFrames = c_upFrames;
+        }
+        m_lastStepUp = true;
+        m_metricStepsUp.fetch_add(1, std::memory_order_relaxed);
+        setLevel(m_level - 1);
+        return true;
+    }
+    return false;
+}
+
+void QualityController::reset()
+{
+    m_upFrames = c_upFrames;
+    m_lastStepUp = false;
+    setLevel(0);
+}
+
+QualityController::Metrics QualityController::getMetrics() const
+{
+    Metrics metrics;
+    metrics.level = m_metricLevel.load(std::memory_order_relaxed);
+    metrics.levelCount = static_cast<int>(m_levels.size());
+    metrics.smoothedMs = m_metricSmoothedMs.load(std::memory_order_relaxed);
+    metrics.frames = m_metricFrames.load(std::memory_order_relaxed);
+    metrics.overBudget = m_metricOverBudget.load(std::memory_order_relaxed);
+    metrics.stepsDown = m_metricStepsDown.load(std::memory_order_relaxed);
+    metrics.stepsUp = m_metricStepsUp.load(std::memory_order_relaxed);
+    return metrics;
+}
+
+void QualityController::setLevel(int level)
+{
+    m_level = level;
+    m_overFrames = 0;
+    m_headroomFrames = 0;
+    m_framesSinceChange = 0;
+    m_metricLevel.store(level, std::memory_order_relaxed);
+}
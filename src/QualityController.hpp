@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "FrameProfiler.hpp"
+
+//! Closed loop controller that trades filter quality for holding the frame budget.
+//!
+//! Fed with measured frame work time and frame interval once per frame. Steps down the quality
+//! ladder when frames go over budget and steps back up with hysteresis when there is headroom. A
+//! step up that is followed quickly by a step down doubles the headroom time needed for the next
+//! step up, so that the controller does not oscillate around a level the machine can not hold.
+//! Metrics are atomics, so they can be read from the UI thread while the render thread updates.
+class QualityController
+{
+public:
+    //! Quality level settings
+    struct Level {
+        int tapStride = 1;              //!< Low pass tap stride: taps per axis divided by this over the same area
+        int textureUpdateInterval = 1;  //!< Frames the noise texture is reused before regenerating
+    };
+
+    //! Controller metrics
+    struct Metrics {
+        int level = 0;            //!< Current level, 0 is full quality
+        int levelCount = 0;       //!< Number of levels
+        double smoothedMs = 0.0;  //!< Smoothed frame work time
+        uint64_t frames = 0;      //!< Frames measured
+        uint64_t overBudget = 0;  //!< Frames over budget
+        uint64_t stepsDown = 0;   //!< Quality steps down
+        uint64_t stepsUp = 0;     //!< Quality steps up
+    };
+
+    //! Constructor. Budget is frame time to hold in milliseconds, 90 Hz by default.
+    explicit QualityController(double budgetMs = FrameProfiler::c_frameBudgetNs / 1.0e6);
+
+    //! Add measured frame. Work time is CPU time spent on the frame, interval is time since the
+    //! previous frame. Returns true if quality level changed.
+    bool addFrame(double workMs, double intervalMs);
+
+    //! Return to full quality and clear controller state. Metric counters are kept.
+    void reset();
+
+    //! Returns settings of current level
+    const Level& getLevel() const { return m_levels[m_level]; }
+
+    //! Returns current level index, 0 is full quality
+    int getLevelIndex() const { return m_level; }
+
+    //! Returns metrics. Can be called from any thread.
+    Metrics getMetrics() const;
+
+private:
+    //! Change level and update counters
+    void setLevel(int level);
+
+private:
+    const std::vector<Level> m_levels;  //!< Quality ladder, full quality first
+    const double m_budgetMs;            //!< Frame budget
+    int m_level = 0;                    //!< Current level
+    double m_smoothedMs = 0.0;          //!< Smoothed frame work time
+    int m_overFrames = 0;               //!< Recent frames over budget
+    int m_headroomFrames = 0;           //!< Consecutive frames with headroom
+    int m_framesSinceChange = 0;        //!< Frames since last level change
+    int m_upFrames = 0;                 //!< Headroom frames needed for stepping up
+    bool m_lastStepUp = false;          //!< Last level change was a step up
+
+    std::atomic<int> m_metricLevel{0};            //!< Current level for metrics
+    std::atomic<double> m_metricSmoothedMs{0.0};  //!< Smoothed frame work time for metrics
+    std::atomic<uint64_t> m_metricFrames{0};      //!< Frames measured
+    std::atomic<uint64_t> m_metricOverBudget{0};  //!< Frames over budget
+    std::atomic<uint64_t> m_metricStepsDown{0};   //!< Quality steps down
+    std::atomic<uint64_t> m_metricStepsUp{0};     //!< Quality steps up
+};
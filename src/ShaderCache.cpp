@@ -0,0 +1,230 @@
+#include "ShaderCache.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "Hash.hpp"
+#include "TraceRecorder.hpp"
+
+namespace
+{
+// Cache file header magic and version. Bump version when the file layout changes.
+constexpr uint32_t c_fileMagic = 0x43535056;  // "VPSC"
+constexpr uint32_t c_fileVersion = 1;
+
+// Largest accepted binary, guards against allocating for corrupted headers
+constexpr uint32_t c_maxBinarySize = 64 << 20;
+
+// Cache file header
+struct FileHeader {
+    uint32_t magic;     // File magic
+    uint32_t version;   // File layout version
+    uint64_t key;       // Cache key
+    uint64_t checksum;  // Hash of binary data
+    uint32_t format;    // Binary format
+    uint32_t size;      // Binary data size in bytes
+};
+
+// Create directory if it does not exist
+bool makeDirectory(const std::string& path)
+{
+#ifdef _WIN32
+    const int ret = _mkdir(path.c_str());
+#else
+    const int ret = mkdir(path.c_str(), 0755);
+#endif
+    return ret == 0 || errno == EEXIST;
+}
+
+}  // namespace
+
+ShaderCache& ShaderCache::instance()
+{
+    static ShaderCache s_instance;
+    return s_instance;
+}
+
+uint64_t ShaderCache::makeKey(const std::string& source, const std::string& defines, const std::string& identity)
+{
+    // Separator between parts so that moving text from one part to another changes the key
+    const char separator = 0;
+    uint64_t hash = Hash::fnv1a(source.data(), source.size());
+    hash = Hash::fnv1a(&separator, 1, hash);
+    hash = Hash::fnv1a(defines.data(), defines.size(), hash);
+    hash = Hash::fnv1a(&separator, 1, hash);
+    return Hash::fnv1a(identity.data(), identity.size(), hash);
+}
+
+bool ShaderCache::setDirectory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_directory = directory;
+    if (!m_directory.empty() && !makeDirectory(m_directory)) {
+        m_directory.clear();
+        return false;
+    }
+    return true;
+}
+
+std::string ShaderCache::getDirectory() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_directory;
+}
+
+std::string ShaderCache::getPath(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return m_directory + "/" + name;
+}
+
+std::string ShaderCache::getFilePath(uint64_t key, const std::string& prefix, const std::string& extension) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_directory.empty()) {
+        return {};
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+    return m_directory + "/" + prefix + name + extension;
+}
+
+bool ShaderCache::writeFile(const std::string& path, const void* data, size_t size)
+{
+    // Write to temporary file first so that readers never see a partial file
+    const std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(static_cast<const char*>(data), size)) {
+            return false;
+        }
+    }
+
+    // Replace existing file in one step. Rename does not replace existing files on Windows.
+#ifdef _WIN32
+    const bool replaced = MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    const bool replaced = std::rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+    if (!replaced) {
+        std::remove(tempPath.c_str());
+    }
+    return replaced;
+}
+
+std::shared_ptr<const ShaderCache::Binary> ShaderCache::find(uint64_t key)
+{
+    TRACE_SCOPE("ShaderCache::find");
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_binaries.find(key);
+        if (it != m_binaries.end()) {
+            m_stats.memoryHits++;
+            return it->second;
+        }
+        if (m_directory.empty()) {
+            m_stats.misses++;
+            return nullptr;
+        }
+        path = getPath(key);
+    }
+
+    // Load from disk without holding the lock
+    auto binary = load(path, key);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!binary) {
+        m_stats.misses++;
+        return nullptr;
+    }
+    m_stats.diskHits++;
+    return m_binaries.emplace(key, std::move(binary)).first->second;
+}
+
+bool ShaderCache::store(uint64_t key, uint32_t format, const void* data, size_t size)
+{
+    TRACE_SCOPE("ShaderCache::store");
+
+    auto binary = std::make_shared<Binary>();
+    binary->format = format;
+    binary->data.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_binaries[key] = binary;
+        m_stats.stores++;
+        if (m_directory.empty()) {
+            return true;
+        }
+        path = getPath(key);
+    }
+
+    return save(path, key, *binary);
+}
+
+void ShaderCache::clearMemory()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_binaries.clear();
+}
+
+ShaderCache::Stats ShaderCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+std::shared_ptr<const ShaderCache::Binary> ShaderCache::load(const std::string& path, uint64_t key) const
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return nullptr;
+    }
+
+    FileHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != c_fileMagic || header.version != c_fileVersion ||
+        header.key != key || header.size > c_maxBinarySize) {
+        return nullptr;
+    }
+
+    auto binary = std::make_shared<Binary>();
+    binary->format = header.format;
+    binary->data.resize(header.size);
+    if (!file.read(reinterpret_cast<char*>(binary->data.data()), header.size) || Hash::fnv1a(binary->data.data(), header.size) != header.checksum) {
+        return nullptr;
+    }
+    return binary;
+}
+
+bool ShaderCache::save(const std::string& path, uint64_t key, const Binary& binary) const
+{
+    FileHeader header{};
+    header.magic = c_fileMagic;
+    header.version = c_fileVersion;
+    header.key = key;
+    header.checksum = Hash::fnv1a(binary.data.data(), binary.data.size());
+    header.format = binary.format;
+    header.size = static_cast<uint32_t>(binary.data.size());
+
+    std::vector<uint8_t> data(sizeof(header) + binary.data.size());
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + sizeof(header), binary.data.data(), binary.data.size());
+    return writeFile(path, data.data(), data.size());
+}
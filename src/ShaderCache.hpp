@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//! Shader binary cache keyed by source hash, defines and compiler or driver identity.
+//!
+//! Binaries are kept in memory so that instances compiling the same shader share the result,
+//! and persisted to a cache directory so that later runs skip compiling. Files are validated
+//! on load and ignored if truncated, corrupted or written for another key.
+class ShaderCache
+{
+public:
+    //! Cached shader binary
+    struct Binary {
+        uint32_t format = 0;        //!< API specific binary format, e.g. GL program binary format
+        std::vector<uint8_t> data;  //!< Binary data
+    };
+
+    //! Cache statistics
+    struct Stats {
+        uint64_t memoryHits = 0;  //!< Lookups found in memory
+        uint64_t diskHits = 0;    //!< Lookups loaded from disk
+        uint64_t misses = 0;      //!< Lookups not found
+        uint64_t stores = 0;      //!< Binaries stored
+    };
+
+    //! Returns shared cache instance
+    static ShaderCache& instance();
+
+    //! Returns cache key for given shader source, preprocessor defines and compiler or driver identity
+    static uint64_t makeKey(const std::string& source, const std::string& defines, const std::string& identity);
+
+    //! Set cache directory, created if missing. Empty directory disables disk cache.
+    //! Returns false and disables disk cache if directory could not be created.
+    bool setDirectory(const std::string& directory);
+
+    //! Returns cache directory
+    std::string getDirectory() const;
+
+    //! Find binary for key from memory or disk. Returns nullptr if not cached.
+    std::shared_ptr<const Binary> find(uint64_t key);
+
+    //! Store binary for key in memory and on disk. Returns false if writing to disk failed.
+    bool store(uint64_t key, uint32_t format, const void* data, size_t size);
+
+    //! Returns path of raw binary file for key in cache directory, for APIs that load shaders from files.
+    //! Raw files have no header, so check them against the binary stored for the key before use.
+    //! Returns empty string if disk cache is disabled.
+    std::string getFilePath(uint64_t key, const std::string& prefix, const std::string& extension) const;
+
+    //! Write file so that readers never see a partially written file. Returns false on failure.
+    static bool writeFile(const std::string& path, const void* data, size_t size);
+
+    //! Drop binaries kept in memory. Files on disk are kept.
+    void clearMemory();
+
+    //! Returns cache statistics
+    Stats getStats() const;
+
+private:
+    //! Returns cache file path for key. Call with mutex held.
+    std::string getPath(uint64_t key) const;
+
+    //! Load binary file for key. Returns nullptr if missing or invalid.
+    std::shared_ptr<const Binary> load(const std::string& path, uint64_t key) const;
+
+    //! Write binary file for key
+    bool save(const std::string& path, uint64_t key, const Binary& binary) const;
+
+private:
+    mutable std::mutex m_mutex;                                              //!< Cache mutex
+    std::string m_directory;                                                 //!< Cache directory, empty if disabled
+    std::unordered_map<uint64_t, std::shared_ptr<const Binary>> m_binaries;  //!< Binaries in memory
+    Stats m_stats;                                                           //!< Cache statistics
+};
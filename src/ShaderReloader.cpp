@@ -0,0 +1,165 @@
+#include "ShaderReloader.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+
+#include "Globals.hpp"
+#include "TraceRecorder.hpp"
+
+namespace
+{
+// Interval for polling source file changes
+constexpr auto c_pollInterval = std::chrono::milliseconds(250);
+
+}  // namespace
+
+ShaderReloader::ShaderReloader(const std::string& sourceFile, const FilterTuner::Setting& setting, const std::vector<FilterTuner::Setting>& variants,
+    const Compiler& compiler)
+    : m_sourceFile(sourceFile)
+    , m_variants(variants)
+    , m_compiler(compiler)
+    , m_setting(setting)
+{
+    m_thread = std::thread(&ShaderReloader::watchMain, this);
+}
+
+ShaderReloader::~ShaderReloader()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+}
+
+void ShaderReloader::requestSetting(const FilterTuner::Setting& setting)
+{
+    {
+        // Compile thread holds the mutex only between compiles
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (setting == m_setting) {
+            return;
+        }
+        m_setting = setting;
+        m_hasRequest = true;
+        m_requestTime = std::chrono::steady_clock::now();
+    }
+    m_cond.notify_all();
+}
+
+bool ShaderReloader::takeResult(Result& result)
+{
+    // Frame thread must not wait for a compile to finish
+    std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+    if (!lock.owns_lock() || !m_hasResult) {
+        return false;
+    }
+    result = std::move(m_result);
+    m_hasResult = false;
+    return true;
+}
+
+ShaderReloader::FileStamp ShaderReloader::getFileStamp() const
+{
+    FileStamp stamp;
+#ifdef _WIN32
+    struct _stat64 info;
+    if (_stat64(m_sourceFile.c_str(), &info) == 0) {
+#else
+    struct stat info;
+    if (stat(m_sourceFile.c_str(), &info) == 0) {
+#endif
+        stamp.time = static_cast<int64_t>(info.st_mtime);
+        stamp.size = static_cast<int64_t>(info.st_size);
+    }
+    return stamp;
+}
+
+void ShaderReloader::compile(const FilterTuner::Setting& setting, bool sourceChanged, std::chrono::steady_clock::time_point changeTime)
+{
+    TRACE_SCOPE("ShaderReloader::compile");
+    const auto startTime = std::chrono::steady_clock::now();
+    Result result;
+    result.binaryFile = m_compiler(m_sourceFile, setting);
+    result.setting = setting;
+    result.sourceChanged = sourceChanged;
+    result.changeTime = changeTime;
+    result.compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    if (result.binaryFile.empty()) {
+        LOG_ERROR("Recompiling shader failed, keeping previous shader: %s", m_sourceFile.c_str());
+    } else {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_result = std::move(result);
+        m_hasResult = true;
+    }
+}
+
+void ShaderReloader::precompileVariants(const FilterTuner::Setting& setting)
+{
+    TRACE_SCOPE("ShaderReloader::precompileVariants");
+    for (size_t i = 0; i < m_variants.size(); i++) {
+        const auto& variant = m_variants[i];
+        if (variant == setting || std::find(m_variants.begin(), m_variants.begin() + i, variant) != m_variants.begin() + i) {
+            continue;
+        }
+
+        // Requests and stopping take priority over variants that may never be used
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop || m_hasRequest) {
+                return;
+            }
+        }
+        m_compiler(m_sourceFile, variant);
+    }
+}
+
+void ShaderReloader::watchMain()
+{
+    TraceRecorder::instance().setThreadName("ShaderReload");
+
+    // Polling works the same on every platform and editor. Change notification APIs report
+    // intermediate writes that would need the same settling logic anyway.
+    FileStamp compiledStamp = getFileStamp();
+    FileStamp pendingStamp = compiledStamp;
+    auto changeTime = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cond.wait_for(lock, c_pollInterval, [this] { return m_stop || m_hasRequest; });
+        if (m_stop) {
+            break;
+        }
+        const FilterTuner::Setting setting = m_setting;
+        const bool hasRequest = m_hasRequest;
+        const auto requestTime = m_requestTime;
+        m_hasRequest = false;
+        lock.unlock();
+
+        // Requests wake the thread early, so the file is only polled once a full interval has passed
+        if (hasRequest) {
+            compile(setting, false, requestTime);
+            lock.lock();
+            continue;
+        }
+
+        const FileStamp stamp = getFileStamp();
+        if (stamp != pendingStamp) {
+            // Changed, wait for the editor to finish writing
+            pendingStamp = stamp;
+            changeTime = std::chrono::steady_clock::now();
+        } else if (stamp != compiledStamp && stamp.size >= 0) {
+            // Unchanged for one poll interval, compile requested setting first, then the other
+            // variants so that switching to them later is a cache hit
+            compiledStamp = stamp;
+            LOG_INFO("Shader source changed, recompiling: %s", m_sourceFile.c_str());
+            compile(setting, true, changeTime);
+            precompileVariants(setting);
+        }
+
+        lock.lock();
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FilterTuner.hpp"
+
+//! Watches a shader source file and recompiles it on a worker thread when it changes.
+//!
+//! Compiled shaders are picked up with takeResult() at a frame boundary, so the frame thread never
+//! waits for compilation and the previous shader keeps running until the new one is ready. Failed
+//! compiles are logged and leave the previous shader in place.
+//!
+//! The shader is compiled with the requested tuned setting. After a source change the other tuned
+//! variants are precompiled too, and a different setting is requested with requestSetting(), so
+//! switching variants never compiles on the frame thread.
+class ShaderReloader
+{
+public:
+    //! Shader compiler. Returns path of compiled binary, or empty string on failure.
+    using Compiler = std::function<std::string(const std::string& sourceFile, const FilterTuner::Setting& setting)>;
+
+    //! Compiled shader ready for swapping in
+    struct Result {
+        std::string binaryFile;                            //!< Compiled shader binary
+        FilterTuner::Setting setting;                      //!< Setting the binary was compiled with
+        bool sourceChanged = false;                        //!< Compiled for source change, otherwise for setting request
+        std::chrono::steady_clock::time_point changeTime;  //!< Time source change was detected or setting requested
+        double compileMs = 0.0;                            //!< Compile time in milliseconds
+    };
+
+    //! Constructor. Starts watching given source file compiled with given setting. Variants are
+    //! precompiled after each source change.
+    ShaderReloader(const std::string& sourceFile, const FilterTuner::Setting& setting, const std::vector<FilterTuner::Setting>& variants,
+        const Compiler& compiler);
+
+    //! Destructor. Waits for compile in progress to finish.
+    ~ShaderReloader();
+
+    // Disable copy and assign
+    ShaderReloader(const ShaderReloader& other) = delete;
+    ShaderReloader& operator=(const ShaderReloader& other) = delete;
+
+    //! Returns watched source file
+    const std::string& getSourceFile() const { return m_sourceFile; }
+
+    //! Request shader compiled with given setting. Result is delivered through takeResult().
+    //! Requesting the setting requested last does nothing. Never blocks on compilation.
+    void requestSetting(const FilterTuner::Setting& setting);
+
+    //! Take latest compiled shader if one is ready. Never blocks on compilation.
+    bool takeResult(Result& result);
+
+private:
+    //! File modification stamp
+    struct FileStamp {
+        int64_t time = 0;   //!< Modification time
+        int64_t size = -1;  //!< File size, -1 if file is missing
+
+        bool operator==(const FileStamp& other) const { return time == other.time && size == other.size; }
+        bool operator!=(const FileStamp& other) const { return !(*this == other); }
+    };
+
+    //! Returns modification stamp of watched file
+    FileStamp getFileStamp() const;
+
+    //! Compile requested setting and publish result
+    void compile(const FilterTuner::Setting& setting, bool sourceChanged, std::chrono::steady_clock::time_point changeTime);
+
+    //! Compile variants other than given setting so that later requests are cache hits. Stops early
+    //! on stop or a new request.
+    void precompileVariants(const FilterTuner::Setting& setting);
+
+    //! Watch thread main
+    void watchMain();
+
+private:
+    const std::string m_sourceFile;                       //!< Watched source file
+    const std::vector<FilterTuner::Setting> m_variants;   //!< Tuned variants precompiled after source changes
+    Compiler m_compiler;                                  //!< Shader compiler
+    std::mutex m_mutex;                                   //!< Request, result and stop flag mutex
+    std::condition_variable m_cond;                       //!< Signaled on stop and request
+    bool m_stop = false;                                  //!< Stop watching flag
+    FilterTuner::Setting m_setting;                       //!< Requested setting
+    bool m_hasRequest = false;                            //!< Requested setting not compiled yet flag
+    std::chrono::steady_clock::time_point m_requestTime;  //!< Time setting was requested
+    bool m_hasResult = false;                             //!< New result ready flag
+    Result m_result;                                      //!< Latest compiled shader
+    std::thread m_thread;                                 //!< Watch and compile thread
+};
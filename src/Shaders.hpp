@@ -1,17 +1,25 @@
 // Copyright 2020 Varjo Technologies Oy. All rights reserved.
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <iterator>
 #include <string>
 #include <unordered_map>
 #include <glm/glm.hpp>
 
 #include "PostProcess.hpp"
+#include "ColorLut.hpp"
+#include "FilterCPU.hpp"
+#include "KernelBank.hpp"
 
 // This is example shader for showcasing how to use video post process filters from
 // your own application. In your application, implement your own shader that suits
 // your needs.
 
+//! Bank kernel weights in the constant buffer, rounded up to whole float4 vectors
+constexpr int c_kernelWeightCount = (KernelBank::c_maxTaps + 3) / 4 * 4;
+
 //! Post process constant buffer. Must match with the shader exactly!
 struct PostProcessConstantBuffer {
     float colorFactor = 1.0f;             //!< Color grading amount: 0=off, 1=full
@@ -25,8 +33,70 @@ struct PostProcessConstantBuffer {
     int blurKernelSize = 1;                        //!< Blur kernel size
     float highPassCutoffFreq = 0.5f;                        //!< Freq to cutoff of high pass filter
     int filterType = 0;                            //what type of filter to apply
-    float _padding1[2];
+    int tapStride = 1;                             //!< Low pass tap stride set by adaptive quality
+    float _padding1[1];
+    int kernelShape = 0;                           //!< Low pass kernel shape, FilterCPU::KernelShape
+    int kernelRadius = 0;                          //!< Bank kernel taps on each side of the center
+    float kernelStep = 1.0f;                       //!< Bank kernel tap spacing in texels
+    float _padding2[1];
+    float kernelWeights[c_kernelWeightCount] = {};  //!< Bank kernel weights, float4 array in the shader
+    int gridCellSize = 16;                         //!< Bilateral grid cell size in pixels
+    int gridRangeBins = 8;                         //!< Bilateral grid luminance bins
+    float enhanceGain = 1.0f;                      //!< Bilateral grid edge enhancement gain
+    float _padding3[1];
 };
+static_assert(sizeof(PostProcessConstantBuffer) % 16 == 0, "Constant buffer must be whole float4 vectors");
+
+//! Returns CPU filter parameters matching the shader for given constant buffer
+inline FilterCPU::Params getFilterParams(const PostProcessConstantBuffer& cBuffer)
+{
+    FilterCPU::Params params;
+    params.filterType = cBuffer.filterType;
+    params.highPassCutoffFreq = cBuffer.highPassCutoffFreq;
+    params.colorFactor = cBuffer.colorFactor;
+    params.tapStride = cBuffer.tapStride;
+    params.kernelShape = cBuffer.kernelShape;
+    params.gridCellSize = cBuffer.gridCellSize;
+    params.gridRangeBins = cBuffer.gridRangeBins;
+    params.enhanceGain = cBuffer.enhanceGain;
+    return params;
+}
+
+//! Set bank kernel constants from kernel shape, cutoff and tap stride of the constant buffer, for a
+//! view of given pixels per degree. The CPU engine looks up the same kernel for the same PPD, so the
+//! shader filters with identical weights.
+//!
+//! All views share one constant buffer, so the kernel is looked up once per frame at a single PPD.
+//! Focus views get no kernel of their own; the shader only rescales their tap offsets to the focus
+//! resolution through kernelScale.
+inline void setKernelConstants(PostProcessConstantBuffer& cBuffer, float ppd)
+{
+    cBuffer.kernelRadius = 0;
+    cBuffer.kernelStep = 1.0f;
+    std::fill(std::begin(cBuffer.kernelWeights), std::end(cBuffer.kernelWeights), 0.0f);
+    if (cBuffer.kernelShape == FilterCPU::KernelBox) {
+        return;
+    }
+    FilterCPU::Params params = getFilterParams(cBuffer);
+    params.ppd = ppd;
+    const auto kernel = FilterCPU::findKernel(params);
+    cBuffer.kernelRadius = kernel.kernel->radius;
+    cBuffer.kernelStep = kernel.step;
+    std::copy(kernel.kernel->weights, kernel.kernel->weights + 2 * kernel.kernel->radius + 1, cBuffer.kernelWeights);
+}
+
+//! Returns color grading LUT parameters for given constant buffer
+inline ColorLut::Params getColorLutParams(const PostProcessConstantBuffer& cBuffer)
+{
+    ColorLut::Params params;
+    params.value = {cBuffer.colorValue.r, cBuffer.colorValue.g, cBuffer.colorValue.b};
+    params.exponent = {cBuffer.colorExp.r, cBuffer.colorExp.g, cBuffer.colorExp.b};
+    params.preserveSaturated = cBuffer.colorPreserveSaturated;
+    return params;
+}
+
+// Noise texture width and height. CPU generation and upload are tiled, so sizes of 4096 and beyond work.
+constexpr int c_noiseTextureSize = 256;
 
 // Shader parameters
 static const VarjoExamples::PostProcess::ShaderParams c_postProcessShaderParams = {  //
@@ -35,11 +105,11 @@ static const VarjoExamples::PostProcess::ShaderParams c_postProcessShaderParams
     sizeof(PostProcessConstantBuffer),                                               // Size of constant buffer
     {
         // Texture size and format. Enable one of these for testing the format.
-        {256, 256, varjo_TextureFormat_R8G8B8A8_UNORM},
-        //{256, 256, varjo_TextureFormat_R8G8B8A8_SRGB},
-        //{256, 256, varjo_TextureFormat_R32_UINT},
-        //{256, 256, varjo_TextureFormat_R32_FLOAT},
-        //{256, 256, varjo_MaskTextureFormat_A8_UNORM},
+        {c_noiseTextureSize, c_noiseTextureSize, varjo_TextureFormat_R8G8B8A8_UNORM},
+        //{c_noiseTextureSize, c_noiseTextureSize, varjo_TextureFormat_R8G8B8A8_SRGB},
+        //{c_noiseTextureSize, c_noiseTextureSize, varjo_TextureFormat_R32_UINT},
+        //{c_noiseTextureSize, c_noiseTextureSize, varjo_TextureFormat_R32_FLOAT},
+        //{c_noiseTextureSize, c_noiseTextureSize, varjo_MaskTextureFormat_A8_UNORM},
 
         // | Varjo Format   | D3D11     | GL        | D3D12     |
         // |----------------|-----------|-----------|-----------|
@@ -57,8 +127,23 @@ static const VarjoExamples::PostProcess::ShaderParams c_postProcessShaderParams
         //    geometry rendering, or with different shader texture bindings, or using intermediate texture
         //    or texture view. Highly dependent on rendering API as well.
         // 3) D3D12 GPU support in the example not implemented so marked ???. Should be the same as D3D11.
+
+        // Color grading LUT. Blue slices laid side by side.
+        {ColorLut::c_size * ColorLut::c_size, ColorLut::c_size, varjo_TextureFormat_R8G8B8A8_UNORM},
     }};
 
+//! Returns shader parameters for shader variant compiled with given BLOCK_SIZE
+inline VarjoExamples::PostProcess::ShaderParams getPostProcessShaderParams(int blockSize)
+{
+    auto params = c_postProcessShaderParams;
+    params.computeBlockSize = blockSize;
+    return params;
+}
+
+// Shader input texture indices
+constexpr int64_t c_noiseTextureIndex = 0;     //!< Noise/test texture (t1)
+constexpr int64_t c_colorLutTextureIndex = 1;  //!< Color grading LUT texture (t2)
+
 // Shader source filenames
 const std::unordered_map<VarjoExamples::PostProcess::ShaderSource, std::string> c_postProcessShaderSources = {
     {VarjoExamples::PostProcess::ShaderSource::None, ""},
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+//! Lock-free single producer, single consumer channel passing the latest value of a state (triple buffer).
+//!
+//! The producer always writes into its own back slot and publishes it by swapping it with the shared
+//! middle slot. The consumer swaps the middle slot into its front slot only when a new version has been
+//! published, so neither side ever waits for the other and intermediate values may be skipped.
+template <typename T>
+class StateChannel
+{
+public:
+    //! Constructor
+    StateChannel() = default;
+
+    // Disable copy and assign
+    StateChannel(const StateChannel& other) = delete;
+    StateChannel& operator=(const StateChannel& other) = delete;
+
+    //! Publish new value. Call from producer thread only.
+    void publish(const T& value)
+    {
+        Slot& slot = m_slots[m_backIndex];
+        slot.value = value;
+        slot.version = ++m_publishVersion;
+        m_backIndex = m_middle.exchange(m_backIndex | c_freshBit, std::memory_order_acq_rel) & c_indexMask;
+    }
+
+    //! Copy latest value to given target if a new version was published since previous fetch.
+    //! Returns false and leaves target untouched otherwise. Call from consumer thread only.
+    bool fetch(T& value)
+    {
+        if ((m_middle.load(std::memory_order_acquire) & c_freshBit) == 0) {
+            return false;
+        }
+
+        // Only producer can modify middle slot after this point and it always leaves it fresh
+        m_frontIndex = m_middle.exchange(m_frontIndex, std::memory_order_acq_rel) & c_indexMask;
+
+        const Slot& slot = m_slots[m_frontIndex];
+        value = slot.value;
+        m_fetchVersion = slot.version;
+        return true;
+    }
+
+    //! Returns version of the previously fetched value. Zero if nothing fetched yet. Consumer thread only.
+    uint64_t getVersion() const { return m_fetchVersion; }
+
+private:
+    //! Slot index mask
+    static constexpr uint32_t c_indexMask = 0x3;
+
+    //! Flag set in middle index when it holds an unfetched value
+    static constexpr uint32_t c_freshBit = 0x4;
+
+    //! Value slot
+    struct alignas(64) Slot {
+        T value{};             //!< Stored value
+        uint64_t version = 0;  //!< Publish version of stored value
+    };
+
+    Slot m_slots[3];                        //!< Value slots
+    std::atomic<uint32_t> m_middle{1};      //!< Shared middle slot index and fresh flag
+    uint32_t m_backIndex = 0;               //!< Producer slot index
+    uint64_t m_publishVersion = 0;          //!< Producer version counter
+    alignas(64) uint32_t m_frontIndex = 2;  //!< Consumer slot index
+    uint64_t m_fetchVersion = 0;            //!< Version of consumer slot
+};
@@ -0,0 +1,57 @@
+#include "TestPattern.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+namespace
+{
+template <typename T>
+inline T getGradientValue(int64_t x, int64_t y, int64_t w, int64_t h, int c, T maxValue)
+{
+    T value = 0;
+    switch (c) {
+        case 0: value = static_cast<T>(static_cast<double>(x * maxValue) / w); break;
+        case 1: value = static_cast<T>(static_cast<double>(y * maxValue) / h); break;
+        case 2: value = static_cast<T>(static_cast<double>(((w - x) + (h - y)) * maxValue) / (w + h)); break;
+        case 3: value = static_cast<T>(static_cast<double>((x + (h - y)) * maxValue) / (w + h)); break;
+    }
+    return value;
+}
+
+template <typename T>
+void generateGradientTexture(int patternWidth, int patternHeight, int x0, int y0, int width, int height, int numChannels, T* target, size_t rowPitch)
+{
+    numChannels = std::min(std::max(numChannels, 0), 4);
+    const T maxValue = std::is_floating_point<T>::value ? T(1) : std::numeric_limits<T>::max();
+
+    for (int y = y0; y < y0 + height; y++) {
+        T* dst = reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(target) + (y - y0) * rowPitch);
+        for (int x = x0; x < x0 + width; x++) {
+            // Debug: Black grid
+            const bool grid = ((x & 15) == 8) || ((y & 15) == 8);
+            for (int c = 0; c < numChannels; c++) {
+                dst[c] = grid ? T(0) : getGradientValue<T>(x, y, patternWidth, patternHeight, c, maxValue);
+            }
+            dst += numChannels;
+        }
+    }
+}
+
+}  // namespace
+
+namespace TestPattern
+{
+void generateGradientRegion(int patternWidth, int patternHeight, int x0, int y0, int width, int height, int numChannels, uint8_t* target,
+    size_t rowPitch)
+{
+    generateGradientTexture(patternWidth, patternHeight, x0, y0, width, height, numChannels, target, rowPitch);
+}
+
+void generateGradientRegion(int patternWidth, int patternHeight, int x0, int y0, int width, int height, int numChannels, float* target,
+    size_t rowPitch)
+{
+    generateGradientTexture(patternWidth, patternHeight, x0, y0, width, height, numChannels, target, rowPitch);
+}
+
+}  // namespace TestPattern
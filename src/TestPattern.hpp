@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//! Deterministic test patterns shared by test textures, offline tools and tests.
+//!
+//! The gradient ramps red along x, green along y, blue from bottom right to top left and alpha from
+//! top right to bottom left, with a black debug grid every 16 pixels at offset 8. Regions of a
+//! pattern can be generated in any order and in parallel.
+namespace TestPattern
+{
+//! Generate region of 8-bit unorm gradient of given pattern size with top left pixel at x0, y0.
+//! Target points to the top left pixel, row pitch in bytes. Up to four channels.
+void generateGradientRegion(int patternWidth, int patternHeight, int x0, int y0, int width, int height, int numChannels, uint8_t* target,
+    size_t rowPitch);
+
+//! Generate region of float gradient of given pattern size with top left pixel at x0, y0.
+void generateGradientRegion(int patternWidth, int patternHeight, int x0, int y0, int width, int height, int numChannels, float* target,
+    size_t rowPitch);
+
+//! Generate whole float gradient of given size, row pitch in bytes
+inline void generateGradient(int width, int height, int numChannels, float* target, size_t rowPitch)
+{
+    generateGradientRegion(width, height, 0, 0, width, height, numChannels, target, rowPitch);
+}
+
+}  // namespace TestPattern
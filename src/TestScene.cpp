@@ -2,6 +2,9 @@
 
 #include "TestScene.hpp"
 
+#include <algorithm>
+#include <glm/gtc/constants.hpp>
+
 #include "ExampleShaders.hpp"
 
 // VarjoExamples namespace contains simple example wrappers for using Varjo API features.
@@ -19,6 +22,20 @@ constexpr float c_cubeSize = 0.30f;
 constexpr int c_gridsize = 5;
 constexpr float c_gridSpacing = 1.0f;
 
+// Grid object count
+constexpr int c_gridObjectCount = 2 * c_gridsize * c_gridsize * c_gridsize;
+
+// Stress test objects are scattered on a ring around the user
+constexpr float c_stressMinRadius = 2.0f;
+constexpr float c_stressMaxRadius = 30.0f;
+constexpr float c_stressMaxHeight = 8.0f;
+constexpr float c_stressMinSize = 0.05f;
+constexpr float c_stressMaxSize = 0.2f;
+constexpr float c_stressBobAmplitude = 0.1f;
+
+// Every Nth stress object bobs up and down
+constexpr int c_stressAnimStride = 16;
+
 // Object dimensions
 constexpr float d = 1.0f;
 constexpr float r = d * 0.5f;
@@ -55,6 +72,33 @@ const std::vector<unsigned int> c_cubeIndexData = {
 
 // clang-format on
 
+// Local cube bounds
+const Aabb c_cubeBounds = {glm::vec3(-r), glm::vec3(r)};
+
+// Deterministic pseudo random value in [0, 1) for given index and channel
+float hashUnit(uint32_t index, uint32_t channel)
+{
+    uint32_t h = index * 0x9E3779B1u ^ channel * 0x85EBCA77u;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    h *= 0x297A2D39u;
+    h ^= h >> 15;
+    return static_cast<float>(h >> 8) * (1.0f / 16777216.0f);
+}
+
+// Stress test object position at given time
+glm::vec3 getStressPosition(uint32_t index, double time)
+{
+    const float radius = c_stressMinRadius + (c_stressMaxRadius - c_stressMinRadius) * std::sqrt(hashUnit(index, 0));
+    const float angle = 2.0f * glm::pi<float>() * hashUnit(index, 1);
+    float height = c_stressMaxHeight * hashUnit(index, 2);
+    if (index % c_stressAnimStride == 0) {
+        height += c_stressBobAmplitude * static_cast<float>(std::sin(time + index));
+    }
+    return {radius * std::cos(angle), height, radius * std::sin(angle)};
+}
+
 }  // namespace
 
 TestScene::TestScene(Renderer& renderer)
@@ -62,7 +106,21 @@ TestScene::TestScene(Renderer& renderer)
     , m_cubeShader(renderer.getShaders().createShader(ExampleShaders::ShaderType::RainbowCube))
 {
     // Allocate objects
-    m_cubes.resize(2 * c_gridsize * c_gridsize * c_gridsize);
+    m_cubes.resize(c_gridObjectCount);
+}
+
+void TestScene::setStressObjectCount(int count)
+{
+    count = std::min(std::max(count, 0), c_maxStressObjectCount);
+    if (count == m_stressObjectCount) {
+        return;
+    }
+
+    LOG_INFO("Stress test objects: %d", count);
+    m_stressObjectCount = count;
+    m_cubes.resize(c_gridObjectCount + count);
+    m_cubesValid = false;
+    m_bvhValid = false;
 }
 
 void TestScene::onUpdate(double frameTime, double deltaTime, int64_t frameCounter, const UpdateParams& params)
@@ -84,39 +142,71 @@ void TestScene::onUpdate(double frameTime, double deltaTime, int64_t frameCounte
     m_lighting = ExampleShaders::LightingData();
     m_lighting.ambientLight *= c_sceneLuminance;
 
-    // Scene grid offsets: X centered, Y on floor, Z in front
-    {
+    // Scene grid offsets: X centered, Y on floor, Z in front. Only rewritten when animated,
+    // and only objects actually changed get their transforms rebuilt.
+    const bool layoutValid = m_cubesValid;
+    if (anim || !layoutValid) {
         const float cubeOffs = 0.5f * (c_gridSpacing - c_cubeSize);
         const float gridOffs = 0.5f * c_gridsize * c_gridSpacing;
         const float offsX = 0.0f;
         const float offsY = 0.0f + 0.5f * c_cubeSize;
         const float offsZ = 1.0f + 0.5f * c_cubeSize;
 
-        // Render scene to the target using the view information
         size_t i = 0;
         for (int x = 0; x < c_gridsize; x++) {
             for (int y = 0; y < c_gridsize; y++) {
                 for (int z = 0; z < c_gridsize; z++) {
-                    // Render grid of cubes on both sides
+                    // Grid of cubes on both sides
                     for (int zSign = -1; zSign <= 1; zSign += 2) {
-                        auto& object = m_cubes[i++];
-                        object.pose.position[0] = offsX + c_gridSpacing * ((float)x - (0.5f * (c_gridsize - 1)));
-                        object.pose.position[1] = offsY + c_gridSpacing * ((float)y);
-                        object.pose.position[2] = zSign * (offsZ + c_gridSpacing * ((float)z));
-                        double s = 1.0 + animScale * sin(animPhase + x + y + z);
-                        object.pose.scale = {
-                            static_cast<float>(c_cubeSize * s),
-                            static_cast<float>(c_cubeSize * s),
-                            static_cast<float>(c_cubeSize * s),
-                        };
-
-                        object.color = {0.5f, 0.5f, 0.5f, 1.0f};
-                        object.vtxColorFactor = 1.0f;
+                        const glm::vec3 position(offsX + c_gridSpacing * ((float)x - (0.5f * (c_gridsize - 1))),  //
+                            offsY + c_gridSpacing * ((float)y),                                                  //
+                            zSign * (offsZ + c_gridSpacing * ((float)z)));
+                        const float s = static_cast<float>(c_cubeSize * (1.0 + animScale * sin(animPhase + x + y + z)));
+
+                        m_cubes.setPosition(i, position);
+                        m_cubes.setScale(i, {s, s, s});
+                        m_cubes.setColor(i, {0.5f, 0.5f, 0.5f, 1.0f}, 1.0f);
+                        i++;
                     }
                 }
             }
         }
     }
+
+    // Stress objects are written once, after that only the bobbing ones
+    {
+        const int step = layoutValid ? c_stressAnimStride : 1;
+        for (int k = 0; k < m_stressObjectCount; k += step) {
+            const size_t i = c_gridObjectCount + k;
+            m_cubes.setPosition(i, getStressPosition(k, frameTime));
+            if (!layoutValid) {
+                const float s = c_stressMinSize + (c_stressMaxSize - c_stressMinSize) * hashUnit(k, 3);
+                const float yaw = glm::pi<float>() * hashUnit(k, 4);
+                const float gray = 0.3f + 0.5f * hashUnit(k, 5);
+                m_cubes.setRotation(i, glm::quat(std::cos(yaw), 0.0f, std::sin(yaw), 0.0f));
+                m_cubes.setScale(i, {s, s, s});
+                m_cubes.setColor(i, {gray, gray, gray, 1.0f}, 1.0f);
+            }
+        }
+    }
+    m_cubesValid = true;
+
+    // Rebuild transforms for changed cubes
+    m_cubes.update();
+
+    // Update bounds of changed cubes and refit hierarchy, or rebuild it if object count changed
+    const auto& updated = m_cubes.getUpdatedIndices();
+    const auto& instances = m_cubes.getInstances();
+    m_bounds.resize(m_cubes.size());
+    for (const uint32_t i : updated) {
+        m_bounds[i] = transformBounds(instances[i].model, c_cubeBounds);
+    }
+    if (!m_bvhValid) {
+        m_bvh.build(m_bounds);
+        m_bvhValid = true;
+    } else {
+        m_bvh.refit(m_bounds, updated);
+    }
 }
 
 void TestScene::onRender(
@@ -125,24 +215,24 @@ void TestScene::onRender(
     // Bind the cube shader
     renderer.bindShader(*m_cubeShader);
 
-    // Render cubes
-    for (const auto& object : m_cubes) {
-        // Calculate model transformation
-        glm::mat4x4 modelMat(1.0);
-        modelMat = glm::translate(modelMat, object.pose.position);
-        modelMat *= glm::toMat4(object.pose.rotation);
-        modelMat = glm::scale(modelMat, object.pose.scale);
-
-        ExampleShaders::RainbowCubeConstants constants{};
-
-        constants.vs.transform = ExampleShaders::TransformData(modelMat, viewMat, projMat);
-        constants.vs.vtxColorFactor = object.vtxColorFactor;
-        constants.vs.objectColor = object.color;
-        constants.vs.objectScale = object.pose.scale;
-
-        constants.ps.lighting = m_lighting;
-        constants.ps.exposureGain = m_exposureGain;
-        constants.ps.wbNormalization = m_wbNormalization;
+    // Constants shared by all cubes
+    ExampleShaders::RainbowCubeConstants constants{};
+    constants.ps.lighting = m_lighting;
+    constants.ps.exposureGain = m_exposureGain;
+    constants.ps.wbNormalization = m_wbNormalization;
+
+    // Cull cubes against view frustum
+    m_visible.clear();
+    m_bvh.cull(Frustum(projMat * viewMat), m_visible);
+
+    // Render visible cubes from cached instance data
+    const auto& instances = m_cubes.getInstances();
+    for (const uint32_t index : m_visible) {
+        const auto& instance = instances[index];
+        constants.vs.transform = ExampleShaders::TransformData(instance.model, viewMat, projMat);
+        constants.vs.vtxColorFactor = instance.scale.w;
+        constants.vs.objectColor = instance.color;
+        constants.vs.objectScale = glm::vec3(instance.scale);
 
         renderer.renderMesh(*m_cubeMesh, constants.vs, constants.ps);
     }
@@ -10,16 +10,26 @@
 #include "Renderer.hpp"
 #include "Scene.hpp"
 
-//! Simple test scene consisting of grid of cubes and unit vectors in origin
+#include "Bvh.hpp"
+#include "TransformStore.hpp"
+
+//! Simple test scene consisting of grid of cubes and unit vectors in origin. Optional stress test
+//! objects can be scattered around the user. Objects are culled per view with a bounding volume hierarchy.
 class TestScene : public VarjoExamples::Scene
 {
 public:
     //! Constant for nominal exposure EV
     static const double c_nominalExposureEV;
 
+    //! Maximum stress test object count
+    static constexpr int c_maxStressObjectCount = 1000000;
+
     //! Constructor
     TestScene(VarjoExamples::Renderer& renderer);
 
+    //! Set number of stress test objects scattered around the user
+    void setStressObjectCount(int count);
+
 protected:
     //! Update scene animation
     void onUpdate(double frameTime, double deltaTime, int64_t frameCounter, const UpdateParams& params) override;
@@ -29,14 +39,13 @@ protected:
         const glm::mat4x4& projMat, void* userData) const override;
 
 private:
-    //! Simple class for storing object data
-    struct Object {
-        VarjoExamples::ObjectPose pose;              //!< Object pose
-        glm::vec4 color = {1.0f, 1.0f, 1.0f, 1.0f};  //!< Object color + alhpa
-        float vtxColorFactor = 1.0f;                 //!< Vertex color factor
-    };
-
-    std::vector<Object> m_cubes;                                    //!< Cube grid objects
+    TransformStore m_cubes;                                         //!< Cube transforms and instance data. Grid followed by stress objects.
+    bool m_cubesValid = false;                                      //!< True once cube layout is written
+    int m_stressObjectCount = 0;                                    //!< Stress test object count
+    std::vector<Aabb> m_bounds;                                     //!< World space cube bounds
+    Bvh m_bvh;                                                      //!< Cube bounds hierarchy for culling
+    bool m_bvhValid = false;                                        //!< False if hierarchy needs rebuild
+    mutable std::vector<uint32_t> m_visible;                        //!< Visible cubes of the view being rendered
     std::unique_ptr<VarjoExamples::Renderer::Mesh> m_cubeMesh;      //!< Mesh object instance
     std::unique_ptr<VarjoExamples::Renderer::Shader> m_cubeShader;  //!< Cube shader instance
 
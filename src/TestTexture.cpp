@@ -1,121 +1,96 @@
 
 #include "TestTexture.hpp"
 
-#include <random>
-#include <limits>
 #include <unordered_map>
 
+#include "TestPattern.hpp"
+#include "ThreadPool.hpp"
+#include "TraceRecorder.hpp"
+
 namespace
 {
-const std::unordered_map<varjo_TextureFormat, int> c_formatChannels = {
-    {varjo_TextureFormat_R8G8B8A8_SRGB, 4},
-    {varjo_TextureFormat_R8G8B8A8_UNORM, 4},
-    {varjo_MaskTextureFormat_A8_UNORM, 1},
-    {varjo_TextureFormat_R32_FLOAT, 1},
-    {varjo_TextureFormat_R32_UINT, 1},
+const std::unordered_map<varjo_TextureFormat, PixelFormat> c_pixelFormats = {
+    {varjo_TextureFormat_R8G8B8A8_SRGB, PixelFormat::RGBA8Srgb},
+    {varjo_TextureFormat_R8G8B8A8_UNORM, PixelFormat::RGBA8Unorm},
+    {varjo_MaskTextureFormat_A8_UNORM, PixelFormat::A8Unorm},
+    {varjo_TextureFormat_R32_FLOAT, PixelFormat::R32Float},
+    {varjo_TextureFormat_R32_UINT, PixelFormat::R32Uint},
 };
 
-std::default_random_engine g_generator;
-
-template <typename T>
-inline T getGradientValue(int64_t x, int64_t y, int64_t w, int64_t h, int c, T maxValue)
+// Returns tiling of texture of given type and size. Color LUT is copied as a whole.
+TextureTiler::Params getTilerParams(TestTexture::Type testType, const glm::ivec2& size)
 {
-    T value = 0;
-    switch (c) {
-        case 0: value = static_cast<T>(static_cast<double>(x * maxValue) / w); break;
-        case 1: value = static_cast<T>(static_cast<double>(y * maxValue) / h); break;
-        case 2: value = static_cast<T>(static_cast<double>(((w - x) + (h - y)) * maxValue) / (w + h)); break;
-        case 3: value = static_cast<T>(static_cast<double>((x + (h - y)) * maxValue) / (w + h)); break;
+    TextureTiler::Params params;
+    if (testType == TestTexture::Type::ColorLut) {
+        params.tileWidth = size.x;
+        params.tileHeight = size.y;
+        params.bandHeight = size.y;
     }
-    return value;
+    return params;
 }
 
-template <typename T>
-void generateNoise(const glm::ivec2& size, size_t rowPitch, int numChannels, T* target, T maxValue)
-{
-    std::uniform_real_distribution<double> distribution(0, maxValue);
-
-    size_t yoffs = 0;
-    for (int y = 0; y < size.y; y++) {
-        size_t offs = yoffs;
-        for (int x = 0; x < size.x; x++) {
-            for (int c = 0; c < numChannels; c++) {
-                target[offs + c] = static_cast<T>(distribution(g_generator));
-
-                // Debug: Black grid
-                if (((x & 15) == 8) || ((y & 15) == 8)) {
-                    target[offs + c] = 0;
-                }
-            }
-            offs += numChannels;
-        }
-        yoffs += (rowPitch / sizeof(T));
-    }
-}
-
-template <typename T>
-void generateGradient(const glm::ivec2& size, size_t rowPitch, int numChannels, T* target, T maxValue)
-{
-    const size_t bytes = size.x * size.y * numChannels;
-
-    size_t yoffs = 0;
-    for (int y = 0; y < size.y; y++) {
-        size_t offs = yoffs;
-        for (int x = 0; x < size.x; x++) {
-            for (int c = 0; c < numChannels; c++) {
-                target[offs + c] = getGradientValue<T>(x, y, size.x, size.y, c, maxValue);
-
-                // Debug: Black grid
-                if (((x & 15) == 8) || ((y & 15) == 8)) {
-                    target[offs + c] = 0;
-                }
-            }
-            offs += numChannels;
-        }
-        yoffs += (rowPitch / sizeof(T));
-    }
-}
-
-
 }  // namespace
 
 TestTexture::TestTexture(Type testType, varjo_TextureFormat textureFormat, const glm::ivec2& size)
     : m_testType(testType)
     , m_varjoFormat(textureFormat)
+    , m_pixelFormat(c_pixelFormats.at(textureFormat))
     , m_size(size)
-    , m_numChannels(c_formatChannels.at(textureFormat))
+    , m_numChannels(PixelConvert::getChannelCount(m_pixelFormat))
+    , m_tiler(size.x, size.y, getTilerParams(testType, size))
 {
 }
 
-void TestTexture::generate(uint8_t* target, size_t rowPitch)
-{
-    if (m_testType == Type::Gradient) {
-        // Generate gradient texture
-        generateGradient<uint8_t>(m_size, rowPitch, m_numChannels, target, std::numeric_limits<uint8_t>::max());
-    } else if (m_testType == Type::Noise) {
-        // Generate noise texture
-        generateNoise<uint8_t>(m_size, rowPitch, m_numChannels, target, std::numeric_limits<uint8_t>::max());
-    }
-}
+bool TestTexture::isUnorm8() const { return m_varjoFormat != varjo_TextureFormat_R32_FLOAT && m_varjoFormat != varjo_TextureFormat_R32_UINT; }
 
-void TestTexture::generate(float* target, size_t rowPitch)
+void TestTexture::generateBands(const BandTarget& getTarget, const BandUpload& upload)
 {
-    if (m_testType == Type::Gradient) {
-        // Generate gradient texture
-        generateGradient<float>(m_size, rowPitch, m_numChannels, target, 1.0f);
-    } else if (m_testType == Type::Noise) {
-        // Generate noise texture
-        generateNoise<float>(m_size, rowPitch, m_numChannels, target, 1.0f);
-    }
+    TRACE_SCOPE("TestTexture::generateBands");
+
+    // All tiles are of the same frame
+    const int64_t frame = m_frameIndex++;
+    const size_t pixelSize = PixelConvert::getPixelSize(m_pixelFormat);
+
+    // Target of current band and its top row
+    uint8_t* target = nullptr;
+    size_t rowPitch = 0;
+    int bandY = 0;
+
+    const auto beginBand = [&](const Region& band) {
+        target = getTarget(band, rowPitch);
+        bandY = band.y;
+    };
+    const auto generateTile = [&](const Region& tile) {
+        uint8_t* dst = target + (tile.y - bandY) * rowPitch + tile.x * pixelSize;
+        if (isUnorm8()) {
+            generateRegion(frame, tile, dst, rowPitch);
+        } else {
+            // R32_FLOAT, and R32_UINT which holds float bits as well, see PixelFormat::R32Uint
+            generateRegion(frame, tile, reinterpret_cast<float*>(dst), rowPitch);
+        }
+    };
+
+    // Functions are passed by reference wrapper, which std::function stores without heap allocation
+    m_tiler.run(ThreadPool::instance(), std::ref(beginBand), std::ref(generateTile), upload);
 }
 
-void TestTexture::generate(uint32_t* target, size_t rowPitch)
+template <typename T>
+void TestTexture::generateRegion(int64_t frame, const Region& region, T* target, size_t rowPitch) const
 {
-    if (m_testType == Type::Gradient) {
+    if (m_testType == Type::ColorLut) {
+        // Copy baked color LUT, always a single tile
+        if (m_colorLut && m_numChannels == 4) {
+            m_colorLut->writeTexture(reinterpret_cast<uint8_t*>(target), rowPitch);
+        }
+    } else if (m_testType == Type::Gradient) {
         // Generate gradient texture
-        generateGradient<uint32_t>(m_size, rowPitch, m_numChannels, target, std::numeric_limits<uint32_t>::max());
+        TestPattern::generateGradientRegion(m_size.x, m_size.y, region.x, region.y, region.width, region.height, m_numChannels, target, rowPitch);
     } else if (m_testType == Type::Noise) {
-        // Generate noise texture
-        generateNoise<uint32_t>(m_size, rowPitch, m_numChannels, target, std::numeric_limits<uint32_t>::max());
+        // Generate hash noise, same as the GPU generator for the frame
+        HashNoise::generateRegion(
+            static_cast<uint32_t>(frame), m_noiseSeed, region.x, region.y, region.width, region.height, m_numChannels, target, rowPitch);
+    } else if (m_testType == Type::BlueNoise && m_blueNoise) {
+        // Copy blue noise atlas frame
+        m_blueNoise->writeRegion(frame, region.x, region.y, region.width, region.height, m_numChannels, target, rowPitch);
     }
-}
\ No newline at end of file
+}
@@ -1,15 +1,21 @@
 
 #pragma once
 
+#include <functional>
 #include <glm/glm.hpp>
 
 #include "Globals.hpp"
+#include "ColorLut.hpp"
+#include "BlueNoise.hpp"
+#include "HashNoise.hpp"
+#include "PixelConvert.hpp"
+#include "TextureTiler.hpp"
 
 //! Base class for noise texture implementations
 class TestTexture
 {
 public:
-    enum class Type { None = 0, Noise, Gradient };
+    enum class Type { None = 0, Noise, Gradient, BlueNoise, ColorLut };
 
     //! Destructor
     virtual ~TestTexture() = default;
@@ -17,24 +23,49 @@ public:
     //! Update texture data to given varjo texture
     virtual void update(const varjo_Texture& varjoTexture, bool useGPU) = 0;
 
+    //! Set color LUT used as the source for ColorLut type. LUT must outlive this texture.
+    void setColorLut(const ColorLut* colorLut) { m_colorLut = colorLut; }
+
+    //! Set blue noise atlas used as the source for BlueNoise type. Atlas must outlive this texture.
+    void setBlueNoise(const BlueNoise* blueNoise) { m_blueNoise = blueNoise; }
+
 protected:
     //! Protected constructor
     TestTexture(Type testType, varjo_TextureFormat textureFormat, const glm::ivec2& size);
 
-    //! Generate texture to given buffer, row pitch in bytes. Caller must ensure the target has enough space.
-    void generate(uint8_t* target, size_t rowPitch);
+    //! Returns true if texture format has 8-bit unorm channels, false if channels are 32-bit
+    bool isUnorm8() const;
+
+    //! Rectangle of texture in pixels
+    using Region = TextureTiler::Region;
+
+    //! Returns target buffer for given band and its row pitch in bytes. Caller must ensure the target has enough space.
+    using BandTarget = std::function<uint8_t*(const Region& band, size_t& rowPitch)>;
+
+    //! Uploads given finished band from its target buffer
+    using BandUpload = std::function<void(const Region& band)>;
 
-    //! Generate texture to given buffer, row pitch in bytes.. Caller must ensure the target has enough space.
-    void generate(float* target, size_t rowPitch);
+    //! Generate next frame in bands of cache sized tiles, tiles of a band in parallel. Each band is uploaded
+    //! before the next one is generated. Texels are 8-bit unorm if isUnorm8, otherwise float. Pass lambdas
+    //! with std::ref, so that their captures are not copied to the heap every frame.
+    void generateBands(const BandTarget& getTarget, const BandUpload& upload);
 
-    //! Generate texture to given buffer, row pitch in bytes.. Caller must ensure the target has enough space.
-    void generate(uint32_t* target, size_t rowPitch);
+private:
+    //! Generate region of given frame, target points to the top left pixel of the region
+    template <typename T>
+    void generateRegion(int64_t frame, const Region& region, T* target, size_t rowPitch) const;
 
 protected:
-    Type m_testType;                    //!< Test texture type
-    varjo_TextureFormat m_varjoFormat;  //!< Varjo texture format
-    glm::ivec2 m_size;                  //!< Texture size
-    int m_numChannels = 0;              //!< Number of channels
-    bool m_gpuSupported = false;        //! GPU generate supported
-    bool m_cpuSupported = false;        //! CPU generate supported
+    Type m_testType;                                  //!< Test texture type
+    varjo_TextureFormat m_varjoFormat;                //!< Varjo texture format
+    PixelFormat m_pixelFormat;                        //!< Pixel format of Varjo texture format
+    glm::ivec2 m_size;                                //!< Texture size
+    int m_numChannels = 0;                            //!< Number of channels
+    TextureTiler m_tiler;                             //!< Generation tiles and upload bands
+    bool m_gpuSupported = false;                      //! GPU generate supported
+    bool m_cpuSupported = false;                      //! CPU generate supported
+    const ColorLut* m_colorLut = nullptr;             //!< Color LUT source for ColorLut type
+    const BlueNoise* m_blueNoise = nullptr;           //!< Blue noise atlas source for BlueNoise type
+    int64_t m_frameIndex = 0;                         //!< Frame index animating noise types
+    uint32_t m_noiseSeed = HashNoise::c_defaultSeed;  //!< Hash noise seed
 };
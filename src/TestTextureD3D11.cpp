@@ -1,10 +1,17 @@
 
 #include "TestTextureD3D11.hpp"
 
+#include <cstring>
+#include <string>
+#include <vector>
+#include <d3dcompiler.h>
 #include <Varjo_d3d11.h>
 
 #include "Shaders.hpp"
+#include "HashNoise.hpp"
 #include "D3D11Renderer.hpp"
+#include "ShaderCache.hpp"
+#include "TraceRecorder.hpp"
 
 // VarjoExamples namespace contains simple example wrappers for using Varjo API features.
 // These are only meant to be used in SDK example applications. In your own application,
@@ -13,27 +20,43 @@ using namespace VarjoExamples;
 
 namespace
 {
-// Example compute shader for generating noise texture on GPU
-static const char* c_noiseShaderSource = R"(
+// Example compute shader for generating noise texture on GPU, see HashNoise for the hash function
+const char* c_noiseShaderHeader = R"(
 RWTexture2D<unorm float4> tex : register(u0);
 
 cbuffer ConstantBuffer : register(b0) {
-    float4 noiseSeed;
+    uint4 noiseKey;  // Frame number, seed, 1 if target is 8-bit unorm, unused
 };
+)";
 
+const char* c_noiseShaderMain = R"(
 [numthreads(16, 16, 1)]
 void main(uint3 dispatchThreadID : SV_DispatchThreadID)
 {
-    const int2 uv = dispatchThreadID.xy;
-
-    // Generate noise
-    const float PHI = 1.61803398874989484820459;
-    const float2 xy = float2(uv) + 1.0;
-    float4 rgba = frac(tan(noiseSeed * distance(PHI * xy, xy)) * xy.x);
-    tex[uv] = rgba;
+    const uint4 v = hashNoise(uint4(dispatchThreadID.xy, noiseKey.xy));
+    if (noiseKey.z != 0) {
+        tex[dispatchThreadID.xy] = hashNoiseUnorm8(v);
+    } else {
+        tex[dispatchThreadID.xy] = hashNoiseFloat(v);
+    }
 }
 )";
 
+// Returns noise shader source with hash function shared with CPU noise
+const std::string& getNoiseShaderSource()
+{
+    static const std::string s_source = std::string(c_noiseShaderHeader) + HashNoise::getShaderSource() + c_noiseShaderMain;
+    return s_source;
+}
+
+//! Noise shader constant buffer. Must match the shader.
+struct NoiseConstantBuffer {
+    uint32_t frame = 0;   //!< Frame number
+    uint32_t seed = 0;    //!< Noise seed
+    uint32_t unorm8 = 0;  //!< 1 if target is 8-bit unorm
+    uint32_t _padding0 = 0;
+};
+
 // Example compute shader for generating noise texture on GPU
 static const char* c_gradientShaderSource = R"(
 RWTexture2D<float4> tex : register(u0);
@@ -59,6 +82,12 @@ void main(uint3 dispatchThreadID : SV_DispatchThreadID)
 }
 )";
 
+// Compute shader compile target
+constexpr const char* c_shaderTarget = "cs_5_0";
+
+// Compiler identity for shader cache keys. Bytecode is driver independent, only the compiler matters.
+const std::string c_compilerIdentity = "D3DCompiler_" + std::to_string(D3D_COMPILER_VERSION);
+
 }  // namespace
 
 TestTextureD3D11::TestTextureD3D11(Type testType, varjo_TextureFormat varjoFormat, const glm::ivec2& size, ComPtr<ID3D11Device>& d3dDevice, DXGI_FORMAT format)
@@ -76,12 +105,17 @@ TestTextureD3D11::TestTextureD3D11(Type testType, varjo_TextureFormat varjoForma
     try {
         DXGI_FORMAT texFormat = format;
 
-        CD3D11_TEXTURE2D_DESC desc(texFormat, static_cast<UINT>(size.x), static_cast<UINT>(size.y), 1, 1);
-        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        desc.Usage = D3D11_USAGE_STAGING;
-        desc.BindFlags = 0;
-        if (FAILED(hr = d3dDevice->CreateTexture2D(&desc, nullptr, &m_textureCPU))) {
-            CRITICAL("Creating staging texture failed (%d): %s", hr, std::system_category().message(hr).c_str());
+        // Staging texture per upload band, so finished bands are copied while later ones are generated
+        m_bandTextures.resize(m_tiler.getBandCount());
+        for (int i = 0; i < m_tiler.getBandCount(); i++) {
+            const auto band = m_tiler.getBand(i);
+            CD3D11_TEXTURE2D_DESC desc(texFormat, static_cast<UINT>(band.width), static_cast<UINT>(band.height), 1, 1);
+            desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+            desc.Usage = D3D11_USAGE_STAGING;
+            desc.BindFlags = 0;
+            if (FAILED(hr = d3dDevice->CreateTexture2D(&desc, nullptr, &m_bandTextures[i]))) {
+                CRITICAL("Creating staging texture failed (%d): %s", hr, std::system_category().message(hr).c_str());
+            }
         }
 
         m_cpuSupported = true;
@@ -90,6 +124,11 @@ TestTextureD3D11::TestTextureD3D11(Type testType, varjo_TextureFormat varjoForma
         m_cpuSupported = false;
     }
 
+    // Color LUT and blue noise atlas are made on CPU, there is no GPU generator for them
+    if (m_testType == Type::ColorLut || m_testType == Type::BlueNoise) {
+        return;
+    }
+
     // Create GPU mode resources.
     try {
         m_uavFormat = format;
@@ -99,26 +138,40 @@ TestTextureD3D11::TestTextureD3D11(Type testType, varjo_TextureFormat varjoForma
             m_uavFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
         }
 
-        const char* shaderSource = nullptr;
+        std::string shaderSource;
 
         if (m_testType == Type::Gradient) {
             shaderSource = c_gradientShaderSource;
         } else if (m_testType == Type::Noise) {
-            shaderSource = c_noiseShaderSource;
+            shaderSource = getNoiseShaderSource();
         } else {
             CRITICAL("Unsupported type: %d", m_testType);
         }
 
-        // Compile compute shader for generating texture
-        ComPtr<ID3DBlob> shaderBlob = D3D11Renderer::compileShader("postprocess_cs", shaderSource, "cs_5_0");
-        if (!shaderBlob) {
-            CRITICAL("Compiling compute shader failed.");
+        // Get compute shader bytecode from shader cache, compile it on cache miss
+        const uint64_t cacheKey = ShaderCache::makeKey(shaderSource, c_shaderTarget, c_compilerIdentity);
+        const auto cached = ShaderCache::instance().find(cacheKey);
+        ComPtr<ID3DBlob> shaderBlob;
+        const void* bytecode = nullptr;
+        size_t bytecodeSize = 0;
+        if (cached) {
+            bytecode = cached->data.data();
+            bytecodeSize = cached->data.size();
+        } else {
+            shaderBlob = D3D11Renderer::compileShader("postprocess_cs", shaderSource.c_str(), c_shaderTarget);
+            if (!shaderBlob) {
+                CRITICAL("Compiling compute shader failed.");
+            }
+            bytecode = shaderBlob->GetBufferPointer();
+            bytecodeSize = shaderBlob->GetBufferSize();
+            if (!ShaderCache::instance().store(cacheKey, 0, bytecode, bytecodeSize)) {
+                LOG_ERROR("Writing compute shader to shader cache failed.");
+            }
         }
 
         // Create compute shader for generating texture
-        m_generateShader = D3D11Renderer::createComputeShader(d3dDevice.Get(), shaderBlob.Get());
-        if (!m_generateShader) {
-            CRITICAL("Loading compute shader failed.");
+        if (FAILED(hr = d3dDevice->CreateComputeShader(bytecode, bytecodeSize, nullptr, &m_generateShader))) {
+            CRITICAL("Loading compute shader failed (%d): %s", hr, std::system_category().message(hr).c_str());
         }
 
         m_gpuSupported = true;
@@ -131,7 +184,7 @@ TestTextureD3D11::TestTextureD3D11(Type testType, varjo_TextureFormat varjoForma
 TestTextureD3D11::~TestTextureD3D11()
 {
     // Free resources
-    m_textureCPU.Reset();
+    m_bandTextures.clear();
     m_generateShader.Reset();
 }
 
@@ -152,26 +205,28 @@ void TestTextureD3D11::generateOnGPU(ID3D11Texture2D* dstTexture)
     }
 
     // Set UAV
-    std::vector<ID3D11UnorderedAccessView*> uavs;
-    uavs.push_back(textureUAV.Get());
-    m_d3dContext->CSSetUnorderedAccessViews(0, static_cast<UINT>(uavs.size()), uavs.data(), nullptr);
+    ID3D11UnorderedAccessView* uavs[] = {textureUAV.Get()};
+    m_d3dContext->CSSetUnorderedAccessViews(0, 1, uavs, nullptr);
 
     // Constant buffer
     // We are now re-generating these on each update, but we could also stash this
     ComPtr<ID3D11Buffer> cb;
+    NoiseConstantBuffer noiseKey;
     if (m_testType == Type::Noise) {
-        glm::vec4 noiseSeeds(rand(), rand(), rand(), rand());
+        noiseKey.frame = static_cast<uint32_t>(m_frameIndex++);
+        noiseKey.seed = m_noiseSeed;
+        noiseKey.unorm8 = isUnorm8() ? 1 : 0;
 
         D3D11_BUFFER_DESC bufferDesc;
         bufferDesc.Usage = D3D11_USAGE_DEFAULT;
-        bufferDesc.ByteWidth = sizeof(noiseSeeds);
+        bufferDesc.ByteWidth = sizeof(noiseKey);
         bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
         bufferDesc.CPUAccessFlags = 0;
         bufferDesc.MiscFlags = 0;
 
         D3D11_SUBRESOURCE_DATA dataDesc;
-        dataDesc.pSysMem = &noiseSeeds;
-        dataDesc.SysMemPitch = sizeof(noiseSeeds);
+        dataDesc.pSysMem = &noiseKey;
+        dataDesc.SysMemPitch = sizeof(noiseKey);
 
         if (FAILED(hr = m_d3dDevice->CreateBuffer(&bufferDesc, &dataDesc, &cb))) {
             m_gpuSupported = false;
@@ -182,42 +237,93 @@ void TestTextureD3D11::generateOnGPU(ID3D11Texture2D* dstTexture)
         m_d3dContext->CSSetConstantBuffers(0, 1, cbs);
     }
 
-    // Dispatch compute shader
-    m_d3dContext->Dispatch(16, 16, 1);
+    // Dispatch compute shader, 16x16 threads per group. Writes outside the texture are discarded.
+    m_d3dContext->Dispatch((m_size.x + 15) / 16, (m_size.y + 15) / 16, 1);
+
+    // Check once that GPU noise matches CPU noise. Formats without exact CPU counterpart are skipped.
+    if (m_testType == Type::Noise && !m_noiseVerified && m_varjoFormat != varjo_TextureFormat_R32_UINT) {
+        m_noiseVerified = true;
+        verifyNoise(dstTexture, noiseKey.frame);
+    }
 }
 
-void TestTextureD3D11::generateOnCPU(ID3D11Texture2D* dstTexture)
+bool TestTextureD3D11::verifyNoise(ID3D11Texture2D* texture, uint32_t frame)
 {
     HRESULT hr = 0;
 
-    // Map staging texture and generate some noise on CPU
+    // Read generated texture back through a staging copy
+    D3D11_TEXTURE2D_DESC desc{};
+    texture->GetDesc(&desc);
+    desc.Usage = D3D11_USAGE_STAGING;
+    desc.BindFlags = 0;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    desc.MiscFlags = 0;
+    ComPtr<ID3D11Texture2D> readback;
+    if (FAILED(hr = m_d3dDevice->CreateTexture2D(&desc, nullptr, &readback))) {
+        LOG_ERROR("Creating noise readback texture failed (%d)", hr);
+        return false;
+    }
+    m_d3dContext->CopyResource(readback.Get(), texture);
+
     D3D11_MAPPED_SUBRESOURCE mapped{};
-    if (FAILED(hr = m_d3dContext->Map(m_textureCPU.Get(), 0, D3D11_MAP_WRITE, 0, &mapped))) {
-        m_cpuSupported = false;
-        CRITICAL("Mapping texture for writing failed. err=%d", hr);
+    if (FAILED(hr = m_d3dContext->Map(readback.Get(), 0, D3D11_MAP_READ, 0, &mapped))) {
+        LOG_ERROR("Mapping noise readback texture failed (%d)", hr);
+        return false;
     }
 
-    // Generate noise
-    if (m_varjoFormat == varjo_TextureFormat_R32_FLOAT) {
-        generate(static_cast<float*>(mapped.pData), mapped.RowPitch);
-    } else if (m_varjoFormat == varjo_TextureFormat_R32_UINT) {
-        // HACK : Our shader is reading floats from texture, so we write the buffer here in float format,
-        // even though the texture is uint32. If you use data as uints, you should write it as uint32_t here.
-        generate(static_cast<float*>(mapped.pData), mapped.RowPitch);
-        // generate(static_cast<uint32_t*>(mapped.pData));
+    // Same frame generated on CPU
+    const size_t rowBytes = m_size.x * m_numChannels * (isUnorm8() ? sizeof(uint8_t) : sizeof(float));
+    std::vector<uint8_t> expected(rowBytes * m_size.y);
+    if (isUnorm8()) {
+        HashNoise::generate(frame, m_noiseSeed, m_size.x, m_size.y, m_numChannels, expected.data(), rowBytes);
     } else {
-        generate(static_cast<uint8_t*>(mapped.pData), mapped.RowPitch);
+        HashNoise::generate(frame, m_noiseSeed, m_size.x, m_size.y, m_numChannels, reinterpret_cast<float*>(expected.data()), rowBytes);
+    }
+
+    int mismatchRows = 0;
+    for (int y = 0; y < m_size.y; y++) {
+        if (std::memcmp(static_cast<const uint8_t*>(mapped.pData) + y * mapped.RowPitch, expected.data() + y * rowBytes, rowBytes) != 0) {
+            mismatchRows++;
+        }
     }
+    m_d3dContext->Unmap(readback.Get(), 0);
 
-    // Unmap staging texture
-    m_d3dContext->Unmap(m_textureCPU.Get(), 0);
+    if (mismatchRows > 0) {
+        LOG_ERROR("GPU noise differs from CPU noise on %d of %d rows.", mismatchRows, m_size.y);
+        return false;
+    }
+    LOG_INFO("GPU noise matches CPU noise.");
+    return true;
+}
 
-    // Copy texture from CPU staging texture to varjo GPU texture.
-    m_d3dContext->CopyResource(dstTexture, m_textureCPU.Get());
+void TestTextureD3D11::generateOnCPU(ID3D11Texture2D* dstTexture)
+{
+    HRESULT hr = 0;
+
+    // Generate noise on CPU band by band to mapped staging textures
+    int bandIndex = 0;
+    const auto getTarget = [&](const Region&, size_t& rowPitch) {
+        D3D11_MAPPED_SUBRESOURCE mapped{};
+        if (FAILED(hr = m_d3dContext->Map(m_bandTextures[bandIndex].Get(), 0, D3D11_MAP_WRITE, 0, &mapped))) {
+            m_cpuSupported = false;
+            CRITICAL("Mapping texture for writing failed. err=%d", hr);
+        }
+        rowPitch = mapped.RowPitch;
+        return static_cast<uint8_t*>(mapped.pData);
+    };
+    const auto upload = [&](const Region& band) {
+        // Unmap staging texture and copy band to varjo GPU texture
+        ID3D11Texture2D* staging = m_bandTextures[bandIndex++].Get();
+        m_d3dContext->Unmap(staging, 0);
+        m_d3dContext->CopySubresourceRegion(dstTexture, 0, 0, static_cast<UINT>(band.y), 0, staging, 0, nullptr);
+    };
+    generateBands(std::ref(getTarget), std::ref(upload));
 }
 
 void TestTextureD3D11::update(const varjo_Texture& varjoTexture, bool useGPU)
 {
+    TRACE_SCOPE("TestTextureD3D11::update");
+
     ID3D11Texture2D* d3dTexture = nullptr;
     d3dTexture = varjo_ToD3D11Texture(varjoTexture);
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vector>
 #include <d3d11_1.h>
 
 #include "Globals.hpp"
@@ -24,10 +25,14 @@ private:
     //! Generate noise texture on CPU
     void generateOnCPU(ID3D11Texture2D* dstTexture);
 
+    //! Read back noise generated on GPU and compare it to CPU noise of the same frame. Returns true if equal.
+    bool verifyNoise(ID3D11Texture2D* texture, uint32_t frame);
+
 private:
-    ComPtr<ID3D11Device> m_d3dDevice;               //!< D3D11 device
-    ComPtr<ID3D11DeviceContext> m_d3dContext;       //!< D3D11 context
-    ComPtr<ID3D11Texture2D> m_textureCPU;           //!< generated texture (CPU mode)
-    ComPtr<ID3D11ComputeShader> m_generateShader;   //!< Generating compute shader (GPU mode)
-    DXGI_FORMAT m_uavFormat = DXGI_FORMAT_UNKNOWN;  //!< UAV format (GPU mode)
+    ComPtr<ID3D11Device> m_d3dDevice;                     //!< D3D11 device
+    ComPtr<ID3D11DeviceContext> m_d3dContext;             //!< D3D11 context
+    std::vector<ComPtr<ID3D11Texture2D>> m_bandTextures;  //!< Staging texture per upload band (CPU mode)
+    ComPtr<ID3D11ComputeShader> m_generateShader;         //!< Generating compute shader (GPU mode)
+    DXGI_FORMAT m_uavFormat = DXGI_FORMAT_UNKNOWN;        //!< UAV format (GPU mode)
+    bool m_noiseVerified = false;                         //!< GPU noise compared to CPU noise
 };
@@ -9,6 +9,8 @@
 
 #include <Varjo_d3d12.h>
 
+#include "TraceRecorder.hpp"
+
 namespace
 {
 uint64_t align(uint64_t uLocation, uint64_t uAlign)
@@ -70,10 +72,8 @@ TestTextureD3D12::TestTextureD3D12(
         CHECK_HRESULT(HRESULT_FROM_WIN32(GetLastError()));
     }
 
-    constexpr int numChannels = 4;
-
-    // Create upload buffer
-    auto bufSize = m_size.y * align(m_size.x * numChannels * sizeof(float), D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+    // Create upload buffer, with room for texture data placement alignment
+    const auto bufSize = m_size.y * PixelConvert::getRowPitch(m_pixelFormat, m_size.x, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
     auto desc = CD3DX12_RESOURCE_DESC::Buffer(bufSize);
     auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD, 1, 1);
     hr = m_device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&m_uploadBuffer));
@@ -97,13 +97,7 @@ TestTextureD3D12::TestTextureD3D12(
         subresFootprint.Height = m_size.y;
         subresFootprint.Depth = 1;
 
-        if (m_varjoFormat == varjo_TextureFormat_R32_FLOAT) {
-            subresFootprint.RowPitch = static_cast<UINT>(align(m_size.x * numChannels * sizeof(float), D3D12_TEXTURE_DATA_PITCH_ALIGNMENT));
-        } else if (m_varjoFormat == varjo_TextureFormat_R32_UINT) {
-            subresFootprint.RowPitch = static_cast<UINT>(align(m_size.x * numChannels * sizeof(uint32_t), D3D12_TEXTURE_DATA_PITCH_ALIGNMENT));
-        } else {
-            subresFootprint.RowPitch = static_cast<UINT>(align(m_size.x * numChannels * sizeof(uint8_t), D3D12_TEXTURE_DATA_PITCH_ALIGNMENT));
-        }
+        subresFootprint.RowPitch = static_cast<UINT>(PixelConvert::getRowPitch(m_pixelFormat, m_size.x, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT));
 
         hr = suballocateFromBuffer(m_pDataCur, m_pDataEnd, subresFootprint.Height * subresFootprint.RowPitch, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
         CHECK_HRESULT(hr);
@@ -165,42 +159,45 @@ void TestTextureD3D12::generateOnCPU(ID3D12Resource* dstTexture)
     // Wait for previous frame
     waitForPreviousFrame();
 
-    uint8_t* mappedData = m_pDataBegin + m_uploadFootprint.Offset;
-
-    if (m_varjoFormat == varjo_TextureFormat_R32_FLOAT) {
-        generate(reinterpret_cast<float*>(mappedData), m_uploadFootprint.Footprint.RowPitch);
-    } else if (m_varjoFormat == varjo_TextureFormat_R32_UINT) {
-        // HACK : Our shader is reading floats from texture, so we write the buffer here in float format,
-        // even though the texture is uint32. If you use data as uints, you should write it as uint32_t here.
-        generate(reinterpret_cast<float*>(mappedData), m_uploadFootprint.Footprint.RowPitch);
-    } else {
-        generate(reinterpret_cast<uint8_t*>(mappedData), m_uploadFootprint.Footprint.RowPitch);
-    }
-
-    // Reset command allocator
-    hr = m_commandAllocators[m_fenceValue % m_commandAllocators.size()]->Reset();
+    // Reset command allocator. Band command lists are recorded to it until the next frame.
+    auto* commandAllocator = m_commandAllocators[m_fenceValue % m_commandAllocators.size()].Get();
+    hr = commandAllocator->Reset();
     CHECK_HRESULT(hr);
 
-    // Reset command list
-    hr = m_commandList->Reset(m_commandAllocators[m_fenceValue % m_commandAllocators.size()].Get(), nullptr);
-    CHECK_HRESULT(hr);
+    uint8_t* mappedData = m_pDataBegin + m_uploadFootprint.Offset;
+    const UINT rowPitch = m_uploadFootprint.Footprint.RowPitch;
+
+    // Generate bands to upload buffer, copying each finished band to the texture
+    const auto getTarget = [&](const Region& band, size_t& bandRowPitch) {
+        bandRowPitch = rowPitch;
+        return mappedData + static_cast<size_t>(band.y) * rowPitch;
+    };
+    const auto upload = [&](const Region& band) {
+        // Command list can be reset as soon as it has been submitted
+        hr = m_commandList->Reset(commandAllocator, nullptr);
+        CHECK_HRESULT(hr);
 
-    // Copy upload buffer to texture
-    auto dst = CD3DX12_TEXTURE_COPY_LOCATION(dstTexture, 0);
-    auto src = CD3DX12_TEXTURE_COPY_LOCATION(m_uploadBuffer.Get(), m_uploadFootprint);
-    m_commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+        // Copy band from upload buffer to texture
+        auto dst = CD3DX12_TEXTURE_COPY_LOCATION(dstTexture, 0);
+        auto src = CD3DX12_TEXTURE_COPY_LOCATION(m_uploadBuffer.Get(), m_uploadFootprint);
+        const D3D12_BOX box = {0, static_cast<UINT>(band.y), 0, static_cast<UINT>(band.width), static_cast<UINT>(band.y + band.height), 1};
+        m_commandList->CopyTextureRegion(&dst, 0, static_cast<UINT>(band.y), 0, &src, &box);
 
-    // Close command list
-    hr = m_commandList->Close();
-    CHECK_HRESULT(hr);
+        // Close command list
+        hr = m_commandList->Close();
+        CHECK_HRESULT(hr);
 
-    // Execute commands
-    ID3D12CommandList* commandLists[] = {m_commandList.Get()};
-    m_commandQueue->ExecuteCommandLists(1, commandLists);
+        // Execute commands
+        ID3D12CommandList* commandLists[] = {m_commandList.Get()};
+        m_commandQueue->ExecuteCommandLists(1, commandLists);
+    };
+    generateBands(std::ref(getTarget), std::ref(upload));
 }
 
 void TestTextureD3D12::update(const varjo_Texture& varjoTexture, bool useGPU)
 {
+    TRACE_SCOPE("TestTextureD3D12::update");
+
     // Get D3D12 texture
     ID3D12Resource* d3d12Texture = varjo_ToD3D12Texture(varjoTexture);
 
@@ -1,11 +1,18 @@
 
 #include "TestTextureGL.hpp"
 
+#include <chrono>
 #include <cstdio>
+#include <mutex>
 #include <vector>
 #include <unordered_map>
 #include <Varjo_gl.h>
 
+#include "FrameArena.hpp"
+#include "HashNoise.hpp"
+#include "ShaderCache.hpp"
+#include "TraceRecorder.hpp"
+
 #define CHECK_GL_ERR()                                                            \
     {                                                                             \
         auto err = glGetError();                                                  \
@@ -16,32 +23,45 @@
 
 namespace
 {
-// Example compute shader for generating noise texture on GPU
-static const char* c_noiseShaderSource = R"(
+// Example compute shader for generating noise texture on GPU, see HashNoise for the hash function
+static const char* c_noiseShaderHeader = R"(
 #version 430
 
+// Hash function is shared with HLSL
+#define uint4 uvec4
+#define float4 vec4
+
 layout(local_size_x = 1, local_size_y = 1) in;
 layout(rgba32f, binding = 0) uniform image2D tex;
 //layout(r32f, binding = 0) uniform image2D tex;
 //layout(r8ui, binding = 0) uniform image2D tex;
 
-uniform vec4 noiseSeed;
+// Frame number, seed, 1 if target is 8-bit unorm, unused
+layout(location = 0) uniform uvec4 noiseKey;
+)";
 
+static const char* c_noiseShaderMain = R"(
 void main() {
 
     // get index in global work group i.e xy position
     ivec2 uv = ivec2(gl_GlobalInvocationID.xy);
 
-    // Generate noise
-    const float PHI = 1.61803398874989484820459;
-    vec2 xy = vec2(uv) + 1.0;
-    vec4 rgba = fract(tan(noiseSeed*distance(PHI * xy, xy)) * xy.x);
+    // Generate noise, bit identical to CPU noise
+    uvec4 v = hashNoise(uvec4(gl_GlobalInvocationID.xy, noiseKey.xy));
+    vec4 rgba = (noiseKey.z != 0u) ? hashNoiseUnorm8(v) : hashNoiseFloat(v);
 
     // Output to a specific pixel in the image
     imageStore(tex, uv, rgba);
 }
 )";
 
+// Returns noise shader source with hash function shared with CPU noise
+const std::string& getNoiseShaderSource()
+{
+    static const std::string s_source = std::string(c_noiseShaderHeader) + HashNoise::getShaderSource() + c_noiseShaderMain;
+    return s_source;
+}
+
 // Example compute shader for generating gradient texture on GPU
 static const char* c_gradientShaderSource = R"(
 #version 430
@@ -68,15 +88,14 @@ void main() {
 }
 )";
 
-bool loadShader(const char* source, GLuint& shaderId, GLuint& programId)
+// Compile and link compute program from source
+GLuint compileProgram(const char* source)
 {
-    shaderId = programId = 0;
-
     constexpr int maxLen = 1024;
     int len;
     std::vector<GLchar> errorLog(1024);
 
-    shaderId = glCreateShader(GL_COMPUTE_SHADER);
+    GLuint shaderId = glCreateShader(GL_COMPUTE_SHADER);
     CHECK_GL_ERR();
     glShaderSource(shaderId, 1, &source, NULL);
     CHECK_GL_ERR();
@@ -85,26 +104,140 @@ bool loadShader(const char* source, GLuint& shaderId, GLuint& programId)
     glGetShaderInfoLog(shaderId, maxLen, &len, errorLog.data());
     CHECK_GL_ERR();
     if (len > 0) {
+        glDeleteShader(shaderId);
         CRITICAL("Compiling GL compute shader failed: %s", std::string(errorLog.data()).c_str());
     }
 
-    programId = glCreateProgram();
+    GLuint programId = glCreateProgram();
+    CHECK_GL_ERR();
+    // Ask driver to keep the binary retrievable for the shader cache
+    glProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     CHECK_GL_ERR();
     glAttachShader(programId, shaderId);
     CHECK_GL_ERR();
     glLinkProgram(programId);
     CHECK_GL_ERR();
+
+    // Shader object is not needed after linking
+    glDetachShader(programId, shaderId);
+    glDeleteShader(shaderId);
+    CHECK_GL_ERR();
+
     glGetProgramInfoLog(programId, maxLen, &len, errorLog.data());
     CHECK_GL_ERR();
     if (len > 0) {
+        glDeleteProgram(programId);
         CRITICAL("Linking GL compute shader failed: %s", std::string(errorLog.data()).c_str());
     }
 
-    return true;
+    return programId;
+}
+
+// Returns true if driver supports loading program binaries
+bool isProgramBinarySupported()
+{
+    GLint numFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+    return glGetError() == GL_NO_ERROR && numFormats > 0;
+}
+
+// Returns driver identity string. Program binaries are only valid for the driver that created them.
+std::string getDriverIdentity()
+{
+    std::string identity;
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        const auto* str = reinterpret_cast<const char*>(glGetString(name));
+        identity += str ? str : "";
+        identity += '\n';
+    }
+    return identity;
+}
+
+// Create program from cached binary. Returns 0 if driver rejects the binary, e.g. after a driver update.
+GLuint loadProgramBinary(const ShaderCache::Binary& binary)
+{
+    GLuint programId = glCreateProgram();
+    CHECK_GL_ERR();
+    glProgramBinary(programId, binary.format, binary.data.data(), static_cast<GLsizei>(binary.data.size()));
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(programId, GL_LINK_STATUS, &status);
+    if (glGetError() != GL_NO_ERROR || status != GL_TRUE) {
+        glDeleteProgram(programId);
+        return 0;
+    }
+    return programId;
+}
+
+// Store linked program binary to shader cache
+void storeProgramBinary(uint64_t key, GLuint programId)
+{
+    GLint length = 0;
+    glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &length);
+    CHECK_GL_ERR();
+    if (length <= 0) {
+        return;
+    }
+
+    std::vector<uint8_t> data(length);
+    GLenum format = 0;
+    glGetProgramBinary(programId, length, nullptr, &format, data.data());
+    CHECK_GL_ERR();
+
+    if (!ShaderCache::instance().store(key, format, data.data(), data.size())) {
+        LOG_ERROR("Writing GL program binary to shader cache failed.");
+    }
 }
 
 }  // namespace
 
+//! Compute program shared by test textures generating with the same shader
+struct TestTextureGL::Program {
+    GLuint id = 0;  //!< Program ID
+
+    ~Program() { glDeleteProgram(id); }
+};
+
+std::shared_ptr<TestTextureGL::Program> TestTextureGL::getProgram(const char* source)
+{
+    TRACE_SCOPE("TestTextureGL::getProgram");
+
+    // Programs are kept alive by the textures using them
+    static std::mutex s_mutex;
+    static std::unordered_map<uint64_t, std::weak_ptr<Program>> s_programs;
+
+    const uint64_t key = ShaderCache::makeKey(source, "", getDriverIdentity());
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (auto program = s_programs[key].lock()) {
+        return program;
+    }
+
+    const auto startTime = std::chrono::high_resolution_clock::now();
+
+    auto program = std::make_shared<Program>();
+    const bool binarySupported = isProgramBinarySupported();
+    if (binarySupported) {
+        if (const auto binary = ShaderCache::instance().find(key)) {
+            program->id = loadProgramBinary(*binary);
+        }
+    }
+
+    const bool cached = program->id != 0;
+    if (!cached) {
+        program->id = compileProgram(source);
+        if (binarySupported) {
+            storeProgramBinary(key, program->id);
+        }
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+    LOG_DEBUG("GL compute program %s in %.2f ms", cached ? "loaded from shader cache" : "compiled", ms);
+
+    s_programs[key] = program;
+    return program;
+}
+
 TestTextureGL::TestTextureGL(Type testType, varjo_TextureFormat varjoFormat, const glm::ivec2& size, GLenum baseFormat, GLenum internalFormat)
     : TestTexture(testType, varjoFormat, size)
     , m_baseFormat(baseFormat)
@@ -118,21 +251,24 @@ TestTextureGL::TestTextureGL(Type testType, varjo_TextureFormat varjoFormat, con
         m_cpuSupported = false;
     }
 
+    // Color LUT and blue noise atlas are made on CPU, there is no GPU generator for them
+    if (m_testType == Type::ColorLut || m_testType == Type::BlueNoise) {
+        return;
+    }
+
     // Init GPU generate
     try {
         const char* shaderSource = nullptr;
         if (m_testType == Type::Gradient) {
             shaderSource = c_gradientShaderSource;
         } else if (m_testType == Type::Noise) {
-            shaderSource = c_noiseShaderSource;
+            shaderSource = getNoiseShaderSource().c_str();
         } else {
             CRITICAL("Unsupported type: %d", m_testType);
         }
 
-        // Load generate compute shader from source
-        if (!loadShader(shaderSource, m_generateShaderId, m_generateProgramId)) {
-            CRITICAL("Loading GL noise compute shader failed.");
-        }
+        // Get generate compute program from shader cache or compile it from source
+        m_generateProgram = getProgram(shaderSource);
 
         m_gpuSupported = true;
     } catch (const std::runtime_error&) {
@@ -141,20 +277,12 @@ TestTextureGL::TestTextureGL(Type testType, varjo_TextureFormat varjoFormat, con
     }
 }
 
-TestTextureGL::~TestTextureGL()
-{
-    // Free resources
-    glDeleteProgram(m_generateProgramId);
-    CHECK_GL_ERR();
-
-    glDeleteShader(m_generateShaderId);
-    CHECK_GL_ERR();
-}
+TestTextureGL::~TestTextureGL() = default;
 
 void TestTextureGL::generateOnGPU(GLuint dstTexture)
 {
     // Bind compute shader
-    glUseProgram(m_generateProgramId);
+    glUseProgram(m_generateProgram->id);
     CHECK_GL_ERR();
 
     auto bindImageFormat = m_internalFormat;
@@ -179,10 +307,9 @@ void TestTextureGL::generateOnGPU(GLuint dstTexture)
     glBindImageTexture(0, dstTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, bindImageFormat);
     CHECK_GL_ERR();
 
-    // Set uniforms for noise seed
+    // Set uniforms for noise frame and seed
     if (m_testType == Type::Noise) {
-        glm::vec4 seed(rand(), rand(), rand(), rand());
-        glUniform4fv(0, 1, &seed.x);
+        glUniform4ui(0, static_cast<GLuint>(m_frameIndex++), m_noiseSeed, isUnorm8() ? 1 : 0, 0);
         CHECK_GL_ERR();
     }
 
@@ -205,33 +332,35 @@ void TestTextureGL::generateOnCPU(GLuint dstTexture)
     glBindTexture(GL_TEXTURE_2D, dstTexture);
     CHECK_GL_ERR();
 
-    // Generate CPU noise buffer and update data
+    // Data type of generated texels. R32_UINT holds float bits, uploaded unchanged, see PixelFormat::R32Uint.
+    GLenum dataType = GL_UNSIGNED_BYTE;
     if (m_varjoFormat == varjo_TextureFormat_R32_FLOAT) {
-        const GLenum dataType = GL_FLOAT;
-        std::vector<float> dataBuffer(m_size.x * m_size.y * m_numChannels);
-        generate(dataBuffer.data(), m_size.x * m_numChannels * sizeof(float));
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_size.x, m_size.y, m_baseFormat, dataType, dataBuffer.data());
-        CHECK_GL_ERR();
+        dataType = GL_FLOAT;
     } else if (m_varjoFormat == varjo_TextureFormat_R32_UINT) {
-        const GLenum dataType = GL_UNSIGNED_INT;
-        // HACK: Our shader is reading floats from texture, so we write the buffer here in float format,
-        // even though the texture is uint32. If you use data as uints, you should write it as uint32_t here.
-        std::vector<float> dataBuffer(m_size.x * m_size.y * m_numChannels);
-        // std::vector<uint32_t> dataBuffer(m_size.x * m_size.y * m_numChannels);
-        generate(dataBuffer.data(), m_size.x * m_numChannels * sizeof(float));
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_size.x, m_size.y, m_baseFormat, dataType, dataBuffer.data());
-        CHECK_GL_ERR();
-    } else {
-        const GLenum dataType = GL_UNSIGNED_BYTE;
-        std::vector<uint8_t> dataBuffer(m_size.x * m_size.y * m_numChannels);
-        generate(dataBuffer.data(), m_size.x * m_numChannels * sizeof(uint8_t));
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_size.x, m_size.y, m_baseFormat, dataType, dataBuffer.data());
-        CHECK_GL_ERR();
+        dataType = GL_UNSIGNED_INT;
     }
+
+    // Generate CPU noise band by band to a band buffer in frame arena. Buffer is reused after each band upload.
+    // Rows are aligned to four bytes, the default GL_UNPACK_ALIGNMENT.
+    FrameArena::Scope scope(FrameArena::forThread());
+    const size_t rowPitch = PixelConvert::getRowPitch(m_pixelFormat, m_size.x, 4);
+    ArenaVector<uint8_t> bandBuffer(rowPitch * m_tiler.getBand(0).height);
+
+    const auto getTarget = [&](const Region&, size_t& bandRowPitch) {
+        bandRowPitch = rowPitch;
+        return bandBuffer.data();
+    };
+    const auto upload = [&](const Region& band) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, band.x, band.y, band.width, band.height, m_baseFormat, dataType, bandBuffer.data());
+        CHECK_GL_ERR();
+    };
+    generateBands(std::ref(getTarget), std::ref(upload));
 }
 
 void TestTextureGL::update(const varjo_Texture& varjoTexture, bool useGPU)
 {
+    TRACE_SCOPE("TestTextureGL::update");
+
     // Get GL texture id
     GLuint glTexture = varjo_ToGLTexture(varjoTexture);
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <glm/glm.hpp>
 
 #include "MultiGfxContext.hpp"
@@ -20,6 +21,12 @@ public:
     void update(const varjo_Texture& varjoTexture, bool useGPU) override;
 
 private:
+    struct Program;
+
+    //! Returns compute program for source, shared with other textures using the same source.
+    //! Loaded from shader cache if available, otherwise compiled and stored to cache.
+    static std::shared_ptr<Program> getProgram(const char* source);
+
     //! Generate noise texture on GPU
     void generateOnGPU(GLuint dstTexture);
 
@@ -27,9 +34,8 @@ private:
     void generateOnCPU(GLuint dstTexture);
 
 private:
-    GLenum m_baseFormat = 0;             //!< Base texture format
-    GLenum m_internalFormat = 0;         //!< Internal texture format
-    GLuint m_generateShaderId = 0;       //!< Noise compute shader ID
-    GLuint m_generateProgramId = 0;      //!< Noise compute program ID
-    bool m_gpuNoiseInitialized = false;  //!< GPU noise texture initialized flag
+    GLenum m_baseFormat = 0;                     //!< Base texture format
+    GLenum m_internalFormat = 0;                 //!< Internal texture format
+    std::shared_ptr<Program> m_generateProgram;  //!< Generate compute program
+    bool m_gpuNoiseInitialized = false;          //!< GPU noise texture initialized flag
 };
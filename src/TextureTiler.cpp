@@ -0,0 +1,68 @@
+#include "TextureTiler.hpp"
+
+#include <algorithm>
+
+#include "ThreadPool.hpp"
+#include "TraceRecorder.hpp"
+
+namespace
+{
+// Returns value divided by divisor rounded up
+int divideUp(int value, int divisor) { return (value + divisor - 1) / divisor; }
+
+}  // namespace
+
+TextureTiler::TextureTiler(int width, int height)
+    : TextureTiler(width, height, Params())
+{
+}
+
+TextureTiler::TextureTiler(int width, int height, const Params& params)
+    : m_width(std::max(width, 0))
+    , m_height(std::max(height, 0))
+    , m_params(params)
+{
+    m_params.tileWidth = std::max(m_params.tileWidth, 1);
+    m_params.tileHeight = std::max(m_params.tileHeight, 1);
+    m_params.bandHeight = divideUp(std::max(m_params.bandHeight, 1), m_params.tileHeight) * m_params.tileHeight;
+
+    m_tilesX = divideUp(m_width, m_params.tileWidth);
+    m_bandCount = m_width > 0 ? divideUp(m_height, m_params.bandHeight) : 0;
+}
+
+TextureTiler::Region TextureTiler::getBand(int index) const
+{
+    Region band;
+    band.y = index * m_params.bandHeight;
+    band.width = m_width;
+    band.height = std::min(m_params.bandHeight, m_height - band.y);
+    return band;
+}
+
+int TextureTiler::getTileCount(const Region& band) const { return m_tilesX * divideUp(band.height, m_params.tileHeight); }
+
+TextureTiler::Region TextureTiler::getTile(const Region& band, int index) const
+{
+    Region tile;
+    tile.x = (index % m_tilesX) * m_params.tileWidth;
+    tile.y = band.y + (index / m_tilesX) * m_params.tileHeight;
+    tile.width = std::min(m_params.tileWidth, m_width - tile.x);
+    tile.height = std::min(m_params.tileHeight, band.y + band.height - tile.y);
+    return tile;
+}
+
+void TextureTiler::run(ThreadPool& pool, const std::function<void(const Region& band)>& begin, const std::function<void(const Region& tile)>& generate,
+    const std::function<void(const Region& band)>& upload) const
+{
+    TRACE_SCOPE("TextureTiler::run");
+
+    // Passed by reference wrapper, which std::function stores without allocating, so the frame loop stays off the heap
+    Region band;
+    const auto generateTile = [&](int index) { generate(getTile(band, index)); };
+    for (int i = 0; i < m_bandCount; i++) {
+        band = getBand(i);
+        begin(band);
+        pool.parallelFor(getTileCount(band), std::ref(generateTile));
+        upload(band);
+    }
+}
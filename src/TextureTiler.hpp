@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functional>
+
+class ThreadPool;
+
+//! Splits generation of a large texture into cache sized tiles processed in parallel.
+//!
+//! Tiles are grouped to bands of full width rows. Bands are generated in order, the tiles of each
+//! band in parallel on the thread pool, and each finished band is handed to the upload function on
+//! the calling thread before the next band starts, so a band needs its own target only until
+//! uploaded. Graphics API copies run asynchronously, so the upload of a band overlaps generation
+//! of the following ones, and the first rows reach the GPU after one band instead of the whole
+//! texture.
+class TextureTiler
+{
+public:
+    //! Rectangle in pixels
+    struct Region {
+        int x = 0;       //!< Left column
+        int y = 0;       //!< Top row
+        int width = 0;   //!< Width in pixels
+        int height = 0;  //!< Height in pixels
+    };
+
+    //! Tiling parameters
+    struct Params {
+        int tileWidth = 256;   //!< Tile width, 64 KB tiles at four bytes per pixel
+        int tileHeight = 64;   //!< Tile height
+        int bandHeight = 256;  //!< Rows per upload band, rounded up to whole tiles
+    };
+
+    //! Constructor with default tiling
+    TextureTiler(int width, int height);
+
+    //! Constructor
+    TextureTiler(int width, int height, const Params& params);
+
+    //! Returns number of bands
+    int getBandCount() const { return m_bandCount; }
+
+    //! Returns band of given index
+    Region getBand(int index) const;
+
+    //! Returns number of tiles in given band
+    int getTileCount(const Region& band) const;
+
+    //! Returns tile of given index in given band
+    Region getTile(const Region& band, int index) const;
+
+    //! Process texture band by band as described above. For each band, begin is called on the calling thread,
+    //! then generate for each tile of the band concurrently from pool threads, and finally upload on the
+    //! calling thread. Generate must only write the given tile.
+    void run(ThreadPool& pool, const std::function<void(const Region& band)>& begin, const std::function<void(const Region& tile)>& generate,
+        const std::function<void(const Region& band)>& upload) const;
+
+private:
+    int m_width;          //!< Texture width
+    int m_height;         //!< Texture height
+    Params m_params;      //!< Tiling parameters
+    int m_tilesX = 0;     //!< Tile columns
+    int m_bandCount = 0;  //!< Number of bands
+};
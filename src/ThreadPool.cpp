@@ -0,0 +1,120 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include "TraceRecorder.hpp"
+
+namespace
+{
+// Set for pool worker threads to run nested loops inline
+thread_local bool t_isPoolThread = false;
+
+}  // namespace
+
+ThreadPool::ThreadPool(int numThreads)
+{
+    if (numThreads <= 0) {
+        numThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    // Calling thread participates as well, so spawn one less
+    for (int i = 0; i < numThreads - 1; i++) {
+        m_workers.emplace_back(&ThreadPool::workerMain, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_jobCond.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::instance()
+{
+    static ThreadPool s_instance;
+    return s_instance;
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& func)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    // Run serially if there is nothing to gain or pool is busy
+    std::unique_lock<std::mutex> submitLock(m_submitMutex, std::defer_lock);
+    if (count == 1 || m_workers.empty() || t_isPoolThread || !submitLock.try_lock()) {
+        for (int i = 0; i < count; i++) {
+            func(i);
+        }
+        return;
+    }
+
+    {
+        // Wait for stragglers from previous job before touching job state
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCond.wait(lock, [this] { return m_active == 0; });
+
+        m_func = &func;
+        m_count = count;
+        m_next = 0;
+        m_remaining = count;
+        m_generation++;
+    }
+    m_jobCond.notify_all();
+
+    // Help out on the calling thread
+    runItems();
+
+    // Wait for all items finished
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCond.wait(lock, [this] { return m_remaining == 0; });
+}
+
+void ThreadPool::workerMain(int workerIndex)
+{
+    t_isPoolThread = true;
+    TraceRecorder::instance().setThreadName("Pool worker " + std::to_string(workerIndex));
+
+    uint64_t generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobCond.wait(lock, [&] { return m_quit || m_generation != generation; });
+            if (m_quit) {
+                return;
+            }
+            generation = m_generation;
+            m_active++;
+        }
+
+        runItems();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_active--;
+        }
+        m_doneCond.notify_all();
+    }
+}
+
+void ThreadPool::runItems()
+{
+    int index;
+    while ((index = m_next.fetch_add(1)) < m_count) {
+        (*m_func)(index);
+
+        if (m_remaining.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_doneCond.notify_all();
+        }
+    }
+}
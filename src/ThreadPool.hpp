@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! Simple persistent worker pool for data parallel CPU work (LUT bakes, filter tiles, etc.)
+class ThreadPool
+{
+public:
+    //! Constructor. Zero thread count uses hardware concurrency.
+    explicit ThreadPool(int numThreads = 0);
+
+    //! Destructor
+    ~ThreadPool();
+
+    // Disable copy and assign
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool(const ThreadPool&& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+    ThreadPool& operator=(const ThreadPool&& other) = delete;
+
+    //! Returns number of threads participating in parallel loops, including the caller
+    int getThreadCount() const { return static_cast<int>(m_workers.size()) + 1; }
+
+    //! Run func(index) for index in [0, count) using pool threads and the calling thread. Blocks until done.
+    //! Nested or concurrent calls are executed serially on the calling thread.
+    void parallelFor(int count, const std::function<void(int)>& func);
+
+    //! Returns shared pool instance
+    static ThreadPool& instance();
+
+private:
+    //! Worker thread main loop
+    void workerMain(int workerIndex);
+
+    //! Execute job items until none left
+    void runItems();
+
+private:
+    std::vector<std::thread> m_workers;                //!< Worker threads
+    std::mutex m_submitMutex;                          //!< Held by the thread running the current job
+    std::mutex m_mutex;                                //!< Job state mutex
+    std::condition_variable m_jobCond;                 //!< Signaled when new job is available
+    std::condition_variable m_doneCond;                //!< Signaled when job items or workers finish
+    const std::function<void(int)>* m_func = nullptr;  //!< Current job function
+    int m_count = 0;                                   //!< Current job item count
+    std::atomic<int> m_next{0};                        //!< Next job item index
+    std::atomic<int> m_remaining{0};                   //!< Job items not yet finished
+    int m_active = 0;                                  //!< Workers currently executing job items
+    uint64_t m_generation = 0;                         //!< Job generation counter
+    bool m_quit = false;                               //!< Quit flag for workers
+};
@@ -0,0 +1,138 @@
+#include "TraceRecorder.hpp"
+
+#include <algorithm>
+
+namespace
+{
+// Calling thread's ring buffer
+thread_local void* t_threadBuffer = nullptr;
+
+// Calling thread's name set before its ring buffer was created
+thread_local std::string t_threadName;
+
+// Write string as JSON string literal
+void writeJsonString(std::ostream& out, const char* str)
+{
+    out << '"';
+    for (const char* c = str; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\';
+        }
+        out << *c;
+    }
+    out << '"';
+}
+
+}  // namespace
+
+TraceRecorder::TraceRecorder()
+    : m_epoch(std::chrono::steady_clock::now())
+{
+}
+
+TraceRecorder& TraceRecorder::instance()
+{
+    static TraceRecorder s_instance;
+    return s_instance;
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::getThreadBuffer()
+{
+    if (!t_threadBuffer) {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->events = std::make_unique<Event[]>(c_eventsPerThread);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        buffer->threadId = static_cast<uint32_t>(m_threads.size()) + 1;
+        buffer->name = t_threadName.empty() ? "Thread " + std::to_string(buffer->threadId) : std::move(t_threadName);
+        t_threadBuffer = buffer.get();
+        m_threads.push_back(std::move(buffer));
+    }
+    return *static_cast<ThreadBuffer*>(t_threadBuffer);
+}
+
+void TraceRecorder::record(const char* name, bool isEnd)
+{
+    auto& buffer = getThreadBuffer();
+
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+    const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+
+    auto& event = buffer.events[head & (c_eventsPerThread - 1)];
+    event.name.store(name, std::memory_order_relaxed);
+    event.data.store((static_cast<uint64_t>(ns) << 1) | (isEnd ? 1 : 0), std::memory_order_relaxed);
+
+    // Publish event
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void TraceRecorder::setThreadName(const std::string& name)
+{
+    // Only keep the name until the thread records its first event, so naming threads that never
+    // record doesn't allocate a ring for them
+    if (!t_threadBuffer) {
+        t_threadName = name;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    static_cast<ThreadBuffer*>(t_threadBuffer)->name = name;
+}
+
+void TraceRecorder::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& buffer : m_threads) {
+        buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+void TraceRecorder::writeChromeTrace(std::ostream& out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+
+    for (const auto& buffer : m_threads) {
+        // Thread name metadata
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":";
+        writeJsonString(out, buffer->name.c_str());
+        out << "}}";
+        first = false;
+
+        // Copy the valid part of the ring. Events may be overwritten while copying, so re-check head after.
+        const uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = std::max(buffer->tail.load(std::memory_order_relaxed), head > c_eventsPerThread ? head - c_eventsPerThread : 0);
+
+        std::vector<std::pair<const char*, uint64_t>> events;
+        events.reserve(static_cast<size_t>(head - begin));
+        for (uint64_t i = begin; i < head; i++) {
+            const auto& event = buffer->events[i & (c_eventsPerThread - 1)];
+            events.emplace_back(event.name.load(std::memory_order_relaxed), event.data.load(std::memory_order_relaxed));
+        }
+
+        const uint64_t headAfter = buffer->head.load(std::memory_order_acquire);
+        const uint64_t overwritten = headAfter > c_eventsPerThread ? headAfter - c_eventsPerThread : 0;
+        const size_t skip = static_cast<size_t>(overwritten > begin ? std::min(overwritten - begin, head - begin) : 0);
+
+        // Drop end events whose begin was lost to ring wrap-around
+        int depth = 0;
+        for (size_t i = skip; i < events.size(); i++) {
+            const char* name = events[i].first;
+            const bool isEnd = (events[i].second & 1) != 0;
+            const double us = 0.001 * static_cast<double>(events[i].second >> 1);
+            if (!name || (isEnd && depth == 0)) {
+                continue;
+            }
+            depth += isEnd ? -1 : 1;
+
+            out << ",\n{\"name\":";
+            writeJsonString(out, name);
+            out << ",\"ph\":\"" << (isEnd ? 'E' : 'B') << "\",\"ts\":" << std::fixed << us << std::defaultfloat << ",\"pid\":1,\"tid\":" << buffer->threadId
+                << "}";
+        }
+    }
+
+    out << "\n]}";
+}
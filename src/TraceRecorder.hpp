@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//! Timeline trace recorder writing Chrome trace JSON (readable by Perfetto and chrome://tracing).
+//!
+//! Each thread records begin and end events into its own fixed size ring buffer, so recording
+//! takes no locks and the latest events are always available. The ring is allocated when the
+//! thread records its first event, so threads never traced cost nothing. Event names must be
+//! string literals or otherwise outlive the recorder.
+class TraceRecorder
+{
+public:
+    //! Scoped trace event
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name)
+            : m_name(TraceRecorder::instance().isEnabled() ? name : nullptr)
+        {
+            if (m_name) {
+                TraceRecorder::instance().begin(m_name);
+            }
+        }
+
+        ~Scope()
+        {
+            if (m_name) {
+                TraceRecorder::instance().end(m_name);
+            }
+        }
+
+        Scope(const Scope& other) = delete;
+        Scope& operator=(const Scope& other) = delete;
+
+    private:
+        const char* m_name;  //!< Event name, null if not recording
+    };
+
+    //! Events kept per thread
+    static constexpr size_t c_eventsPerThread = size_t(1) << 16;
+
+    //! Returns recorder instance
+    static TraceRecorder& instance();
+
+    //! Enable or disable recording
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+
+    //! Returns true if recording is enabled
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    //! Record begin event on calling thread
+    void begin(const char* name) { record(name, false); }
+
+    //! Record end event on calling thread
+    void end(const char* name) { record(name, true); }
+
+    //! Set name for the calling thread shown in the trace. Doesn't allocate the thread's ring.
+    void setThreadName(const std::string& name);
+
+    //! Discard all recorded events
+    void clear();
+
+    //! Write recorded events as Chrome trace JSON
+    void writeChromeTrace(std::ostream& out) const;
+
+private:
+    //! Ring buffer event. Timestamp in ns shifted left by one, lowest bit set for end events.
+    struct Event {
+        std::atomic<const char*> name{nullptr};  //!< Event name
+        std::atomic<uint64_t> data{0};           //!< Timestamp and phase
+    };
+
+    //! Per thread event ring buffer
+    struct ThreadBuffer {
+        uint32_t threadId = 0;            //!< Sequential thread id
+        std::string name;                 //!< Thread name
+        std::unique_ptr<Event[]> events;  //!< Event ring
+        std::atomic<uint64_t> head{0};    //!< Total events written
+        std::atomic<uint64_t> tail{0};    //!< First event index not cleared
+    };
+
+    //! Private constructor
+    TraceRecorder();
+
+    //! Record event on calling thread
+    void record(const char* name, bool isEnd);
+
+    //! Returns ring buffer for calling thread, creating it on first recorded event
+    ThreadBuffer& getThreadBuffer();
+
+private:
+    std::atomic<bool> m_enabled{false};                    //!< Recording enabled flag
+    const std::chrono::steady_clock::time_point m_epoch;   //!< Trace time origin
+    mutable std::mutex m_mutex;                            //!< Guards thread buffer list and names
+    std::vector<std::unique_ptr<ThreadBuffer>> m_threads;  //!< Thread buffers, kept after threads exit
+};
+
+// Trace enclosing scope with given event name
+#define TRACE_SCOPE_CONCAT_(a, b) a##b
+#define TRACE_SCOPE_CONCAT(a, b) TRACE_SCOPE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceRecorder::Scope TRACE_SCOPE_CONCAT(_traceScope, __LINE__)(name)
@@ -0,0 +1,244 @@
+#include "TransformKernel.hpp"
+
+#include "TransformKernelImpl.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <emmintrin.h>
+#define TRANSFORM_KERNEL_X64 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define TRANSFORM_KERNEL_X64 0
+#endif
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+#include <arm_neon.h>
+#define TRANSFORM_KERNEL_NEON 1
+#else
+#define TRANSFORM_KERNEL_NEON 0
+#endif
+
+namespace
+{
+// Single lane fallback, also used for batch remainders
+struct ScalarOps {
+    using V = float;
+    static constexpr int c_width = 1;
+
+    static V set1(float v) { return v; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+    static V gather(const float* base, const uint32_t* idx) { return base[idx[0]]; }
+
+    static void store4(V x, V y, V z, V w, float* const* dst, size_t offset)
+    {
+        float* p = dst[0] + offset;
+        p[0] = x, p[1] = y, p[2] = z, p[3] = w;
+    }
+};
+
+#if TRANSFORM_KERNEL_X64
+
+// Four lanes with SSE2, always available on x64
+struct Sse2Ops {
+    using V = __m128;
+    static constexpr int c_width = 4;
+
+    static V set1(float v) { return _mm_set1_ps(v); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm_div_ps(a, b); }
+    static V gather(const float* base, const uint32_t* idx) { return _mm_setr_ps(base[idx[0]], base[idx[1]], base[idx[2]], base[idx[3]]); }
+
+    static void store4(V x, V y, V z, V w, float* const* dst, size_t offset)
+    {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(dst[0] + offset, x);
+        _mm_storeu_ps(dst[1] + offset, y);
+        _mm_storeu_ps(dst[2] + offset, z);
+        _mm_storeu_ps(dst[3] + offset, w);
+    }
+};
+
+// Returns true if CPU and OS support AVX2
+bool detectAvx2()
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 1);
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    const bool avx = (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+#if TRANSFORM_KERNEL_NEON
+
+// Four lanes with NEON, always available on ARM64
+struct NeonOps {
+    using V = float32x4_t;
+    static constexpr int c_width = 4;
+
+    static V set1(float v) { return vdupq_n_f32(v); }
+    static V add(V a, V b) { return vaddq_f32(a, b); }
+    static V sub(V a, V b) { return vsubq_f32(a, b); }
+    static V mul(V a, V b) { return vmulq_f32(a, b); }
+    static V div(V a, V b) { return vdivq_f32(a, b); }
+
+    static V gather(const float* base, const uint32_t* idx)
+    {
+        const float v[4] = {base[idx[0]], base[idx[1]], base[idx[2]], base[idx[3]]};
+        return vld1q_f32(v);
+    }
+
+    static void store4(V x, V y, V z, V w, float* const* dst, size_t offset)
+    {
+        const float32x4x2_t xy = vzipq_f32(x, y);
+        const float32x4x2_t zw = vzipq_f32(z, w);
+        vst1q_f32(dst[0] + offset, vcombine_f32(vget_low_f32(xy.val[0]), vget_low_f32(zw.val[0])));
+        vst1q_f32(dst[1] + offset, vcombine_f32(vget_high_f32(xy.val[0]), vget_high_f32(zw.val[0])));
+        vst1q_f32(dst[2] + offset, vcombine_f32(vget_low_f32(xy.val[1]), vget_low_f32(zw.val[1])));
+        vst1q_f32(dst[3] + offset, vcombine_f32(vget_high_f32(xy.val[1]), vget_high_f32(zw.val[1])));
+    }
+};
+
+#endif
+
+// Run kernel with given instruction set and finish remainder with scalar code
+void run(const PoseArrays& poses, const uint32_t* indices, size_t count, const TransformKernelParams& params, const MatrixOutput& out,
+    TransformKernel::Isa isa)
+{
+    if (!TransformKernel::isSupported(isa)) {
+        isa = TransformKernel::Isa::Scalar;
+    }
+
+    size_t done = 0;
+    switch (isa) {
+#if TRANSFORM_KERNEL_X64
+        case TransformKernel::Isa::Sse2:
+            done = transformBatches<Sse2Ops>(poses, indices, count, params, out);
+            break;
+        case TransformKernel::Isa::Avx2:
+            done = transformAvx2(poses, indices, count, params, out);
+            break;
+#endif
+#if TRANSFORM_KERNEL_NEON
+        case TransformKernel::Isa::Neon:
+            done = transformBatches<NeonOps>(poses, indices, count, params, out);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    if (done < count) {
+        // Remainder output positions are relative to the full index list
+        MatrixOutput rest = out;
+        if (!out.byObjectIndex) {
+            rest.matrix += done * out.matrixStride;
+            rest.normal = out.normal ? out.normal + done * out.normalStride : nullptr;
+        }
+        transformBatches<ScalarOps>(poses, indices + done, count - done, params, rest);
+    }
+}
+
+}  // namespace
+
+namespace TransformKernel
+{
+Isa getBestIsa()
+{
+#if TRANSFORM_KERNEL_X64
+    static const Isa s_isa = detectAvx2() ? Isa::Avx2 : Isa::Sse2;
+    return s_isa;
+#elif TRANSFORM_KERNEL_NEON
+    return Isa::Neon;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+bool isSupported(Isa isa)
+{
+    switch (isa) {
+        case Isa::Scalar:
+            return true;
+        case Isa::Sse2:
+            return TRANSFORM_KERNEL_X64;
+        case Isa::Avx2:
+            return getBestIsa() == Isa::Avx2;
+        case Isa::Neon:
+            return TRANSFORM_KERNEL_NEON;
+    }
+    return false;
+}
+
+const char* getIsaName(Isa isa)
+{
+    switch (isa) {
+        case Isa::Scalar:
+            return "scalar";
+        case Isa::Sse2:
+            return "sse2";
+        case Isa::Avx2:
+            return "avx2";
+        case Isa::Neon:
+            return "neon";
+    }
+    return "unknown";
+}
+
+void transform(const PoseArrays& poses, const uint32_t* indices, size_t count, const glm::mat4& view, const glm::mat4& proj, const MatrixOutput& out, Isa isa)
+{
+    TransformKernelParams params;
+    params.project = true;
+
+    const glm::mat4 viewProj = proj * view;
+    for (int c = 0; c < 4; c++) {
+        for (int r = 0; r < 4; r++) {
+            params.viewProj[c * 4 + r] = viewProj[c][r];
+        }
+    }
+
+    // Inverse transpose of view 3x3 from column cross products
+    const glm::vec3 v0(view[0]);
+    const glm::vec3 v1(view[1]);
+    const glm::vec3 v2(view[2]);
+    const glm::vec3 n[3] = {glm::cross(v1, v2), glm::cross(v2, v0), glm::cross(v0, v1)};
+    const float invDet = 1.0f / glm::dot(v0, n[0]);
+    for (int c = 0; c < 3; c++) {
+        for (int r = 0; r < 3; r++) {
+            params.normalView[c * 3 + r] = n[c][r] * invDet;
+        }
+    }
+
+    run(poses, indices, count, params, out, isa);
+}
+
+void compose(const PoseArrays& poses, const uint32_t* indices, size_t count, const MatrixOutput& out, Isa isa)
+{
+    TransformKernelParams params;
+    params.project = false;
+    for (int i = 0; i < 16; i++) {
+        params.viewProj[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+    }
+    for (int i = 0; i < 9; i++) {
+        params.normalView[i] = (i % 4 == 0) ? 1.0f : 0.0f;
+    }
+
+    run(poses, indices, count, params, out, isa);
+}
+
+}  // namespace TransformKernel
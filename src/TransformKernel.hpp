@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+//! Object poses in structure of arrays layout: translate * rotate (unit quaternion) * scale
+struct PoseArrays {
+    const float* posX = nullptr;    //!< Position x
+    const float* posY = nullptr;    //!< Position y
+    const float* posZ = nullptr;    //!< Position z
+    const float* rotX = nullptr;    //!< Rotation quaternion x
+    const float* rotY = nullptr;    //!< Rotation quaternion y
+    const float* rotZ = nullptr;    //!< Rotation quaternion z
+    const float* rotW = nullptr;    //!< Rotation quaternion w
+    const float* scaleX = nullptr;  //!< Scale x
+    const float* scaleY = nullptr;  //!< Scale y
+    const float* scaleZ = nullptr;  //!< Scale z
+};
+
+//! Output matrix arrays for batch transform kernels
+struct MatrixOutput {
+    float* matrix = nullptr;      //!< First 4x4 column major matrix
+    size_t matrixStride = 16;     //!< Float stride between matrices
+    float* normal = nullptr;      //!< First normal matrix as three xyz0 columns. Optional.
+    size_t normalStride = 12;     //!< Float stride between normal matrices
+    bool byObjectIndex = false;   //!< Write results at object index instead of position in index list
+};
+
+//! Batch kernels composing object poses with view and projection matrices.
+//!
+//! Poses are processed several objects at a time, one object per SIMD lane, with the widest
+//! instruction set available on the running CPU.
+namespace TransformKernel
+{
+//! Instruction set used by kernels
+enum class Isa {
+    Scalar = 0,  //!< Portable scalar code
+    Sse2,        //!< 4 lanes, x64 baseline
+    Avx2,        //!< 8 lanes, detected at runtime
+    Neon,        //!< 4 lanes, ARM64 baseline
+};
+
+//! Returns widest instruction set supported by the running CPU
+Isa getBestIsa();
+
+//! Returns true if given instruction set can be used on the running CPU
+bool isSupported(Isa isa);
+
+//! Returns instruction set name
+const char* getIsaName(Isa isa);
+
+//! Compute proj * view * model and inverse transpose of the upper 3x3 of view * model
+//! for objects given by indices. Normal matrices are skipped if output has none.
+void transform(const PoseArrays& poses, const uint32_t* indices, size_t count, const glm::mat4& view, const glm::mat4& proj, const MatrixOutput& out,
+    Isa isa = getBestIsa());
+
+//! Compute model matrices for objects given by indices
+void compose(const PoseArrays& poses, const uint32_t* indices, size_t count, const MatrixOutput& out, Isa isa = getBestIsa());
+
+}  // namespace TransformKernel
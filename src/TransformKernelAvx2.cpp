@@ -0,0 +1,57 @@
+// AVX2 backend of TransformKernel. Compiled with AVX2 code generation and called only after
+// runtime detection, so nothing outside this file may be compiled from here.
+
+#include "TransformKernelImpl.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+#include <immintrin.h>
+
+namespace
+{
+// Eight lanes with AVX2 gathers
+struct Avx2Ops {
+    using V = __m256;
+    static constexpr int c_width = 8;
+
+    static V set1(float v) { return _mm256_set1_ps(v); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+
+    static V gather(const float* base, const uint32_t* idx)
+    {
+        return _mm256_i32gather_ps(base, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx)), 4);
+    }
+
+    // Transpose four component vectors to per lane xyzw and store at dst[lane] + offset
+    static void store4(V x, V y, V z, V w, float* const* dst, size_t offset)
+    {
+        const __m256 xy0 = _mm256_unpacklo_ps(x, y);
+        const __m256 xy1 = _mm256_unpackhi_ps(x, y);
+        const __m256 zw0 = _mm256_unpacklo_ps(z, w);
+        const __m256 zw1 = _mm256_unpackhi_ps(z, w);
+        const __m256 v0 = _mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 v1 = _mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 v2 = _mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 v3 = _mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(3, 2, 3, 2));
+        _mm_storeu_ps(dst[0] + offset, _mm256_castps256_ps128(v0));
+        _mm_storeu_ps(dst[1] + offset, _mm256_castps256_ps128(v1));
+        _mm_storeu_ps(dst[2] + offset, _mm256_castps256_ps128(v2));
+        _mm_storeu_ps(dst[3] + offset, _mm256_castps256_ps128(v3));
+        _mm_storeu_ps(dst[4] + offset, _mm256_extractf128_ps(v0, 1));
+        _mm_storeu_ps(dst[5] + offset, _mm256_extractf128_ps(v1, 1));
+        _mm_storeu_ps(dst[6] + offset, _mm256_extractf128_ps(v2, 1));
+        _mm_storeu_ps(dst[7] + offset, _mm256_extractf128_ps(v3, 1));
+    }
+};
+
+}  // namespace
+
+size_t transformAvx2(const PoseArrays& poses, const uint32_t* indices, size_t count, const TransformKernelParams& params, const MatrixOutput& out)
+{
+    return transformBatches<Avx2Ops>(poses, indices, count, params, out);
+}
+
+#endif
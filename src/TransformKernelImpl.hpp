@@ -0,0 +1,135 @@
+#pragma once
+
+// Shared body of TransformKernel backends. Included only by the kernel translation units, each
+// providing its own lane operations. Backend code uses plain float arrays instead of glm and has
+// internal linkage, so functions compiled with different instruction set flags are never merged
+// by the linker.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "TransformKernel.hpp"
+
+//! Kernel parameters as plain arrays
+struct TransformKernelParams {
+    float viewProj[16];    //!< Column major matrix applied to model matrices
+    float normalView[9];   //!< Column major matrix applied to model normal matrices
+    bool project = false;  //!< Apply view projection. Model matrices are written as is otherwise.
+};
+
+#if defined(_M_X64) || defined(__x86_64__)
+//! AVX2 backend. Processes whole lane batches and returns number of objects processed.
+size_t transformAvx2(const PoseArrays& poses, const uint32_t* indices, size_t count, const TransformKernelParams& params, const MatrixOutput& out);
+#endif
+
+namespace
+{
+// Batch transform over whole lane batches with given lane operations. Returns number of objects processed.
+template <typename Ops, bool Project, bool Normals>
+size_t transformLanes(const PoseArrays& poses, const uint32_t* indices, size_t count, const TransformKernelParams& params, const MatrixOutput& out)
+{
+    using V = typename Ops::V;
+    constexpr int width = Ops::c_width;
+
+    const V zero = Ops::set1(0.0f);
+    const V one = Ops::set1(1.0f);
+    const V two = Ops::set1(2.0f);
+
+    // Matrices are broadcast to all lanes once
+    V a[16];
+    for (int i = 0; i < 16; i++) {
+        a[i] = Ops::set1(params.viewProj[i]);
+    }
+    V nv[9];
+    for (int i = 0; i < 9; i++) {
+        nv[i] = Ops::set1(params.normalView[i]);
+    }
+
+    size_t n = 0;
+    for (; n + width <= count; n += width) {
+        const uint32_t* idx = indices + n;
+
+        // Rotation matrix columns from quaternion, same as glm::mat3_cast
+        const V x = Ops::gather(poses.rotX, idx);
+        const V y = Ops::gather(poses.rotY, idx);
+        const V z = Ops::gather(poses.rotZ, idx);
+        const V w = Ops::gather(poses.rotW, idx);
+        const V xx = Ops::mul(x, x), yy = Ops::mul(y, y), zz = Ops::mul(z, z);
+        const V xy = Ops::mul(x, y), xz = Ops::mul(x, z), yz = Ops::mul(y, z);
+        const V wx = Ops::mul(w, x), wy = Ops::mul(w, y), wz = Ops::mul(w, z);
+
+        V r[3][3];
+        r[0][0] = Ops::sub(one, Ops::mul(two, Ops::add(yy, zz)));
+        r[0][1] = Ops::mul(two, Ops::add(xy, wz));
+        r[0][2] = Ops::mul(two, Ops::sub(xz, wy));
+        r[1][0] = Ops::mul(two, Ops::sub(xy, wz));
+        r[1][1] = Ops::sub(one, Ops::mul(two, Ops::add(xx, zz)));
+        r[1][2] = Ops::mul(two, Ops::add(yz, wx));
+        r[2][0] = Ops::mul(two, Ops::add(xz, wy));
+        r[2][1] = Ops::mul(two, Ops::sub(yz, wx));
+        r[2][2] = Ops::sub(one, Ops::mul(two, Ops::add(xx, yy)));
+
+        const V s[3] = {Ops::gather(poses.scaleX, idx), Ops::gather(poses.scaleY, idx), Ops::gather(poses.scaleZ, idx)};
+        const V t[3] = {Ops::gather(poses.posX, idx), Ops::gather(poses.posY, idx), Ops::gather(poses.posZ, idx)};
+
+        // Output pointers per lane
+        float* matrix[width];
+        float* normal[width];
+        for (int l = 0; l < width; l++) {
+            const size_t slot = out.byObjectIndex ? idx[l] : n + l;
+            matrix[l] = out.matrix + slot * out.matrixStride;
+            normal[l] = Normals ? out.normal + slot * out.normalStride : nullptr;
+        }
+
+        // Model matrix: translate * rotate * scale
+        for (int c = 0; c < 3; c++) {
+            const V m[3] = {Ops::mul(r[c][0], s[c]), Ops::mul(r[c][1], s[c]), Ops::mul(r[c][2], s[c])};
+            if (Project) {
+                V col[4];
+                for (int row = 0; row < 4; row++) {
+                    col[row] = Ops::add(Ops::add(Ops::mul(a[row], m[0]), Ops::mul(a[4 + row], m[1])), Ops::mul(a[8 + row], m[2]));
+                }
+                Ops::store4(col[0], col[1], col[2], col[3], matrix, c * 4);
+            } else {
+                Ops::store4(m[0], m[1], m[2], zero, matrix, c * 4);
+            }
+        }
+        if (Project) {
+            V col[4];
+            for (int row = 0; row < 4; row++) {
+                col[row] = Ops::add(Ops::add(Ops::mul(a[row], t[0]), Ops::mul(a[4 + row], t[1])), Ops::add(Ops::mul(a[8 + row], t[2]), a[12 + row]));
+            }
+            Ops::store4(col[0], col[1], col[2], col[3], matrix, 12);
+        } else {
+            Ops::store4(t[0], t[1], t[2], one, matrix, 12);
+        }
+
+        // Normal matrix: inverse transpose of (view * rotate * scale) = normalView * rotate * inverse scale
+        if (Normals) {
+            for (int c = 0; c < 3; c++) {
+                const V invScale = Ops::div(one, s[c]);
+                V col[3];
+                for (int row = 0; row < 3; row++) {
+                    const V v = Ops::add(Ops::add(Ops::mul(nv[row], r[c][0]), Ops::mul(nv[3 + row], r[c][1])), Ops::mul(nv[6 + row], r[c][2]));
+                    col[row] = Ops::mul(v, invScale);
+                }
+                Ops::store4(col[0], col[1], col[2], zero, normal, c * 4);
+            }
+        }
+    }
+    return n;
+}
+
+// Select kernel variant for given parameters and output
+template <typename Ops>
+size_t transformBatches(const PoseArrays& poses, const uint32_t* indices, size_t count, const TransformKernelParams& params, const MatrixOutput& out)
+{
+    if (params.project) {
+        return out.normal ? transformLanes<Ops, true, true>(poses, indices, count, params, out)
+                          : transformLanes<Ops, true, false>(poses, indices, count, params, out);
+    }
+    return out.normal ? transformLanes<Ops, false, true>(poses, indices, count, params, out)
+                      : transformLanes<Ops, false, false>(poses, indices, count, params, out);
+}
+
+}  // namespace
@@ -0,0 +1,150 @@
+#include "TransformStore.hpp"
+
+#include <algorithm>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "ThreadPool.hpp"
+#include "TraceRecorder.hpp"
+
+namespace
+{
+// Objects per parallel work item when rebuilding large batches
+constexpr size_t c_rebuildBatchSize = 4096;
+
+}  // namespace
+
+void TransformStore::resize(size_t count)
+{
+    const size_t prevCount = size();
+
+    m_posX.resize(count, 0.0f);
+    m_posY.resize(count, 0.0f);
+    m_posZ.resize(count, 0.0f);
+    m_rotX.resize(count, 0.0f);
+    m_rotY.resize(count, 0.0f);
+    m_rotZ.resize(count, 0.0f);
+    m_rotW.resize(count, 1.0f);
+    m_scaleX.resize(count, 1.0f);
+    m_scaleY.resize(count, 1.0f);
+    m_scaleZ.resize(count, 1.0f);
+    m_dirty.resize(count, 0);
+    m_instances.resize(count);
+
+    // Drop removed objects from dirty lists
+    if (count < prevCount) {
+        const auto removed = [count](uint32_t i) { return i >= count; };
+        m_dirtyList.erase(std::remove_if(m_dirtyList.begin(), m_dirtyList.end(), removed), m_dirtyList.end());
+        m_updatedList.erase(std::remove_if(m_updatedList.begin(), m_updatedList.end(), removed), m_updatedList.end());
+    }
+
+    for (size_t i = prevCount; i < count; i++) {
+        markDirty(i);
+    }
+}
+
+void TransformStore::setPosition(size_t index, const glm::vec3& position)
+{
+    if (m_posX[index] != position.x || m_posY[index] != position.y || m_posZ[index] != position.z) {
+        m_posX[index] = position.x;
+        m_posY[index] = position.y;
+        m_posZ[index] = position.z;
+        markDirty(index);
+    }
+}
+
+void TransformStore::setRotation(size_t index, const glm::quat& rotation)
+{
+    if (m_rotX[index] != rotation.x || m_rotY[index] != rotation.y || m_rotZ[index] != rotation.z || m_rotW[index] != rotation.w) {
+        m_rotX[index] = rotation.x;
+        m_rotY[index] = rotation.y;
+        m_rotZ[index] = rotation.z;
+        m_rotW[index] = rotation.w;
+        markDirty(index);
+    }
+}
+
+void TransformStore::setScale(size_t index, const glm::vec3& scale)
+{
+    if (m_scaleX[index] != scale.x || m_scaleY[index] != scale.y || m_scaleZ[index] != scale.z) {
+        m_scaleX[index] = scale.x;
+        m_scaleY[index] = scale.y;
+        m_scaleZ[index] = scale.z;
+        markDirty(index);
+    }
+}
+
+void TransformStore::setColor(size_t index, const glm::vec4& color, float vtxColorFactor)
+{
+    auto& instance = m_instances[index];
+    instance.color = color;
+    instance.scale.w = vtxColorFactor;
+}
+
+void TransformStore::markDirty(size_t index)
+{
+    if (!m_dirty[index]) {
+        m_dirty[index] = 1;
+        m_dirtyList.push_back(static_cast<uint32_t>(index));
+    }
+}
+
+size_t TransformStore::update()
+{
+    const size_t count = m_dirtyList.size();
+    m_updatedList.clear();
+    if (count == 0) {
+        return 0;
+    }
+
+    TRACE_SCOPE("TransformStore::update");
+
+    if (count <= c_rebuildBatchSize) {
+        rebuild(0, count);
+    } else {
+        const int batchCount = static_cast<int>((count + c_rebuildBatchSize - 1) / c_rebuildBatchSize);
+        ThreadPool::instance().parallelFor(batchCount, [&](int batch) {
+            const size_t begin = batch * c_rebuildBatchSize;
+            rebuild(begin, std::min(begin + c_rebuildBatchSize, count));
+        });
+    }
+
+    m_updatedList.swap(m_dirtyList);
+    return count;
+}
+
+void TransformStore::rebuild(size_t begin, size_t end)
+{
+    // Model matrices in batches with SIMD kernel
+    MatrixOutput out;
+    out.matrix = glm::value_ptr(m_instances[0].model);
+    out.matrixStride = sizeof(Instance) / sizeof(float);
+    out.byObjectIndex = true;
+    TransformKernel::compose(getPoses(), m_dirtyList.data() + begin, end - begin, out);
+
+    for (size_t n = begin; n < end; n++) {
+        const uint32_t i = m_dirtyList[n];
+
+        auto& instance = m_instances[i];
+        instance.scale.x = m_scaleX[i];
+        instance.scale.y = m_scaleY[i];
+        instance.scale.z = m_scaleZ[i];
+
+        m_dirty[i] = 0;
+    }
+}
+
+PoseArrays TransformStore::getPoses() const
+{
+    PoseArrays poses;
+    poses.posX = m_posX.data();
+    poses.posY = m_posY.data();
+    poses.posZ = m_posZ.data();
+    poses.rotX = m_rotX.data();
+    poses.rotY = m_rotY.data();
+    poses.rotZ = m_rotZ.data();
+    poses.rotW = m_rotW.data();
+    poses.scaleX = m_scaleX.data();
+    poses.scaleY = m_scaleY.data();
+    poses.scaleZ = m_scaleZ.data();
+    return poses;
+}
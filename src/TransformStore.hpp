@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "TransformKernel.hpp"
+
+//! Structure of arrays store for object transforms with dirty tracking.
+//!
+//! Pose components are kept in separate arrays and model matrices are rebuilt on update only
+//! for objects changed since the previous update. Per object render data is kept in a flat
+//! instance buffer ready for submitting.
+class TransformStore
+{
+public:
+    //! Per object render data
+    struct Instance {
+        glm::mat4 model{1.0f};                    //!< Model matrix
+        glm::vec4 color{1.0f, 1.0f, 1.0f, 1.0f};  //!< Object color + alpha
+        glm::vec4 scale{1.0f, 1.0f, 1.0f, 1.0f};  //!< Object scale in xyz, vertex color factor in w
+    };
+
+    //! Resize store. Added objects have identity pose and are marked dirty.
+    void resize(size_t count);
+
+    //! Returns object count
+    size_t size() const { return m_instances.size(); }
+
+    //! Set object position. Marks object dirty if changed.
+    void setPosition(size_t index, const glm::vec3& position);
+
+    //! Set object rotation. Marks object dirty if changed.
+    void setRotation(size_t index, const glm::quat& rotation);
+
+    //! Set object scale. Marks object dirty if changed.
+    void setScale(size_t index, const glm::vec3& scale);
+
+    //! Set object color and vertex color factor. Written directly to instance data.
+    void setColor(size_t index, const glm::vec4& color, float vtxColorFactor);
+
+    //! Returns object position
+    glm::vec3 getPosition(size_t index) const { return {m_posX[index], m_posY[index], m_posZ[index]}; }
+
+    //! Returns object scale
+    glm::vec3 getScale(size_t index) const { return {m_scaleX[index], m_scaleY[index], m_scaleZ[index]}; }
+
+    //! Returns pose arrays for batch transform kernels
+    PoseArrays getPoses() const;
+
+    //! Returns number of objects changed since previous update
+    size_t getDirtyCount() const { return m_dirtyList.size(); }
+
+    //! Rebuild instance data for changed objects. Returns number of objects rebuilt.
+    size_t update();
+
+    //! Returns indices of objects rebuilt by the previous update
+    const std::vector<uint32_t>& getUpdatedIndices() const { return m_updatedList; }
+
+    //! Returns instance data. Valid for changed objects after update.
+    const std::vector<Instance>& getInstances() const { return m_instances; }
+
+private:
+    //! Mark object dirty
+    void markDirty(size_t index);
+
+    //! Rebuild instance data for objects in dirty list range
+    void rebuild(size_t begin, size_t end);
+
+private:
+    std::vector<float> m_posX, m_posY, m_posZ;          //!< Object positions
+    std::vector<float> m_rotX, m_rotY, m_rotZ, m_rotW;  //!< Object rotation quaternions
+    std::vector<float> m_scaleX, m_scaleY, m_scaleZ;    //!< Object scales
+    std::vector<uint8_t> m_dirty;                       //!< Per object dirty flags
+    std::vector<uint32_t> m_dirtyList;                  //!< Indices of dirty objects
+    std::vector<uint32_t> m_updatedList;                //!< Indices of objects rebuilt by previous update
+    std::vector<Instance> m_instances;                  //!< Instance data
+};
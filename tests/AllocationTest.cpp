@@ -0,0 +1,142 @@
+// Allocation tests: a steady state frame of the CPU side frame loop must make no heap allocations on
+// the frame loop thread, and allocations must be counted at all for that check to mean anything
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "ColorLut.hpp"
+#include "FrameArena.hpp"
+#include "HashNoise.hpp"
+#include "LatencyTracker.hpp"
+#include "QualityController.hpp"
+#include "Test.hpp"
+#include "TextureTiler.hpp"
+#include "ThreadPool.hpp"
+
+namespace
+{
+// Noise texture size, several bands of tiles
+constexpr int c_textureSize = 512;
+
+// Frames run before counting, first frames size the arena and the texture
+constexpr int c_warmupFrames = 3;
+
+// Frames counted
+constexpr int c_frames = 20;
+
+// Keeps allocations in the counting checks from being optimized away
+void* volatile g_sink = nullptr;
+
+// CPU side work of AppLogic::update in steady state: frame arena reset, latency and quality
+// tracking, color LUT with unchanged parameters, and tiled noise texture generation and upload
+class FrameLoop
+{
+public:
+    FrameLoop()
+        : m_latency(LatencyTracker::makeSteadyClock())
+        , m_tiler(c_textureSize, c_textureSize)
+        , m_texture(static_cast<size_t>(c_textureSize) * c_textureSize * 4)
+        , m_uploaded(static_cast<size_t>(c_textureSize) * c_textureSize * 4)
+    {
+    }
+
+    void runFrame()
+    {
+        FrameArena::forThread().reset();
+        m_latency.beginFrame(m_frame);
+
+        m_colorLut.bake(ColorLut::Params());
+
+        // Updated texture list with capacity kept between frames, as in the frame loop
+        m_updatedTextures.clear();
+        m_tiler.run(
+            ThreadPool::instance(), [this](const TextureTiler::Region& band) { beginBand(band); },
+            [this](const TextureTiler::Region& tile) { generateTile(tile); }, [this](const TextureTiler::Region& band) { uploadBand(band); });
+        m_updatedTextures.push_back(0);
+
+        // Per frame scratch from the frame arena
+        ArenaVector<float> scratch(c_textureSize * 4, 0.0f);
+        scratch[0] = static_cast<float>(m_frame);
+
+        m_latency.mark(LatencyTracker::Event::Apply);
+        m_latency.mark(LatencyTracker::Event::Submit);
+        m_latency.endFrame();
+        m_quality.addFrame(5.0, 11.1);
+        m_frame++;
+    }
+
+private:
+    void beginBand(const TextureTiler::Region& band) { m_bandY = band.y; }
+
+    void generateTile(const TextureTiler::Region& tile)
+    {
+        const size_t rowPitch = static_cast<size_t>(c_textureSize) * 4;
+        HashNoise::generateRegion(static_cast<uint32_t>(m_frame), HashNoise::c_defaultSeed, tile.x, tile.y, tile.width, tile.height, 4,
+            m_texture.data() + tile.y * rowPitch + tile.x * 4, rowPitch);
+    }
+
+    void uploadBand(const TextureTiler::Region& band)
+    {
+        const size_t rowPitch = static_cast<size_t>(c_textureSize) * 4;
+        std::copy(m_texture.begin() + m_bandY * rowPitch, m_texture.begin() + (band.y + band.height) * rowPitch, m_uploaded.begin() + band.y * rowPitch);
+    }
+
+    LatencyTracker m_latency;
+    QualityController m_quality;
+    ColorLut m_colorLut;
+    TextureTiler m_tiler;
+    std::vector<uint8_t> m_texture;
+    std::vector<uint8_t> m_uploaded;
+    std::vector<int32_t> m_updatedTextures;
+    int64_t m_frame = 0;
+    int m_bandY = 0;
+};
+
+#ifdef __cpp_aligned_new
+// Over-aligned type, allocated with the aligned operator new
+struct alignas(64) CacheLine {
+    float values[16];
+};
+#endif
+
+}  // namespace
+
+void runAllocationTests(const std::string& filter)
+{
+    if (!Test::isSelected(filter, "allocation")) {
+        return;
+    }
+
+    // Counting must be on, otherwise the frame check below passes trivially
+    TEST_CHECK(AllocationCounter::isEnabled());
+    uint64_t before = AllocationCounter::getThreadCount();
+    g_sink = new int[4];
+    delete[] static_cast<int*>(g_sink);
+    TEST_CHECK(AllocationCounter::getThreadCount() - before == 1);
+
+#ifdef __cpp_aligned_new
+    before = AllocationCounter::getThreadCount();
+    g_sink = new CacheLine;
+    TEST_CHECK(reinterpret_cast<uintptr_t>(g_sink) % alignof(CacheLine) == 0);
+    delete static_cast<CacheLine*>(g_sink);
+    TEST_CHECK(AllocationCounter::getThreadCount() - before == 1);
+#endif
+
+    // Steady state frames
+    FrameLoop loop;
+    for (int i = 0; i < c_warmupFrames; i++) {
+        loop.runFrame();
+    }
+    before = AllocationCounter::getThreadCount();
+    for (int i = 0; i < c_frames; i++) {
+        loop.runFrame();
+    }
+    const uint64_t allocations = AllocationCounter::getThreadCount() - before;
+    if (!TEST_CHECK(allocations == 0)) {
+        std::printf("allocation: %llu heap allocations in %d steady state frames\n", static_cast<unsigned long long>(allocations), c_frames);
+    }
+}
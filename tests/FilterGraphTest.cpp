@@ -0,0 +1,106 @@
+// Filter graph tests: graphs from filter parameters must match FilterCPU::process for every filter
+// type, so that a new filter type cannot be added without a graph stage
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "ColorLut.hpp"
+#include "FilterGraph.hpp"
+#include "Test.hpp"
+
+namespace
+{
+// Largest difference between graph and engine output. Both run the same row functions.
+constexpr float c_tolerance = 1e-6f;
+
+// Image sizes: band multiples, odd sizes, single pixel and a column narrower than the kernels
+struct Shape {
+    int width;
+    int height;
+};
+
+const Shape c_shapes[] = {{64, 48}, {37, 19}, {1, 1}, {5, 130}};
+
+// Returns deterministic image with edges and noise
+ImageRGBA makeImage(const Shape& shape)
+{
+    ImageRGBA image;
+    image.resize(shape.width, shape.height);
+    uint32_t state = 0x9e3779b9u;
+    for (int y = 0; y < shape.height; y++) {
+        float* row = image.row(y);
+        for (int x = 0; x < shape.width; x++) {
+            for (int c = 0; c < 4; c++) {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                const float edge = (x * 2 < shape.width) == (y * 3 < shape.height) ? 0.2f : 0.8f;
+                row[x * 4 + c] = edge + ((state >> 8) * (1.0f / 16777216.0f) - 0.5f) * 0.1f;
+            }
+        }
+    }
+    return image;
+}
+
+// Returns largest absolute difference of images, infinity if sizes differ
+float getMaxDifference(const ImageRGBA& a, const ImageRGBA& b)
+{
+    if (a.width != b.width || a.height != b.height) {
+        return INFINITY;
+    }
+    float maxDiff = 0.0f;
+    for (size_t i = 0; i < a.pixels.size(); i++) {
+        maxDiff = std::max(maxDiff, std::abs(a.pixels[i] - b.pixels[i]));
+    }
+    return maxDiff;
+}
+
+}  // namespace
+
+void runFilterGraphTests(const std::string& filter)
+{
+    if (!Test::isSelected(filter, "filter-graph")) {
+        return;
+    }
+
+    ColorLut colorLut;
+    colorLut.bake(ColorLut::Params());
+
+    for (const auto& shape : c_shapes) {
+        const ImageRGBA src = makeImage(shape);
+        for (const int lowPassMode : {FilterCPU::LowPassDirect, FilterCPU::LowPassSeparable}) {
+            for (const bool grading : {false, true}) {
+                for (int filterType = FilterCPU::FilterNone; filterType < FilterCPU::FilterTypeCount; filterType++) {
+                    FilterCPU::Params params;
+                    params.filterType = filterType;
+                    params.highPassCutoffFreq = 5.0f;
+                    params.lowPassMode = lowPassMode;
+                    params.colorFactor = grading ? 0.75f : 0.0f;
+                    const ColorLut* lut = grading ? &colorLut : nullptr;
+
+                    ImageRGBA expected;
+                    FilterCPU::process(src, expected, params, lut);
+
+                    ImageRGBA actual;
+                    float maxDiff = INFINITY;
+                    try {
+                        FilterGraph graph = FilterGraph::fromParams(params);
+                        graph.compile(params, lut);
+                        graph.process(src, actual);
+                        maxDiff = getMaxDifference(expected, actual);
+                    } catch (const std::invalid_argument& e) {
+                        std::printf("%s\n", e.what());
+                    }
+                    if (!TEST_CHECK(maxDiff <= c_tolerance)) {
+                        std::printf("  filter type %d, %dx%d, low pass mode %d, grading %d: max difference %g\n", filterType, shape.width,
+                            shape.height, lowPassMode, grading ? 1 : 0, static_cast<double>(maxDiff));
+                    }
+                }
+            }
+        }
+    }
+}
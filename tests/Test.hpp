@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+//! Minimal test helpers for portable CPU code paths
+namespace Test
+{
+//! Returns number of failed checks so far
+inline int& getFailureCount()
+{
+    static int count = 0;
+    return count;
+}
+
+//! Returns true if test group name matches command line filter (substring, empty matches all)
+inline bool isSelected(const std::string& filter, const std::string& name) { return filter.empty() || name.find(filter) != std::string::npos; }
+
+//! Record result of a check, failed checks are printed with their location. Returns the condition.
+inline bool check(bool condition, const char* expression, const char* file, int line)
+{
+    if (!condition) {
+        std::printf("%s:%d: check failed: %s\n", file, line, expression);
+        getFailureCount()++;
+    }
+    return condition;
+}
+
+}  // namespace Test
+
+//! Check condition, continuing the test on failure. Evaluates to the condition.
+#define TEST_CHECK(condition) Test::check((condition), #condition, __FILE__, __LINE__)
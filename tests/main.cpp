@@ -0,0 +1,26 @@
+// Tests for CPU side code paths. Runs without Varjo runtime or GPU.
+//
+// Usage: VideoPostProcessTests [filter]
+// Runs test groups whose name contains the filter string, or all if omitted. Exit code is
+// nonzero if any check failed.
+
+#include <cstdio>
+#include <string>
+
+#include "Test.hpp"
+
+// Test groups
+void runAllocationTests(const std::string& filter);
+void runFilterGraphTests(const std::string& filter);
+
+int main(int argc, char** argv)
+{
+    const std::string filter = argc > 1 ? argv[1] : "";
+
+    runAllocationTests(filter);
+    runFilterGraphTests(filter);
+
+    const int failures = Test::getFailureCount();
+    std::printf("%d checks failed\n", failures);
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,255 @@
+// Offline filter command: applies the CPU filter chain to raw RGBA frame sequences or Y4M video.
+//
+// Reading, filtering and writing run as frame pipeline stages over a fixed set of frame buffers,
+// so memory use is bounded regardless of stream length. Filtering itself uses all cores through
+// the thread pool.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ColorLut.hpp"
+#include "FilterCPU.hpp"
+#include "FilterGraph.hpp"
+#include "FrameIO.hpp"
+#include "FramePipeline.hpp"
+#include "FilterTuner.hpp"
+#include "LatencyTracker.hpp"
+#include "Options.hpp"
+#include "ThreadPool.hpp"
+#include "TraceRecorder.hpp"
+
+namespace
+{
+// Default number of frames in flight
+constexpr int c_defaultBufferCount = 4;
+
+// Filter settings from options named after AppState::PostProcess fields
+struct FilterSettings {
+    FilterCPU::Params params;
+    bool colorEnabled = false;
+    ColorLut::Params lutParams;
+    std::string graph;
+};
+
+FilterSettings parseSettings(const Options& options)
+{
+    FilterSettings settings;
+    settings.params.filterType = options.getInt("filterType", FilterCPU::FilterNone);
+    settings.params.highPassCutoffFreq = options.getFloat("highPassCutoffFreq", 5.0f);
+    settings.params.kernelScale = options.getFloat("kernelScale", 1.0f);
+
+    // Tuned low pass strategy and band height for this machine, unless given explicitly
+    FilterTuner tuner;
+    FilterTuner::Setting tuned{settings.params.bandHeight, settings.params.lowPassMode};
+    if (tuner.load(options.get("tuning", FilterTuner::c_defaultFile))) {
+        tuned = tuner.getSetting(FilterTuner::Target::CPU, FilterTuner::getCPUIdentity(), settings.params.highPassCutoffFreq, tuned);
+    }
+    settings.params.lowPassMode = options.getInt("lowPassMode", tuned.lowPassMode);
+    settings.params.bandHeight = options.getInt("bandHeight", tuned.tileSize);
+    settings.params.tapStride = options.getInt("tapStride", 1);
+    settings.params.kernelShape = options.getInt("kernelShape", FilterCPU::KernelBox);
+    settings.params.ppd = options.getFloat("ppd", KernelBank::c_defaultPpd);
+    settings.params.gridCellSize = options.getInt("gridCellSize", 16);
+    settings.params.gridRangeBins = options.getInt("gridRangeBins", 8);
+    settings.params.enhanceGain = options.getFloat("enhanceGain", 1.0f);
+    settings.colorEnabled = options.getInt("colorEnabled", 0) != 0;
+    settings.params.colorFactor = settings.colorEnabled ? options.getFloat("colorFactor", 1.0f) : 0.0f;
+
+    // Same conversion from UI values as for the post process constant buffer
+    const std::vector<float> colorValue = options.getFloats("colorValue", {0.4f, 0.5f, 0.7f});
+    const std::vector<float> colorExp = options.getFloats("colorExp", {0.5f, 0.75f, 1.0f});
+    const float colorScale = options.getFloat("colorScale", 1.0f);
+    const float colorExpScale = options.getFloat("colorExpScale", 2.0f);
+    for (int c = 0; c < 3; c++) {
+        settings.lutParams.value[c] = std::max(0.0f, colorValue[c] * colorScale);
+        settings.lutParams.exponent[c] = 1.0f / std::max(0.01f, colorExp[c] / colorExpScale);
+    }
+    settings.lutParams.preserveSaturated = options.getFloat("colorPreserveSaturated", 1.0f);
+    settings.graph = options.get("graph", "");
+    return settings;
+}
+
+void printUsage()
+{
+    std::fprintf(stderr,
+        "Usage: filter [options] <input> <output>\n"
+        "\n"
+        "Input is Y4M video (detected from header) or raw RGBA8 frames. Output is Y4M if it ends with\n"
+        ".y4m, otherwise raw RGBA8. Paths with a printf style number (frame_%%05d.rgba) are frame\n"
+        "sequences, \"-\" is stdin or stdout.\n"
+        "\n"
+        "  --width N, --height N         Raw input frame size\n"
+        "  --fps N:D                     Y4M output frame rate for raw input (default 30:1)\n"
+        "  --frames N                    Maximum number of frames\n"
+        "  --buffers N                   Frame buffers in flight (default %d)\n"
+        "  --live FPS                    Read input at given frame rate like a camera, dropping frames\n"
+        "                                when filtering falls behind\n"
+        "  --y4m 0|1                     Force output format\n"
+        "  --latencyBudget MS            Fail if p99 latency from capture to write is over budget\n"
+        "  --latencyJson FILE            Write latency histograms and timeline as JSON\n"
+        "\n"
+        "Filter options, named and defaulted as in the application post process state:\n"
+        "  --filterType N                0=none 1=high pass 2=low pass 3=invert 4=kaleidoscope 5=high pass special\n"
+        "                                6=bilateral grid edge enhancement\n"
+        "  --highPassCutoffFreq F        Cutoff frequency in cycles per degree\n"
+        "  --kernelScale F               Kernel offset scale in texels\n"
+        "  --lowPassMode N               0=direct 1=separable 2=integral 3=reduced (default from tuning)\n"
+        "  --bandHeight N                Rows per parallel work item (default from tuning)\n"
+        "  --tapStride N                 Low pass tap stride as set by adaptive quality (default 1)\n"
+        "  --kernelShape N               Low pass kernel 0=box 1=gaussian 2=windowed sinc, bank kernels\n"
+        "                                ignore lowPassMode\n"
+        "  --ppd F                       View pixels per degree for bank kernel lookup (default %.0f)\n"
+        "  --gridCellSize N              Bilateral grid cell size in pixels (default 16)\n"
+        "  --gridRangeBins N             Bilateral grid luminance bins (default 8)\n"
+        "  --enhanceGain F               Bilateral grid edge enhancement gain (default 1)\n"
+        "  --tuning FILE                 Autotuning results from tune command (default %s)\n"
+        "  --colorEnabled 0|1            Color grading, off by default\n"
+        "  --colorFactor F, --colorValue R,G,B, --colorExp R,G,B,\n"
+        "  --colorScale F, --colorExpScale F, --colorPreserveSaturated F\n"
+        "  --graph STAGES                Filter graph instead of filterType and color factor, fused to as few\n"
+        "                                passes as possible, e.g. invert,highpass:5,lut:1. Stages: invert,\n"
+        "                                gain:G:O, absclamp:G, lut:F, lowpass:C, highpass:C, highpass-special:C,\n"
+        "                                kaleidoscope, bilateral-grid:G:S:B\n",
+        c_defaultBufferCount, static_cast<double>(KernelBank::c_defaultPpd), FilterTuner::c_defaultFile);
+}
+
+}  // namespace
+
+int runFilterCommand(const Options& options)
+{
+    const auto& paths = options.getPositional();
+    if (paths.size() != 2) {
+        printUsage();
+        return 1;
+    }
+    const std::string& inputPath = paths[0];
+    const std::string& outputPath = paths[1];
+
+    const FilterSettings settings = parseSettings(options);
+    ColorLut colorLut;
+    if (settings.colorEnabled) {
+        colorLut.bake(settings.lutParams);
+    }
+    const ColorLut* lut = settings.colorEnabled ? &colorLut : nullptr;
+
+    // Filter graph, run by the single filter stage thread
+    std::shared_ptr<FilterGraph> graph;
+    if (!settings.graph.empty()) {
+        graph = std::make_shared<FilterGraph>();
+        std::string error;
+        if (!graph->parse(settings.graph, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        graph->compile(settings.params, lut);
+        std::fprintf(stderr, "Filter graph: %s\n", graph->describePasses().c_str());
+    }
+
+    std::unique_ptr<FrameReader> reader;
+    std::unique_ptr<FrameWriter> writer;
+    try {
+        reader = FrameReader::open(inputPath, options.getInt("width", 0), options.getInt("height", 0));
+
+        FrameStreamInfo outInfo = reader->getInfo();
+        if (!reader->isY4M() && options.has("fps")) {
+            std::sscanf(options.get("fps", "").c_str(), "%d:%d", &outInfo.fpsNum, &outInfo.fpsDen);
+        }
+        const bool y4mExtension = outputPath.size() > 4 && outputPath.compare(outputPath.size() - 4, 4, ".y4m") == 0;
+        const bool y4m = options.getInt("y4m", (y4mExtension || (outputPath == "-" && reader->isY4M())) ? 1 : 0) != 0;
+        writer = FrameWriter::create(outputPath, y4m, outInfo);
+    } catch (const std::runtime_error& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    const FrameStreamInfo& info = reader->getInfo();
+    const int64_t maxFrames = options.has("frames") ? options.getInt("frames", 0) : INT64_MAX;
+    const float liveFps = options.getFloat("live", 0.0f);
+
+    FramePipeline::Config config;
+    config.frameCount = static_cast<size_t>(std::max(1, options.getInt("buffers", c_defaultBufferCount)));
+    config.queueCapacity = config.frameCount;
+    config.liveSource = liveFps > 0.0f;
+    std::fprintf(stderr, "Input: %dx%d %s, %d buffers, %d threads, low pass mode %d, band height %d\n", info.width, info.height,
+        reader->isY4M() ? "Y4M" : "raw RGBA8", static_cast<int>(config.frameCount), ThreadPool::instance().getThreadCount(),
+        settings.params.lowPassMode, settings.params.bandHeight);
+
+    // Replay latency from capture to write on the steady clock: filter start and end stand in for
+    // frame sync and post process apply, write for submit
+    const double latencyBudgetMs = options.getFloat("latencyBudget", 1e-6f * LatencyTracker::c_defaultBudgetNs);
+    LatencyTracker latency(LatencyTracker::makeSteadyClock(), static_cast<int64_t>(latencyBudgetMs * 1e6));
+    const auto markLatency = [&latency](FramePipeline::Frame& frame, LatencyTracker::Event event) {
+        frame.latency.latencyNs[static_cast<size_t>(event)] = latency.now() - frame.latency.cameraTimeNs;
+    };
+
+    FramePipeline pipeline(config);
+    FramePipeline::Source source = [&](FramePipeline::Frame& frame) { return frame.index < maxFrames && reader->read(frame.image); };
+    pipeline.setSource("FrameRead", config.liveSource ? FramePipeline::makePacedSource(source, liveFps) : source);
+    FramePipeline::Stage filterStage = FramePipeline::makeFilterStage(settings.params, lut);
+    if (graph) {
+        filterStage = [graph](FramePipeline::Frame& frame) {
+            graph->process(frame.image, frame.scratch);
+            std::swap(frame.image, frame.scratch);
+        };
+    }
+    pipeline.addStage("Filter", [&](FramePipeline::Frame& frame) {
+        markLatency(frame, LatencyTracker::Event::Sync);
+        filterStage(frame);
+        markLatency(frame, LatencyTracker::Event::Apply);
+    });
+    pipeline.setSink("FrameWrite", [&](const FramePipeline::Frame& frame) {
+        writer->write(frame.image);
+        LatencyTracker::Sample sample = frame.latency;
+        sample.latencyNs[static_cast<size_t>(LatencyTracker::Event::Submit)] = latency.now() - sample.cameraTimeNs;
+        latency.addSample(sample);
+    });
+
+    using Clock = std::chrono::steady_clock;
+    const auto startTime = Clock::now();
+    const bool ok = pipeline.run();
+    const double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+    writer.reset();
+
+    const auto stats = pipeline.getStats();
+    const int64_t frameCount = static_cast<int64_t>(stats.back().frames);
+    if (!ok) {
+        std::fprintf(stderr, "Processing failed after %lld frames: %s\n", static_cast<long long>(frameCount), pipeline.getError().c_str());
+        return 1;
+    }
+
+    const double megapixels = static_cast<double>(info.width) * info.height * frameCount * 1e-6;
+    std::fprintf(stderr, "Processed %lld frames in %.2f s: %.1f fps, %.1f MP/s (%.1fx real time at %d:%d)\n", static_cast<long long>(frameCount),
+        seconds, frameCount / seconds, megapixels / seconds, frameCount / seconds * info.fpsDen / info.fpsNum, info.fpsNum, info.fpsDen);
+    std::fprintf(stderr, "%-12s %10s %12s %12s %12s %10s %10s\n", "Stage", "Frames", "ms/frame", "In stalls", "Out stalls", "Max queue", "Drops");
+    for (const auto& s : stats) {
+        std::fprintf(stderr, "%-12s %10llu %12.2f %12llu %12llu %10d %10llu\n", s.name.c_str(), static_cast<unsigned long long>(s.frames),
+            s.frames ? s.busyMs / s.frames : 0.0, static_cast<unsigned long long>(s.inputStalls), static_cast<unsigned long long>(s.outputStalls),
+            static_cast<int>(s.maxQueueDepth), static_cast<unsigned long long>(s.drops));
+    }
+
+    // Latency from capture, failing when writes are over budget
+    std::fprintf(stderr, "%-12s %10s %10s %10s %10s %10s %10s\n", "Latency", "Frames", "p50 ms", "p95 ms", "p99 ms", "max ms", "Over");
+    for (int i = 0; i < static_cast<int>(LatencyTracker::Event::Count); i++) {
+        const auto event = static_cast<LatencyTracker::Event>(i);
+        const auto s = latency.getStats(event);
+        std::fprintf(stderr, "%-12s %10llu %10.2f %10.2f %10.2f %10.2f %10llu\n", LatencyTracker::getEventName(event),
+            static_cast<unsigned long long>(s.count), s.p50, s.p95, s.p99, s.max, static_cast<unsigned long long>(s.overBudget));
+    }
+    if (options.has("latencyJson")) {
+        std::ofstream file(options.get("latencyJson", ""));
+        latency.writeJson(file);
+        file << std::endl;
+    }
+    const auto submitStats = latency.getStats(LatencyTracker::Event::Submit);
+    if (options.has("latencyBudget") && submitStats.p99 > latencyBudgetMs) {
+        std::fprintf(stderr, "Latency over budget: p99 %.2f ms > %.2f ms\n", submitStats.p99, latencyBudgetMs);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+//! Command line options: "--name value" pairs and positional arguments
+class Options
+{
+public:
+    //! Parse arguments after the command name. Returns false on a dangling option name.
+    bool parse(int argc, char** argv, int first)
+    {
+        for (int i = first; i < argc; i++) {
+            const std::string arg = argv[i];
+            if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+                if (i + 1 >= argc) {
+                    m_error = "Missing value for " + arg;
+                    return false;
+                }
+                m_values[arg.substr(2)] = argv[++i];
+            } else {
+                m_positional.push_back(arg);
+            }
+        }
+        return true;
+    }
+
+    //! Returns parse error
+    const std::string& getError() const { return m_error; }
+
+    //! Returns positional arguments
+    const std::vector<std::string>& getPositional() const { return m_positional; }
+
+    //! Returns true if option was given
+    bool has(const std::string& name) const { return m_values.count(name) > 0; }
+
+    //! Returns string option or default
+    std::string get(const std::string& name, const std::string& def) const
+    {
+        const auto it = m_values.find(name);
+        return it != m_values.end() ? it->second : def;
+    }
+
+    //! Returns integer option or default
+    int getInt(const std::string& name, int def) const { return has(name) ? std::atoi(get(name, "").c_str()) : def; }
+
+    //! Returns float option or default
+    float getFloat(const std::string& name, float def) const { return has(name) ? static_cast<float>(std::atof(get(name, "").c_str())) : def; }
+
+    //! Returns comma separated float list option or default. Missing trailing values keep their defaults.
+    std::vector<float> getFloats(const std::string& name, std::vector<float> def) const
+    {
+        if (!has(name)) {
+            return def;
+        }
+        const std::string value = get(name, "");
+        size_t pos = 0;
+        for (size_t i = 0; i < def.size() && pos <= value.size(); i++) {
+            const size_t end = std::min(value.find(',', pos), value.size());
+            if (end > pos) {
+                def[i] = static_cast<float>(std::atof(value.substr(pos, end - pos).c_str()));
+            }
+            pos = end + 1;
+        }
+        return def;
+    }
+
+private:
+    std::map<std::string, std::string> m_values;  //!< Option values by name
+    std::vector<std::string> m_positional;        //!< Positional arguments
+    std::string m_error;                          //!< Parse error
+};
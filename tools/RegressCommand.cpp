@@ -0,0 +1,378 @@
+// Regression command: runs every filter mode on fixed inputs and compares output against stored golden
+// images, and optionally timing against baseline timings.
+//
+// Golden images are written as raw RGBA8 frames into the golden directory with --update. Outputs are
+// quantized to 8 bits the same way before comparing by PSNR and maximum error. Timing depends on the
+// machine and its load, so it is only compared when a baseline file from the same machine is given.
+// A missing baseline file is recorded from the run. The RegressTiming CTest keeps its baseline in the
+// build directory. A CI job records a baseline on the base commit and compares the change against it:
+//
+//   git checkout <base> && build && rm -f timings.txt && VideoPostProcessTool regress --timings timings.txt
+//   git checkout <change> && build && VideoPostProcessTool regress --timings timings.txt
+//
+// Goldens come from FilterCPU only, the CPU port of the post process shader. Edits to
+// vstPostProcess.hlsl that change output without a matching FilterCPU change are not detected here.
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "ColorLut.hpp"
+#include "FilterCPU.hpp"
+#include "FrameIO.hpp"
+#include "Options.hpp"
+#include "PixelConvert.hpp"
+#include "TestPattern.hpp"
+
+namespace
+{
+// Size of generated inputs
+constexpr int c_inputSize = 128;
+
+// Default thresholds. Identical output scores 99 dB, rounding differences between compilers a few code values.
+constexpr float c_defaultMinPsnr = 50.0f;
+constexpr int c_defaultMaxError = 2;
+
+// Default allowed slowdown from baseline. Cases are timed as the minimum over batches, which is
+// stable to a few percent, so a 30% margin absorbs clock boost while doubled cost fails.
+constexpr float c_defaultTimeTolerance = 0.3f;
+
+// Absolute timing slack, keeps the fastest cases of a few microseconds from failing on clock noise
+constexpr double c_timeSlackMs = 0.01;
+
+// Timing batches and minimum batch length
+constexpr int c_timingBatches = 7;
+constexpr double c_minBatchMs = 20.0;
+
+// Regression input image
+struct Input {
+    std::string name;  // Input name used in case names
+    ImageRGBA image;   // Input image
+};
+
+// Regression case
+struct Case {
+    std::string name;          // Case name, also golden file name
+    const Input* input;        // Input image
+    FilterCPU::Params params;  // Filter parameters
+    bool colorGrading;         // Apply color grading LUT
+};
+
+// Same pattern as TestTexture::Type::Gradient, including the debug grid
+Input makeGradientInput()
+{
+    Input input;
+    input.name = "gradient";
+    input.image.resize(c_inputSize, c_inputSize);
+    TestPattern::generateGradient(c_inputSize, c_inputSize, 4, input.image.pixels.data(), c_inputSize * 4 * sizeof(float));
+    return input;
+}
+
+// Deterministic hash noise, high frequency content for pass filters
+Input makeNoiseInput()
+{
+    Input input;
+    input.name = "noise";
+    input.image.resize(c_inputSize, c_inputSize);
+    uint32_t state = 0x9e3779b9u;
+    for (float& value : input.image.pixels) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        value = (state >> 8) * (1.0f / 16777216.0f);
+    }
+    return input;
+}
+
+// Build case list for all filter modes. Cutoff and low pass strategy only matter for pass filters.
+std::vector<Case> makeCases(const std::vector<Input>& inputs)
+{
+    const std::vector<int> filterTypes = {FilterCPU::FilterNone, FilterCPU::FilterHighPass, FilterCPU::FilterLowPass, FilterCPU::FilterInvert,
+        FilterCPU::FilterKaleidoscope, FilterCPU::FilterHighPassSpecial, FilterCPU::FilterBilateralGrid};
+    const std::vector<float> cutoffs = {1.0f, 5.0f, 20.0f};
+
+    std::vector<Case> cases;
+    for (const auto& input : inputs) {
+        for (int filterType : filterTypes) {
+            const bool passFilter =
+                filterType == FilterCPU::FilterHighPass || filterType == FilterCPU::FilterLowPass || filterType == FilterCPU::FilterHighPassSpecial;
+            for (float cutoff : passFilter ? cutoffs : std::vector<float>{0.0f}) {
+                Case c;
+                c.input = &input;
+                c.params.filterType = filterType;
+                c.params.highPassCutoffFreq = cutoff;
+                c.colorGrading = false;
+                c.name = input.name + "_f" + std::to_string(filterType);
+                if (passFilter) {
+                    c.name += "_c" + std::to_string(static_cast<int>(cutoff));
+                }
+                cases.push_back(c);
+            }
+        }
+
+        // Low pass strategies at kernel sizes 5 and 11
+        for (int mode = FilterCPU::LowPassDirect; mode < FilterCPU::LowPassModeCount; mode++) {
+            for (int kernelSize : {5, 11}) {
+                Case c;
+                c.input = &input;
+                c.params.filterType = FilterCPU::FilterLowPass;
+                c.params.highPassCutoffFreq = 1.0f / kernelSize;
+                c.params.lowPassMode = mode;
+                c.colorGrading = false;
+                c.name = input.name + "_lowpass_k" + std::to_string(kernelSize) + "_m" + std::to_string(mode);
+                cases.push_back(c);
+            }
+        }
+
+        // Color grading on top of no filter
+        Case c;
+        c.input = &input;
+        c.params.colorFactor = 1.0f;
+        c.colorGrading = true;
+        c.name = input.name + "_color";
+        cases.push_back(c);
+    }
+    return cases;
+}
+
+// Returns minimum time per call in milliseconds over timing batches
+template <typename Func>
+double measureMs(Func&& func)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Warm up and find batch size long enough for clock resolution
+    int callsPerBatch = 1;
+    while (true) {
+        const auto t0 = Clock::now();
+        for (int i = 0; i < callsPerBatch; i++) {
+            func();
+        }
+        if (std::chrono::duration<double, std::milli>(Clock::now() - t0).count() >= c_minBatchMs || callsPerBatch >= (1 << 16)) {
+            break;
+        }
+        callsPerBatch *= 2;
+    }
+
+    double minMs = 0.0;
+    for (int b = 0; b < c_timingBatches; b++) {
+        const auto t0 = Clock::now();
+        for (int i = 0; i < callsPerBatch; i++) {
+            func();
+        }
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count() / callsPerBatch;
+        minMs = (b == 0) ? ms : std::min(minMs, ms);
+    }
+    return minMs;
+}
+
+// Compare image to golden. Image is quantized to 8 bits as when written as golden. Returns PSNR in dB
+// over all channels and maximum error in 8-bit code values.
+void compare(const ImageRGBA& image, const ImageRGBA& golden, double& psnr, int& maxError)
+{
+    const size_t pitch = static_cast<size_t>(image.width) * 4;
+    std::vector<uint8_t> quantized(pitch * image.height);
+    PixelConvert::convert(PixelFormat::RGBA32Float, image.pixels.data(), pitch * sizeof(float), PixelFormat::RGBA8Unorm, quantized.data(), pitch,
+        image.width, image.height);
+
+    double squaredError = 0.0;
+    maxError = 0;
+    for (size_t i = 0; i < quantized.size(); i++) {
+        const int error = std::abs(quantized[i] - static_cast<int>(std::lround(golden.pixels[i] * 255.0f)));
+        squaredError += static_cast<double>(error) * error;
+        maxError = std::max(maxError, error);
+    }
+    const double mse = squaredError / std::max<size_t>(quantized.size(), 1);
+    psnr = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+}
+
+// Create directory if it does not exist
+bool makeDirectory(const std::string& path)
+{
+#ifdef _WIN32
+    const int ret = _mkdir(path.c_str());
+#else
+    const int ret = mkdir(path.c_str(), 0755);
+#endif
+    return ret == 0 || errno == EEXIST;
+}
+
+std::map<std::string, double> loadTimings(const std::string& path)
+{
+    std::map<std::string, double> timings;
+    std::ifstream file(path);
+    std::string name;
+    double ms;
+    while (file >> name >> ms) {
+        timings[name] = ms;
+    }
+    return timings;
+}
+
+void printUsage()
+{
+    std::fprintf(stderr,
+        "Usage: regress [options]\n"
+        "\n"
+        "Runs every filter mode on fixed inputs, compares output to golden images and optionally timing to baseline.\n"
+        "\n"
+        "  --golden DIR                  Golden image directory (default golden)\n"
+        "  --update 1                    Write golden images and baseline timings instead of comparing\n"
+        "  --timings FILE                Baseline timing file of this machine, recorded if missing. Timing is\n"
+        "                                not measured without it\n"
+        "  --input FILE                  Add recorded frame input: Y4M or raw RGBA8 with --width and --height\n"
+        "  --cases TEXT                  Run only cases whose name contains text\n"
+        "  --minPsnr DB                  Minimum PSNR against golden (default %.0f)\n"
+        "  --maxError N                  Maximum error in 8-bit code values (default %d)\n"
+        "  --timeTolerance F             Allowed slowdown from baseline, 1.0 = 100%% (default %.2f)\n",
+        c_defaultMinPsnr, c_defaultMaxError, c_defaultTimeTolerance);
+}
+
+}  // namespace
+
+int runRegressCommand(const Options& options)
+{
+    if (!options.getPositional().empty()) {
+        printUsage();
+        return 1;
+    }
+
+    const std::string goldenDir = options.get("golden", "golden");
+    const bool update = options.getInt("update", 0) != 0;
+    const std::string caseFilter = options.get("cases", "");
+    const float minPsnr = options.getFloat("minPsnr", c_defaultMinPsnr);
+    const int maxAllowedError = options.getInt("maxError", c_defaultMaxError);
+    const float timeTolerance = options.getFloat("timeTolerance", c_defaultTimeTolerance);
+    const std::string timingPath = options.get("timings", "");
+    const bool timed = !timingPath.empty();
+    const bool recordTimings = timed && (update || !std::ifstream(timingPath));
+
+    std::vector<Input> inputs;
+    inputs.push_back(makeGradientInput());
+    inputs.push_back(makeNoiseInput());
+    if (options.has("input")) {
+        try {
+            auto reader = FrameReader::open(options.get("input", ""), options.getInt("width", 0), options.getInt("height", 0));
+            Input input;
+            input.name = "recorded";
+            if (!reader->read(input.image)) {
+                throw std::runtime_error("No frames in input");
+            }
+            inputs.push_back(std::move(input));
+        } catch (const std::runtime_error& e) {
+            std::fprintf(stderr, "Reading input failed: %s\n", e.what());
+            return 1;
+        }
+    }
+
+    if (update && !makeDirectory(goldenDir)) {
+        std::fprintf(stderr, "Creating golden directory failed: %s\n", goldenDir.c_str());
+        return 1;
+    }
+
+    ColorLut colorLut;
+    colorLut.bake(ColorLut::Params());
+
+    const auto baseline = timed && !recordTimings ? loadTimings(timingPath) : std::map<std::string, double>();
+    std::map<std::string, double> timings = timed ? loadTimings(timingPath) : std::map<std::string, double>();
+
+    std::printf("%-28s %10s %10s %12s %12s  %s\n", "Case", "PSNR", "Max error", "Time ms", "Baseline ms", "Result");
+
+    int failed = 0;
+    int run = 0;
+    ImageRGBA output;
+    for (const auto& c : makeCases(inputs)) {
+        if (!caseFilter.empty() && c.name.find(caseFilter) == std::string::npos) {
+            continue;
+        }
+        run++;
+
+        const ColorLut* lut = c.colorGrading ? &colorLut : nullptr;
+        FilterCPU::process(c.input->image, output, c.params, lut);
+        const double ms = timed ? measureMs([&] { FilterCPU::process(c.input->image, output, c.params, lut); }) : 0.0;
+
+        FrameStreamInfo info;
+        info.width = output.width;
+        info.height = output.height;
+        const std::string goldenPath = goldenDir + "/" + c.name + ".rgba";
+
+        if (update) {
+            try {
+                FrameWriter::create(goldenPath, false, info)->write(output);
+            } catch (const std::runtime_error& e) {
+                std::fprintf(stderr, "Writing golden failed: %s\n", e.what());
+                return 1;
+            }
+            if (timed) {
+                timings[c.name] = ms;
+            }
+            std::printf("%-28s %10s %10s %12.3f %12s  %s\n", c.name.c_str(), "-", "-", ms, "-", "UPDATED");
+            continue;
+        }
+
+        // Compare output against golden
+        ImageRGBA golden;
+        std::string result = "OK";
+        double psnr = 0.0;
+        int maxError = 0;
+        try {
+            auto reader = FrameReader::open(goldenPath, info.width, info.height);
+            if (!reader->read(golden)) {
+                throw std::runtime_error("Empty golden");
+            }
+            compare(output, golden, psnr, maxError);
+            if (psnr < minPsnr || maxError > maxAllowedError) {
+                result = "FAIL output";
+            }
+        } catch (const std::runtime_error&) {
+            result = "FAIL no golden";
+        }
+
+        // Compare timing against baseline
+        const auto it = baseline.find(c.name);
+        const double baselineMs = it != baseline.end() ? it->second : 0.0;
+        if (baselineMs > 0.0 && ms > baselineMs * (1.0 + timeTolerance) + c_timeSlackMs) {
+            result = (result == "OK") ? "FAIL time" : result + ", time";
+        }
+
+        if (recordTimings) {
+            timings[c.name] = ms;
+        }
+        if (result != "OK") {
+            failed++;
+        }
+        std::printf("%-28s %10.2f %10d %12.3f %12.3f  %s\n", c.name.c_str(), psnr, maxError, ms, baselineMs, result.c_str());
+    }
+
+    if (recordTimings) {
+        std::ofstream file(timingPath);
+        for (const auto& t : timings) {
+            file << t.first << " " << t.second << "\n";
+        }
+        if (!file) {
+            std::fprintf(stderr, "Writing baseline timings failed: %s\n", timingPath.c_str());
+            return 1;
+        }
+        std::printf("Recorded baseline timings: %s\n", timingPath.c_str());
+    }
+    if (update) {
+        std::printf("Updated %d cases in %s\n", run, goldenDir.c_str());
+        return 0;
+    }
+
+    std::printf("%d of %d cases failed\n", failed, run);
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,65 @@
+// Tune command: times CPU filter band heights and low pass strategies on each kernel size range and
+// stores the fastest for this machine. The filter command applies stored results automatically.
+
+#include <cstdio>
+#include <string>
+
+#include "FilterTuner.hpp"
+#include "Options.hpp"
+#include "ThreadPool.hpp"
+
+namespace
+{
+// Default tuning frame size
+constexpr int c_defaultWidth = 1280;
+constexpr int c_defaultHeight = 720;
+
+const char* const c_lowPassModeNames[FilterCPU::LowPassModeCount] = {"direct", "separable", "integral", "reduced"};
+
+void printUsage()
+{
+    std::fprintf(stderr,
+        "Usage: tune [options]\n"
+        "\n"
+        "Times CPU filter band heights and low pass strategies and stores the fastest per cutoff range.\n"
+        "\n"
+        "  --width N, --height N         Frame size to tune for (default %dx%d)\n"
+        "  --tuning FILE                 Results file, results of other machines are kept (default %s)\n",
+        c_defaultWidth, c_defaultHeight, FilterTuner::c_defaultFile);
+}
+
+}  // namespace
+
+int runTuneCommand(const Options& options)
+{
+    if (!options.getPositional().empty()) {
+        printUsage();
+        return 1;
+    }
+
+    const int width = options.getInt("width", c_defaultWidth);
+    const int height = options.getInt("height", c_defaultHeight);
+    const std::string path = options.get("tuning", FilterTuner::c_defaultFile);
+    if (width <= 0 || height <= 0) {
+        printUsage();
+        return 1;
+    }
+
+    FilterTuner tuner;
+    tuner.load(path);
+
+    std::fprintf(stderr, "Tuning CPU filter at %dx%d on %d threads..\n", width, height, ThreadPool::instance().getThreadCount());
+    const uint64_t identity = FilterTuner::getCPUIdentity();
+    tuner.tune(FilterTuner::Target::CPU, identity, FilterTuner::getCPUCandidates(), FilterTuner::makeCPUMeasure(width, height));
+
+    std::printf("%-16s %12s %12s %12s\n", "Max kernel", "Band height", "Low pass", "ms/frame");
+    for (const auto& range : tuner.getResults(FilterTuner::Target::CPU, identity)) {
+        std::printf("%-16d %12d %12s %12.2f\n", range.maxKernelSize, range.setting.tileSize, c_lowPassModeNames[range.setting.lowPassMode], range.ms);
+    }
+
+    if (!tuner.save(path)) {
+        std::fprintf(stderr, "Writing tuning results failed: %s\n", path.c_str());
+        return 1;
+    }
+    return 0;
+}
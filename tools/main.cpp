@@ -0,0 +1,45 @@
+// Command line tools for offline processing with the CPU filter engine. Runs without Varjo runtime or GPU.
+//
+// Usage: VideoPostProcessTool <command> [options]
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "Options.hpp"
+
+// Commands
+int runFilterCommand(const Options& options);
+int runRegressCommand(const Options& options);
+int runTuneCommand(const Options& options);
+
+int main(int argc, char** argv)
+{
+    const char* command = argc > 1 ? argv[1] : "";
+
+    Options options;
+    if (!options.parse(argc, argv, 2)) {
+        std::fprintf(stderr, "%s\n", options.getError().c_str());
+        return 1;
+    }
+
+    if (std::strcmp(command, "filter") == 0) {
+        return runFilterCommand(options);
+    }
+    if (std::strcmp(command, "regress") == 0) {
+        return runRegressCommand(options);
+    }
+    if (std::strcmp(command, "tune") == 0) {
+        return runTuneCommand(options);
+    }
+
+    std::fprintf(stderr,
+        "Usage: %s <command> [options]\n"
+        "\n"
+        "Commands:\n"
+        "  filter    Apply filter chain to raw RGBA frames or Y4M video\n"
+        "  regress   Compare filter modes against golden images and optionally baseline timings\n"
+        "  tune      Find fastest CPU filter settings for this machine\n",
+        argc > 0 ? argv[0] : "VideoPostProcessTool");
+    return 1;
+}